@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "client.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "../src/common/log.h"
+#include "../src/mp/command.h"
+
+#include "world.h"
+
+using namespace std;
+
+using namespace reone::mp;
+
+namespace reone {
+
+namespace loadtest {
+
+static const float kViewRadius = 32.0f;
+static const float kViewAngularSpeed = 0.2f; // radians per second
+
+SimulatedClient::SimulatedClient(int index, const LoadTestOptions &opts) :
+    _index(index),
+    _opts(opts),
+    _incomingLink(opts.network, 2 * index + 1),
+    _outgoingLink(opts.network, 2 * index + 2) {
+
+    // Spread viewpoints over the world deterministically
+    uint32_t hash = static_cast<uint32_t>(index) * 2654435761u;
+    _viewCenter.x = kViewRadius + (hash & 0xffff) / 65535.0f * (kWorldSizeX - 2.0f * kViewRadius);
+    _viewCenter.y = kViewRadius + (hash >> 16) / 65535.0f * (kWorldSizeY - 2.0f * kViewRadius);
+}
+
+void SimulatedClient::start() {
+    _startTime = chrono::steady_clock::now();
+    _nextPing = _startTime;
+    _client.start("127.0.0.1", _opts.port);
+}
+
+void SimulatedClient::stop() {
+    _client.stop();
+}
+
+void SimulatedClient::update(TimePoint now) {
+    if (!_client.isConnected()) return;
+
+    receive(now);
+
+    if (_opts.pingRate > 0 && now >= _nextPing) {
+        sendPing(now);
+        _nextPing += chrono::microseconds(1000000 / _opts.pingRate);
+    }
+    flush(now);
+}
+
+void SimulatedClient::receive(TimePoint now) {
+    if (_opts.network.isIdeal()) {
+        _client.poll([this, &now](const char *data, size_t size) { processCommand(data, size, now); });
+        return;
+    }
+
+    // Frames are copied out of the receive buffer to be delivered later
+    _client.poll([this, &now](const char *data, size_t size) {
+        _incoming.push_back(make_pair(_incomingLink.getDeliveryTime(now), ByteArray(data, data + size)));
+    });
+    while (!_incoming.empty() && _incoming.front().first <= now) {
+        const ByteArray &frame = _incoming.front().second;
+        processCommand(frame.data(), frame.size(), now);
+        _incoming.pop_front();
+    }
+}
+
+void SimulatedClient::flush(TimePoint now) {
+    while (!_outgoing.empty() && _outgoing.front().first <= now) {
+        _client.send(_outgoing.front().second);
+        _outgoing.pop_front();
+    }
+}
+
+void SimulatedClient::send(const shared_ptr<net::Command> &command, TimePoint now) {
+    ++_stats.framesSent;
+
+    if (_opts.network.isIdeal()) {
+        _client.send(command);
+    } else {
+        _outgoing.push_back(make_pair(_outgoingLink.getDeliveryTime(now), command));
+    }
+}
+
+void SimulatedClient::sendPing(TimePoint now) {
+    // Payload starts with the send time, so that no state is needed to match
+    // pongs to pings
+    int64_t sendTime = chrono::duration_cast<chrono::nanoseconds>(now.time_since_epoch()).count();
+
+    ByteArray payload(max(_opts.pingPayload, static_cast<int>(sizeof(sendTime))), 0);
+    memcpy(&payload[0], &sendTime, sizeof(sendTime));
+
+    auto ping = make_shared<Command>(_cmdCounter++, CommandType::Ping);
+    ping->setTick(_pingCounter++);
+    ping->setPayload(move(payload));
+
+    send(ping, now);
+}
+
+void SimulatedClient::processCommand(const char *data, size_t size, TimePoint now) {
+    ++_stats.framesReceived;
+    _stats.bytesReceived += size;
+
+    Command cmd;
+    try {
+        cmd.load(data, size);
+    }
+    catch (const exception &e) {
+        warn("Client: malformed command received: " + string(e.what()));
+        return;
+    }
+
+    switch (cmd.type()) {
+        case CommandType::Snapshot: {
+            ++_stats.snapshotsReceived;
+
+            WorldSnapshot empty;
+            const WorldSnapshot *baseline = cmd.baselineTick() != 0 ? _snapshots.find(cmd.baselineTick()) : &empty;
+            if (!baseline) {
+                ++_stats.snapshotsDiscarded;
+                return;
+            }
+            const ByteArray &payload = cmd.payload();
+            BitReader reader(payload.data(), payload.size());
+            _snapshots.add(decodeSnapshotDelta(*baseline, cmd.tick(), reader));
+
+            glm::vec3 viewPosition(getViewPosition(now));
+
+            auto ack = make_shared<Command>(_cmdCounter++, CommandType::SnapshotAck);
+            ack->setTick(cmd.tick());
+            ack->setViewPosition(viewPosition);
+            ack->setViewRoom(getRoomName(viewPosition));
+            send(ack, now);
+            break;
+        }
+        case CommandType::Pong: {
+            const ByteArray &payload = cmd.payload();
+            if (payload.size() < sizeof(int64_t)) return;
+
+            int64_t sendTime;
+            memcpy(&sendTime, payload.data(), sizeof(sendTime));
+
+            chrono::nanoseconds roundTrip(now.time_since_epoch().count() - sendTime);
+            _stats.roundTrips.push_back(chrono::duration<float, milli>(roundTrip).count());
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+glm::vec3 SimulatedClient::getViewPosition(TimePoint now) const {
+    float angle = kViewAngularSpeed * chrono::duration<float>(now - _startTime).count() + _index;
+    return _viewCenter + kViewRadius * glm::vec3(cosf(angle), sinf(angle), 0.0f);
+}
+
+const ClientStats &SimulatedClient::stats() const {
+    return _stats;
+}
+
+} // namespace loadtest
+
+} // namespace reone
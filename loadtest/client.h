@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "glm/vec3.hpp"
+
+#include "../src/common/types.h"
+#include "../src/mp/replication.h"
+#include "../src/net/client.h"
+
+#include "link.h"
+#include "options.h"
+
+namespace reone {
+
+namespace loadtest {
+
+struct ClientStats {
+    std::vector<float> roundTrips; /**< milliseconds */
+    uint64_t framesReceived { 0 };
+    uint64_t bytesReceived { 0 };
+    uint64_t framesSent { 0 };
+    uint64_t snapshotsReceived { 0 };
+    uint64_t snapshotsDiscarded { 0 }; /**< baseline was not found */
+};
+
+/**
+ * Client, that behaves like a multiplayer game client: decodes snapshots and
+ * acknowledges them, reporting a viewpoint that moves along a circle. In
+ * addition, it sends pings at the configured rate to measure round-trip time.
+ *
+ * Not thread-safe: all simulated clients are updated from a single thread.
+ */
+class SimulatedClient {
+public:
+    SimulatedClient(int index, const LoadTestOptions &opts);
+
+    void start();
+    void stop();
+
+    void update(std::chrono::steady_clock::time_point now);
+
+    const ClientStats &stats() const;
+
+private:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    int _index { 0 };
+    LoadTestOptions _opts;
+    net::Client _client;
+    mp::SnapshotHistory _snapshots;
+    uint32_t _cmdCounter { 0 };
+    uint32_t _pingCounter { 0 };
+    TimePoint _startTime;
+    TimePoint _nextPing;
+    glm::vec3 _viewCenter { 0.0f };
+    ClientStats _stats;
+
+    // Network conditions
+
+    LinkModel _incomingLink;
+    LinkModel _outgoingLink;
+    std::deque<std::pair<TimePoint, ByteArray>> _incoming;
+    std::deque<std::pair<TimePoint, std::shared_ptr<net::Command>>> _outgoing;
+
+    // END Network conditions
+
+    SimulatedClient(const SimulatedClient &) = delete;
+    SimulatedClient &operator=(const SimulatedClient &) = delete;
+
+    void receive(TimePoint now);
+    void flush(TimePoint now);
+    void send(const std::shared_ptr<net::Command> &command, TimePoint now);
+    void sendPing(TimePoint now);
+
+    void processCommand(const char *data, size_t size, TimePoint now);
+
+    glm::vec3 getViewPosition(TimePoint now) const;
+};
+
+} // namespace loadtest
+
+} // namespace reone
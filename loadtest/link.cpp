@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "link.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace reone {
+
+namespace loadtest {
+
+LinkModel::LinkModel(const NetworkConditions &conditions, uint32_t seed) : _conditions(conditions), _random(seed) {
+}
+
+chrono::steady_clock::time_point LinkModel::getDeliveryTime(chrono::steady_clock::time_point sendTime) {
+    int delay = _conditions.latency;
+
+    if (_conditions.jitter > 0) {
+        delay += uniform_int_distribution<int>(0, _conditions.jitter)(_random);
+    }
+    if (_conditions.loss > 0.0f && uniform_real_distribution<float>(0.0f, 1.0f)(_random) < _conditions.loss) {
+        delay += _conditions.retransmitTimeout;
+    }
+    _lastDelivery = max(_lastDelivery, sendTime + chrono::milliseconds(delay));
+
+    return _lastDelivery;
+}
+
+} // namespace loadtest
+
+} // namespace reone
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <random>
+
+#include "options.h"
+
+namespace reone {
+
+namespace loadtest {
+
+/**
+ * Models delivery of frames over a TCP connection with the configured
+ * latency, jitter and loss. TCP delivers frames in order, so a lost frame is
+ * retransmitted after a timeout and delays every frame behind it.
+ */
+class LinkModel {
+public:
+    LinkModel(const NetworkConditions &conditions, uint32_t seed);
+
+    /**
+     * @return time at which a frame, sent at the specified time, is delivered
+     */
+    std::chrono::steady_clock::time_point getDeliveryTime(std::chrono::steady_clock::time_point sendTime);
+
+private:
+    NetworkConditions _conditions;
+    std::mt19937 _random;
+    std::chrono::steady_clock::time_point _lastDelivery;
+};
+
+} // namespace loadtest
+
+} // namespace reone
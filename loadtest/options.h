@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+
+namespace reone {
+
+namespace loadtest {
+
+/**
+ * Artificial network conditions, applied by simulated clients to both
+ * directions of their connection.
+ */
+struct NetworkConditions {
+    int latency { 0 }; /**< one-way, in milliseconds */
+    int jitter { 0 }; /**< maximum extra one-way delay, in milliseconds */
+    float loss { 0.0f }; /**< probability of a frame being lost, from 0 to 1 */
+    int retransmitTimeout { 200 }; /**< delay of a lost frame, in milliseconds */
+
+    bool isIdeal() const { return latency == 0 && jitter == 0 && loss == 0.0f; }
+};
+
+struct LoadTestOptions {
+    int port { 0 };
+    int clientCount { 0 };
+    int objectCount { 0 };
+    int duration { 0 }; /**< seconds */
+    int pingRate { 0 }; /**< pings per second per client */
+    int pingPayload { 0 }; /**< bytes */
+    int ioThreads { 0 };
+    NetworkConditions network;
+    boost::filesystem::path output; /**< CSV file to append results to */
+};
+
+} // namespace loadtest
+
+} // namespace reone
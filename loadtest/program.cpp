@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "program.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+#include "client.h"
+#include "server.h"
+#include "stats.h"
+
+using namespace std;
+
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+
+namespace reone {
+
+namespace loadtest {
+
+static const int kDefaultPort = 47100;
+static const int kConnectTimeout = 5000; // milliseconds
+
+Program::Program(int argc, char **argv) : _argc(argc), _argv(argv) {
+}
+
+int Program::run() {
+    initOptions();
+    loadOptions();
+
+    if (_help) {
+        cout << _cmdLineOpts << endl;
+        return 0;
+    }
+
+    SyntheticServer server(_opts);
+    server.start();
+
+    vector<unique_ptr<SimulatedClient>> clients;
+    for (int i = 0; i < _opts.clientCount; ++i) {
+        auto client = make_unique<SimulatedClient>(i, _opts);
+        client->start();
+        clients.push_back(move(client));
+    }
+
+    // Give clients a chance to connect before measurements start
+    auto connectDeadline = chrono::steady_clock::now() + chrono::milliseconds(kConnectTimeout);
+    while (server.clientCount() < _opts.clientCount && chrono::steady_clock::now() < connectDeadline) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    if (server.clientCount() < _opts.clientCount) {
+        cerr << str(boost::format("Only %d of %d clients connected") % server.clientCount() % _opts.clientCount) << endl;
+    }
+
+    auto startTime = chrono::steady_clock::now();
+    auto endTime = startTime + chrono::seconds(_opts.duration);
+
+    for (auto now = startTime; now < endTime; now = chrono::steady_clock::now()) {
+        for (auto &client : clients) {
+            client->update(now);
+        }
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    float elapsed = chrono::duration<float>(chrono::steady_clock::now() - startTime).count();
+
+    for (auto &client : clients) {
+        client->stop();
+    }
+    server.stop();
+
+    // Aggregate
+
+    vector<float> roundTrips;
+    uint64_t framesReceived = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t framesSent = 0;
+    uint64_t snapshotsDiscarded = 0;
+
+    for (auto &client : clients) {
+        const ClientStats &stats = client->stats();
+        roundTrips.insert(roundTrips.end(), stats.roundTrips.begin(), stats.roundTrips.end());
+        framesReceived += stats.framesReceived;
+        bytesReceived += stats.bytesReceived;
+        framesSent += stats.framesSent;
+        snapshotsDiscarded += stats.snapshotsDiscarded;
+    }
+    Percentiles rtt(getPercentiles(roundTrips));
+    Percentiles tick(getPercentiles(server.tickTimes()));
+    MemoryUsage memory(getMemoryUsage());
+
+    // END Aggregate
+
+    cout << boost::format("clients=%d objects=%d duration=%.1fs latency=%dms jitter=%dms loss=%.3f") % _opts.clientCount % _opts.objectCount % elapsed % _opts.network.latency % _opts.network.jitter % _opts.network.loss << endl;
+    cout << boost::format("rtt ms: p50=%.2f p90=%.2f p99=%.2f max=%.2f (%d samples)") % rtt.p50 % rtt.p90 % rtt.p99 % rtt.max % roundTrips.size() << endl;
+    cout << boost::format("client in: %.0f frames/s, %.1f KB/s; client out: %.0f frames/s; discarded snapshots: %d") % (framesReceived / elapsed) % (bytesReceived / 1024.0f / elapsed) % (framesSent / elapsed) % snapshotsDiscarded << endl;
+    cout << boost::format("server tick ms: p50=%.2f p99=%.2f max=%.2f; snapshots: %.1f KB/s") % tick.p50 % tick.p99 % tick.max % (server.snapshotBytes() / 1024.0f / elapsed) << endl;
+    cout << boost::format("memory KB: resident=%d peak=%d") % memory.resident % memory.peakResident << endl;
+
+    if (!_opts.output.empty()) {
+        bool header = !fs::exists(_opts.output);
+        fs::ofstream csv(_opts.output, ios::app);
+        if (header) {
+            csv << "clients,objects,duration,latency,jitter,loss,rtt_p50,rtt_p90,rtt_p99,rtt_max,frames_in,kb_in,frames_out,tick_p50,tick_p99,tick_max,rss_kb,peak_rss_kb" << endl;
+        }
+        csv << boost::format("%d,%d,%.1f,%d,%d,%.3f,%.2f,%.2f,%.2f,%.2f,%.0f,%.1f,%.0f,%.2f,%.2f,%.2f,%d,%d")
+            % _opts.clientCount % _opts.objectCount % elapsed % _opts.network.latency % _opts.network.jitter % _opts.network.loss
+            % rtt.p50 % rtt.p90 % rtt.p99 % rtt.max
+            % (framesReceived / elapsed) % (bytesReceived / 1024.0f / elapsed) % (framesSent / elapsed)
+            % tick.p50 % tick.p99 % tick.max
+            % memory.resident % memory.peakResident
+            << endl;
+    }
+
+    return 0;
+}
+
+void Program::initOptions() {
+    _cmdLineOpts.add_options()
+        ("help", "print this message")
+        ("port", po::value<int>()->default_value(kDefaultPort), "loopback port to listen on")
+        ("clients", po::value<int>()->default_value(16), "number of simulated clients")
+        ("objects", po::value<int>()->default_value(256), "number of replicated objects")
+        ("duration", po::value<int>()->default_value(10), "duration of the test in seconds")
+        ("pingrate", po::value<int>()->default_value(10), "pings per second per client")
+        ("payload", po::value<int>()->default_value(64), "size of the ping payload in bytes")
+        ("netthreads", po::value<int>()->default_value(0), "number of server I/O threads, 0 to detect")
+        ("latency", po::value<int>()->default_value(0), "simulated one-way latency in milliseconds")
+        ("jitter", po::value<int>()->default_value(0), "simulated maximum one-way jitter in milliseconds")
+        ("loss", po::value<float>()->default_value(0.0f), "simulated frame loss probability, from 0 to 1")
+        ("out", po::value<string>(), "path to CSV file to append results to");
+}
+
+void Program::loadOptions() {
+    po::variables_map vars;
+    po::store(po::parse_command_line(_argc, _argv, _cmdLineOpts), vars);
+    po::notify(vars);
+
+    _help = vars.count("help") > 0;
+    _opts.port = vars["port"].as<int>();
+    _opts.clientCount = vars["clients"].as<int>();
+    _opts.objectCount = vars["objects"].as<int>();
+    _opts.duration = vars["duration"].as<int>();
+    _opts.pingRate = vars["pingrate"].as<int>();
+    _opts.pingPayload = vars["payload"].as<int>();
+    _opts.ioThreads = vars["netthreads"].as<int>();
+    _opts.network.latency = vars["latency"].as<int>();
+    _opts.network.jitter = vars["jitter"].as<int>();
+    _opts.network.loss = vars["loss"].as<float>();
+    _opts.output = vars.count("out") > 0 ? vars["out"].as<string>() : "";
+
+    if (_opts.network.loss < 0.0f || _opts.network.loss >= 1.0f) {
+        throw invalid_argument("Loss must be in range [0, 1)");
+    }
+}
+
+} // namespace loadtest
+
+} // namespace reone
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <boost/program_options/options_description.hpp>
+
+#include "options.h"
+
+namespace reone {
+
+namespace loadtest {
+
+/**
+ * Runs a synthetic server and a number of simulated clients over loopback
+ * for a fixed duration, then reports round-trip time, throughput, server
+ * tick time and memory usage.
+ */
+class Program {
+public:
+    Program(int argc, char **argv);
+
+    int run();
+
+private:
+    LoadTestOptions _opts;
+    bool _help { false };
+
+    // Command line arguments
+
+    int _argc { 0 };
+    char **_argv { nullptr };
+
+    // END Command line arguments
+
+    boost::program_options::options_description _cmdLineOpts { "Usage" };
+
+    Program(const Program &) = delete;
+    Program &operator=(const Program &) = delete;
+
+    void initOptions();
+    void loadOptions();
+};
+
+} // namespace loadtest
+
+} // namespace reone
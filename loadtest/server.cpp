@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "server.h"
+
+#include "../src/common/log.h"
+#include "../src/mp/command.h"
+
+using namespace std;
+using namespace std::placeholders;
+
+using namespace reone::mp;
+
+namespace reone {
+
+namespace loadtest {
+
+static const chrono::microseconds kSimulationStep(33333); // 30 Hz
+static const uint32_t kWorldSeed = 1;
+
+SyntheticServer::SyntheticServer(const LoadTestOptions &opts) : _opts(opts), _world(opts.objectCount, kWorldSeed) {
+}
+
+SyntheticServer::~SyntheticServer() {
+    stop();
+}
+
+void SyntheticServer::start() {
+    _replicator.setRooms(_world.roomNames(), _world.visibility());
+
+    _server.setOnClientConnected(bind(&Replicator::addClient, &_replicator, _1));
+    _server.setOnClientDisconnected(bind(&Replicator::removeClient, &_replicator, _1));
+    _server.start(_opts.port, _opts.ioThreads);
+
+    _running = true;
+    _thread = thread(bind(&SyntheticServer::run, this));
+}
+
+void SyntheticServer::stop() {
+    _running = false;
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    _server.stop();
+}
+
+void SyntheticServer::run() {
+    auto nextTick = chrono::steady_clock::now();
+
+    while (_running) {
+        auto tickStart = chrono::steady_clock::now();
+        update();
+        auto tickEnd = chrono::steady_clock::now();
+
+        _tickTimes.push_back(chrono::duration<float, milli>(tickEnd - tickStart).count());
+
+        // Fall behind rather than run a burst of ticks
+        nextTick = max(nextTick + kSimulationStep, tickEnd);
+        this_thread::sleep_until(nextTick);
+    }
+}
+
+void SyntheticServer::update() {
+    _server.poll(bind(&SyntheticServer::onCommandReceived, this, _1, _2, _3));
+
+    _world.update(chrono::duration<float>(kSimulationStep).count());
+
+    WorldSnapshot world;
+    vector<InterestObject> objects;
+    _world.capture(world, objects);
+    world.tick = ++_tick;
+
+    net::SendBufferPool &pool = net::SendBufferPool::instance();
+
+    _replicator.replicate(world, move(objects), [&](uint32_t client, uint32_t baselineTick, ByteArray payload) {
+        Command command(_cmdCounter++, CommandType::Snapshot);
+        command.setTick(world.tick);
+        command.setBaselineTick(baselineTick);
+        command.setPayload(move(payload));
+
+        net::SendBuffer *frame = pool.serialize(command);
+        _snapshotBytes += frame->data.size();
+        _server.send(client, frame);
+        pool.release(frame);
+    });
+}
+
+void SyntheticServer::onCommandReceived(uint32_t client, const char *data, size_t size) {
+    Command cmd;
+    try {
+        cmd.load(data, size);
+    }
+    catch (const exception &e) {
+        warn("Server: malformed command received: " + string(e.what()));
+        return;
+    }
+
+    switch (cmd.type()) {
+        case CommandType::SnapshotAck:
+            _replicator.acknowledge(client, cmd.tick(), cmd.viewPosition(), cmd.viewRoom());
+            break;
+        case CommandType::Ping: {
+            auto pong = make_shared<Command>(_cmdCounter++, CommandType::Pong);
+            pong->setTick(cmd.tick());
+            pong->setPayload(cmd.payload());
+            _server.send(client, pong);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+int SyntheticServer::clientCount() {
+    return _server.clientCount();
+}
+
+const vector<float> &SyntheticServer::tickTimes() const {
+    return _tickTimes;
+}
+
+uint64_t SyntheticServer::snapshotBytes() const {
+    return _snapshotBytes;
+}
+
+} // namespace loadtest
+
+} // namespace reone
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../src/mp/replicator.h"
+#include "../src/net/server.h"
+
+#include "options.h"
+#include "world.h"
+
+namespace reone {
+
+namespace loadtest {
+
+/**
+ * Headless server, that replicates a synthetic world through the same
+ * networking and replication code as the multiplayer game, and answers
+ * pings. Runs a fixed 30 Hz simulation on its own thread.
+ */
+class SyntheticServer {
+public:
+    SyntheticServer(const LoadTestOptions &opts);
+    ~SyntheticServer();
+
+    void start();
+    void stop();
+
+    int clientCount();
+
+    /**
+     * @return durations of server ticks in milliseconds, valid after stop
+     */
+    const std::vector<float> &tickTimes() const;
+
+    /**
+     * @return number of snapshot bytes sent to all clients, valid after stop
+     */
+    uint64_t snapshotBytes() const;
+
+private:
+    LoadTestOptions _opts;
+    net::Server _server;
+    mp::Replicator _replicator;
+    SyntheticWorld _world;
+    std::thread _thread;
+    std::atomic_bool _running { false };
+    uint32_t _tick { 0 };
+    uint32_t _cmdCounter { 0 };
+    std::vector<float> _tickTimes;
+    uint64_t _snapshotBytes { 0 };
+
+    SyntheticServer(const SyntheticServer &) = delete;
+    SyntheticServer &operator=(const SyntheticServer &) = delete;
+
+    void run();
+    void update();
+
+    void onCommandReceived(uint32_t client, const char *data, size_t size);
+};
+
+} // namespace loadtest
+
+} // namespace reone
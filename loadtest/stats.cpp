@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "stats.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+namespace reone {
+
+namespace loadtest {
+
+static float getPercentile(const vector<float> &sorted, float fraction) {
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5f);
+    return sorted[min(index, sorted.size() - 1)];
+}
+
+Percentiles getPercentiles(vector<float> samples) {
+    Percentiles result;
+    if (samples.empty()) return move(result);
+
+    sort(samples.begin(), samples.end());
+    result.p50 = getPercentile(samples, 0.5f);
+    result.p90 = getPercentile(samples, 0.9f);
+    result.p99 = getPercentile(samples, 0.99f);
+    result.max = samples.back();
+
+    return move(result);
+}
+
+MemoryUsage getMemoryUsage() {
+    MemoryUsage result;
+
+    // Linux only: values are reported in kilobytes
+    ifstream status("/proc/self/status");
+    string line;
+
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            result.resident = stoi(line.substr(6));
+        } else if (line.compare(0, 6, "VmHWM:") == 0) {
+            result.peakResident = stoi(line.substr(6));
+        }
+    }
+
+    return move(result);
+}
+
+} // namespace loadtest
+
+} // namespace reone
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace reone {
+
+namespace loadtest {
+
+struct Percentiles {
+    float p50 { 0.0f };
+    float p90 { 0.0f };
+    float p99 { 0.0f };
+    float max { 0.0f };
+};
+
+struct MemoryUsage {
+    int resident { 0 }; /**< kilobytes */
+    int peakResident { 0 }; /**< kilobytes */
+};
+
+/**
+ * @return percentiles of the samples, all zero if there are none
+ */
+Percentiles getPercentiles(std::vector<float> samples);
+
+/**
+ * @return memory usage of the current process, all zero if it is unknown
+ */
+MemoryUsage getMemoryUsage();
+
+} // namespace loadtest
+
+} // namespace reone
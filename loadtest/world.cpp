@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "world.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/format.hpp>
+
+using namespace std;
+
+using namespace reone::mp;
+
+namespace reone {
+
+namespace loadtest {
+
+static const float kMaxSpeed = 4.0f; // units per second
+static const float kAnimationChangeRate = 0.2f; // per second
+static const float kDamageRate = 0.05f; // per second
+static const int kMaxHitPoints = 100;
+
+static const char *kAnimations[] = { "pause1", "walk", "run", "talk_normal" };
+
+static int getRoomCoord(float val, int count) {
+    return max(0, min(static_cast<int>(floorf(val / kRoomSize)), count - 1));
+}
+
+static string getRoomName(int x, int y) {
+    return str(boost::format("room_%d_%d") % x % y);
+}
+
+string getRoomName(const glm::vec3 &position) {
+    return getRoomName(getRoomCoord(position.x, kRoomCountX), getRoomCoord(position.y, kRoomCountY));
+}
+
+int getRoomIndex(const glm::vec3 &position) {
+    return getRoomCoord(position.y, kRoomCountY) * kRoomCountX + getRoomCoord(position.x, kRoomCountX);
+}
+
+SyntheticWorld::SyntheticWorld(int objectCount, uint32_t seed) : _random(seed) {
+    // Rooms are listed in the order of their indices
+    for (int y = 0; y < kRoomCountY; ++y) {
+        for (int x = 0; x < kRoomCountX; ++x) {
+            string name(getRoomName(x, y));
+            _roomNames.push_back(name);
+
+            for (int adjY = max(0, y - 1); adjY <= min(y + 1, kRoomCountY - 1); ++adjY) {
+                for (int adjX = max(0, x - 1); adjX <= min(x + 1, kRoomCountX - 1); ++adjX) {
+                    if (adjX == x && adjY == y) continue;
+                    _visibility.insert(make_pair(name, getRoomName(adjX, adjY)));
+                }
+            }
+        }
+    }
+
+    uniform_real_distribution<float> positionX(0.0f, kWorldSizeX);
+    uniform_real_distribution<float> positionY(0.0f, kWorldSizeY);
+    uniform_real_distribution<float> velocity(-kMaxSpeed, kMaxSpeed);
+
+    for (int i = 0; i < objectCount; ++i) {
+        Object object;
+        object.id = static_cast<uint32_t>(i + 1);
+        object.position = glm::vec3(positionX(_random), positionY(_random), 0.0f);
+        object.velocity = glm::vec3(velocity(_random), velocity(_random), 0.0f);
+        object.hitPoints = kMaxHitPoints;
+        _objects.push_back(move(object));
+    }
+}
+
+void SyntheticWorld::update(float dt) {
+    uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+    for (auto &object : _objects) {
+        object.position += object.velocity * dt;
+
+        // Bounce off the world bounds
+        if (object.position.x < 0.0f || object.position.x > kWorldSizeX) {
+            object.velocity.x = -object.velocity.x;
+            object.position.x = max(0.0f, min(object.position.x, kWorldSizeX));
+        }
+        if (object.position.y < 0.0f || object.position.y > kWorldSizeY) {
+            object.velocity.y = -object.velocity.y;
+            object.position.y = max(0.0f, min(object.position.y, kWorldSizeY));
+        }
+        if (object.velocity.x != 0.0f || object.velocity.y != 0.0f) {
+            object.facing = atan2f(object.velocity.y, object.velocity.x);
+        }
+        if (chance(_random) < kAnimationChangeRate * dt) {
+            object.animation = (object.animation + 1) % (sizeof(kAnimations) / sizeof(kAnimations[0]));
+        }
+        if (chance(_random) < kDamageRate * dt) {
+            object.hitPoints = object.hitPoints > 1 ? object.hitPoints - 1 : kMaxHitPoints;
+        }
+    }
+}
+
+void SyntheticWorld::capture(WorldSnapshot &snapshot, vector<InterestObject> &objects) const {
+    snapshot.objects.reserve(_objects.size());
+    objects.reserve(_objects.size());
+
+    // Objects are created in the order of their ids
+    for (auto &object : _objects) {
+        ObjectState state;
+        state.id = object.id;
+        for (int i = 0; i < 3; ++i) {
+            state.position[i] = quantizePosition(object.position[i]);
+        }
+        state.facing = quantizeFacing(object.facing);
+        state.animation = kAnimations[object.animation];
+        state.hitPoints = object.hitPoints;
+        snapshot.objects.push_back(move(state));
+
+        InterestObject interestObject;
+        interestObject.id = object.id;
+        interestObject.position = object.position;
+        interestObject.room = getRoomIndex(object.position);
+        objects.push_back(move(interestObject));
+    }
+}
+
+const vector<string> &SyntheticWorld::roomNames() const {
+    return _roomNames;
+}
+
+const resource::Visibility &SyntheticWorld::visibility() const {
+    return _visibility;
+}
+
+} // namespace loadtest
+
+} // namespace reone
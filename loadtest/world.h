@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "glm/vec3.hpp"
+
+#include "../src/mp/interest.h"
+#include "../src/mp/replication.h"
+#include "../src/resource/types.h"
+
+namespace reone {
+
+namespace loadtest {
+
+const float kRoomSize = 64.0f;
+const int kRoomCountX = 4;
+const int kRoomCountY = 4;
+const float kWorldSizeX = kRoomSize * kRoomCountX;
+const float kWorldSizeY = kRoomSize * kRoomCountY;
+
+/**
+ * @return name of the synthetic room, containing the specified position
+ */
+std::string getRoomName(const glm::vec3 &position);
+
+/**
+ * @return index of the synthetic room, containing the specified position, in
+ *         the list of room names
+ */
+int getRoomIndex(const glm::vec3 &position);
+
+/**
+ * Grid of rooms, each visible from its neighbours, populated with objects
+ * that wander around, change animations and lose hit points.
+ */
+class SyntheticWorld {
+public:
+    SyntheticWorld(int objectCount, uint32_t seed);
+
+    void update(float dt);
+
+    /**
+     * Captures object states, sorted by id, along with interest objects in
+     * the same order.
+     */
+    void capture(mp::WorldSnapshot &snapshot, std::vector<mp::InterestObject> &objects) const;
+
+    const std::vector<std::string> &roomNames() const;
+    const resource::Visibility &visibility() const;
+
+private:
+    struct Object {
+        uint32_t id { 0 };
+        glm::vec3 position { 0.0f };
+        glm::vec3 velocity { 0.0f };
+        float facing { 0.0f };
+        int animation { 0 };
+        int hitPoints { 0 };
+    };
+
+    std::vector<Object> _objects;
+    std::vector<std::string> _roomNames;
+    resource::Visibility _visibility;
+    std::mt19937 _random;
+};
+
+} // namespace loadtest
+
+} // namespace reone
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "glm/vec3.hpp"
+
+#include "stream.h"
+
+namespace reone {
+
+namespace audio {
+
+/**
+ * Plays queued sample buffers on a limited number of voices. Used by the
+ * audio thread only.
+ */
+class AudioBackend {
+public:
+    virtual ~AudioBackend() = default;
+
+    virtual void init() = 0;
+    virtual void deinit() = 0;
+
+    /**
+     * Called by the audio thread after sounds are updated.
+     */
+    virtual void update() = 0;
+
+    /**
+     * @return true if the backend produces output only when updated, and must therefore be updated while idle
+     */
+    virtual bool isUpdatedWhileIdle() const { return false; }
+
+    virtual void setListenerPosition(const glm::vec3 &position) = 0;
+
+    // Voices
+
+    /**
+     * @return free voice, or 0 if all voices are in use
+     */
+    virtual uint32_t acquireVoice() = 0;
+
+    /**
+     * Stops the voice, discards its queued buffers and resets its state.
+     */
+    virtual void releaseVoice(uint32_t voice) = 0;
+
+    /**
+     * Starts playback of queued buffers, that are not processed yet.
+     */
+    virtual void play(uint32_t voice) = 0;
+
+    /**
+     * Appends a copy of the frame to the queue of the voice.
+     */
+    virtual void queue(uint32_t voice, const AudioStream::Frame &frame) = 0;
+
+    /**
+     * Removes buffers, that finished playing, from the queue of the voice.
+     *
+     * @return number of removed buffers
+     */
+    virtual int unqueueProcessed(uint32_t voice) = 0;
+
+    virtual void setGain(uint32_t voice, float gain) = 0;
+
+    /**
+     * Looping voices play their queue over and over, never processing buffers.
+     */
+    virtual void setLooping(uint32_t voice, bool looping) = 0;
+
+    /**
+     * @param relative whether position is relative to the listener
+     */
+    virtual void setPosition(uint32_t voice, const glm::vec3 &position, bool relative) = 0;
+
+    virtual bool isPlaying(uint32_t voice) const = 0;
+    virtual int getQueuedCount(uint32_t voice) const = 0;
+
+    // END Voices
+};
+
+} // namespace audio
+
+} // namespace reone
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mixerbackend.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "glm/geometric.hpp"
+#include "glm/gtc/constants.hpp"
+
+#include "../../common/log.h"
+#include "../../common/profiler.h"
+
+#include "../util.h"
+
+using namespace std;
+
+namespace reone {
+
+namespace audio {
+
+static const double kMaxMixDuration = 0.1;
+
+MixerBackend::MixerBackend(int voiceCount, int sampleRate, unique_ptr<AudioSink> sink) :
+    _sampleRate(sampleRate),
+    _sink(move(sink)),
+    _voices(voiceCount) {
+
+    if (sampleRate <= 0) {
+        throw invalid_argument("sampleRate must be greater than zero");
+    }
+    if (!_sink) {
+        throw invalid_argument("sink must not be null");
+    }
+}
+
+void MixerBackend::init() {
+    _lastUpdate = chrono::steady_clock::now();
+    _pendingFrames = 0.0;
+
+    info(boost::format("MixerBackend: %d voices at %d Hz") % _voices.size() % _sampleRate);
+}
+
+void MixerBackend::deinit() {
+    for (size_t i = 0; i < _voices.size(); ++i) {
+        if (_voices[i].inUse) {
+            releaseVoice(static_cast<uint32_t>(i + 1));
+        }
+    }
+}
+
+void MixerBackend::update() {
+    auto now = chrono::steady_clock::now();
+    double elapsed = chrono::duration<double>(now - _lastUpdate).count();
+    _lastUpdate = now;
+
+    // Skip rather than catch up after a stall
+    _pendingFrames += min(elapsed, kMaxMixDuration) * _sampleRate;
+
+    int frameCount = static_cast<int>(_pendingFrames);
+    if (frameCount == 0) return;
+
+    _pendingFrames -= frameCount;
+
+    PROFILE_ZONE("MixerBackend::update");
+
+    mix(frameCount);
+}
+
+void MixerBackend::mix(int frameCount) {
+    _output.assign(2 * frameCount, 0.0f);
+    if (frameCount == 0) return;
+
+    for (auto &voice : _voices) {
+        if (voice.playing) {
+            mixVoice(voice, frameCount);
+        }
+    }
+    _sink->write(&_output[0], frameCount);
+}
+
+void MixerBackend::mixVoice(Voice &voice, int frameCount) {
+    int written = 0;
+
+    while (written < frameCount) {
+        if (voice.current == static_cast<int>(voice.buffers.size())) {
+            if (!voice.looping || voice.buffers.empty()) {
+                voice.playing = false;
+                return;
+            }
+            voice.current = 0;
+        }
+        const Buffer &buffer = voice.buffers[voice.current];
+        double step = buffer.sampleRate / static_cast<double>(_sampleRate);
+        int available = static_cast<int>(ceil((buffer.frameCount - voice.cursor) / step));
+        int count = min(frameCount - written, available);
+
+        const float *samples;
+        if (buffer.sampleRate == _sampleRate) {
+            samples = &buffer.samples[static_cast<int>(voice.cursor) * buffer.channelCount];
+        } else {
+            _resampled.resize(count * buffer.channelCount);
+            for (int i = 0; i < count; ++i) {
+                double position = voice.cursor + i * step;
+                int frame0 = static_cast<int>(position);
+                int frame1 = min(frame0 + 1, buffer.frameCount - 1);
+                float frac = static_cast<float>(position - frame0);
+
+                for (int c = 0; c < buffer.channelCount; ++c) {
+                    float sample0 = buffer.samples[frame0 * buffer.channelCount + c];
+                    float sample1 = buffer.samples[frame1 * buffer.channelCount + c];
+                    _resampled[i * buffer.channelCount + c] = sample0 + frac * (sample1 - sample0);
+                }
+            }
+            samples = &_resampled[0];
+        }
+
+        float left, right;
+        getVoiceGains(voice, buffer.channelCount, left, right);
+
+        float *out = &_output[2 * written];
+        if (buffer.channelCount == 2) {
+            mixStereo(samples, count, left, right, out);
+        } else {
+            mixMonoToStereo(samples, count, left, right, out);
+        }
+
+        written += count;
+        voice.cursor += count * step;
+
+        if (voice.cursor >= buffer.frameCount) {
+            voice.cursor -= buffer.frameCount;
+            ++voice.current;
+        }
+    }
+}
+
+void MixerBackend::getVoiceGains(const Voice &voice, int channelCount, float &left, float &right) const {
+    if (channelCount == 2) {
+        left = voice.gain;
+        right = voice.gain;
+        return;
+    }
+    glm::vec3 offset(voice.relative ? voice.position : voice.position - _listenerPosition);
+    float distance = glm::length(offset);
+    float attenuation = 1.0f / max(distance, 1.0f);
+    float pan = distance > 0.0f ? offset.x / distance : 0.0f;
+    float angle = (pan + 1.0f) * glm::quarter_pi<float>();
+
+    left = voice.gain * attenuation * cosf(angle);
+    right = voice.gain * attenuation * sinf(angle);
+}
+
+void MixerBackend::setListenerPosition(const glm::vec3 &position) {
+    _listenerPosition = position;
+}
+
+uint32_t MixerBackend::acquireVoice() {
+    for (size_t i = 0; i < _voices.size(); ++i) {
+        if (!_voices[i].inUse) {
+            _voices[i].inUse = true;
+            return static_cast<uint32_t>(i + 1);
+        }
+    }
+    return 0;
+}
+
+void MixerBackend::releaseVoice(uint32_t voice) {
+    Voice &v = getVoice(voice);
+    for (auto &buffer : v.buffers) {
+        releaseBuffer(buffer);
+    }
+    v = Voice();
+}
+
+void MixerBackend::releaseBuffer(Buffer &buffer) {
+    buffer.samples.clear();
+    _freeSamples.push_back(move(buffer.samples));
+}
+
+void MixerBackend::play(uint32_t voice) {
+    Voice &v = getVoice(voice);
+    v.playing = v.current < static_cast<int>(v.buffers.size());
+}
+
+void MixerBackend::queue(uint32_t voice, const AudioStream::Frame &frame) {
+    Buffer buffer;
+    if (!_freeSamples.empty()) {
+        buffer.samples = move(_freeSamples.back());
+        _freeSamples.pop_back();
+    }
+    bool stereo = frame.format == AudioFormat::Stereo8 || frame.format == AudioFormat::Stereo16;
+    buffer.channelCount = stereo ? 2 : 1;
+    buffer.sampleRate = frame.sampleRate;
+    buffer.frameCount = static_cast<int>(frame.samples.size() / getBytesPerSample(frame.format));
+
+    int sampleCount = buffer.frameCount * buffer.channelCount;
+    buffer.samples.resize(sampleCount);
+
+    switch (frame.format) {
+        case AudioFormat::Mono8:
+        case AudioFormat::Stereo8:
+            for (int i = 0; i < sampleCount; ++i) {
+                buffer.samples[i] = (static_cast<uint8_t>(frame.samples[i]) - 128) / 128.0f;
+            }
+            break;
+        default:
+            if (sampleCount > 0) {
+                convertPCM16ToFloat(reinterpret_cast<const int16_t *>(&frame.samples[0]), sampleCount, &buffer.samples[0]);
+            }
+            break;
+    }
+    if (buffer.frameCount == 0) {
+        // Nothing to play, but must still be processed like any other buffer
+        buffer.samples.assign(buffer.channelCount, 0.0f);
+        buffer.frameCount = 1;
+    }
+
+    getVoice(voice).buffers.push_back(move(buffer));
+}
+
+int MixerBackend::unqueueProcessed(uint32_t voice) {
+    Voice &v = getVoice(voice);
+    if (v.looping) return 0;
+
+    int processed = v.current;
+    for (int i = 0; i < processed; ++i) {
+        releaseBuffer(v.buffers.front());
+        v.buffers.pop_front();
+    }
+    v.current = 0;
+
+    return processed;
+}
+
+void MixerBackend::setGain(uint32_t voice, float gain) {
+    getVoice(voice).gain = gain;
+}
+
+void MixerBackend::setLooping(uint32_t voice, bool looping) {
+    getVoice(voice).looping = looping;
+}
+
+void MixerBackend::setPosition(uint32_t voice, const glm::vec3 &position, bool relative) {
+    Voice &v = getVoice(voice);
+    v.position = position;
+    v.relative = relative;
+}
+
+bool MixerBackend::isPlaying(uint32_t voice) const {
+    return getVoice(voice).playing;
+}
+
+int MixerBackend::getQueuedCount(uint32_t voice) const {
+    return static_cast<int>(getVoice(voice).buffers.size());
+}
+
+const vector<float> &MixerBackend::output() const {
+    return _output;
+}
+
+MixerBackend::Voice &MixerBackend::getVoice(uint32_t voice) {
+    if (voice == 0 || voice > _voices.size()) {
+        throw out_of_range("Invalid voice: " + to_string(voice));
+    }
+    return _voices[voice - 1];
+}
+
+const MixerBackend::Voice &MixerBackend::getVoice(uint32_t voice) const {
+    if (voice == 0 || voice > _voices.size()) {
+        throw out_of_range("Invalid voice: " + to_string(voice));
+    }
+    return _voices[voice - 1];
+}
+
+} // namespace audio
+
+} // namespace reone
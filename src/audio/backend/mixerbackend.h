@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "../backend.h"
+
+#include "sink.h"
+
+namespace reone {
+
+namespace audio {
+
+/**
+ * Mixes voices in software into interleaved stereo output, which is passed to
+ * a sink. Does not depend on an audio device, which makes it suitable for
+ * headless runs and tests.
+ *
+ * Mirrors the OpenAL defaults: mono voices are attenuated by the inverse of
+ * the distance to the listener, clamped at 1, and panned along the X axis
+ * with constant power; stereo voices are not spatialized. Voices of a sample
+ * rate other than the output sample rate are resampled linearly.
+ */
+class MixerBackend : public AudioBackend {
+public:
+    MixerBackend(int voiceCount, int sampleRate, std::unique_ptr<AudioSink> sink);
+
+    void init() override;
+    void deinit() override;
+
+    /**
+     * Mixes as many frames as the time since the previous call requires.
+     */
+    void update() override;
+
+    bool isUpdatedWhileIdle() const override { return true; }
+
+    void setListenerPosition(const glm::vec3 &position) override;
+
+    uint32_t acquireVoice() override;
+    void releaseVoice(uint32_t voice) override;
+    void play(uint32_t voice) override;
+    void queue(uint32_t voice, const AudioStream::Frame &frame) override;
+    int unqueueProcessed(uint32_t voice) override;
+
+    void setGain(uint32_t voice, float gain) override;
+    void setLooping(uint32_t voice, bool looping) override;
+    void setPosition(uint32_t voice, const glm::vec3 &position, bool relative) override;
+
+    bool isPlaying(uint32_t voice) const override;
+    int getQueuedCount(uint32_t voice) const override;
+
+    /**
+     * Mixes the specified number of frames and writes them to the sink.
+     */
+    void mix(int frameCount);
+
+    /**
+     * @return interleaved stereo output of the last mix call
+     */
+    const std::vector<float> &output() const;
+
+private:
+    struct Buffer {
+        std::vector<float> samples; /**< interleaved if stereo */
+        int channelCount { 1 };
+        int sampleRate { 0 };
+        int frameCount { 0 };
+    };
+
+    struct Voice {
+        bool inUse { false };
+        bool playing { false };
+        bool looping { false };
+        bool relative { false };
+        float gain { 1.0f };
+        glm::vec3 position { 0.0f };
+        std::deque<Buffer> buffers;
+        int current { 0 }; /**< buffers before this one are processed */
+        double cursor { 0.0 }; /**< position in the current buffer in frames */
+    };
+
+    int _sampleRate { 0 };
+    std::unique_ptr<AudioSink> _sink;
+    std::vector<Voice> _voices;
+    glm::vec3 _listenerPosition { 0.0f };
+    std::chrono::steady_clock::time_point _lastUpdate;
+    double _pendingFrames { 0.0 };
+    std::vector<float> _output;
+    std::vector<float> _resampled; /**< reused between calls */
+    std::vector<std::vector<float>> _freeSamples; /**< sample storage of released buffers */
+
+    MixerBackend(const MixerBackend &) = delete;
+    MixerBackend &operator=(const MixerBackend &) = delete;
+
+    void mixVoice(Voice &voice, int frameCount);
+    void getVoiceGains(const Voice &voice, int channelCount, float &left, float &right) const;
+    void releaseBuffer(Buffer &buffer);
+
+    Voice &getVoice(uint32_t voice);
+    const Voice &getVoice(uint32_t voice) const;
+};
+
+} // namespace audio
+
+} // namespace reone
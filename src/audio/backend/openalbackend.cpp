@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "openalbackend.h"
+
+#include <stdexcept>
+
+#include "AL/al.h"
+
+#include "../../common/log.h"
+
+using namespace std;
+
+namespace reone {
+
+namespace audio {
+
+static int getALAudioFormat(AudioFormat format) {
+    switch (format) {
+        case AudioFormat::Mono8:
+            return AL_FORMAT_MONO8;
+        case AudioFormat::Mono16:
+            return AL_FORMAT_MONO16;
+        case AudioFormat::Stereo8:
+            return AL_FORMAT_STEREO8;
+        case AudioFormat::Stereo16:
+            return AL_FORMAT_STEREO16;
+        default:
+            throw logic_error("Unknown audio format: " + to_string(static_cast<int>(format)));
+    }
+}
+
+OpenALBackend::OpenALBackend(int voiceCount) : _voiceCount(voiceCount) {
+}
+
+OpenALBackend::~OpenALBackend() {
+    deinit();
+}
+
+void OpenALBackend::init() {
+    _device = alcOpenDevice(nullptr);
+    if (!_device) {
+        throw runtime_error("Failed to open an OpenAL device");
+    }
+    _context = alcCreateContext(_device, nullptr);
+    if (!_context) {
+        throw runtime_error("Failed to create an OpenAL context");
+    }
+    alcMakeContextCurrent(_context);
+
+    initSources();
+}
+
+void OpenALBackend::initSources() {
+    alGetError();
+
+    for (int i = 0; i < _voiceCount; ++i) {
+        uint32_t source = 0;
+        alGenSources(1, &source);
+        if (alGetError() != AL_NO_ERROR) break;
+
+        _sources.push_back(source);
+    }
+    if (_sources.empty()) {
+        throw runtime_error("Failed to generate OpenAL sources");
+    }
+    if (_sources.size() < _voiceCount) {
+        warn(boost::format("OpenAL: only %d of %d sources are available") % _sources.size() % _voiceCount);
+    }
+    _freeSources = _sources;
+}
+
+void OpenALBackend::deinit() {
+    if (!_sources.empty()) {
+        for (auto &source : _sources) {
+            alSourceStop(source);
+            alSourcei(source, AL_BUFFER, 0);
+        }
+        alDeleteSources(static_cast<int>(_sources.size()), &_sources[0]);
+        _sources.clear();
+        _freeSources.clear();
+    }
+    if (!_buffers.empty()) {
+        alDeleteBuffers(static_cast<int>(_buffers.size()), &_buffers[0]);
+        _buffers.clear();
+        _freeBuffers.clear();
+    }
+    if (_context) {
+        alcMakeContextCurrent(nullptr);
+        alcDestroyContext(_context);
+        _context = nullptr;
+    }
+    if (_device) {
+        alcCloseDevice(_device);
+        _device = nullptr;
+    }
+}
+
+void OpenALBackend::update() {
+}
+
+void OpenALBackend::setListenerPosition(const glm::vec3 &position) {
+    alListener3f(AL_POSITION, position.x, position.y, position.z);
+}
+
+uint32_t OpenALBackend::acquireVoice() {
+    if (_freeSources.empty()) return 0;
+
+    uint32_t source = _freeSources.back();
+    _freeSources.pop_back();
+
+    return source;
+}
+
+void OpenALBackend::releaseVoice(uint32_t voice) {
+    // Stopping a source marks all of its buffers as processed
+    alSourceStop(voice);
+    unqueueProcessed(voice);
+
+    alSourcei(voice, AL_BUFFER, 0);
+    alSourcei(voice, AL_LOOPING, AL_FALSE);
+    alSourcei(voice, AL_SOURCE_RELATIVE, AL_FALSE);
+    alSourcef(voice, AL_GAIN, 1.0f);
+    alSource3f(voice, AL_POSITION, 0.0f, 0.0f, 0.0f);
+
+    _freeSources.push_back(voice);
+}
+
+void OpenALBackend::play(uint32_t voice) {
+    alSourcePlay(voice);
+}
+
+void OpenALBackend::queue(uint32_t voice, const AudioStream::Frame &frame) {
+    uint32_t buffer = 0;
+    if (_freeBuffers.empty()) {
+        alGenBuffers(1, &buffer);
+        _buffers.push_back(buffer);
+    } else {
+        buffer = _freeBuffers.back();
+        _freeBuffers.pop_back();
+    }
+    alBufferData(buffer, getALAudioFormat(frame.format), frame.samples.data(), static_cast<int>(frame.samples.size()), frame.sampleRate);
+    alSourceQueueBuffers(voice, 1, &buffer);
+}
+
+int OpenALBackend::unqueueProcessed(uint32_t voice) {
+    ALint processed = 0;
+    alGetSourcei(voice, AL_BUFFERS_PROCESSED, &processed);
+    if (processed == 0) return 0;
+
+    _unqueued.resize(processed);
+    alSourceUnqueueBuffers(voice, processed, &_unqueued[0]);
+    _freeBuffers.insert(_freeBuffers.end(), _unqueued.begin(), _unqueued.end());
+
+    return processed;
+}
+
+void OpenALBackend::setGain(uint32_t voice, float gain) {
+    alSourcef(voice, AL_GAIN, gain);
+}
+
+void OpenALBackend::setLooping(uint32_t voice, bool looping) {
+    alSourcei(voice, AL_LOOPING, looping ? AL_TRUE : AL_FALSE);
+}
+
+void OpenALBackend::setPosition(uint32_t voice, const glm::vec3 &position, bool relative) {
+    alSourcei(voice, AL_SOURCE_RELATIVE, relative ? AL_TRUE : AL_FALSE);
+    alSource3f(voice, AL_POSITION, position.x, position.y, position.z);
+}
+
+bool OpenALBackend::isPlaying(uint32_t voice) const {
+    ALint state = 0;
+    alGetSourcei(voice, AL_SOURCE_STATE, &state);
+    return state == AL_PLAYING;
+}
+
+int OpenALBackend::getQueuedCount(uint32_t voice) const {
+    ALint queued = 0;
+    alGetSourcei(voice, AL_BUFFERS_QUEUED, &queued);
+    return queued;
+}
+
+} // namespace audio
+
+} // namespace reone
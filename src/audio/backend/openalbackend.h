@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "AL/alc.h"
+
+#include "../backend.h"
+
+namespace reone {
+
+namespace audio {
+
+/**
+ * Plays voices on a fixed set of OpenAL sources. Buffers are returned to a
+ * free list instead of being deleted.
+ */
+class OpenALBackend : public AudioBackend {
+public:
+    /**
+     * @param voiceCount number of sources to generate, fewer if the device
+     *                   does not support as many
+     */
+    OpenALBackend(int voiceCount);
+    ~OpenALBackend();
+
+    void init() override;
+    void deinit() override;
+    void update() override;
+
+    void setListenerPosition(const glm::vec3 &position) override;
+
+    uint32_t acquireVoice() override;
+    void releaseVoice(uint32_t voice) override;
+    void play(uint32_t voice) override;
+    void queue(uint32_t voice, const AudioStream::Frame &frame) override;
+    int unqueueProcessed(uint32_t voice) override;
+
+    void setGain(uint32_t voice, float gain) override;
+    void setLooping(uint32_t voice, bool looping) override;
+    void setPosition(uint32_t voice, const glm::vec3 &position, bool relative) override;
+
+    bool isPlaying(uint32_t voice) const override;
+    int getQueuedCount(uint32_t voice) const override;
+
+private:
+    int _voiceCount { 0 };
+    ALCdevice *_device { nullptr };
+    ALCcontext *_context { nullptr };
+    std::vector<uint32_t> _sources;
+    std::vector<uint32_t> _freeSources;
+    std::vector<uint32_t> _buffers;
+    std::vector<uint32_t> _freeBuffers;
+    std::vector<uint32_t> _unqueued; /**< reused between calls */
+
+    OpenALBackend(const OpenALBackend &) = delete;
+    OpenALBackend &operator=(const OpenALBackend &) = delete;
+
+    void initSources();
+};
+
+} // namespace audio
+
+} // namespace reone
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sink.h"
+
+#include <stdexcept>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include "../util.h"
+
+using namespace std;
+
+namespace fs = boost::filesystem;
+
+namespace reone {
+
+namespace audio {
+
+static const int kChannelCount = 2;
+static const int kBitsPerSample = 16;
+static const int kRiffSizeOffset = 4;
+static const int kDataSizeOffset = 40;
+
+void NullSink::write(const float *samples, int frameCount) {
+}
+
+static shared_ptr<ostream> openWavFile(const fs::path &path) {
+    auto stream = make_shared<fs::ofstream>(path, ios::binary);
+    if (!*stream) {
+        throw runtime_error("WavSink: unable to open file: " + path.string());
+    }
+    return stream;
+}
+
+WavSink::WavSink(const fs::path &path, int sampleRate) : _stream(openWavFile(path)), _writer(_stream) {
+    writeHeader(sampleRate);
+}
+
+void WavSink::writeHeader(int sampleRate) {
+    int blockAlign = kChannelCount * kBitsPerSample / 8;
+
+    _writer.putString("RIFF");
+    _writer.putUint32(0); // patched on close
+    _writer.putString("WAVE");
+
+    _writer.putString("fmt ");
+    _writer.putUint32(16);
+    _writer.putUint16(1); // PCM
+    _writer.putUint16(kChannelCount);
+    _writer.putUint32(sampleRate);
+    _writer.putUint32(sampleRate * blockAlign);
+    _writer.putUint16(blockAlign);
+    _writer.putUint16(kBitsPerSample);
+
+    _writer.putString("data");
+    _writer.putUint32(0); // patched on close
+}
+
+WavSink::~WavSink() {
+    _stream->seekp(kRiffSizeOffset);
+    _writer.putUint32(kDataSizeOffset - kRiffSizeOffset + _dataSize);
+    _stream->seekp(kDataSizeOffset);
+    _writer.putUint32(_dataSize);
+}
+
+void WavSink::write(const float *samples, int frameCount) {
+    if (frameCount == 0) return;
+
+    int sampleCount = kChannelCount * frameCount;
+    _buffer.resize(sampleCount);
+    convertFloatToPCM16(samples, sampleCount, &_buffer[0]);
+
+    for (int16_t sample : _buffer) {
+        _writer.putUint16(static_cast<uint16_t>(sample));
+    }
+    _dataSize += sampleCount * sizeof(int16_t);
+}
+
+} // namespace audio
+
+} // namespace reone
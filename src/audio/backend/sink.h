@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include "../../common/streamwriter.h"
+
+namespace reone {
+
+namespace audio {
+
+/**
+ * Receives the output of the software mixer.
+ */
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    /**
+     * @param samples interleaved stereo samples in [-1, 1]
+     * @param frameCount number of samples per channel
+     */
+    virtual void write(const float *samples, int frameCount) = 0;
+};
+
+/**
+ * Discards mixer output. Used for headless runs, where only the state of
+ * voices matters.
+ */
+class NullSink : public AudioSink {
+public:
+    void write(const float *samples, int frameCount) override;
+};
+
+/**
+ * Writes mixer output into a 16-bit stereo WAV file. Sizes in the header are
+ * updated when the sink is destroyed.
+ */
+class WavSink : public AudioSink {
+public:
+    WavSink(const boost::filesystem::path &path, int sampleRate);
+    ~WavSink();
+
+    void write(const float *samples, int frameCount) override;
+
+private:
+    std::shared_ptr<std::ostream> _stream;
+    StreamWriter _writer;
+    uint32_t _dataSize { 0 };
+    std::vector<int16_t> _buffer;
+
+    WavSink(const WavSink &) = delete;
+    WavSink &operator=(const WavSink &) = delete;
+
+    void writeHeader(int sampleRate);
+};
+
+} // namespace audio
+
+} // namespace reone
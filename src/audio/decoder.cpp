@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "decoder.h"
+
+using namespace std;
+
+namespace reone {
+
+namespace audio {
+
+static const size_t kMaxPreloadSize = 512 * 1024;
+
+shared_ptr<AudioStream> createAudioStream(AudioStream::DecoderFactory decoderFactory, float duration, size_t size) {
+    if (size > kMaxPreloadSize) {
+        return make_shared<AudioStream>(move(decoderFactory), duration);
+    }
+    auto stream = make_shared<AudioStream>();
+    unique_ptr<AudioDecoder> decoder(decoderFactory());
+
+    AudioStream::Frame frame;
+    while (decoder->decode(frame)) {
+        stream->add(move(frame));
+        frame = AudioStream::Frame();
+    }
+
+    return move(stream);
+}
+
+} // namespace audio
+
+} // namespace reone
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "stream.h"
+
+namespace reone {
+
+namespace audio {
+
+/**
+ * Approximate size of a chunk, produced by a decoder, in bytes.
+ */
+const int kAudioChunkSize = 64 * 1024;
+
+/**
+ * Decodes audio incrementally, one chunk at a time.
+ */
+class AudioDecoder {
+public:
+    virtual ~AudioDecoder() = default;
+
+    /**
+     * Decodes the next chunk of samples into the frame, replacing its
+     * contents.
+     *
+     * @return false if there are no more samples to decode, true otherwise
+     */
+    virtual bool decode(AudioStream::Frame &frame) = 0;
+
+    /**
+     * Restarts decoding from the beginning of the stream.
+     */
+    virtual void rewind() = 0;
+};
+
+/**
+ * Creates an audio stream, that is decoded by decoders, produced by the
+ * factory. Short streams are decoded in full right away, so that they can be
+ * played any number of times without decoding them again, long streams are
+ * decoded incrementally during playback.
+ *
+ * @param duration duration in milliseconds
+ * @param size size of decoded samples in bytes
+ */
+std::shared_ptr<AudioStream> createAudioStream(AudioStream::DecoderFactory decoderFactory, float duration, size_t size);
+
+} // namespace audio
+
+} // namespace reone
@@ -56,7 +56,7 @@ shared_ptr<AudioStream> AudioFiles::doGet(const string &resRef) {
 
     if (mp3Data) {
         Mp3File mp3;
-        mp3.load(wrap(mp3Data));
+        mp3.load(mp3Data);
         stream = mp3.stream();
 
     } else {
@@ -17,26 +17,15 @@
 
 #include "mp3file.h"
 
+#include "../util.h"
+
 using namespace std;
 
 namespace reone {
 
 namespace audio {
 
-static inline int scale(mad_fixed_t sample) {
-    // round
-    sample += (1L << (MAD_F_FRACBITS - 16));
-
-    // clip
-    if (sample >= MAD_F_ONE) {
-        sample = MAD_F_ONE - 1;
-    } else if (sample < -MAD_F_ONE) {
-        sample = -MAD_F_ONE;
-    }
-
-    // quantize
-    return sample >> (MAD_F_FRACBITS + 1 - 16);
-}
+static_assert(sizeof(mad_fixed_t) == sizeof(int32_t), "libmad must use 32-bit fixed-point samples");
 
 void Mp3File::load(const shared_ptr<istream> &stream) {
     stream->seekg(0, ios::end);
@@ -51,71 +40,93 @@ void Mp3File::load(const shared_ptr<istream> &stream) {
 }
 
 void Mp3File::load(ByteArray &&data) {
-    _input = data;
-    _stream = make_shared<AudioStream>();
-
-    mad_decoder decoder;
-    mad_decoder_init(
-        &decoder,
-        this,
-        inputFunc,
-        headerFunc,
-        nullptr,
-        outputFunc,
-        nullptr,
-        nullptr);
-
-    mad_decoder_run(&decoder, MAD_DECODER_MODE_SYNC);
-    mad_decoder_finish(&decoder);
+    load(make_shared<ByteArray>(move(data)));
 }
 
-mad_flow Mp3File::inputFunc(void *playbuf, mad_stream *stream) {
-    Mp3File *mp3 = reinterpret_cast<Mp3File *>(playbuf);
-    if (mp3->_done) {
-        return MAD_FLOW_BREAK;
-    }
-    mad_stream_buffer(stream, reinterpret_cast<unsigned char *>(&mp3->_input[0]), static_cast<int>(mp3->_input.size()));
-    mp3->_done = true;
+void Mp3File::load(shared_ptr<ByteArray> data, size_t offset) {
+    // Headers are enough to compute duration and decoded size
+    mad_stream stream;
+    mad_stream_init(&stream);
+    mad_stream_buffer(&stream, reinterpret_cast<unsigned char *>(data->data()) + offset, data->size() - offset);
 
-    return MAD_FLOW_CONTINUE;
-}
+    mad_header header;
+    mad_header_init(&header);
 
-mad_flow Mp3File::headerFunc(void *playbuf, mad_header const *header) {
-    return MAD_FLOW_CONTINUE;
-}
+    mad_timer_t duration = mad_timer_zero;
+    size_t size = 0;
 
-mad_flow Mp3File::outputFunc(void *playbuf, mad_header const *header, mad_pcm *pcm) {
-    Mp3File *mp3 = reinterpret_cast<Mp3File *>(playbuf);
-    unsigned short sampleCount = pcm->length;
-    mad_fixed_t *chLeft = pcm->samples[0];
-    mad_fixed_t *chRight = pcm->samples[1];
-
-    AudioStream::Frame frame;
-    frame.format = pcm->channels == 2 ? AudioFormat::Stereo16 : AudioFormat::Mono16;
-    frame.sampleRate = pcm->samplerate;
-    frame.samples.reserve(static_cast<uint64_t>(pcm->channels) * sampleCount * sizeof(int16_t));
-
-    while (sampleCount--) {
-        int sample = scale(*chLeft++);
-        frame.samples.push_back((sample >> 0) & 0xff);
-        frame.samples.push_back((sample >> 8) & 0xff);
-
-        if (pcm->channels == 2) {
-            sample = scale(*chRight++);
-            frame.samples.push_back((sample >> 0) & 0xff);
-            frame.samples.push_back((sample >> 8) & 0xff);
+    while (true) {
+        if (mad_header_decode(&header, &stream) == -1) {
+            if (MAD_RECOVERABLE(stream.error)) continue;
+            break;
         }
+        mad_timer_add(&duration, header.duration);
+        size += static_cast<size_t>(MAD_NCHANNELS(&header)) * 32 * MAD_NSBSAMPLES(&header) * sizeof(int16_t);
     }
 
-    mp3->_stream->add(move(frame));
+    mad_header_finish(&header);
+    mad_stream_finish(&stream);
 
-    return MAD_FLOW_CONTINUE;
+    auto decoderFactory = [data, offset]() { return make_unique<Mp3Decoder>(data, offset); };
+    _stream = createAudioStream(move(decoderFactory), static_cast<float>(mad_timer_count(duration, MAD_UNITS_MILLISECONDS)), size);
 }
 
 shared_ptr<AudioStream> Mp3File::stream() const {
     return _stream;
 }
 
+Mp3Decoder::Mp3Decoder(shared_ptr<ByteArray> data, size_t offset) : _data(move(data)), _offset(offset) {
+    mad_stream_init(&_stream);
+    mad_frame_init(&_frame);
+    mad_synth_init(&_synth);
+
+    rewind();
+}
+
+Mp3Decoder::~Mp3Decoder() {
+    mad_synth_finish(&_synth);
+    mad_frame_finish(&_frame);
+    mad_stream_finish(&_stream);
+}
+
+void Mp3Decoder::rewind() {
+    mad_stream_buffer(&_stream, reinterpret_cast<unsigned char *>(_data->data()) + _offset, _data->size() - _offset);
+    mad_frame_mute(&_frame);
+    mad_synth_mute(&_synth);
+    _ended = false;
+}
+
+bool Mp3Decoder::decode(AudioStream::Frame &frame) {
+    frame.samples.clear();
+
+    while (!_ended && frame.samples.size() < kAudioChunkSize) {
+        if (mad_frame_decode(&_frame, &_stream) == -1) {
+            if (MAD_RECOVERABLE(_stream.error)) continue;
+            _ended = true;
+            break;
+        }
+        mad_synth_frame(&_synth, &_frame);
+
+        const mad_pcm &pcm = _synth.pcm;
+        bool stereo = pcm.channels == 2;
+
+        frame.format = stereo ? AudioFormat::Stereo16 : AudioFormat::Mono16;
+        frame.sampleRate = pcm.samplerate;
+
+        size_t offset = frame.samples.size();
+        frame.samples.resize(offset + static_cast<size_t>(pcm.channels) * pcm.length * sizeof(int16_t));
+
+        convertFixedToPCM16(
+            reinterpret_cast<const int32_t *>(pcm.samples[0]),
+            stereo ? reinterpret_cast<const int32_t *>(pcm.samples[1]) : nullptr,
+            pcm.length,
+            MAD_F_FRACBITS,
+            reinterpret_cast<int16_t *>(&frame.samples[offset]));
+    }
+
+    return !frame.samples.empty();
+}
+
 } // namespace audio
 
 } // namespace reone
@@ -22,32 +22,59 @@
 
 #include "mad.h"
 
+#include "../decoder.h"
 #include "../stream.h"
 
 namespace reone {
 
 namespace audio {
 
+/**
+ * Scans MPEG audio frame headers to compute duration of an MP3 file, without
+ * decoding it. Decoding is left to Mp3Decoder.
+ */
 class Mp3File {
 public:
     Mp3File() = default;
 
     void load(const std::shared_ptr<std::istream> &stream);
     void load(ByteArray &&data);
+    void load(std::shared_ptr<ByteArray> data, size_t offset = 0);
 
     std::shared_ptr<AudioStream> stream() const;
 
 private:
-    ByteArray _input;
     std::shared_ptr<AudioStream> _stream;
-    bool _done { false };
 
     Mp3File(const Mp3File &) = delete;
     Mp3File &operator=(const Mp3File &) = delete;
+};
+
+/**
+ * Decodes MP3 data frame by frame, using the low-level libmad API.
+ */
+class Mp3Decoder : public AudioDecoder {
+public:
+    /**
+     * @param data MP3 data, shared between decoders of the same file
+     * @param offset offset of MP3 data in the array
+     */
+    Mp3Decoder(std::shared_ptr<ByteArray> data, size_t offset);
+    ~Mp3Decoder();
+
+    bool decode(AudioStream::Frame &frame) override;
+    void rewind() override;
+
+private:
+    std::shared_ptr<ByteArray> _data;
+    size_t _offset { 0 };
+    mad_stream _stream;
+    mad_frame _frame;
+    mad_synth _synth;
+    bool _ended { false };
 
-    static mad_flow inputFunc(void *playbuf, mad_stream *stream);
-    static mad_flow headerFunc(void *playbuf, mad_header const *header);
-    static mad_flow outputFunc(void *playbuf, mad_header const *header, mad_pcm *pcm);
+    Mp3Decoder(const Mp3Decoder &) = delete;
+    Mp3Decoder &operator=(const Mp3Decoder &) = delete;
 };
 
 } // namespace audio
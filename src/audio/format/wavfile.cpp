@@ -21,6 +21,8 @@
 
 #include "../../common/streamutil.h"
 
+#include "../util.h"
+
 #include "mp3file.h"
 
 using namespace std;
@@ -105,84 +107,44 @@ void WavFile::loadData(ChunkHeader chunk) {
         return;
     }
 
-    switch (_audioFormat) {
-        case WavAudioFormat::PCM:
-            loadPCM(chunk.size);
-            break;
-        case WavAudioFormat::IMAADPCM:
-            loadIMAADPCM(chunk.size);
-            break;
-    }
-}
+    auto data = make_shared<ByteArray>(_reader->getArray<char>(chunk.size));
 
-void WavFile::loadPCM(uint32_t chunkSize) {
-    ByteArray data(_reader->getArray<char>(chunkSize));
+    WavAudioFormat audioFormat = _audioFormat;
+    AudioFormat format = getAudioFormat();
+    int channelCount = _channelCount;
+    int sampleRate = _sampleRate;
+    int blockAlign = _blockAlign;
 
-    AudioStream::Frame frame;
-    frame.format = getAudioFormat();
-    frame.sampleRate = _sampleRate;
-    frame.samples.resize(chunkSize);
-    frame.samples = move(data);
+    auto decoderFactory = [=]() {
+        return make_unique<WavDecoder>(data, audioFormat, format, channelCount, sampleRate, blockAlign);
+    };
+    size_t sampleCount = getSampleCount(chunk.size);
+    float duration = 1000.0f * sampleCount / static_cast<float>(_sampleRate);
 
-    _stream = make_shared<AudioStream>();
-    _stream->add(move(frame));
+    _stream = createAudioStream(move(decoderFactory), duration, sampleCount * getBytesPerSample(format));
 }
 
-static const int kIMAIndexTable[] = { -1, -1, -1, -1, 2, 4, 6, 8 };
-
-static const int kIMAStepTable[] = {
-    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
-    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
-    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
-    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
-    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
-    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
-    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
-    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
-    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
-};
-
-void WavFile::loadIMAADPCM(uint32_t chunkSize) {
-    ByteArray chunk(_reader->getArray<char>(chunkSize));
+size_t WavFile::getSampleCount(uint32_t dataSize) const {
+    if (_blockAlign == 0) {
+        throw runtime_error("WAV: invalid block alignment");
+    }
+    if (_audioFormat == WavAudioFormat::PCM) {
+        return dataSize / _blockAlign;
+    }
 
-    AudioStream::Frame frame;
-    frame.format = getAudioFormat();
-    frame.sampleRate = _sampleRate;
-    frame.samples.reserve(2 * (chunkSize - 4 * _channelCount * chunkSize / _blockAlign));
+    // Every IMA ADPCM block starts with a 4-byte header per channel, followed
+    // by groups of 4 bytes per channel, each of which holds 8 samples
+    uint32_t headerSize = 4 * _channelCount;
+    size_t sampleCount = 0;
 
-    uint32_t off = 0;
-    while (off < chunkSize) {
-        if (off % _blockAlign == 0) {
-            for (int i = 0; i < _channelCount; ++i) {
-                _ima[i].lastSample = *reinterpret_cast<int16_t *>(&chunk[off + 0]);
-                _ima[i].stepIndex = *reinterpret_cast<int16_t *>(&chunk[off + 2]);
-                off += 4;
-            }
-        }
-        int16_t samples[16];
-        for (int i = 0; i < _channelCount; ++i) {
-            for (int j = 0; j < 4; ++j) {
-                int idx = 8 * i + 2 * j;
-                getIMASamples(i, chunk[off++], samples[idx + 0], samples[idx + 1]);
-            }
-        }
-        if (_channelCount == 2) {
-            for (int i = 0; i < 8; ++i) {
-                frame.samples.push_back((samples[i + 0] >> 0) & 0xff);
-                frame.samples.push_back((samples[i + 0] >> 8) & 0xff);
-                frame.samples.push_back((samples[i + 8] >> 0) & 0xff);
-                frame.samples.push_back((samples[i + 8] >> 8) & 0xff);
-            }
-        } else {
-            for (int i = 0; i < 8; ++i) {
-                frame.samples.push_back((samples[i] >> 0) & 0xff);
-                frame.samples.push_back((samples[i] >> 8) & 0xff);
-            }
+    for (uint32_t off = 0; off < dataSize; off += _blockAlign) {
+        uint32_t blockSize = min<uint32_t>(_blockAlign, dataSize - off);
+        if (blockSize > headerSize) {
+            sampleCount += 8 * ((blockSize - headerSize) / headerSize);
         }
     }
 
-    _stream = make_shared<AudioStream>();
-    _stream->add(move(frame));
+    return sampleCount;
 }
 
 AudioFormat WavFile::getAudioFormat() const {
@@ -207,15 +169,99 @@ AudioFormat WavFile::getAudioFormat() const {
     }
 }
 
-void WavFile::getIMASamples(int channel, uint8_t nibbles, int16_t &sample1, int16_t &sample2) {
-    uint8_t n1 = (nibbles >> 0) & 0xf;
-    uint8_t n2 = (nibbles >> 4) & 0xf;
+shared_ptr<AudioStream> WavFile::stream() const {
+    return _stream;
+}
+
+WavDecoder::WavDecoder(shared_ptr<ByteArray> data, WavAudioFormat audioFormat, AudioFormat format, int channelCount, int sampleRate, int blockAlign) :
+    _data(move(data)),
+    _audioFormat(audioFormat),
+    _format(format),
+    _channelCount(channelCount),
+    _sampleRate(sampleRate),
+    _blockAlign(blockAlign) {
+}
 
-    sample1 = getIMASample(channel, n1);
-    sample2 = getIMASample(channel, n2);
+void WavDecoder::rewind() {
+    _offset = 0;
 }
 
-int16_t WavFile::getIMASample(int channel, uint8_t nibble) {
+bool WavDecoder::decode(AudioStream::Frame &frame) {
+    frame.format = _format;
+    frame.sampleRate = _sampleRate;
+    frame.samples.clear();
+
+    switch (_audioFormat) {
+        case WavAudioFormat::PCM:
+            decodePCM(frame.samples);
+            break;
+        case WavAudioFormat::IMAADPCM:
+            decodeIMAADPCM(frame.samples);
+            break;
+    }
+
+    return !frame.samples.empty();
+}
+
+void WavDecoder::decodePCM(ByteArray &samples) {
+    size_t chunkSize = max(kAudioChunkSize / _blockAlign, 1) * _blockAlign;
+    size_t size = min(chunkSize, _data->size() - _offset);
+
+    samples.assign(_data->begin() + _offset, _data->begin() + _offset + size);
+    _offset += size;
+}
+
+static const int kIMAIndexTable[] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+static const int kIMAStepTable[] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+void WavDecoder::decodeIMAADPCM(ByteArray &samples) {
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(_data->data());
+    size_t dataSize = _data->size();
+    size_t headerSize = 4ll * _channelCount;
+
+    while (_offset < dataSize && samples.size() < kAudioChunkSize) {
+        size_t blockEnd = min(_offset + _blockAlign, dataSize);
+
+        for (int i = 0; i < _channelCount && _offset + 4 <= blockEnd; ++i) {
+            _ima[i].lastSample = static_cast<int16_t>(data[_offset + 0] | (data[_offset + 1] << 8));
+            _ima[i].stepIndex = min(max<int>(static_cast<int16_t>(data[_offset + 2] | (data[_offset + 3] << 8)), 0), 88);
+            _offset += 4;
+        }
+
+        // Decode groups of 8 samples per channel straight into the interleaved
+        // output
+        size_t groupCount = blockEnd > _offset ? (blockEnd - _offset) / headerSize : 0;
+        size_t outOffset = samples.size();
+        samples.resize(outOffset + groupCount * 8 * _channelCount * sizeof(int16_t));
+        int16_t *out = reinterpret_cast<int16_t *>(&samples[outOffset]);
+
+        for (size_t group = 0; group < groupCount; ++group) {
+            for (int i = 0; i < _channelCount; ++i) {
+                for (int j = 0; j < 4; ++j) {
+                    uint8_t nibbles = data[_offset++];
+                    out[_channelCount * (2 * j + 0) + i] = getIMASample(i, (nibbles >> 0) & 0xf);
+                    out[_channelCount * (2 * j + 1) + i] = getIMASample(i, (nibbles >> 4) & 0xf);
+                }
+            }
+            out += 8 * _channelCount;
+        }
+
+        _offset = blockEnd;
+    }
+}
+
+int16_t WavDecoder::getIMASample(int channel, uint8_t nibble) {
     int step = (2 * (nibble & 0x7) + 1) * kIMAStepTable[_ima[channel].stepIndex] / 8;
     int diff = nibble & 0x8 ? -step : step;
     int sample = min(max(_ima[channel].lastSample + diff, -32768), 32767);
@@ -226,10 +272,6 @@ int16_t WavFile::getIMASample(int channel, uint8_t nibble) {
     return sample;
 }
 
-shared_ptr<AudioStream> WavFile::stream() const {
-    return _stream;
-}
-
 } // namespace audio
 
 } // namespace reone
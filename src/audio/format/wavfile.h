@@ -19,6 +19,7 @@
 
 #include "../../resource/binfile.h"
 
+#include "../decoder.h"
 #include "../stream.h"
 
 namespace reone {
@@ -30,6 +31,10 @@ enum class WavAudioFormat {
     IMAADPCM = 0x11
 };
 
+/**
+ * Parses a WAV file and extracts its sample data, which is then decoded by
+ * WavDecoder. Also handles MP3 files, disguised as WAV.
+ */
 class WavFile : public resource::BinaryFile {
 public:
     WavFile();
@@ -42,30 +47,58 @@ private:
         uint32_t size { 0 };
     };
 
-    struct IMA {
-        int16_t lastSample { 0 };
-        int16_t stepIndex { 0 };
-    };
-
     WavAudioFormat _audioFormat { WavAudioFormat::PCM };
     uint16_t _channelCount { 0 };
     uint32_t _sampleRate { 0 };
     uint16_t _blockAlign { 0 };
     uint16_t _bitsPerSample { 0 };
-    IMA _ima[2];
     std::shared_ptr<AudioStream> _stream;
 
     void doLoad() override;
 
-    int16_t getIMASample(int channel, uint8_t nibble);
-    void getIMASamples(int channel, uint8_t nibbles, int16_t &sample1, int16_t &sample2);
     void loadData(ChunkHeader chunk);
     void loadFormat(ChunkHeader chunk);
-    void loadIMAADPCM(uint32_t chunkSize);
-    void loadPCM(uint32_t chunkSize);
     bool readChunkHeader(ChunkHeader &chunk);
 
     AudioFormat getAudioFormat() const;
+    size_t getSampleCount(uint32_t dataSize) const;
+};
+
+/**
+ * Decodes PCM or IMA ADPCM samples of a WAV file, block by block.
+ */
+class WavDecoder : public AudioDecoder {
+public:
+    /**
+     * @param data sample data, shared between decoders of the same file
+     */
+    WavDecoder(std::shared_ptr<ByteArray> data, WavAudioFormat audioFormat, AudioFormat format, int channelCount, int sampleRate, int blockAlign);
+
+    bool decode(AudioStream::Frame &frame) override;
+    void rewind() override;
+
+private:
+    struct IMA {
+        int16_t lastSample { 0 };
+        int16_t stepIndex { 0 };
+    };
+
+    std::shared_ptr<ByteArray> _data;
+    WavAudioFormat _audioFormat { WavAudioFormat::PCM };
+    AudioFormat _format { AudioFormat::Mono8 };
+    int _channelCount { 0 };
+    int _sampleRate { 0 };
+    int _blockAlign { 0 };
+    size_t _offset { 0 };
+    IMA _ima[2];
+
+    WavDecoder(const WavDecoder &) = delete;
+    WavDecoder &operator=(const WavDecoder &) = delete;
+
+    void decodePCM(ByteArray &samples);
+    void decodeIMAADPCM(ByteArray &samples);
+
+    int16_t getIMASample(int channel, uint8_t nibble);
 };
 
 } // namespace audio
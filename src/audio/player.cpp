@@ -18,15 +18,18 @@
 #include "player.h"
 
 #include <algorithm>
+#include <chrono>
 #include <functional>
 #include <stdexcept>
 
-#include "AL/al.h"
-
 #include "../common/log.h"
+#include "../common/profiler.h"
 
+#include "backend/mixerbackend.h"
+#include "backend/openalbackend.h"
 #include "files.h"
 #include "soundhandle.h"
+#include "streamer.h"
 
 using namespace std;
 
@@ -34,6 +37,9 @@ namespace reone {
 
 namespace audio {
 
+static const int kMixerSampleRate = 44100;
+static const chrono::milliseconds kUpdateInterval(10);
+
 AudioPlayer &AudioPlayer::instance() {
     static AudioPlayer instance;
     return instance;
@@ -41,67 +47,141 @@ AudioPlayer &AudioPlayer::instance() {
 
 void AudioPlayer::init(const AudioOptions &opts) {
     _opts = opts;
+    _inited = true;
 
     if (_opts.musicVolume == 0 && _opts.soundVolume == 0 && _opts.movieVolume == 0) {
         info("AudioPlayer: audio is disabled");
         return;
     }
+    AudioStreamer::instance().init();
+
+    _backend = createBackend();
+    _run = true;
     _thread = thread(bind(&AudioPlayer::threadStart, this));
 }
 
 void AudioPlayer::threadStart() {
-    initAL();
+    Profiler::instance().setThreadName("Audio");
+    _backend->init();
 
-    vector<shared_ptr<SoundInstance>> sounds;
     while (_run) {
-        {
-            lock_guard<recursive_mutex> lock(_soundsMutex);
-            auto maybeSounds = remove_if(
-                _sounds.begin(), _sounds.end(),
-                [](auto &sound) { return sound->handle()->isStopped(); });
-
-            _sounds.erase(maybeSounds, _sounds.end());
-            sounds = _sounds;
-        }
-        if (_listenerPositionDirty) {
-            glm::vec3 position(_listenerPosition.load());
-            alListener3f(AL_POSITION, position.x, position.y, position.z);
-            _listenerPositionDirty = false;
-        }
-        for (auto &sound : sounds) {
-            if (sound->handle()->isNotInited()) {
-                sound->init();
+        update();
+        wait();
+    }
+
+    _sounds.clear();
+    _backend->deinit();
+}
+
+unique_ptr<AudioBackend> AudioPlayer::createBackend() const {
+    switch (_opts.backend) {
+        case AudioBackendType::Mixer: {
+            unique_ptr<AudioSink> sink;
+            if (_opts.wavOutput.empty()) {
+                sink = make_unique<NullSink>();
+            } else {
+                sink = make_unique<WavSink>(_opts.wavOutput, kMixerSampleRate);
             }
-            sound->update();
+            return make_unique<MixerBackend>(_opts.voiceCount, kMixerSampleRate, move(sink));
         }
-        this_thread::yield();
+        default:
+            return make_unique<OpenALBackend>(_opts.voiceCount);
     }
+}
 
-    deinitAL();
+void AudioPlayer::update() {
+    if (_listenerPositionDirty.exchange(false)) {
+        _backend->setListenerPosition(_listenerPosition.load());
+    }
+
+    // Release voices of stopped sounds before starting new ones
+    auto stopped = remove_if(
+        _sounds.begin(), _sounds.end(),
+        [](auto &sound) { return sound->handle()->isStopped(); });
+
+    _sounds.erase(stopped, _sounds.end());
+
+    for (PlayRequest *request = _requests.pop(); request; request = _requests.pop()) {
+        _sounds.push_back(move(request->sound));
+        delete request;
+    }
+    if (!_sounds.empty()) {
+        updateSounds();
+    }
+    if (!_sounds.empty() || _backend->isUpdatedWhileIdle()) {
+        _backend->update();
+    }
 }
 
-void AudioPlayer::initAL() {
-    _device = alcOpenDevice(nullptr);
-    if (!_device) {
-        throw runtime_error("Failed to open an OpenAL device");
+void AudioPlayer::updateSounds() {
+    PROFILE_ZONE("AudioPlayer::updateSounds");
+
+    glm::vec3 listenerPosition(_listenerPosition.load());
+
+    for (auto &sound : _sounds) {
+        if (sound->handle()->isNotInited()) {
+            startSound(*sound, listenerPosition);
+        }
+        if (sound->isInited()) {
+            sound->update();
+        }
     }
-    _context = alcCreateContext(_device, nullptr);
-    if (!_context) {
-        throw runtime_error("Failed to create an OpenAL context");
+}
+
+void AudioPlayer::startSound(SoundInstance &sound, const glm::vec3 &listenerPosition) {
+    uint32_t voice = _backend->acquireVoice();
+    if (!voice) {
+        SoundInstance *victim = nullptr;
+        float victimAudibility = 0.0f;
+
+        for (auto &other : _sounds) {
+            if (!other->isInited()) continue;
+
+            float audibility = other->getAudibility(listenerPosition);
+            if (!victim ||
+                other->priority() < victim->priority() ||
+                (other->priority() == victim->priority() && audibility < victimAudibility)) {
+
+                victim = other.get();
+                victimAudibility = audibility;
+            }
+        }
+        bool steal = victim && (
+            victim->priority() < sound.priority() ||
+            (victim->priority() == sound.priority() && victimAudibility < sound.getAudibility(listenerPosition)));
+
+        if (!steal) {
+            debug("AudioPlayer: out of voices, sound dropped", 2);
+            sound.handle()->stop();
+            return;
+        }
+        victim->handle()->stop();
+        victim->deinit();
+
+        voice = _backend->acquireVoice();
     }
-    alcMakeContextCurrent(_context);
+    sound.init(*_backend, voice);
 }
 
-void AudioPlayer::deinitAL() {
-    if (_context) {
-        alcMakeContextCurrent(nullptr);
-        alcDestroyContext(_context);
-        _context = nullptr;
+void AudioPlayer::wait() {
+    unique_lock<mutex> lock(_wakeMutex);
+    auto woken = [this]() { return _wakeRequested || !_run; };
+
+    // Nothing to refill while idle, unless the backend clock must keep running
+    if (_sounds.empty() && !_backend->isUpdatedWhileIdle()) {
+        _wakeCondition.wait(lock, woken);
+    } else {
+        _wakeCondition.wait_for(lock, kUpdateInterval, woken);
     }
-    if (_device) {
-        alcCloseDevice(_device);
-        _device = nullptr;
+    _wakeRequested = false;
+}
+
+void AudioPlayer::wake() {
+    {
+        lock_guard<mutex> lock(_wakeMutex);
+        _wakeRequested = true;
     }
+    _wakeCondition.notify_one();
 }
 
 AudioPlayer::~AudioPlayer() {
@@ -110,19 +190,27 @@ AudioPlayer::~AudioPlayer() {
 
 void AudioPlayer::deinit() {
     _run = false;
+    wake();
 
     if (_thread.joinable()) {
         _thread.join();
     }
+    for (PlayRequest *request = _requests.pop(); request; request = _requests.pop()) {
+        delete request;
+    }
+    _backend.reset();
+    AudioStreamer::instance().deinit();
 }
 
 shared_ptr<SoundHandle> AudioPlayer::play(const string &resRef, AudioType type, bool loop, float gain, bool positional, glm::vec3 position) {
+    if (!_inited) return nullptr;
+
     shared_ptr<AudioStream> stream(AudioFiles::instance().get(resRef));
     if (!stream) {
         warn("AudioPlayer: file not found: " + resRef);
         return nullptr;
     }
-    shared_ptr<SoundInstance> sound(new SoundInstance(stream, loop, getGain(type, gain), positional, move(position)));
+    shared_ptr<SoundInstance> sound(new SoundInstance(stream, loop, getGain(type, gain), positional, move(position), getPriority(type, positional)));
     enqueue(sound);
     return sound->handle();
 }
@@ -146,13 +234,30 @@ float AudioPlayer::getGain(AudioType type, float gain) const {
     return gain * (volume / 100.0f);
 }
 
+int AudioPlayer::getPriority(AudioType type, bool positional) const {
+    switch (type) {
+        case AudioType::Music:
+        case AudioType::Movie:
+            return 2;
+        default:
+            return positional ? 0 : 1;
+    }
+}
+
 void AudioPlayer::enqueue(const shared_ptr<SoundInstance> &sound) {
-    lock_guard<recursive_mutex> lock(_soundsMutex);
-    _sounds.push_back(sound);
+    if (!_run) return;
+
+    auto request = new PlayRequest();
+    request->sound = sound;
+    _requests.push(request);
+
+    wake();
 }
 
 shared_ptr<SoundHandle> AudioPlayer::play(const shared_ptr<AudioStream> &stream, AudioType type, bool loop, float gain, bool positional, glm::vec3 position) {
-    shared_ptr<SoundInstance> sound(new SoundInstance(stream, loop, getGain(type, gain), positional, move(position)));
+    if (!_inited) return nullptr;
+
+    shared_ptr<SoundInstance> sound(new SoundInstance(stream, loop, getGain(type, gain), positional, move(position), getPriority(type, positional)));
     enqueue(sound);
     return sound->handle();
 }
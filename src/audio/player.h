@@ -18,17 +18,19 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
-#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
 
-#include "AL/alc.h"
-
 #include "glm/vec3.hpp"
 
+#include "../common/mpscqueue.h"
+
+#include "backend.h"
 #include "soundinstance.h"
 
 namespace reone {
@@ -37,6 +39,17 @@ namespace audio {
 
 class SoundHandle;
 
+/**
+ * Plays sounds on a dedicated thread. The thread sleeps until a sound is
+ * requested and, while sounds are playing, wakes up at a fixed interval to
+ * refill their buffers.
+ *
+ * Sounds are played on voices of an audio backend. When voices are
+ * exhausted, a new sound replaces the least important playing sound: the one
+ * of the lowest priority, and of those, the least audible. Music and movie
+ * audio take precedence over non-positional sounds, which take precedence
+ * over positional sounds.
+ */
 class AudioPlayer {
 public:
     static AudioPlayer &instance();
@@ -44,22 +57,44 @@ public:
     void init(const AudioOptions &opts);
     void deinit();
 
+    /**
+     * @return handle to the sound, or nullptr if the file is not found or
+     *         the player was never initialized
+     */
     std::shared_ptr<SoundHandle> play(const std::string &resRef, AudioType type, bool loop = false, float gain = 1.0f, bool positional = false, glm::vec3 position = glm::vec3(0.0f));
     std::shared_ptr<SoundHandle> play(const std::shared_ptr<AudioStream> &stream, AudioType type, bool loop = false, float gain = 1.0f, bool positional = false, glm::vec3 position = glm::vec3(0.0f));
 
     void setListenerPosition(const glm::vec3 &position);
 
 private:
+    struct PlayRequest {
+        std::atomic<PlayRequest *> next { nullptr };
+        std::shared_ptr<SoundInstance> sound;
+    };
+
     AudioOptions _opts;
-    ALCdevice *_device { nullptr };
-    ALCcontext *_context { nullptr };
+    bool _inited { false };
     std::thread _thread;
-    std::atomic_bool _run { true };
-    std::vector<std::shared_ptr<SoundInstance>> _sounds;
-    std::recursive_mutex _soundsMutex;
+    std::atomic_bool _run { false };
     std::atomic<glm::vec3> _listenerPosition;
     std::atomic_bool _listenerPositionDirty { false };
 
+    // Wake up
+
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeCondition;
+    bool _wakeRequested { false };
+
+    // END Wake up
+
+    // Audio thread
+
+    MpscQueue<PlayRequest> _requests;
+    std::vector<std::shared_ptr<SoundInstance>> _sounds; /**< in order of start */
+    std::unique_ptr<AudioBackend> _backend;
+
+    // END Audio thread
+
     AudioPlayer() = default;
     AudioPlayer(const AudioPlayer &) = delete;
     ~AudioPlayer();
@@ -67,13 +102,18 @@ private:
     AudioPlayer &operator=(const AudioPlayer &) = delete;
 
     void threadStart();
+    void update();
+    void updateSounds();
+    void wait();
+    void wake();
 
-    void initAL();
-    void deinitAL();
+    std::unique_ptr<AudioBackend> createBackend() const;
 
     void enqueue(const std::shared_ptr<SoundInstance> &sound);
+    void startSound(SoundInstance &sound, const glm::vec3 &listenerPosition);
 
     float getGain(AudioType type, float gain) const;
+    int getPriority(AudioType type, bool positional) const;
 };
 
 } // namespace audio
@@ -17,14 +17,18 @@
 
 #include "soundinstance.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <utility>
 
-#include "AL/al.h"
+#include "glm/geometric.hpp"
 
 #include "../common/log.h"
 
+#include "backend.h"
+#include "decoder.h"
 #include "soundhandle.h"
+#include "streamer.h"
 
 using namespace std;
 
@@ -33,46 +37,52 @@ namespace reone {
 namespace audio {
 
 static const int kMaxBufferCount = 8;
+static const int kStreamBufferCount = kDecodeRingSize;
 
-SoundInstance::SoundInstance(const shared_ptr<AudioStream> &stream, bool loop, float gain, bool positional, glm::vec3 position) :
+SoundInstance::SoundInstance(const shared_ptr<AudioStream> &stream, bool loop, float gain, bool positional, glm::vec3 position, int priority) :
     _stream(stream),
     _loop(loop),
     _gain(gain),
     _positional(positional),
+    _priority(priority),
     _handle(new SoundHandle(stream->duration(), move(position))) {
-}
 
-void SoundInstance::init() {
-    int frameCount = _stream->frameCount();
-    int bufferCount = min(max(frameCount, 1), kMaxBufferCount);
+    // Start decoding right away, so that chunks are ready by the time the
+    // audio thread initializes this instance
+    if (stream->isStreamed()) {
+        _ring = make_shared<DecodeRing>(stream->createDecoder(), loop);
+        AudioStreamer::instance().add(_ring);
+    }
+}
 
-    _buffers.resize(bufferCount);
-    _buffered = bufferCount > 1;
+void SoundInstance::init(AudioBackend &backend, uint32_t voice) {
+    _backend = &backend;
+    _voice = voice;
 
-    alGenBuffers(bufferCount, &_buffers[0]);
-    alGenSources(1, &_source);
-    alSourcef(_source, AL_GAIN, _gain);
+    _backend->setGain(_voice, _gain);
 
     if (_positional) {
-        glm::vec3 position(_handle->position());
-        alSource3f(_source, AL_POSITION, position.x, position.y, position.z);
+        _backend->setPosition(_voice, _handle->position(), false);
     } else {
-        alSourcei(_source, AL_SOURCE_RELATIVE, AL_TRUE);
+        _backend->setPosition(_voice, glm::vec3(0.0f), true);
     }
-    if (_buffered) {
-        for (int i = 0; i < bufferCount; ++i) {
-            _stream->fill(_nextFrame, _buffers[i]);
-            ++_nextFrame;
-        }
-        alSourceQueueBuffers(_source, bufferCount, &_buffers[0]);
+    _handle->setState(SoundHandle::State::Playing);
+
+    if (_ring) {
+        // Playback is started by update once the first chunk is decoded
+        queueDecodedChunks();
+        return;
+    }
+    int frameCount = _stream->frameCount();
+    if (frameCount == 1) {
+        _backend->queue(_voice, _stream->getFrame(0));
+        _backend->setLooping(_voice, _loop);
     } else {
-        _stream->fill(0, _buffers[0]);
-        alSourcei(_source, AL_BUFFER, _buffers[0]);
-        alSourcei(_source, AL_LOOPING, _loop);
+        for (; _nextFrame < min(frameCount, kMaxBufferCount); ++_nextFrame) {
+            _backend->queue(_voice, _stream->getFrame(_nextFrame));
+        }
     }
-
-    alSourcePlay(_source);
-    _handle->setState(SoundHandle::State::Playing);
+    _backend->play(_voice);
 }
 
 SoundInstance::~SoundInstance() {
@@ -80,51 +90,95 @@ SoundInstance::~SoundInstance() {
 }
 
 void SoundInstance::deinit() {
-    if (_source) {
-        alSourceStop(_source);
-        alDeleteSources(1, &_source);
-        _source = 0;
+    if (_ring) {
+        _ring->cancel();
+        _ring.reset();
     }
-    if (!_buffers.empty()) {
-        alDeleteBuffers(static_cast<int>(_buffers.size()), &_buffers[0]);
-        _buffers.clear();
+    if (_voice) {
+        _backend->releaseVoice(_voice);
+        _voice = 0;
     }
 }
 
+bool SoundInstance::isInited() const {
+    return _voice != 0;
+}
+
+float SoundInstance::getAudibility(const glm::vec3 &listenerPosition) const {
+    if (!_positional) return _gain;
+
+    // Inverse distance model with a reference distance of 1, which is the
+    // OpenAL default
+    float distance = glm::distance(_handle->position(), listenerPosition);
+    return _gain / max(distance, 1.0f);
+}
+
 void SoundInstance::update() {
     if (_positional && _handle->isPositionDirty()) {
-        glm::vec3 position(_handle->position());
-        alSource3f(_source, AL_POSITION, position.x, position.y, position.z);
+        _backend->setPosition(_voice, _handle->position(), false);
         _handle->resetPositionDirty();
     }
-    if (!_buffered) {
-        ALint state = 0;
-        alGetSourcei(_source, AL_SOURCE_STATE, &state);
-        if (state == AL_STOPPED) {
-            _handle->setState(SoundHandle::State::Stopped);
-        }
-        return;
+    if (_ring) {
+        updateStreamed();
+    } else {
+        updateFrames();
     }
-    ALint processed = 0;
-    alGetSourcei(_source, AL_BUFFERS_PROCESSED, &processed);
-    while (processed-- > 0) {
-        alSourceUnqueueBuffers(_source, 1, &_buffers[_nextBuffer]);
-        if (_loop && _nextFrame == _stream->frameCount()) {
+}
+
+void SoundInstance::updateFrames() {
+    int frameCount = _stream->frameCount();
+
+    for (int processed = _backend->unqueueProcessed(_voice); processed > 0; --processed) {
+        if (_loop && frameCount > 1 && _nextFrame == frameCount) {
             _nextFrame = 0;
         }
-        if (_nextFrame < _stream->frameCount()) {
-            _stream->fill(_nextFrame++, _buffers[_nextBuffer]);
-            alSourceQueueBuffers(_source, 1, &_buffers[_nextBuffer]);
+        if (_nextFrame < frameCount && frameCount > 1) {
+            _backend->queue(_voice, _stream->getFrame(_nextFrame++));
         }
-        _nextBuffer = (_nextBuffer + 1) % static_cast<int>(_buffers.size());
     }
-    ALint queued = 0;
-    alGetSourcei(_source, AL_BUFFERS_QUEUED, &queued);
-    if (queued == 0) {
+    if (!_backend->isPlaying(_voice)) {
         _handle->setState(SoundHandle::State::Stopped);
     }
 }
 
+void SoundInstance::updateStreamed() {
+    _backend->unqueueProcessed(_voice);
+    queueDecodedChunks();
+
+    if (_backend->getQueuedCount(_voice) == 0) {
+        if (_ring->isFinished()) {
+            _handle->setState(SoundHandle::State::Stopped);
+        }
+        return;
+    }
+
+    // Start playback, or resume it if decoding could not keep up
+    if (!_backend->isPlaying(_voice)) {
+        _backend->play(_voice);
+    }
+}
+
+void SoundInstance::queueDecodedChunks() {
+    bool consumed = false;
+
+    for (int queued = _backend->getQueuedCount(_voice); queued < kStreamBufferCount; ++queued) {
+        const AudioStream::Frame *chunk = _ring->front();
+        if (!chunk) break;
+
+        _backend->queue(_voice, *chunk);
+        _ring->pop();
+
+        consumed = true;
+    }
+    if (consumed) {
+        AudioStreamer::instance().notify();
+    }
+}
+
+int SoundInstance::priority() const {
+    return _priority;
+}
+
 shared_ptr<SoundHandle> SoundInstance::handle() const {
     return _handle;
 }
@@ -17,8 +17,9 @@
 
 #pragma once
 
-#include <string>
+#include <cstdint>
 #include <memory>
+#include <string>
 
 #include "glm/vec3.hpp"
 
@@ -28,19 +29,35 @@ namespace reone {
 
 namespace audio {
 
+class AudioBackend;
+class DecodeRing;
 class SoundHandle;
 
 class SoundInstance {
 public:
-    SoundInstance(const std::shared_ptr<AudioStream> &stream, bool loop, float gain, bool positional, glm::vec3 position);
-    SoundInstance(SoundInstance &&) = default;
+    SoundInstance(const std::shared_ptr<AudioStream> &stream, bool loop, float gain, bool positional, glm::vec3 position, int priority);
     ~SoundInstance();
 
-    SoundInstance &operator=(SoundInstance &&) = default;
+    /**
+     * Starts playback on the specified voice, taking ownership of it.
+     */
+    void init(AudioBackend &backend, uint32_t voice);
 
-    void init();
     void update();
 
+    /**
+     * Returns the voice to the backend.
+     */
+    void deinit();
+
+    bool isInited() const;
+
+    /**
+     * @return approximate gain of this sound at the listener position
+     */
+    float getAudibility(const glm::vec3 &listenerPosition) const;
+
+    int priority() const;
     std::shared_ptr<SoundHandle> handle() const;
 
 private:
@@ -48,17 +65,19 @@ private:
     bool _loop { false };
     float _gain { 0.0f };
     bool _positional { false };
+    int _priority { 0 };
     std::shared_ptr<SoundHandle> _handle;
-    std::vector<uint32_t> _buffers;
-    bool _buffered { false };
-    uint32_t _source { 0 };
+    AudioBackend *_backend { nullptr };
+    uint32_t _voice { 0 };
     int _nextFrame { 0 };
-    int _nextBuffer { 0 };
+    std::shared_ptr<DecodeRing> _ring; /**< streamed sounds only */
 
-    SoundInstance(SoundInstance &) = delete;
-    SoundInstance &operator=(SoundInstance &) = delete;
+    SoundInstance(const SoundInstance &) = delete;
+    SoundInstance &operator=(const SoundInstance &) = delete;
 
-    void deinit();
+    void updateFrames();
+    void updateStreamed();
+    void queueDecodedChunks();
 };
 
 } // namespace audio
@@ -20,7 +20,8 @@
 #include <stdexcept>
 #include <string>
 
-#include "AL/al.h"
+#include "decoder.h"
+#include "util.h"
 
 using namespace std;
 
@@ -28,32 +29,26 @@ namespace reone {
 
 namespace audio {
 
+AudioStream::AudioStream(DecoderFactory decoderFactory, float duration) :
+    _duration(duration),
+    _decoderFactory(move(decoderFactory)) {
+}
+
 void AudioStream::add(Frame &&frame) {
-    _duration += 1000.0f * (frame.samples.size() / static_cast<float>(frame.sampleRate));
+    int bytesPerSample = getBytesPerSample(frame.format);
+    _duration += 1000.0f * (frame.samples.size() / static_cast<float>(bytesPerSample * frame.sampleRate));
     _frames.push_back(move(frame));
 }
 
-void AudioStream::fill(int frameIdx, uint32_t buffer) {
-    if (frameIdx >= _frames.size()) {
-        throw out_of_range("Frame index out of range: " + to_string(frameIdx));
+unique_ptr<AudioDecoder> AudioStream::createDecoder() const {
+    if (!_decoderFactory) {
+        throw logic_error("Audio stream is not decoded incrementally");
     }
-    Frame &frame = _frames[frameIdx];
-    alBufferData(buffer, getALAudioFormat(frame.format), &frame.samples[0], static_cast<int>(frame.samples.size()), frame.sampleRate);
+    return _decoderFactory();
 }
 
-int AudioStream::getALAudioFormat(AudioFormat format) const {
-    switch (format) {
-        case AudioFormat::Mono8:
-            return AL_FORMAT_MONO8;
-        case AudioFormat::Mono16:
-            return AL_FORMAT_MONO16;
-        case AudioFormat::Stereo8:
-            return AL_FORMAT_STEREO8;
-        case AudioFormat::Stereo16:
-            return AL_FORMAT_STEREO16;
-        default:
-            throw logic_error("Unknown audio format: " + to_string(static_cast<int>(format)));
-    }
+bool AudioStream::isStreamed() const {
+    return static_cast<bool>(_decoderFactory);
 }
 
 int AudioStream::duration() const {
@@ -18,6 +18,8 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
+#include <memory>
 
 #include "../common/types.h"
 
@@ -27,6 +29,12 @@ namespace reone {
 
 namespace audio {
 
+class AudioDecoder;
+
+/**
+ * Audio, that is either decoded in full and stored as a sequence of frames, or
+ * decoded incrementally during playback.
+ */
 class AudioStream {
 public:
     struct Frame {
@@ -35,10 +43,27 @@ public:
         ByteArray samples;
     };
 
+    typedef std::function<std::unique_ptr<AudioDecoder>()> DecoderFactory;
+
     AudioStream() = default;
 
+    /**
+     * Constructs a stream, that is decoded incrementally during playback. Each
+     * sound instance gets its own decoder.
+     *
+     * @param duration duration in milliseconds
+     */
+    AudioStream(DecoderFactory decoderFactory, float duration);
+
     void add(Frame &&frame);
-    void fill(int frameIdx, uint32_t buffer);
+
+    /**
+     * @return new decoder, positioned at the start of the stream
+     * @throws std::logic_error if the stream is not decoded incrementally
+     */
+    std::unique_ptr<AudioDecoder> createDecoder() const;
+
+    bool isStreamed() const;
 
     int duration() const;
     int frameCount() const;
@@ -47,11 +72,10 @@ public:
 private:
     float _duration { 0 };
     std::vector<Frame> _frames;
+    DecoderFactory _decoderFactory;
 
     AudioStream(const AudioStream &) = delete;
     AudioStream &operator=(const AudioStream &) = delete;
-
-    int getALAudioFormat(AudioFormat format) const;
 };
 
 } // namespace audio
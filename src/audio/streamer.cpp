@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "streamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+
+#include "../common/log.h"
+#include "../common/profiler.h"
+
+#include "decoder.h"
+
+using namespace std;
+
+namespace reone {
+
+namespace audio {
+
+static const chrono::milliseconds kIdleTimeout(100);
+
+DecodeRing::DecodeRing(unique_ptr<AudioDecoder> decoder, bool loop) : _decoder(move(decoder)), _loop(loop) {
+}
+
+DecodeRing::~DecodeRing() {
+}
+
+const AudioStream::Frame *DecodeRing::front() const {
+    uint32_t head = _head.load(memory_order_relaxed);
+    if (head == _tail.load(memory_order_acquire)) return nullptr;
+
+    return &_chunks[head % kDecodeRingSize];
+}
+
+void DecodeRing::pop() {
+    _head.store(_head.load(memory_order_relaxed) + 1, memory_order_release);
+}
+
+void DecodeRing::cancel() {
+    _cancelled = true;
+}
+
+bool DecodeRing::isFinished() const {
+    return _ended.load(memory_order_acquire) && _head.load(memory_order_relaxed) == _tail.load(memory_order_acquire);
+}
+
+bool DecodeRing::decodeAhead() {
+    if (_cancelled) return false;
+
+    try {
+        uint32_t tail = _tail.load(memory_order_relaxed);
+        bool rewound = false;
+
+        while (!_ended && tail - _head.load(memory_order_acquire) < kDecodeRingSize) {
+            AudioStream::Frame &chunk = _chunks[tail % kDecodeRingSize];
+            if (_decoder->decode(chunk)) {
+                _tail.store(++tail, memory_order_release);
+                rewound = false;
+                continue;
+            }
+            // Stop looping streams, that have nothing to decode
+            if (!_loop || rewound) {
+                _ended.store(true, memory_order_release);
+                break;
+            }
+            _decoder->rewind();
+            rewound = true;
+        }
+    }
+    catch (const exception &e) {
+        warn("DecodeRing: decoding failed: " + string(e.what()));
+        _ended.store(true, memory_order_release);
+    }
+
+    return !_ended;
+}
+
+AudioStreamer &AudioStreamer::instance() {
+    static AudioStreamer instance;
+    return instance;
+}
+
+void AudioStreamer::init() {
+    _run = true;
+    _thread = thread(bind(&AudioStreamer::threadStart, this));
+}
+
+AudioStreamer::~AudioStreamer() {
+    deinit();
+}
+
+void AudioStreamer::deinit() {
+    if (!_run) return;
+
+    _run = false;
+    notify();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    _added.clear();
+    _rings.clear();
+}
+
+void AudioStreamer::add(const shared_ptr<DecodeRing> &ring) {
+    {
+        lock_guard<mutex> lock(_mutex);
+        _added.push_back(ring);
+        _notified = true;
+    }
+    _condition.notify_one();
+}
+
+void AudioStreamer::notify() {
+    {
+        lock_guard<mutex> lock(_mutex);
+        _notified = true;
+    }
+    _condition.notify_one();
+}
+
+void AudioStreamer::threadStart() {
+    Profiler::instance().setThreadName("AudioStreamer");
+
+    while (_run) {
+        {
+            unique_lock<mutex> lock(_mutex);
+            _condition.wait_for(lock, kIdleTimeout, [this]() { return _notified || !_run; });
+            _notified = false;
+
+            _rings.insert(_rings.end(), _added.begin(), _added.end());
+            _added.clear();
+        }
+        if (_rings.empty()) continue;
+
+        PROFILE_ZONE("AudioStreamer::update");
+
+        auto finished = remove_if(
+            _rings.begin(), _rings.end(),
+            [](auto &ring) { return !ring->decodeAhead(); });
+
+        _rings.erase(finished, _rings.end());
+    }
+}
+
+} // namespace audio
+
+} // namespace reone
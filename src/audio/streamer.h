@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "stream.h"
+
+namespace reone {
+
+namespace audio {
+
+class AudioDecoder;
+
+/**
+ * Number of decoded chunks, that are kept ahead of playback of a streamed
+ * sound.
+ */
+const int kDecodeRingSize = 4;
+
+/**
+ * Fixed ring of decoded chunks of a single streamed sound. Filled by the
+ * streamer thread and drained by the audio thread, without locking.
+ */
+class DecodeRing {
+public:
+    DecodeRing(std::unique_ptr<AudioDecoder> decoder, bool loop);
+    ~DecodeRing();
+
+    // Consumer
+
+    /**
+     * @return oldest decoded chunk, or nullptr if none are decoded yet
+     */
+    const AudioStream::Frame *front() const;
+
+    /**
+     * Releases the oldest decoded chunk, so that it can be decoded into again.
+     */
+    void pop();
+
+    /**
+     * Stops decoding. The streamer will release the ring.
+     */
+    void cancel();
+
+    /**
+     * @return true if the end of stream was reached and all decoded chunks
+     *         were consumed
+     */
+    bool isFinished() const;
+
+    // END Consumer
+
+    // Producer
+
+    /**
+     * Decodes chunks until the ring is full or the end of stream is reached.
+     *
+     * @return true if the ring must be kept for further decoding, false otherwise
+     */
+    bool decodeAhead();
+
+    // END Producer
+
+private:
+    std::unique_ptr<AudioDecoder> _decoder;
+    bool _loop { false };
+    AudioStream::Frame _chunks[kDecodeRingSize];
+    std::atomic<uint32_t> _head { 0 }; /**< next chunk to consume */
+    std::atomic<uint32_t> _tail { 0 }; /**< next chunk to decode */
+    std::atomic_bool _ended { false };
+    std::atomic_bool _cancelled { false };
+
+    DecodeRing(const DecodeRing &) = delete;
+    DecodeRing &operator=(const DecodeRing &) = delete;
+};
+
+/**
+ * Background thread, that decodes streamed sounds ahead of playback. Sleeps
+ * until a chunk is consumed or a new ring is added.
+ */
+class AudioStreamer {
+public:
+    static AudioStreamer &instance();
+
+    void init();
+    void deinit();
+
+    void add(const std::shared_ptr<DecodeRing> &ring);
+
+    /**
+     * Wakes the streamer thread up to decode more chunks.
+     */
+    void notify();
+
+private:
+    std::thread _thread;
+    std::atomic_bool _run { false };
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _notified { false };
+    std::vector<std::shared_ptr<DecodeRing>> _added; /**< guarded by _mutex */
+    std::vector<std::shared_ptr<DecodeRing>> _rings; /**< owned by the streamer thread */
+
+    AudioStreamer() = default;
+    AudioStreamer(const AudioStreamer &) = delete;
+    ~AudioStreamer();
+
+    AudioStreamer &operator=(const AudioStreamer &) = delete;
+
+    void threadStart();
+};
+
+} // namespace audio
+
+} // namespace reone
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <string>
+
 namespace reone {
 
 namespace audio {
@@ -34,10 +36,18 @@ enum class AudioType {
     Movie
 };
 
+enum class AudioBackendType {
+    OpenAL,
+    Mixer
+};
+
 struct AudioOptions {
     int soundVolume { 85 };
     int musicVolume { 85 };
     int movieVolume { 85 };
+    AudioBackendType backend { AudioBackendType::OpenAL };
+    int voiceCount { 32 };
+    std::string wavOutput; /**< mixer output file, discarded if empty */
 };
 
 } // namespace audio
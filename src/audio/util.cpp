@@ -17,10 +17,164 @@
 
 #include "util.h"
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REONE_AUDIO_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
 namespace reone {
 
 namespace audio {
 
+int getBytesPerSample(AudioFormat format) {
+    switch (format) {
+        case AudioFormat::Mono8:
+            return 1;
+        case AudioFormat::Mono16:
+        case AudioFormat::Stereo8:
+            return 2;
+        case AudioFormat::Stereo16:
+            return 4;
+        default:
+            throw logic_error("Unknown audio format: " + to_string(static_cast<int>(format)));
+    }
+}
+
+static inline int16_t convertFixedSample(int32_t sample, int fracBits) {
+    // Clipping to [-1, 1) and then shifting is the same as shifting and then
+    // saturating, which is what the vectorized version does
+    int32_t value = (sample + (1 << (fracBits - 16))) >> (fracBits + 1 - 16);
+    if (value > INT16_MAX) return INT16_MAX;
+    if (value < INT16_MIN) return INT16_MIN;
+    return static_cast<int16_t>(value);
+}
+
+void convertFixedToPCM16(const int32_t *left, const int32_t *right, int count, int fracBits, int16_t *out) {
+    int i = 0;
+
+#ifdef REONE_AUDIO_SSE2
+    __m128i round = _mm_set1_epi32(1 << (fracBits - 16));
+    __m128i shift = _mm_cvtsi32_si128(fracBits + 1 - 16);
+
+    auto convert = [&round, &shift](const int32_t *samples) {
+        __m128i lo = _mm_sra_epi32(_mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + 0)), round), shift);
+        __m128i hi = _mm_sra_epi32(_mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + 4)), round), shift);
+        return _mm_packs_epi32(lo, hi);
+    };
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i l = convert(left + i);
+        if (right) {
+            __m128i r = convert(right + i);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i + 0), _mm_unpacklo_epi16(l, r));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), l);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        if (right) {
+            out[2 * i + 0] = convertFixedSample(left[i], fracBits);
+            out[2 * i + 1] = convertFixedSample(right[i], fracBits);
+        } else {
+            out[i] = convertFixedSample(left[i], fracBits);
+        }
+    }
+}
+
+void convertPCM16ToFloat(const int16_t *samples, int count, float *out) {
+    static const float kScale = 1.0f / 32768.0f;
+    int i = 0;
+
+#ifdef REONE_AUDIO_SSE2
+    __m128 scale = _mm_set1_ps(kScale);
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+
+        // Sign-extend by unpacking into the upper halves and shifting back
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+
+        _mm_storeu_ps(out + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[i] = samples[i] * kScale;
+    }
+}
+
+void convertFloatToPCM16(const float *samples, int count, int16_t *out) {
+    int i = 0;
+
+#ifdef REONE_AUDIO_SSE2
+    __m128 scale = _mm_set1_ps(32768.0f);
+
+    for (; i + 8 <= count; i += 8) {
+        // Out of range values convert to INT32_MIN, clamp before converting
+        __m128 lo = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(samples + i + 0), scale), _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+        __m128 hi = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(samples + i + 4), scale), _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        float value = max(-32768.0f, min(samples[i] * 32768.0f, 32767.0f));
+        out[i] = static_cast<int16_t>(lrintf(value));
+    }
+}
+
+void mixMonoToStereo(const float *samples, int count, float leftGain, float rightGain, float *out) {
+    int i = 0;
+
+#ifdef REONE_AUDIO_SSE2
+    __m128 gains = _mm_setr_ps(leftGain, rightGain, leftGain, rightGain);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 in = _mm_loadu_ps(samples + i);
+        __m128 lo = _mm_mul_ps(_mm_unpacklo_ps(in, in), gains);
+        __m128 hi = _mm_mul_ps(_mm_unpackhi_ps(in, in), gains);
+        _mm_storeu_ps(out + 2 * i + 0, _mm_add_ps(_mm_loadu_ps(out + 2 * i + 0), lo));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_add_ps(_mm_loadu_ps(out + 2 * i + 4), hi));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[2 * i + 0] += samples[i] * leftGain;
+        out[2 * i + 1] += samples[i] * rightGain;
+    }
+}
+
+void mixStereo(const float *samples, int count, float leftGain, float rightGain, float *out) {
+    int i = 0;
+
+#ifdef REONE_AUDIO_SSE2
+    __m128 gains = _mm_setr_ps(leftGain, rightGain, leftGain, rightGain);
+
+    for (; i + 2 <= count; i += 2) {
+        __m128 in = _mm_mul_ps(_mm_loadu_ps(samples + 2 * i), gains);
+        _mm_storeu_ps(out + 2 * i, _mm_add_ps(_mm_loadu_ps(out + 2 * i), in));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[2 * i + 0] += samples[2 * i + 0] * leftGain;
+        out[2 * i + 1] += samples[2 * i + 1] * rightGain;
+    }
+}
+
 } // namespace audio
 
 } // namespace reone
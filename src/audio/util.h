@@ -17,10 +17,57 @@
 
 #pragma once
 
+#include <cstdint>
+
+#include "types.h"
+
 namespace reone {
 
 namespace audio {
 
+/**
+ * @return size of a single sample of all channels in bytes
+ */
+int getBytesPerSample(AudioFormat format);
+
+/**
+ * Converts fixed-point samples of one or two channels into interleaved signed
+ * 16-bit samples, rounding and clipping them.
+ *
+ * @param left samples of the left (or the only) channel
+ * @param right samples of the right channel, or nullptr for mono
+ * @param count number of samples per channel
+ * @param fracBits number of fractional bits in the fixed-point samples, at least 16
+ * @param out output buffer of count samples per channel
+ */
+void convertFixedToPCM16(const int32_t *left, const int32_t *right, int count, int fracBits, int16_t *out);
+
+/**
+ * Converts signed 16-bit samples into floating-point samples in [-1, 1).
+ */
+void convertPCM16ToFloat(const int16_t *samples, int count, float *out);
+
+/**
+ * Converts floating-point samples into signed 16-bit samples, clipping them.
+ */
+void convertFloatToPCM16(const float *samples, int count, int16_t *out);
+
+/**
+ * Adds mono samples, scaled by per-channel gains, to interleaved stereo output.
+ *
+ * @param count number of samples in the input
+ * @param out output buffer of count samples per channel
+ */
+void mixMonoToStereo(const float *samples, int count, float leftGain, float rightGain, float *out);
+
+/**
+ * Adds interleaved stereo samples, scaled by per-channel gains, to
+ * interleaved stereo output.
+ *
+ * @param count number of samples per channel
+ */
+void mixStereo(const float *samples, int count, float leftGain, float rightGain, float *out);
+
 } // namespace audio
 
 } // namespace reone
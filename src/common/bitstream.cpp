@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bitstream.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace reone {
+
+// Variable length integers are prefixed with a two-bit width class
+static const int kVarIntBits[] = { 4, 8, 16, 32 };
+
+static uint32_t zigZagEncode(int32_t val) {
+    return (static_cast<uint32_t>(val) << 1) ^ static_cast<uint32_t>(val >> 31);
+}
+
+static int32_t zigZagDecode(uint32_t val) {
+    return static_cast<int32_t>(val >> 1) ^ -static_cast<int32_t>(val & 1);
+}
+
+void BitWriter::putBits(uint32_t val, int bits) {
+    if (bits < 0 || bits > 32) {
+        throw invalid_argument("bits out of range: " + to_string(bits));
+    }
+    uint64_t remaining = bits < 32 ? val & ((1u << bits) - 1) : val;
+
+    // Fill the last partially written byte first, then whole bytes
+    while (bits > 0) {
+        size_t byteIdx = _bitCount >> 3;
+        if (byteIdx == _data.size()) {
+            _data.push_back(0);
+        }
+        int shift = static_cast<int>(_bitCount & 7);
+        int count = min(8 - shift, bits);
+
+        _data[byteIdx] |= static_cast<char>((remaining & ((1 << count) - 1)) << shift);
+
+        remaining >>= count;
+        bits -= count;
+        _bitCount += count;
+    }
+}
+
+void BitWriter::putBool(bool val) {
+    putBits(val ? 1 : 0, 1);
+}
+
+void BitWriter::putVarUint(uint32_t val) {
+    for (int i = 0; i < 4; ++i) {
+        int bits = kVarIntBits[i];
+        if (bits == 32 || val < (1u << bits)) {
+            putBits(i, 2);
+            putBits(val, bits);
+            return;
+        }
+    }
+}
+
+void BitWriter::putVarInt(int32_t val) {
+    putVarUint(zigZagEncode(val));
+}
+
+void BitWriter::putString(const string &str) {
+    int len = static_cast<int>(str.length());
+    if (len > 255) {
+        throw invalid_argument("String is too long: " + to_string(len));
+    }
+    putBits(len, 8);
+    for (int i = 0; i < len; ++i) {
+        putBits(static_cast<uint8_t>(str[i]), 8);
+    }
+}
+
+void BitWriter::appendTo(ByteArray &data) const {
+    data.insert(data.end(), _data.begin(), _data.end());
+}
+
+size_t BitWriter::bitCount() const {
+    return _bitCount;
+}
+
+BitReader::BitReader(const char *data, size_t size) : _data(data), _size(size) {
+}
+
+uint32_t BitReader::getBits(int bits) {
+    if (bits < 0 || bits > 32) {
+        throw invalid_argument("bits out of range: " + to_string(bits));
+    }
+    if (_bitOffset + bits > 8 * _size) {
+        throw out_of_range("BitReader: not enough data");
+    }
+    uint64_t val = 0;
+    int read = 0;
+
+    while (read < bits) {
+        int shift = static_cast<int>(_bitOffset & 7);
+        int count = min(8 - shift, bits - read);
+        uint8_t byte = static_cast<uint8_t>(_data[_bitOffset >> 3]);
+
+        val |= static_cast<uint64_t>((byte >> shift) & ((1 << count) - 1)) << read;
+
+        read += count;
+        _bitOffset += count;
+    }
+
+    return static_cast<uint32_t>(val);
+}
+
+bool BitReader::getBool() {
+    return getBits(1) != 0;
+}
+
+uint32_t BitReader::getVarUint() {
+    uint32_t widthClass = getBits(2);
+    return getBits(kVarIntBits[widthClass]);
+}
+
+int32_t BitReader::getVarInt() {
+    return zigZagDecode(getVarUint());
+}
+
+string BitReader::getString() {
+    int len = static_cast<int>(getBits(8));
+
+    string str(len, '\0');
+    for (int i = 0; i < len; ++i) {
+        str[i] = static_cast<char>(getBits(8));
+    }
+
+    return move(str);
+}
+
+} // namespace reone
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "types.h"
+
+namespace reone {
+
+/**
+ * Packs values of arbitrary bit width into a byte array, least significant
+ * bits first.
+ */
+class BitWriter {
+public:
+    void putBits(uint32_t val, int bits);
+    void putBool(bool val);
+
+    /**
+     * Writes an unsigned integer, using fewer bits for smaller values.
+     */
+    void putVarUint(uint32_t val);
+
+    /**
+     * Writes a signed integer, using fewer bits for values closer to zero.
+     */
+    void putVarInt(int32_t val);
+
+    void putString(const std::string &str);
+
+    /**
+     * Appends written bytes to the specified array. The last byte is padded
+     * with zero bits.
+     */
+    void appendTo(ByteArray &data) const;
+
+    size_t bitCount() const;
+
+private:
+    ByteArray _data;
+    size_t _bitCount { 0 };
+};
+
+/**
+ * Reads values, written by BitWriter.
+ *
+ * @see reone::BitWriter
+ */
+class BitReader {
+public:
+    BitReader(const char *data, size_t size);
+
+    /**
+     * @throws std::out_of_range if there are not enough bits left
+     */
+    uint32_t getBits(int bits);
+    bool getBool();
+    uint32_t getVarUint();
+    int32_t getVarInt();
+    std::string getString();
+
+private:
+    const char *_data { nullptr };
+    size_t _size { 0 };
+    size_t _bitOffset { 0 };
+};
+
+} // namespace reone
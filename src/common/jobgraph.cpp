@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "jobgraph.h"
+
+#include <stdexcept>
+
+#include "jobs.h"
+
+using namespace std;
+
+namespace reone {
+
+int JobGraph::add(const function<void()> &job, const vector<int> &dependencies, bool mainThread) {
+    int id = static_cast<int>(_jobs.size());
+
+    Job newJob;
+    newJob.fn = job;
+    newJob.mainThread = mainThread;
+    newJob.dependencyCount = static_cast<int>(dependencies.size());
+
+    for (int dependency : dependencies) {
+        if (dependency < 0 || dependency >= id) {
+            throw invalid_argument("Invalid job dependency: " + to_string(dependency));
+        }
+        _jobs[dependency].dependents.push_back(id);
+    }
+    _jobs.push_back(move(newJob));
+
+    if (mainThread) {
+        _mainQueue.push_back(id);
+    }
+
+    return id;
+}
+
+void JobGraph::run(const function<void(int, int)> &onProgress) {
+    int total = static_cast<int>(_jobs.size());
+    int reported = -1;
+
+    unique_lock<mutex> lock(_mutex);
+
+    for (int id = 0; id < total; ++id) {
+        if (_jobs[id].dependencyCount == 0) {
+            schedule(id);
+        }
+    }
+    while (_completed < total) {
+        if (onProgress && reported != _completed) {
+            reported = _completed;
+            lock.unlock();
+            onProgress(reported, total);
+            lock.lock();
+            continue;
+        }
+        if (!_mainQueue.empty() && _jobs[_mainQueue.front()].dependencyCount == 0) {
+            int id = _mainQueue.front();
+            _mainQueue.pop_front();
+            lock.unlock();
+            execute(id);
+            lock.lock();
+            continue;
+        }
+        _completedCond.wait(lock);
+    }
+    if (onProgress && reported != _completed) {
+        lock.unlock();
+        onProgress(total, total);
+        lock.lock();
+    }
+    if (_exception) {
+        rethrow_exception(_exception);
+    }
+}
+
+void JobGraph::schedule(int id) {
+    // Main thread jobs are picked up by the run loop
+    if (_jobs[id].mainThread) return;
+
+    JobExecutor::instance().enqueue([this, id](const atomic_bool &) {
+        execute(id);
+    });
+}
+
+void JobGraph::execute(int id) {
+    bool failed;
+    {
+        lock_guard<mutex> lock(_mutex);
+        failed = static_cast<bool>(_exception);
+    }
+    if (!failed) {
+        try {
+            _jobs[id].fn();
+        }
+        catch (...) {
+            lock_guard<mutex> lock(_mutex);
+            if (!_exception) {
+                _exception = current_exception();
+            }
+        }
+    }
+
+    lock_guard<mutex> lock(_mutex);
+
+    for (int dependent : _jobs[id].dependents) {
+        if (--_jobs[dependent].dependencyCount == 0) {
+            schedule(dependent);
+        }
+    }
+    ++_completed;
+    _completedCond.notify_all();
+}
+
+int JobGraph::jobCount() const {
+    return static_cast<int>(_jobs.size());
+}
+
+} // namespace reone
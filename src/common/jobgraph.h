@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace reone {
+
+/**
+ * Runs a set of jobs, respecting dependencies between them. Jobs run on
+ * worker threads of the JobExecutor, unless they must run on the thread that
+ * runs the graph, e.g. because they use OpenGL or modify the scene graph.
+ * The latter run in the order they were added.
+ *
+ * Jobs must be added before the graph is run. A job may only depend on jobs
+ * that were added before it.
+ */
+class JobGraph {
+public:
+    JobGraph() = default;
+
+    /**
+     * @param mainThread whether to run the job on the thread that runs the graph
+     * @return identifier of the job, to be used as a dependency of other jobs
+     */
+    int add(const std::function<void()> &job, const std::vector<int> &dependencies = std::vector<int>(), bool mainThread = false);
+
+    /**
+     * Runs all jobs and waits for them to complete. While waiting, reports
+     * the number of completed jobs, whenever it changes.
+     *
+     * @param onProgress called on the calling thread with the number of
+     *                   completed jobs and the total number of jobs
+     * @throws the first exception thrown by a job, once running jobs have
+     *         completed; jobs that did not start by then are skipped
+     */
+    void run(const std::function<void(int, int)> &onProgress = nullptr);
+
+    int jobCount() const;
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        bool mainThread { false };
+        int dependencyCount { 0 }; /**< number of dependencies, that did not complete yet */
+        std::vector<int> dependents;
+    };
+
+    std::vector<Job> _jobs;
+    std::deque<int> _mainQueue;
+    int _completed { 0 };
+    std::exception_ptr _exception;
+    std::mutex _mutex;
+    std::condition_variable _completedCond;
+
+    JobGraph(const JobGraph &) = delete;
+    JobGraph &operator=(const JobGraph &) = delete;
+
+    void execute(int id);
+    void schedule(int id);
+};
+
+} // namespace reone
@@ -21,6 +21,8 @@
 
 #include <boost/asio/post.hpp>
 
+#include "profiler.h"
+
 using namespace std;
 
 namespace reone {
@@ -43,8 +45,12 @@ void JobExecutor::enqueue(const function<void(const atomic_bool &)> &job) {
     _cancel = false;
 
     boost::asio::post(_pool, [&, job]() {
+        Profiler::instance().setThreadName("Worker");
         ++_jobsActive;
-        job(_cancel);
+        {
+            PROFILE_ZONE("JobExecutor::job");
+            job(_cancel);
+        }
         --_jobsActive;
     });
 }
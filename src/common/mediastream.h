@@ -17,59 +17,189 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
-#include <utility>
+#include <thread>
 #include <vector>
 
+#include "log.h"
+#include "spscqueue.h"
+
 namespace reone {
 
+/**
+ * Decodes frames of a media stream on a dedicated thread, ahead of playback.
+ * Decoded frames are passed to the consumer through a bounded lock-free
+ * queue. Frames are allocated once and returned to the decoding thread for
+ * reuse once the consumer is done with them. The mutex only guards sleeping
+ * and waking up of either side.
+ *
+ * Derived classes must call start once constructed, and stop before their
+ * destructor returns.
+ */
 template <class Frame>
 class MediaStream {
 public:
-    static const int kBufferSize = 8;
+    static const int kQueueSize = 8;
 
     virtual ~MediaStream() {
     }
 
-    std::shared_ptr<Frame> get(int frame) {
-        int relFrame = frame - _frameOffset;
-        if (relFrame < 0) {
-            throw std::logic_error("frame was unloaded: " + std::to_string(frame));
+    /**
+     * Returns the most recent decoded frame, that is not newer than the
+     * requested one, skipping older frames. Waits for the first frame to be
+     * decoded, but never for subsequent ones: if decoding falls behind, the
+     * previous frame is returned again.
+     *
+     * The returned frame remains valid until the next call.
+     *
+     * @return frame to present, or nullptr if the stream has ended and the
+     *         requested frame is past its last frame
+     */
+    const Frame *get(int frame) {
+        if (!_current && !_pending.frame) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _consumerCondition.wait(lock, [this]() { return !_decoded.empty() || _ended; });
         }
-        if (relFrame < static_cast<int>(_frames.size())) {
-            return _frames[relFrame];
+        while (!_current || _currentIndex < frame) {
+            if (!_pending.frame && !_decoded.pop(_pending)) break;
+            if (_pending.index > frame) break;
+
+            recycle(_current);
+            _current = _pending.frame;
+            _currentIndex = _pending.index;
+            _pending.frame = nullptr;
         }
-        if (_ended) {
+        if (_currentIndex < frame && _ended && !_pending.frame && _decoded.empty()) {
             return nullptr;
         }
-        _frames.clear();
 
-        int nextFrame = _frameOffset + kBufferSize;
-        int framesToIgnore = std::max(0, frame - nextFrame);
-        ignoreFrames(framesToIgnore);
-        fetchFrames(kBufferSize);
-
-        _frameOffset = frame;
+        return _current;
+    }
 
-        return get(frame);
+    /**
+     * Frames are reused, therefore a new frame must be told apart from the
+     * previous one by index rather than by address.
+     *
+     * @return index of the frame returned by the last call to get, or -1 if
+     *         none was returned yet
+     */
+    int currentIndex() const {
+        return _currentIndex;
     }
 
 protected:
-    MediaStream() = default;
+    MediaStream() : _decoded(kFrameCount), _free(kFrameCount) {
+    }
 
-    virtual void ignoreFrames(int count) = 0;
-    virtual void fetchFrames(int count) = 0;
+    /**
+     * Called on the decoding thread.
+     *
+     * @param frame frame to decode into, possibly holding an older frame
+     * @return false if there are no more frames to decode, true otherwise
+     */
+    virtual bool decodeFrame(Frame &frame) = 0;
 
-    std::vector<std::shared_ptr<Frame>> _frames;
-    bool _ended { false };
+    void start() {
+        for (int i = 0; i < kFrameCount; ++i) {
+            _frames.push_back(std::make_unique<Frame>());
+            _free.push(_frames.back().get());
+        }
+        _thread = std::thread(std::bind(&MediaStream::threadStart, this));
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _decoderCondition.notify_one();
+
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
 
 private:
+    // Frames in the queue, the current and the pending frames, and the frame
+    // being decoded
+    static const int kFrameCount = kQueueSize + 3;
+
+    struct DecodedFrame {
+        int index { 0 };
+        Frame *frame { nullptr };
+    };
+
+    std::vector<std::unique_ptr<Frame>> _frames;
+    std::thread _thread;
+    std::atomic_bool _ended { false };
+
+    std::mutex _mutex;
+    std::condition_variable _decoderCondition;
+    std::condition_variable _consumerCondition;
+    bool _stop { false };
+
+    // Decoding thread
+
+    int _nextIndex { 0 };
+    SpscQueue<DecodedFrame> _decoded;
+
+    // END Decoding thread
+
+    // Consumer
+
+    Frame *_current { nullptr };
+    int _currentIndex { -1 };
+    DecodedFrame _pending; /**< popped from the queue, but too early to present */
+    SpscQueue<Frame *> _free;
+
+    // END Consumer
+
     MediaStream(const MediaStream &) = delete;
     MediaStream &operator=(const MediaStream &) = delete;
 
-    int _frameOffset { 0 };
+    void threadStart() {
+        while (true) {
+            Frame *frame = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _decoderCondition.wait(lock, [this, &frame]() { return _stop || _free.pop(frame); });
+                if (_stop) break;
+            }
+            bool decoded = false;
+            try {
+                decoded = decodeFrame(*frame);
+            }
+            catch (const std::exception &e) {
+                error("MediaStream: decoding failed: " + std::string(e.what()));
+            }
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (decoded) {
+                    _decoded.push(DecodedFrame { _nextIndex++, frame });
+                } else {
+                    _ended = true;
+                }
+            }
+            _consumerCondition.notify_one();
+
+            if (!decoded) break;
+        }
+    }
+
+    void recycle(Frame *frame) {
+        if (!frame) return;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _free.push(frame);
+        }
+        _decoderCondition.notify_one();
+    }
 };
 
 } // namespace reone
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+
+namespace reone {
+
+/**
+ * Intrusive, lock-free, multiple producer, single consumer queue. Nodes must
+ * have an std::atomic<T *> next member. Any thread may push, but only one
+ * thread at a time may pop.
+ *
+ * Based on the algorithm by Dmitry Vyukov: a producer swaps the head and
+ * then links the previous head to its node, so a pop may briefly observe a
+ * node whose successor is not linked yet, in which case it returns nullptr.
+ */
+template <class T>
+class MpscQueue {
+public:
+    MpscQueue() : _head(&_stub), _tail(&_stub) {
+    }
+
+    void push(T *node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        T *prev = _head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @return oldest node, or nullptr if the queue is empty
+     */
+    T *pop() {
+        T *tail = _tail;
+        T *next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &_stub) {
+            if (!next) return nullptr;
+
+            _tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            _tail = next;
+            return tail;
+        }
+        if (tail != _head.load(std::memory_order_acquire)) {
+            // Producer is in the middle of a push
+            return nullptr;
+        }
+
+        // Tail is the last node: push the stub behind it, so that it can be
+        // detached
+        push(&_stub);
+
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            _tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @return true if the queue is empty, as seen by the consumer
+     */
+    bool empty() const {
+        return _tail == &_stub && !_stub.next.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<T *> _head;
+    T *_tail;
+    T _stub;
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+};
+
+} // namespace reone
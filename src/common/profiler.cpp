@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+
+#include <boost/format.hpp>
+
+#include "log.h"
+
+using namespace std;
+
+namespace reone {
+
+static const float kSmoothingFactor = 0.1f;
+
+atomic_bool Profiler::_enabled { true };
+thread_local Profiler::ThreadBuffer *Profiler::_threadBuffer = nullptr;
+
+static uint64_t getTimestamp() {
+    static const chrono::steady_clock::time_point epoch(chrono::steady_clock::now());
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+Profiler &Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::ThreadBuffer &Profiler::getThreadBuffer() {
+    if (!_threadBuffer) {
+        auto buffer = make_unique<ThreadBuffer>();
+        _threadBuffer = buffer.get();
+
+        lock_guard<mutex> lock(_threadsMutex);
+        buffer->id = static_cast<uint32_t>(_threads.size());
+        buffer->name = "Thread " + to_string(buffer->id);
+        _threads.push_back(move(buffer));
+    }
+    return *_threadBuffer;
+}
+
+void Profiler::setThreadName(const string &name) {
+    ThreadBuffer &buffer = getThreadBuffer();
+    if (buffer.name == name) return;
+
+    lock_guard<mutex> lock(_threadsMutex);
+    buffer.name = name;
+}
+
+void Profiler::endFrame() {
+    vector<Event> events;
+    {
+        lock_guard<mutex> lock(_threadsMutex);
+        lock_guard<mutex> zonesLock(_zonesMutex);
+
+        for (auto &zone : _zones) {
+            zone.second.frameTime = 0.0f;
+            zone.second.frameCalls = 0;
+        }
+        for (auto &buffer : _threads) {
+            uint64_t writeIndex = buffer->writeIndex.load(memory_order_acquire);
+            uint64_t readIndex = max(buffer->readIndex, writeIndex > kProfilerRingSize ? writeIndex - kProfilerRingSize : 0);
+
+            events.clear();
+            for (uint64_t i = readIndex; i < writeIndex; ++i) {
+                events.push_back(buffer->events[i & (kProfilerRingSize - 1)]);
+            }
+            buffer->readIndex = writeIndex;
+
+            // Events, overwritten by the recording thread while being copied, are
+            // discarded. The slot of the next event might be in the process of
+            // being written, hence the extra one.
+            uint64_t nextIndex = buffer->writeIndex.load(memory_order_acquire) + 1;
+            size_t firstValid = nextIndex > readIndex + kProfilerRingSize ? static_cast<size_t>(nextIndex - readIndex - kProfilerRingSize) : 0;
+
+            for (size_t i = firstValid; i < events.size(); ++i) {
+                const Event &event = events[i];
+
+                Zone &zone = _zones[make_tuple(buffer->id, event.parent, event.name)];
+                zone.depth = event.depth;
+                zone.frameTime += (event.end - event.start) / 1e6f;
+                ++zone.frameCalls;
+
+                if (_traceFramesLeft > 0) {
+                    TraceEvent traceEvent;
+                    traceEvent.thread = buffer->id;
+                    traceEvent.event = event;
+                    _trace.push_back(move(traceEvent));
+                }
+            }
+        }
+        for (auto &zone : _zones) {
+            zone.second.time += kSmoothingFactor * (zone.second.frameTime - zone.second.time);
+            zone.second.calls += kSmoothingFactor * (zone.second.frameCalls - zone.second.calls);
+        }
+    }
+
+    if (_traceFramesLeft > 0 && --_traceFramesLeft == 0) {
+        saveTrace();
+    }
+}
+
+void Profiler::startTrace(const string &path, int frameCount) {
+    _tracePath = path;
+    _traceFramesLeft = frameCount;
+    _trace.clear();
+}
+
+void Profiler::saveTrace() {
+    ofstream json(_tracePath);
+    if (!json) {
+        warn("Profiler: unable to open trace file: " + _tracePath);
+        return;
+    }
+    json << "{\"traceEvents\":[";
+
+    bool first = true;
+    auto separate = [&]() {
+        if (!first) json << ",";
+        json << "\n";
+        first = false;
+    };
+    {
+        lock_guard<mutex> lock(_threadsMutex);
+        for (auto &buffer : _threads) {
+            separate();
+            json << boost::format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}") % buffer->id % buffer->name;
+        }
+    }
+    for (auto &traceEvent : _trace) {
+        const Event &event = traceEvent.event;
+        separate();
+        json << boost::format("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}") %
+            event.name % traceEvent.thread % (event.start / 1e3) % ((event.end - event.start) / 1e3);
+    }
+    json << "\n]}\n";
+
+    info(boost::format("Profiler: saved %d zones to %s") % _trace.size() % _tracePath);
+    _trace.clear();
+}
+
+bool Profiler::isTracing() const {
+    return _traceFramesLeft > 0;
+}
+
+vector<ProfilerZoneStats> Profiler::getZoneStats() const {
+    vector<ProfilerZoneStats> result;
+
+    lock_guard<mutex> lock(_threadsMutex);
+    lock_guard<mutex> zonesLock(_zonesMutex);
+
+    for (auto &buffer : _threads) {
+        function<void(const char *)> appendChildren = [&](const char *parent) {
+            vector<pair<const char *, const Zone *>> children;
+            for (auto &zone : _zones) {
+                if (get<0>(zone.first) == buffer->id && get<1>(zone.first) == parent) {
+                    children.push_back(make_pair(get<2>(zone.first), &zone.second));
+                }
+            }
+            sort(children.begin(), children.end(), [](auto &left, auto &right) { return left.second->time > right.second->time; });
+
+            for (auto &child : children) {
+                ProfilerZoneStats stats;
+                stats.thread = buffer->name;
+                stats.name = child.first;
+                stats.depth = child.second->depth;
+                stats.time = child.second->time;
+                stats.calls = child.second->calls;
+                result.push_back(move(stats));
+
+                appendChildren(child.first);
+            }
+        };
+        appendChildren(nullptr);
+    }
+
+    return move(result);
+}
+
+ProfilerZone::ProfilerZone(const char *name) : _name(name) {
+    if (!Profiler::isEnabled()) return;
+
+    Profiler::ThreadBuffer &buffer = Profiler::instance().getThreadBuffer();
+    if (buffer.depth < kProfilerMaxDepth) {
+        buffer.zones[buffer.depth] = name;
+    }
+    ++buffer.depth;
+
+    _start = getTimestamp();
+    _active = true;
+}
+
+ProfilerZone::~ProfilerZone() {
+    if (!_active) return;
+
+    uint64_t end = getTimestamp();
+
+    Profiler::ThreadBuffer &buffer = *Profiler::_threadBuffer;
+    int depth = --buffer.depth;
+
+    uint64_t writeIndex = buffer.writeIndex.load(memory_order_relaxed);
+    Profiler::Event &event = buffer.events[writeIndex & (kProfilerRingSize - 1)];
+    event.name = _name;
+    event.parent = depth > 0 && depth <= kProfilerMaxDepth ? buffer.zones[depth - 1] : nullptr;
+    event.start = _start;
+    event.end = end;
+    event.depth = depth;
+
+    buffer.writeIndex.store(writeIndex + 1, memory_order_release);
+}
+
+} // namespace reone
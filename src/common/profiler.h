@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace reone {
+
+const int kProfilerRingSize = 8192; // events per thread, must be a power of two
+const int kProfilerMaxDepth = 32;
+
+/**
+ * Time spent in a zone, aggregated over a frame and smoothed over time.
+ */
+struct ProfilerZoneStats {
+    std::string thread;
+    std::string name;
+    int depth { 0 };
+    float time { 0.0f }; // milliseconds per frame
+    float calls { 0.0f }; // calls per frame
+};
+
+/**
+ * CPU profiler, based on scoped zones. Every thread records completed zones
+ * into its own ring buffer, without locks. Once per frame, the main thread
+ * drains all ring buffers, aggregating zones for the overlay and, while a
+ * trace is being captured, collecting them for export in the Chrome trace
+ * event format (chrome://tracing, Perfetto).
+ *
+ * Zones are declared using the PROFILE_ZONE macro, which compiles to nothing
+ * unless REONE_ENABLE_PROFILER is defined. Zone names must be string literals.
+ */
+class Profiler {
+public:
+    static Profiler &instance();
+
+    /**
+     * Names the calling thread in the overlay and in traces.
+     */
+    void setThreadName(const std::string &name);
+
+    /**
+     * Drains ring buffers of all threads. Must be called by the main thread
+     * once per frame.
+     */
+    void endFrame();
+
+    /**
+     * Starts capturing zones of the next frameCount frames. When done, the
+     * trace is written to the specified path.
+     */
+    void startTrace(const std::string &path, int frameCount);
+
+    bool isTracing() const;
+
+    /**
+     * @return zone statistics in hierarchical order: threads, then root
+     *         zones, each followed by its children
+     */
+    std::vector<ProfilerZoneStats> getZoneStats() const;
+
+    static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+private:
+    struct Event {
+        const char *name { nullptr };
+        const char *parent { nullptr };
+        uint64_t start { 0 };
+        uint64_t end { 0 };
+        int depth { 0 };
+    };
+
+    struct ThreadBuffer {
+        uint32_t id { 0 };
+        std::string name;
+        Event events[kProfilerRingSize];
+        std::atomic<uint64_t> writeIndex { 0 };
+        uint64_t readIndex { 0 }; // owned by the main thread
+
+        // Owned by the recording thread
+
+        const char *zones[kProfilerMaxDepth] { nullptr };
+        int depth { 0 };
+
+        // END Owned by the recording thread
+    };
+
+    struct TraceEvent {
+        uint32_t thread { 0 };
+        Event event;
+    };
+
+    typedef std::tuple<uint32_t, const char *, const char *> ZoneKey; // thread, parent, name
+
+    struct Zone {
+        int depth { 0 };
+        float time { 0.0f };
+        float calls { 0.0f };
+        float frameTime { 0.0f };
+        int frameCalls { 0 };
+    };
+
+    static std::atomic_bool _enabled;
+    static thread_local ThreadBuffer *_threadBuffer;
+
+    std::vector<std::unique_ptr<ThreadBuffer>> _threads;
+    mutable std::mutex _threadsMutex;
+    std::map<ZoneKey, Zone> _zones;
+    mutable std::mutex _zonesMutex;
+
+    // Tracing
+
+    std::string _tracePath;
+    int _traceFramesLeft { 0 };
+    std::vector<TraceEvent> _trace;
+
+    // END Tracing
+
+    Profiler() = default;
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+
+    ThreadBuffer &getThreadBuffer();
+    void saveTrace();
+
+    friend class ProfilerZone;
+};
+
+/**
+ * Records the time between its construction and destruction as a zone.
+ */
+class ProfilerZone {
+public:
+    ProfilerZone(const char *name);
+    ~ProfilerZone();
+
+private:
+    const char *_name;
+    uint64_t _start { 0 };
+    bool _active { false };
+};
+
+} // namespace reone
+
+#define REONE_PROFILER_CONCAT2(a, b) a##b
+#define REONE_PROFILER_CONCAT(a, b) REONE_PROFILER_CONCAT2(a, b)
+
+#ifdef REONE_ENABLE_PROFILER
+#define PROFILE_ZONE(name) ::reone::ProfilerZone REONE_PROFILER_CONCAT(profilerZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
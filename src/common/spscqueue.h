@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace reone {
+
+/**
+ * Bounded, lock-free, single producer, single consumer queue of values. One
+ * thread at a time may push and one thread at a time may pop. Capacity is
+ * rounded up to a power of two.
+ */
+template <class T>
+class SpscQueue {
+public:
+    SpscQueue(size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("capacity must not be zero");
+        }
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _slots.resize(size);
+        _mask = size - 1;
+    }
+
+    /**
+     * @return false if the queue is full
+     */
+    bool push(const T &value) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == _slots.size()) return false;
+
+        _slots[head & _mask] = value;
+        _head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @return false if the queue is empty
+     */
+    bool pop(T &value) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+
+        value = _slots[tail & _mask];
+        _tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool empty() const {
+        return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return _slots.size();
+    }
+
+private:
+    std::vector<T> _slots;
+    size_t _mask { 0 };
+
+    // Indices live on separate cache lines, so that the producer and the
+    // consumer do not invalidate each other's line on every operation
+    alignas(64) std::atomic<size_t> _head { 0 }; /**< next slot to write, owned by the producer */
+    alignas(64) std::atomic<size_t> _tail { 0 }; /**< next slot to read, owned by the consumer */
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+};
+
+} // namespace reone
@@ -39,6 +39,14 @@ void StreamWriter::putByte(uint8_t val) {
     _stream->put(val);
 }
 
+void StreamWriter::putUint16(uint16_t val) {
+    put(val);
+}
+
+void StreamWriter::putUint32(uint32_t val) {
+    put(val);
+}
+
 void StreamWriter::putInt64(int64_t val) {
     put(val);
 }
@@ -49,6 +57,10 @@ void StreamWriter::putCString(const string &str) {
     _stream->put('\0');
 }
 
+void StreamWriter::putString(const string &str) {
+    _stream->write(&str[0], str.length());
+}
+
 template <class T>
 void StreamWriter::put(T val) {
     fixEndianess(val);
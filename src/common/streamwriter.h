@@ -31,9 +31,16 @@ public:
     StreamWriter(const std::shared_ptr<std::ostream> &stream, Endianess endianess = Endianess::Little);
 
     void putByte(uint8_t val);
+    void putUint16(uint16_t val);
+    void putUint32(uint32_t val);
     void putInt64(int64_t val);
     void putCString(const std::string &str);
 
+    /**
+     * Writes the string without a terminating null character.
+     */
+    void putString(const std::string &str);
+
 private:
     std::shared_ptr<std::ostream> _stream;
     Endianess _endianess;
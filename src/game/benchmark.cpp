@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+
+#include "glm/ext.hpp"
+
+#include "../common/log.h"
+
+using namespace std;
+
+namespace fs = boost::filesystem;
+
+namespace reone {
+
+namespace game {
+
+static const float kPathRadius = 6.0f;
+static const float kPathHeight = 1.8f;
+static const float kPathPeriod = 20.0f; // seconds per orbit
+
+glm::vec3 getBenchmarkCameraPosition(const glm::vec3 &origin, float time, float &facing) {
+    float angle = glm::two_pi<float>() * glm::mod(time, kPathPeriod) / kPathPeriod;
+
+    // Forward direction of the first person camera is (-sin(facing), cos(facing))
+    facing = angle + glm::half_pi<float>();
+
+    return origin + glm::vec3(kPathRadius * glm::cos(angle), kPathRadius * glm::sin(angle), kPathHeight);
+}
+
+BenchmarkRecorder::BenchmarkRecorder(const BenchmarkOptions &opts) : _opts(opts) {
+    _frames.reserve(max(0, opts.frames));
+
+    if (!opts.captureDir.empty() && opts.captureInterval > 0) {
+        fs::create_directories(opts.captureDir);
+    }
+}
+
+void BenchmarkRecorder::record(const BenchmarkFrame &frame) {
+    _frames.push_back(frame);
+}
+
+void BenchmarkRecorder::save() const {
+    fs::ofstream csv(_opts.output);
+    if (!csv) {
+        throw runtime_error("Unable to open benchmark output: " + _opts.output);
+    }
+    csv << "frame,update_ms,prepare_ms,render_ms,total_ms" << endl;
+
+    vector<float> totals;
+    totals.reserve(_frames.size());
+
+    for (size_t i = 0; i < _frames.size(); ++i) {
+        const BenchmarkFrame &frame = _frames[i];
+        float total = frame.update + frame.prepare + frame.render;
+        csv << boost::format("%d,%.4f,%.4f,%.4f,%.4f") % i % frame.update % frame.prepare % frame.render % total << endl;
+        totals.push_back(total);
+    }
+    if (totals.empty()) return;
+
+    float mean = 0.0f;
+    for (float total : totals) {
+        mean += total;
+    }
+    mean /= totals.size();
+
+    sort(totals.begin(), totals.end());
+    float p99 = totals[min(totals.size() - 1, static_cast<size_t>(0.99f * totals.size()))];
+
+    info(boost::format("Benchmark: %d frames, mean %.3f ms, 99th percentile %.3f ms, max %.3f ms") % totals.size() % mean % p99 % totals.back());
+}
+
+bool BenchmarkRecorder::shouldCapture(int frame) const {
+    return !_opts.captureDir.empty() && _opts.captureInterval > 0 && frame % _opts.captureInterval == 0;
+}
+
+void BenchmarkRecorder::capture(int frame, int width, int height, const vector<uint8_t> &pixels) const {
+    fs::path path(_opts.captureDir);
+    path.append(str(boost::format("frame%05d.tga") % frame));
+
+    fs::ofstream tga(path, ios::binary);
+    if (!tga) {
+        throw runtime_error("Unable to open frame capture: " + path.string());
+    }
+
+    // Uncompressed true-color image, bottom-up rows, 8-bit alpha
+    uint8_t header[18] { 0 };
+    header[2] = 2;
+    header[12] = width & 0xff;
+    header[13] = (width >> 8) & 0xff;
+    header[14] = height & 0xff;
+    header[15] = (height >> 8) & 0xff;
+    header[16] = 32;
+    header[17] = 8;
+
+    tga.write(reinterpret_cast<const char *>(header), sizeof(header));
+    tga.write(reinterpret_cast<const char *>(&pixels[0]), pixels.size());
+}
+
+} // namespace game
+
+} // namespace reone
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "options.h"
+
+namespace reone {
+
+namespace game {
+
+/**
+ * CPU time spent in each phase of a single frame, in milliseconds.
+ */
+struct BenchmarkFrame {
+    float update { 0.0f };
+    float prepare { 0.0f };
+    float render { 0.0f };
+};
+
+/**
+ * Computes a point on the scripted camera path of the benchmark mode: a
+ * closed orbit around the origin, looking at its center.
+ *
+ * @param origin center of the orbit
+ * @param time time since the start of the benchmark, in seconds
+ * @param[out] facing camera facing in radians
+ * @return camera position
+ */
+glm::vec3 getBenchmarkCameraPosition(const glm::vec3 &origin, float time, float &facing);
+
+/**
+ * Accumulates frame timings of the benchmark mode and writes them to a CSV
+ * file, along with optional frame captures.
+ */
+class BenchmarkRecorder {
+public:
+    BenchmarkRecorder(const BenchmarkOptions &opts);
+
+    void record(const BenchmarkFrame &frame);
+
+    /**
+     * Writes recorded frames to the output CSV file and logs a summary.
+     */
+    void save() const;
+
+    bool shouldCapture(int frame) const;
+
+    /**
+     * Writes pixels of the specified frame to an uncompressed TGA file in the
+     * capture directory.
+     *
+     * @param pixels bottom-up BGRA rows
+     */
+    void capture(int frame, int width, int height, const std::vector<uint8_t> &pixels) const;
+
+private:
+    BenchmarkOptions _opts;
+    std::vector<BenchmarkFrame> _frames;
+};
+
+} // namespace game
+
+} // namespace reone
@@ -34,6 +34,8 @@ Blueprints &Blueprints::instance() {
 }
 
 void Blueprints::invalidateCache() {
+    lock_guard<mutex> lock(_cacheMutex);
+
     _creatureCache.clear();
     _doorCache.clear();
     _itemCache.clear();
@@ -48,11 +50,17 @@ shared_ptr<CreatureBlueprint> Blueprints::getCreature(const string &resRef) {
 
 template <class T>
 shared_ptr<T> Blueprints::get(const string &resRef, ResourceType type, unordered_map<string, shared_ptr<T>> &cache) {
-    auto maybeBlueprint = cache.find(resRef);
-    if (maybeBlueprint != cache.end()) {
-        return maybeBlueprint->second;
+    {
+        lock_guard<mutex> lock(_cacheMutex);
+        auto maybeBlueprint = cache.find(resRef);
+        if (maybeBlueprint != cache.end()) {
+            return maybeBlueprint->second;
+        }
     }
-    auto inserted = cache.insert(make_pair(resRef, doGet<T>(resRef, type)));
+    shared_ptr<T> blueprint(doGet<T>(resRef, type));
+
+    lock_guard<mutex> lock(_cacheMutex);
+    auto inserted = cache.insert(make_pair(resRef, move(blueprint)));
 
     return inserted.first->second;
 }
@@ -19,6 +19,7 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "../../resource/types.h"
@@ -34,6 +35,9 @@ namespace reone {
 
 namespace game {
 
+/**
+ * Cache of object blueprints. Thread-safe.
+ */
 class Blueprints {
 public:
     static Blueprints &instance();
@@ -54,6 +58,7 @@ private:
     std::unordered_map<std::string, std::shared_ptr<PlaceableBlueprint>> _placeableCache;
     std::unordered_map<std::string, std::shared_ptr<SoundBlueprint>> _soundCache;
     std::unordered_map<std::string, std::shared_ptr<TriggerBlueprint>> _triggerCache;
+    std::mutex _cacheMutex;
 
     Blueprints() = default;
     Blueprints(const Blueprints &) = delete;
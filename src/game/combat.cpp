@@ -23,6 +23,7 @@
 #include "glm/common.hpp"
 
 #include "../common/log.h"
+#include "../common/profiler.h"
 #include "../common/random.h"
 
 #include "game.h"
@@ -51,6 +52,8 @@ Combat::Combat(Game *game) : _game(game) {
 }
 
 void Combat::update(float dt) {
+    PROFILE_ZONE("Combat::update");
+
     _heartbeatTimer.update(dt);
 
     if (_heartbeatTimer.hasTimedOut()) {
@@ -25,11 +25,13 @@
 #include "glm/ext.hpp"
 
 #include "../common/log.h"
+#include "../common/profiler.h"
 
 #include "../render/font.h"
 #include "../render/fonts.h"
 #include "../render/mesh/quad.h"
 #include "../render/shaders.h"
+#include "../render/textures.h"
 #include "../resource/resources.h"
 
 #include "game.h"
@@ -63,6 +65,8 @@ void Console::initCommands() {
     addCommand("playanim", bind(&Console::cmdPlayAnim, this, _1));
     addCommand("kill", bind(&Console::cmdKill, this, _1));
     addCommand("additem", bind(&Console::cmdAddItem, this, _1));
+    addCommand("texmem", bind(&Console::cmdTexMem, this, _1));
+    addCommand("profile", bind(&Console::cmdProfile, this, _1));
 }
 
 void Console::addCommand(const std::string &name, const CommandHandler &handler) {
@@ -167,6 +171,34 @@ void Console::cmdAddItem(vector<string> tokens) {
     object->addItem(tokens[1], stackSize);
 }
 
+void Console::cmdTexMem(vector<string> tokens) {
+    int count = static_cast<int>(tokens.size()) > 1 ? stoi(tokens[1]) : 10;
+    vector<TextureMemoryUsage> report(Textures::instance().getMemoryReport());
+
+    print(str(boost::format("Resident: %d KB in %d textures") % (Textures::instance().getResidentBytes() / 1024) % report.size()));
+
+    for (int i = 0; i < count && i < static_cast<int>(report.size()); ++i) {
+        const TextureMemoryUsage &usage = report[i];
+        print(str(boost::format("%s %dx%d %d KB, %d mips dropped") % usage.name % usage.width % usage.height % (usage.bytes / 1024) % usage.droppedMipMapCount));
+    }
+}
+
+void Console::cmdProfile(vector<string> tokens) {
+    if (tokens.size() > 1 && tokens[1] == "trace") {
+        int frameCount = tokens.size() > 2 ? stoi(tokens[2]) : 300;
+        string path(tokens.size() > 3 ? tokens[3] : "trace.json");
+        Profiler::instance().startTrace(path, frameCount);
+        print(str(boost::format("Tracing %d frames into %s") % frameCount % path));
+        return;
+    }
+    if (tokens.size() > 1) {
+        print("Usage: profile [trace [frames] [path]]");
+        return;
+    }
+    DebugOverlay &overlay = _game->hud().debugOverlay();
+    overlay.setProfilerVisible(!overlay.isProfilerVisible());
+}
+
 void Console::print(const string &text) {
     _output.push_front(text);
     trimOutput();
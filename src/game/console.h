@@ -81,6 +81,8 @@ private:
     void cmdPlayAnim(std::vector<std::string> tokens);
     void cmdKill(std::vector<std::string> tokens);
     void cmdAddItem(std::vector<std::string> tokens);
+    void cmdTexMem(std::vector<std::string> tokens);
+    void cmdProfile(std::vector<std::string> tokens);
 
     // END Commands
 };
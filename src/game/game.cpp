@@ -17,6 +17,9 @@
 
 #include "game.h"
 
+#include <chrono>
+#include <thread>
+
 #include "SDL2/SDL_timer.h"
 
 #include "../audio/files.h"
@@ -30,10 +33,12 @@
 #include "../script/scripts.h"
 #include "../common/jobs.h"
 #include "../common/log.h"
+#include "../common/profiler.h"
 #include "../common/pathutil.h"
 #include "../video/bikfile.h"
 #include "../video/video.h"
 
+#include "benchmark.h"
 #include "blueprint/blueprints.h"
 #include "cursors.h"
 #include "script/routines.h"
@@ -54,6 +59,11 @@ namespace reone {
 
 namespace game {
 
+static const float kBenchmarkFrameTime = 1.0f / 60.0f;
+static const float kSimulationStep = 1.0f / 30.0f;
+static const int kMaxSimulationSteps = 5;
+static const uint32_t kLoadScreenRedrawInterval = 50; // ms
+
 Game::Game(const fs::path &path, const Options &opts) :
     _path(path),
     _options(opts),
@@ -76,31 +86,58 @@ void Game::initGameVersion() {
 
 int Game::run() {
     init();
+
+    if (isDedicatedServer()) {
+        runDedicatedServer();
+        deinit();
+        return 0;
+    }
     openMainMenu();
 
-    if (!_options.module.empty()) {
-        _mainMenu->onModuleSelected(_options.module);
+    if (isBenchmark()) {
+        _mainMenu->onModuleSelected(_options.benchmark.module);
+        runBenchmark();
     } else {
-        playVideo("legal");
-    }
-    _window.show();
+        if (!_options.module.empty()) {
+            _mainMenu->onModuleSelected(_options.module);
+        } else {
+            playVideo("legal");
+        }
+        _window.show();
 
-    runMainLoop();
+        runMainLoop();
+    }
     deinit();
 
     return 0;
 }
 
 void Game::init() {
-    _window.init();
-    _worldPipeline.init();
+    Profiler::instance().setThreadName("Main");
+
+    // Dedicated server only needs resources required by the simulation:
+    // neither a window, nor textures, nor audio
+
+    bool dedicated = isDedicatedServer();
+    if (!dedicated) {
+        _window.init();
+        _worldPipeline.init();
+    }
 
     Resources::instance().init(_version, _path);
+    Models::instance().init(_version, _options.modelCache, !dedicated);
+    Textures::instance().init(_version, !dedicated);
+    Routines::instance().init(_version, this);
+
+    if (dedicated) {
+        info("Game: running a dedicated server");
+        return;
+    }
+
     Cursors::instance().init(_version);
-    Models::instance().init(_version);
-    Textures::instance().init(_version);
+    _prefetcher.init(_version, static_cast<size_t>(_options.prefetchBudget) * 1024 * 1024);
+    Textures::instance().setMemoryBudget(static_cast<size_t>(_options.graphics.textureBudget) * 1024 * 1024);
     AudioPlayer::instance().init(_options.audio);
-    Routines::instance().init(_version, this);
 
     setCursorType(CursorType::Default);
 
@@ -184,6 +221,12 @@ void Game::loadMainMenu() {
 void Game::loadModule(const string &name, const string &entry) {
     info("Game: load module: " + name);
 
+    if (isDedicatedServer()) {
+        doLoadModule(name, entry);
+        openInGame();
+        return;
+    }
+
     withLoadingScreen([this, &name, &entry]() {
         if (!_hud) {
             loadHUD();
@@ -201,33 +244,7 @@ void Game::loadModule(const string &name, const string &entry) {
             loadPartySelection();
         }
 
-        Models::instance().invalidateCache();
-        Walkmeshes::instance().invalidateCache();
-        Textures::instance().invalidateCache();
-        AudioFiles::instance().invalidateCache();
-        Scripts::instance().invalidateCache();
-        Blueprints::instance().invalidateCache();
-        Resources::instance().loadModule(name);
-
-        if (_module) {
-            _module->area()->runOnExitScript();
-            _module->area()->unloadParty();
-        }
-
-        auto maybeModule = _loadedModules.find(name);
-        if (maybeModule != _loadedModules.end()) {
-            _module = maybeModule->second;
-        } else {
-            shared_ptr<GffStruct> ifo(Resources::instance().getGFF("module", ResourceType::ModuleInfo));
-
-            _module = _objectFactory->newModule();
-            _module->load(name, *ifo);
-
-            _loadedModules.insert(make_pair(name, _module));
-        }
-
-        _module->loadParty(entry);
-        _module->area()->fill(_sceneGraph);
+        doLoadModule(name, entry);
 
         string musicName(_module->area()->music());
         playMusic(musicName);
@@ -238,16 +255,78 @@ void Game::loadModule(const string &name, const string &entry) {
     });
 }
 
+void Game::doLoadModule(const string &name, const string &entry) {
+    _prefetcher.cancel();
+
+    Models::instance().invalidateCache();
+    Walkmeshes::instance().invalidateCache();
+    Textures::instance().invalidateCache();
+    AudioFiles::instance().invalidateCache();
+    Scripts::instance().invalidateCache();
+    Blueprints::instance().invalidateCache();
+    Resources::instance().loadModule(name);
+
+    if (_module) {
+        _module->area()->runOnExitScript();
+        _module->area()->unloadParty();
+    }
+
+    auto maybeModule = _loadedModules.find(name);
+    if (maybeModule != _loadedModules.end()) {
+        _module = maybeModule->second;
+    } else {
+        shared_ptr<GffStruct> ifo(Resources::instance().getGFF("module", ResourceType::ModuleInfo));
+
+        _module = _objectFactory->newModule();
+        _module->load(name, *ifo);
+
+        _loadedModules.insert(make_pair(name, _module));
+    }
+
+    _module->loadParty(entry);
+    _module->area()->fill(_sceneGraph);
+
+    _prefetcher.setModule(name, _module->getLinkedModules());
+}
+
 void Game::withLoadingScreen(const function<void()> &block) {
     if (!_loadScreen) {
         loadLoadingScreen();
     }
+    _loadScreen->setProgress(0);
     changeScreen(GameScreen::Loading);
+    prepareWorld();
     drawAll();
+    _window.swapBuffers();
+    _loadScreenTicks = SDL_GetTicks();
     block();
 }
 
+void Game::setLoadingProgress(float progress) {
+    if (_screen != GameScreen::Loading || !_loadScreen) return;
+
+    _loadScreen->setProgress(static_cast<int>(100.0f * progress));
+
+    // Presenting a frame may block until the vertical blank, therefore the
+    // loading screen is only redrawn every so often
+    uint32_t ticks = SDL_GetTicks();
+    if (ticks - _loadScreenTicks < kLoadScreenRedrawInterval) return;
+
+    _loadScreenTicks = ticks;
+
+    Shaders::instance().beginFrame();
+    Textures::instance().update();
+    _window.clear();
+    drawGUI();
+    Shaders::instance().endFrame();
+    _window.swapBuffers();
+}
+
 void Game::drawAll() {
+    PROFILE_ZONE("Game::drawAll");
+
+    Shaders::instance().beginFrame();
+    Textures::instance().update();
     _window.clear();
 
     if (_video) {
@@ -258,16 +337,25 @@ void Game::drawAll() {
         drawCursor();
     }
 
-    _window.swapBuffers();
+    Shaders::instance().endFrame();
 }
 
-void Game::drawWorld() {
+void Game::prepareWorld(bool pipelined) {
     const Camera *camera = getActiveCamera();
     if (!camera) return;
 
     _sceneGraph.setActiveCamera(camera->sceneNode());
     _sceneGraph.setReferenceNode(_party.leader()->model());
-    _sceneGraph.prepareFrame();
+
+    if (pipelined) {
+        _sceneGraph.beginPrepareFrame();
+    } else {
+        _sceneGraph.prepareFrame();
+    }
+}
+
+void Game::drawWorld() {
+    if (!getActiveCamera()) return;
 
     _worldPipeline.render();
 }
@@ -434,18 +522,145 @@ void Game::runMainLoop() {
     _ticks = SDL_GetTicks();
 
     while (!_quit) {
+        uint32_t frameStart = SDL_GetTicks();
+
         _window.processEvents(_quit);
 
+        // The world is rendered one frame behind the simulation: the frame
+        // captured here is prepared while the previous one is drawn and the
+        // next simulation step runs
+
         update();
+        _sceneGraph.endPrepareFrame();
+        prepareWorld(true);
         drawAll();
+        _window.swapBuffers();
+
+        Profiler::instance().endFrame();
+
+        limitFrameRate(frameStart);
+    }
+}
 
+void Game::limitFrameRate(uint32_t frameStart) {
+    int fpsLimit = _options.graphics.fpsLimit;
+    if (fpsLimit <= 0) {
         this_thread::yield();
+        return;
     }
+
+    uint32_t frameTicks = SDL_GetTicks() - frameStart;
+    uint32_t minFrameTicks = 1000 / fpsLimit;
+
+    if (frameTicks < minFrameTicks) {
+        SDL_Delay(minFrameTicks - frameTicks);
+    }
+}
+
+void Game::runBenchmark() {
+    const BenchmarkOptions &opts = _options.benchmark;
+    if (!_module) {
+        throw runtime_error("Benchmark module not loaded: " + opts.module);
+    }
+    info(boost::format("Game: benchmark module %s for %d frames") % opts.module % opts.frames);
+
+    BenchmarkRecorder recorder(opts);
+    vector<uint8_t> pixels;
+
+    setCursorType(CursorType::None);
+    _cameraType = CameraType::FirstPerson;
+    FirstPersonCamera &camera = static_cast<FirstPersonCamera &>(_module->area()->getCamera(CameraType::FirstPerson));
+    glm::vec3 origin(_party.leader()->position());
+
+    for (int frame = 0; frame < opts.frames && !_quit; ++frame) {
+        _window.processEvents(_quit);
+
+        float facing = 0.0f;
+        camera.setPosition(getBenchmarkCameraPosition(origin, frame * kBenchmarkFrameTime, facing));
+        camera.setFacing(facing);
+
+        auto start = chrono::steady_clock::now();
+        update();
+        auto updated = chrono::steady_clock::now();
+        prepareWorld();
+        auto prepared = chrono::steady_clock::now();
+        drawAll();
+        _window.finish();
+        auto rendered = chrono::steady_clock::now();
+
+        BenchmarkFrame timings;
+        timings.update = chrono::duration<float, milli>(updated - start).count();
+        timings.prepare = chrono::duration<float, milli>(prepared - updated).count();
+        timings.render = chrono::duration<float, milli>(rendered - prepared).count();
+        recorder.record(timings);
+
+        if (recorder.shouldCapture(frame)) {
+            _window.readPixels(pixels);
+            recorder.capture(frame, _options.graphics.width, _options.graphics.height, pixels);
+        }
+        _window.swapBuffers();
+
+        Profiler::instance().endFrame();
+    }
+
+    recorder.save();
+}
+
+bool Game::isBenchmark() const {
+    return !_options.benchmark.module.empty();
+}
+
+void Game::runDedicatedServer() {
+    if (_options.module.empty()) {
+        throw runtime_error("Dedicated server requires a module");
+    }
+    loadModule(_options.module, "");
+
+    info(boost::format("Game: dedicated server ticking at %d Hz") % static_cast<int>(1.0f / kSimulationStep));
+
+    auto tickDuration = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<float>(kSimulationStep));
+    auto nextTick = chrono::steady_clock::now();
+
+    while (!_quit) {
+        update();
+
+        Profiler::instance().endFrame();
+
+        // When a tick takes too long, the simulation slows down, rather than
+        // running several ticks back to back
+        nextTick += tickDuration;
+        auto now = chrono::steady_clock::now();
+        if (nextTick < now) {
+            nextTick = now;
+        } else {
+            this_thread::sleep_until(nextTick);
+        }
+    }
+}
+
+bool Game::isDedicatedServer() const {
+    return _options.network.dedicated;
 }
 
 void Game::update() {
+    PROFILE_ZONE("Game::update");
+
     float dt = measureFrameTime();
 
+    if (isDedicatedServer()) {
+        if (!_nextModule.empty()) {
+            loadNextModule();
+        }
+        if (_module) {
+            _module->update(dt);
+
+            // Animations must advance on the server too: creatures wait for
+            // fire-and-forget animations to finish before playing the next
+            // one, and their animation state is replicated to clients
+            _module->updateScene(dt, 1.0f);
+        }
+        return;
+    }
     if (_video) {
         updateVideo(dt);
     } else {
@@ -458,8 +673,10 @@ void Game::update() {
 
     bool updModule = !_video && _module && (_screen == GameScreen::InGame || _screen == GameScreen::Dialog);
     if (updModule) {
-        _module->update(dt);
+        updateSimulation(dt);
     }
+    _prefetcher.update(dt, isPlayerIdle());
+    _inputReceived = false;
 
     GUI *gui = getScreenGUI();
     if (gui) {
@@ -469,6 +686,37 @@ void Game::update() {
     _window.update(dt);
 }
 
+bool Game::isPlayerIdle() const {
+    if (_video || _inputReceived || !_module || _screen != GameScreen::InGame) return false;
+
+    shared_ptr<Creature> leader(_party.leader());
+    if (!leader) return false;
+
+    return
+        leader->actionQueue().empty() &&
+        leader->movementType() == Creature::MovementType::None &&
+        !leader->isInCombat() &&
+        !_module->area()->combat().isActive();
+}
+
+void Game::updateSimulation(float dt) {
+    _simulationTime += dt;
+
+    int steps = 0;
+    while (_simulationTime >= kSimulationStep) {
+        if (steps == kMaxSimulationSteps) {
+            // Drop steps we cannot catch up with, rather than slowing down further
+            _simulationTime = glm::mod(_simulationTime, kSimulationStep);
+            break;
+        }
+        _module->update(kSimulationStep);
+        _simulationTime -= kSimulationStep;
+        ++steps;
+    }
+
+    _module->updateScene(dt, _simulationTime / kSimulationStep);
+}
+
 void Game::updateVideo(float dt) {
     _video->update(dt);
 
@@ -500,6 +748,13 @@ void Game::loadNextModule() {
 }
 
 float Game::measureFrameTime() {
+    // Benchmark frames advance the simulation by a fixed step, so that every
+    // run renders exactly the same frames
+    if (isBenchmark()) return kBenchmarkFrameTime * _gameSpeed;
+
+    // Dedicated server advances the simulation once per tick
+    if (isDedicatedServer()) return kSimulationStep * _gameSpeed;
+
     uint32_t ticks = SDL_GetTicks();
     float dt = (ticks - _ticks) / 1000.0f;
     _ticks = ticks;
@@ -518,13 +773,17 @@ void Game::loadCharacterGeneration() {
 }
 
 void Game::deinit() {
+    _prefetcher.cancel();
     JobExecutor::instance().deinit();
     Routines::instance().deinit();
     AudioPlayer::instance().deinit();
     Cursors::instance().deinit();
+    Textures::instance().deinit();
     Resources::instance().deinit();
 
-    _window.deinit();
+    if (!isDedicatedServer()) {
+        _window.deinit();
+    }
 }
 
 void Game::startCharacterGeneration() {
@@ -588,6 +847,10 @@ void Game::openInGameMenu(InGameMenu::Tab tab) {
 }
 
 void Game::startDialog(const shared_ptr<SpatialObject> &owner, const string &resRef) {
+    if (isDedicatedServer()) {
+        debug("Game: dialog is not supported by a dedicated server: " + resRef);
+        return;
+    }
     stopMovement();
     setCursorType(CursorType::Default);
     changeScreen(GameScreen::Dialog);
@@ -600,12 +863,16 @@ void Game::stopMovement() {
 }
 
 void Game::openContainer(const shared_ptr<SpatialObject> &container) {
+    if (isDedicatedServer()) return;
+
     setCursorType(CursorType::Default);
     _container->open(container);
     changeScreen(GameScreen::Container);
 }
 
 void Game::openPartySelection(const PartySelection::Context &ctx) {
+    if (isDedicatedServer()) return;
+
     stopMovement();
     setCursorType(CursorType::Default);
     _partySelect->prepare(ctx);
@@ -652,6 +919,18 @@ void Game::updateCamera(float dt) {
 }
 
 bool Game::handle(const SDL_Event &event) {
+    switch (event.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+            _inputReceived = true;
+            break;
+        default:
+            break;
+    }
     if (!_video) {
         GUI *gui = getScreenGUI();
         if (gui && gui->handle(event)) {
@@ -757,6 +1036,10 @@ CharacterGeneration &Game::characterGeneration() {
     return *_charGen;
 }
 
+HUD &Game::hud() {
+    return *_hud;
+}
+
 CameraType Game::cameraType() const {
     return _cameraType;
 }
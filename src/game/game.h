@@ -45,6 +45,7 @@
 #include "object/spatial.h"
 #include "options.h"
 #include "party.h"
+#include "prefetcher.h"
 #include "script/runner.h"
 #include "types.h"
 
@@ -107,11 +108,20 @@ public:
     std::shared_ptr<Module> module() const;
     Party &party();
     CharacterGeneration &characterGeneration();
+    HUD &hud();
     CameraType cameraType() const;
     ScriptRunner &scriptRunner();
 
     void setCursorType(CursorType type);
     void setLoadFromSaveGame(bool load);
+
+    /**
+     * Updates the progress bar of the loading screen and redraws it, unless
+     * it was redrawn recently. Does nothing unless the loading screen is open.
+     *
+     * @param progress completed fraction of loading
+     */
+    void setLoadingProgress(float progress);
     void setRunScriptVar(int var);
 
     // Globals/locals
@@ -166,6 +176,7 @@ private:
     std::shared_ptr<video::Video> _video;
     CursorType _cursorType { CursorType::None };
     float _gameSpeed { 1.0f };
+    float _simulationTime { 0.0f }; // not yet simulated time, less than a step
     bool _loadFromSaveGame { false };
     CameraType _cameraType { CameraType::ThirdPerson };
     int _runScriptVar { -1 };
@@ -177,6 +188,8 @@ private:
     std::string _nextEntry;
     std::shared_ptr<Module> _module;
     std::map<std::string, std::shared_ptr<Module>> _loadedModules;
+    ModulePrefetcher _prefetcher;
+    bool _inputReceived { false }; // since the last frame
 
     // END Modules
 
@@ -184,6 +197,7 @@ private:
 
     std::unique_ptr<MainMenu> _mainMenu;
     std::unique_ptr<LoadingScreen> _loadScreen;
+    uint32_t _loadScreenTicks { 0 }; // time of the last loading screen redraw
     std::unique_ptr<CharacterGeneration> _charGen;
     std::unique_ptr<HUD> _hud;
     std::unique_ptr<InGameMenu> _inGame;
@@ -219,13 +233,18 @@ private:
     bool handleMouseButtonDown(const SDL_MouseButtonEvent &event);
     bool handleKeyDown(const SDL_KeyboardEvent &event);
     void loadNextModule();
+    void doLoadModule(const std::string &name, const std::string &entry);
     float measureFrameTime();
     void playMusic(const std::string &resRef);
     void runMainLoop();
+    void runBenchmark();
+    void runDedicatedServer();
+    void limitFrameRate(uint32_t frameStart);
     void toggleInGameCameraType();
     void updateCamera(float dt);
     void stopMovement();
     void changeScreen(GameScreen screen);
+    void updateSimulation(float dt);
     void updateVideo(float dt);
     void updateMusic();
 
@@ -233,6 +252,15 @@ private:
     std::string getCharacterGenerationMusic() const;
     gui::GUI *getScreenGUI() const;
 
+    bool isBenchmark() const;
+    bool isDedicatedServer() const;
+
+    /**
+     * @return true if there was no input since the last frame, and the party
+     *         leader is neither acting, nor moving, nor fighting
+     */
+    bool isPlayerIdle() const;
+
     // Initialization
 
     void initGameVersion();
@@ -256,6 +284,11 @@ private:
 
     // Rendering
 
+    /**
+     * @param pipelined if true, prepare the frame on the frame preparation
+     *                  thread, to be rendered on the next iteration
+     */
+    void prepareWorld(bool pipelined = false);
     void drawAll();
     void drawWorld();
     void drawGUI();
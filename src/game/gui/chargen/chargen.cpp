@@ -150,7 +150,7 @@ void CharacterGeneration::finish() {
     CreatureConfiguration config(_character);
     config.equipment.clear();
 
-    shared_ptr<Creature> player(_game->objectFactory().newCreature());
+    shared_ptr<Creature> player(_game->objectFactory().newPartyMember());
     player->load(config);
     player->setTag("PLAYER");
     player->setFaction(Faction::Friendly1);
@@ -17,8 +17,12 @@
 
 #include "debugoverlay.h"
 
+#include <boost/format.hpp>
+
+#include "../../common/profiler.h"
 #include "../../resource/resources.h"
 #include "../../render/fonts.h"
+#include "../../render/spritebatch.h"
 
 #include "../types.h"
 
@@ -44,6 +48,8 @@ void DebugOverlay::render() const {
     glm::mat4 transform;
     glm::vec3 red(1.0f, 0.0f, 0.0f);
 
+    SpriteBatch::instance().begin();
+
     for (auto &object : _objects) {
         if (object.screenCoords.z >= 1.0f) continue;
 
@@ -52,6 +58,46 @@ void DebugOverlay::render() const {
 
         _font->render(object.tag, transform, red);
     }
+
+    if (_profilerVisible) {
+        renderProfiler();
+    }
+
+    SpriteBatch::instance().end();
+}
+
+void DebugOverlay::renderProfiler() const {
+    glm::vec3 white(1.0f);
+    glm::vec3 yellow(1.0f, 1.0f, 0.0f);
+
+    glm::mat4 transform(1.0f);
+    transform = glm::translate(transform, glm::vec3(3.0f, 0.5f * _font->height(), 0.0f));
+
+    string thread;
+    float y = 0.0f;
+
+    for (auto &zone : Profiler::instance().getZoneStats()) {
+        if (y + 2.0f * _font->height() > _opts.height) break;
+
+        if (zone.thread != thread) {
+            _font->render(zone.thread, transform, yellow, TextGravity::Right);
+            transform = glm::translate(transform, glm::vec3(0.0f, _font->height(), 0.0f));
+            y += _font->height();
+            thread = zone.thread;
+        }
+        string text(str(boost::format("%s%s %.2f ms x%.0f") % string(2 * (zone.depth + 1), ' ') % zone.name % zone.time % zone.calls));
+        _font->render(text, transform, white, TextGravity::Right);
+        transform = glm::translate(transform, glm::vec3(0.0f, _font->height(), 0.0f));
+        y += _font->height();
+    }
+}
+
+bool DebugOverlay::isProfilerVisible() const {
+    return _profilerVisible;
+}
+
+void DebugOverlay::setProfilerVisible(bool visible) {
+    _profilerVisible = visible;
 }
 
 } // namespace game
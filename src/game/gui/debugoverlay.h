@@ -35,6 +35,10 @@ public:
 
     void render() const;
 
+    bool isProfilerVisible() const;
+
+    void setProfilerVisible(bool visible);
+
 private:
     struct DebugObject {
         std::string tag;
@@ -45,6 +49,9 @@ private:
     render::GraphicsOptions _opts;
     std::shared_ptr<render::Font> _font;
     std::vector<DebugObject> _objects;
+    bool _profilerVisible { false };
+
+    void renderProfiler() const;
 };
 
 } // namespace game
@@ -191,6 +191,10 @@ void HUD::update(float dt) {
     _select.update();
 }
 
+DebugOverlay &HUD::debugOverlay() {
+    return _debug;
+}
+
 void HUD::render() const {
     GUI::render();
 
@@ -39,6 +39,8 @@ public:
     void update(float dt) override;
     void render() const override;
 
+    DebugOverlay &debugOverlay();
+
 private:
     Game *_game { nullptr };
     SelectionOverlay _select;
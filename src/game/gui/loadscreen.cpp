@@ -17,6 +17,7 @@
 
 #include "loadscreen.h"
 
+#include "../../gui/control/progressbar.h"
 #include "../../resource/resources.h"
 
 using namespace std;
@@ -49,6 +50,12 @@ void LoadingScreen::load() {
     setControlText("LBL_HINT", "");
 }
 
+void LoadingScreen::setProgress(int progress) {
+    configureControl("PB_PROGRESS", [&progress](Control &ctrl) {
+        static_cast<ProgressBar &>(ctrl).setValue(progress);
+    });
+}
+
 } // namespace game
 
 } // namespace reone
@@ -28,6 +28,11 @@ public:
     LoadingScreen(resource::GameVersion version, const render::GraphicsOptions &opts);
 
     void load() override;
+
+    /**
+     * @param progress loading progress in percents
+     */
+    void setProgress(int progress);
 };
 
 } // namespace game
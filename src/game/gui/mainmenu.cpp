@@ -206,7 +206,7 @@ void MainMenu::onModuleSelected(const string &name) {
 
     Party &party = _game->party();
 
-    shared_ptr<Creature> player(_game->objectFactory().newCreature());
+    shared_ptr<Creature> player(_game->objectFactory().newPartyMember());
     player->load(playerCfg);
     player->setTag("PLAYER");
     player->setFaction(Faction::Friendly1);
@@ -214,7 +214,7 @@ void MainMenu::onModuleSelected(const string &name) {
     party.addMember(player);
     party.setPlayer(player);
 
-    shared_ptr<Creature> companion(_game->objectFactory().newCreature());
+    shared_ptr<Creature> companion(_game->objectFactory().newPartyMember());
     companion->load(companionCfg);
     companion->setFaction(Faction::Friendly1);
     companion->setImmortal(true);
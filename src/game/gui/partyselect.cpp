@@ -222,7 +222,7 @@ void PartySelection::changeParty() {
         string blueprintResRef(party.getAvailableMember(i));
         shared_ptr<CreatureBlueprint> blueprint(Blueprints::instance().getCreature(blueprintResRef));
 
-        shared_ptr<Creature> creature(_game->objectFactory().newCreature());
+        shared_ptr<Creature> creature(_game->objectFactory().newPartyMember());
         creature->load(blueprint);
         creature->setFaction(Faction::Friendly1);
         creature->setImmortal(true);
@@ -20,11 +20,14 @@
 #include <algorithm>
 #include <sstream>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
 
 #include "glm/gtx/norm.hpp"
 
+#include "../../common/jobgraph.h"
 #include "../../common/log.h"
+#include "../../common/profiler.h"
 #include "../../common/streamutil.h"
 #include "../../render/models.h"
 #include "../../render/walkmeshes.h"
@@ -33,6 +36,7 @@
 #include "../../resource/resources.h"
 #include "../../scene/node/cubenode.h"
 
+#include "../blueprint/blueprints.h"
 #include "../blueprint/trigger.h"
 #include "../blueprint/sound.h"
 #include "../game.h"
@@ -76,48 +80,66 @@ Area::Area(uint32_t id, Game *game) :
 }
 
 void Area::load(const string &name, const GffStruct &are, const GffStruct &git) {
+    PROFILE_ZONE("Area::load");
+
     _name = name;
 
-    loadLYT();
-    loadVIS();
-    loadPTH();
-    loadARE(are);
-    loadGIT(git);
-}
+    // Files are read, and models and blueprints are decoded on worker threads.
+    // Rooms and objects are added to the area on the main thread, in the same
+    // order as they would be added by a serial load.
 
-void Area::loadLYT() {
     LytFile lyt;
     lyt.load(wrap(Resources::instance().get(_name, ResourceType::AreaLayout)));
 
+    VisFile vis;
+    shared_ptr<GffStruct> pth;
+
+    JobGraph graph;
+    int visJob = graph.add([this, &vis]() { vis.load(wrap(Resources::instance().get(_name, ResourceType::Vis))); });
+    int pthJob = graph.add([this, &pth]() { pth = Resources::instance().getGFF(_name, ResourceType::Path); });
+
+    loadLYT(lyt, graph);
+    graph.add([this, &vis]() { loadVIS(vis); }, { visJob }, true);
+    graph.add([this, &pth]() { loadPTH(*pth); }, { pthJob }, true);
+    graph.add([this, &are]() { loadARE(are); }, { }, true);
+    loadGIT(git, graph);
+
+    graph.run([this](int completed, int total) {
+        _game->setLoadingProgress(completed / static_cast<float>(total));
+    });
+}
+
+void Area::loadLYT(const LytFile &lyt, JobGraph &graph) {
     for (auto &lytRoom : lyt.rooms()) {
-        shared_ptr<Model> model(Models::instance().get(lytRoom.name));
-        if (!model) continue;
+        int decodeJob = graph.add([&lytRoom]() {
+            Models::instance().preload(lytRoom.name);
+            Walkmeshes::instance().get(lytRoom.name, ResourceType::Walkmesh);
+        });
+        graph.add([this, &lytRoom]() {
+            shared_ptr<Model> model(Models::instance().get(lytRoom.name));
+            if (!model) return;
 
-        glm::vec3 position(lytRoom.position.x, lytRoom.position.y, lytRoom.position.z);
+            glm::vec3 position(lytRoom.position.x, lytRoom.position.y, lytRoom.position.z);
 
-        shared_ptr<ModelSceneNode> sceneNode(new ModelSceneNode(&_game->sceneGraph(), model));
-        sceneNode->setLocalTransform(glm::translate(glm::mat4(1.0f), position));
-        sceneNode->playAnimation("animloop1", kAnimationLoop);
+            shared_ptr<ModelSceneNode> sceneNode(new ModelSceneNode(&_game->sceneGraph(), model));
+            sceneNode->setLocalTransform(glm::translate(glm::mat4(1.0f), position));
+            sceneNode->playAnimation("animloop1", kAnimationLoop);
 
-        shared_ptr<Walkmesh> walkmesh(Walkmeshes::instance().get(lytRoom.name, ResourceType::Walkmesh));
-        unique_ptr<Room> room(new Room(lytRoom.name, position, sceneNode, walkmesh));
+            shared_ptr<Walkmesh> walkmesh(Walkmeshes::instance().get(lytRoom.name, ResourceType::Walkmesh));
+            unique_ptr<Room> room(new Room(lytRoom.name, position, sceneNode, walkmesh));
 
-        _rooms.insert(make_pair(room->name(), move(room)));
+            _rooms.insert(make_pair(room->name(), move(room)));
+        }, { decodeJob }, true);
     }
 }
 
-void Area::loadVIS() {
-    VisFile vis;
-    vis.load(wrap(Resources::instance().get(_name, ResourceType::Vis)));
-
+void Area::loadVIS(const VisFile &vis) {
     _visibility = make_unique<Visibility>(vis.visibility());
 }
 
-void Area::loadPTH() {
-    shared_ptr<GffStruct> pth(Resources::instance().getGFF(_name, ResourceType::Path));
-
+void Area::loadPTH(const GffStruct &pth) {
     Path path;
-    path.load(*pth);
+    path.load(pth);
 
     const vector<Path::Point> &points = path.points();
     unordered_map<int, float> pointZ;
@@ -188,15 +210,17 @@ void Area::loadStealthXP(const GffStruct &are) {
     _maxStealthXP = are.getInt("StealthXPMax");
 }
 
-void Area::loadGIT(const GffStruct &git) {
-    loadProperties(git);
-    loadCreatures(git);
-    loadDoors(git);
-    loadPlaceables(git);
-    loadWaypoints(git);
-    loadTriggers(git);
-    loadSounds(git);
-    loadCameras(git);
+void Area::loadGIT(const GffStruct &git, JobGraph &graph) {
+    graph.add([this, &git]() { loadProperties(git); }, { }, true);
+    loadCreatures(git, graph);
+    loadDoors(git, graph);
+    loadPlaceables(git, graph);
+    graph.add([this, &git]() {
+        loadWaypoints(git);
+        loadTriggers(git);
+        loadSounds(git);
+        loadCameras(git);
+    }, { }, true);
 }
 
 void Area::loadProperties(const GffStruct &git) {
@@ -208,28 +232,97 @@ void Area::loadProperties(const GffStruct &git) {
     }
 }
 
-void Area::loadCreatures(const GffStruct &git) {
+/**
+ * Decodes blueprints of a creature and its items, and models, that do not
+ * depend on its equipment. Thread-safe.
+ */
+static void preloadCreature(const GffStruct &gffs) {
+    string resRef(boost::to_lower_copy(gffs.getString("TemplateResRef")));
+    if (!Blueprints::instance().getCreature(resRef)) return;
+
+    shared_ptr<GffStruct> utc(Resources::instance().getGFF(resRef, ResourceType::CreatureBlueprint));
+    for (auto &item : utc->getList("Equip_ItemList")) {
+        Blueprints::instance().getItem(boost::to_lower_copy(item->getString("EquippedRes")));
+    }
+    for (auto &item : utc->getList("ItemList")) {
+        Blueprints::instance().getItem(boost::to_lower_copy(item->getString("InventoryRes")));
+    }
+
+    shared_ptr<TwoDaTable> appearance(Resources::instance().get2DA("appearance"));
+    int appearanceIdx = utc->getInt("Appearance_Type");
+
+    if (appearance->getString(appearanceIdx, "modeltype") == "B") {
+        int headIdx = appearance->getInt(appearanceIdx, "normalhead", -1);
+        if (headIdx != -1) {
+            shared_ptr<TwoDaTable> heads(Resources::instance().get2DA("heads"));
+            Models::instance().preload(boost::to_lower_copy(heads->getString(headIdx, "head")));
+        }
+    } else {
+        Models::instance().preload(boost::to_lower_copy(appearance->getString(appearanceIdx, "race")));
+    }
+}
+
+void Area::loadCreatures(const GffStruct &git, JobGraph &graph) {
     for (auto &gffs : git.getList("Creature List")) {
-        shared_ptr<Creature> creature(_game->objectFactory().newCreature());
-        creature->load(*gffs);
-        landObject(*creature);
-        add(creature);
+        int preloadJob = graph.add([gffs]() { preloadCreature(*gffs); });
+        graph.add([this, gffs]() {
+            shared_ptr<Creature> creature(_game->objectFactory().newCreature());
+            creature->load(*gffs);
+            landObject(*creature);
+            add(creature);
+        }, { preloadJob }, true);
     }
 }
 
-void Area::loadDoors(const GffStruct &git) {
+/**
+ * Decodes a door blueprint, model and walkmesh. Thread-safe.
+ */
+static void preloadDoor(const GffStruct &gffs) {
+    string resRef(boost::to_lower_copy(gffs.getString("TemplateResRef")));
+    if (!Blueprints::instance().getDoor(resRef)) return;
+
+    shared_ptr<GffStruct> utd(Resources::instance().getGFF(resRef, ResourceType::DoorBlueprint));
+    shared_ptr<TwoDaTable> table(Resources::instance().get2DA("genericdoors"));
+    string modelName(boost::to_lower_copy(table->getString(utd->getInt("GenericType"), "modelname")));
+
+    Models::instance().preload(modelName);
+    Walkmeshes::instance().get(modelName + "0", ResourceType::DoorWalkmesh);
+}
+
+void Area::loadDoors(const GffStruct &git, JobGraph &graph) {
     for (auto &gffs : git.getList("Door List")) {
-        shared_ptr<Door> door(_game->objectFactory().newDoor());
-        door->load(*gffs);
-        add(door);
+        int preloadJob = graph.add([gffs]() { preloadDoor(*gffs); });
+        graph.add([this, gffs]() {
+            shared_ptr<Door> door(_game->objectFactory().newDoor());
+            door->load(*gffs);
+            add(door);
+        }, { preloadJob }, true);
     }
 }
 
-void Area::loadPlaceables(const GffStruct &git) {
+/**
+ * Decodes a placeable blueprint, model and walkmesh. Thread-safe.
+ */
+static void preloadPlaceable(const GffStruct &gffs) {
+    string resRef(boost::to_lower_copy(gffs.getString("TemplateResRef")));
+    if (!Blueprints::instance().getPlaceable(resRef)) return;
+
+    shared_ptr<GffStruct> utp(Resources::instance().getGFF(resRef, ResourceType::PlaceableBlueprint));
+    shared_ptr<TwoDaTable> table(Resources::instance().get2DA("placeables"));
+    string modelName(boost::to_lower_copy(table->getString(utp->getInt("Appearance"), "modelname")));
+
+    Models::instance().preload(modelName);
+    Walkmeshes::instance().get(modelName, ResourceType::PlaceableWalkmesh);
+}
+
+void Area::loadPlaceables(const GffStruct &git, JobGraph &graph) {
     for (auto &gffs : git.getList("Placeable List")) {
-        shared_ptr<Placeable> placeable(_game->objectFactory().newPlaceable());
-        placeable->load(*gffs);
-        add(placeable);
+        int preloadJob = graph.add([gffs]() { preloadPlaceable(*gffs); });
+        graph.add([this, gffs]() {
+            shared_ptr<Placeable> placeable(_game->objectFactory().newPlaceable());
+            placeable->load(*gffs);
+            add(placeable);
+        }, { preloadJob }, true);
     }
 }
 
@@ -538,15 +631,14 @@ bool Area::getElevationAt(const glm::vec2 &position, const SpatialObject *except
 }
 
 void Area::update(float dt) {
+    PROFILE_ZONE("Area::update");
+
     doDestroyObjects();
 
     Object::update(dt);
 
     _actionExecutor.executeActions(_game->module()->area(), dt);
 
-    for (auto &room : _rooms) {
-        room.second->update(dt);
-    }
     updateVisibility();
     updateSounds();
 
@@ -562,6 +654,22 @@ void Area::update(float dt) {
     updateHeartbeat(dt);
 }
 
+void Area::snapshotTransforms() {
+    for (auto &object : _objects) {
+        object->snapshotTransform();
+    }
+}
+
+void Area::updateScene(float dt, float alpha) {
+    for (auto &room : _rooms) {
+        room.second->update(dt);
+    }
+    for (auto &object : _objects) {
+        object->updateScene(dt, alpha);
+    }
+    update3rdPersonCameraTarget();
+}
+
 bool Area::moveCreatureTowards(const shared_ptr<Creature> &creature, const glm::vec2 &dest, bool run, float dt) {
     glm::vec3 position(creature->position());
     glm::vec2 delta(dest - glm::vec2(position));
@@ -703,12 +811,14 @@ void Area::update3rdPersonCameraTarget() {
     shared_ptr<SpatialObject> partyLeader(_game->party().leader());
     if (!partyLeader) return;
 
+    // Follow the model rather than the object, as the model is interpolated
+    glm::vec3 leaderPosition(partyLeader->model()->absoluteTransform()[3]);
     glm::vec3 position;
 
     if (partyLeader->model()->getNodeAbsolutePosition("camerahook", position)) {
-        position += partyLeader->position();
+        position += leaderPosition;
     } else {
-        position = partyLeader->position();
+        position = leaderPosition;
     }
     _thirdPersonCamera->setTargetPosition(position);
 }
@@ -848,6 +958,10 @@ const RoomMap &Area::rooms() const {
     return _rooms;
 }
 
+const Visibility &Area::visibility() const {
+    return *_visibility;
+}
+
 Combat &Area::combat() {
     return _combat;
 }
@@ -47,6 +47,15 @@
 
 namespace reone {
 
+class JobGraph;
+
+namespace resource {
+
+class LytFile;
+class VisFile;
+
+}
+
 namespace scene {
 
 class SceneGraph;
@@ -71,6 +80,19 @@ public:
     bool handle(const SDL_Event &event);
     void update(float dt);
 
+    /**
+     * Prepares objects for the next simulation step.
+     */
+    void snapshotTransforms();
+
+    /**
+     * Interpolates object transforms and advances model animation. Called
+     * once per rendered frame.
+     *
+     * @param alpha fraction of the simulation step, elapsed since the last one
+     */
+    void updateScene(float dt, float alpha);
+
     void destroyObject(const SpatialObject &object);
     void fill(scene::SceneGraph &sceneGraph);
     void initCameras(const glm::vec3 &entryPosition, float entryFacing);
@@ -92,6 +114,7 @@ public:
     ObjectSelector &objectSelector();
     const Pathfinder &pathfinder() const;
     const RoomMap &rooms() const;
+    const resource::Visibility &visibility() const;
     Combat &combat();
     Map &map();
 
@@ -219,11 +242,11 @@ private:
 
     // Loading
 
-    void loadLYT();
-    void loadVIS();
-    void loadPTH();
+    void loadLYT(const resource::LytFile &lyt, JobGraph &graph);
+    void loadVIS(const resource::VisFile &vis);
+    void loadPTH(const resource::GffStruct &pth);
     void loadARE(const resource::GffStruct &are);
-    void loadGIT(const resource::GffStruct &gffs);
+    void loadGIT(const resource::GffStruct &git, JobGraph &graph);
 
     void loadCameraStyle(const resource::GffStruct &are);
     void loadAmbientColor(const resource::GffStruct &are);
@@ -232,9 +255,9 @@ private:
     void loadStealthXP(const resource::GffStruct &are);
 
     void loadProperties(const resource::GffStruct &git);
-    void loadCreatures(const resource::GffStruct &git);
-    void loadDoors(const resource::GffStruct &git);
-    void loadPlaceables(const resource::GffStruct &git);
+    void loadCreatures(const resource::GffStruct &git, JobGraph &graph);
+    void loadDoors(const resource::GffStruct &git, JobGraph &graph);
+    void loadPlaceables(const resource::GffStruct &git, JobGraph &graph);
     void loadWaypoints(const resource::GffStruct &git);
     void loadTriggers(const resource::GffStruct &git);
     void loadSounds(const resource::GffStruct &git);
@@ -288,7 +288,7 @@ void Creature::playAnimation(CombatAnimation animation) {
 void Creature::equip(const string &resRef) {
     shared_ptr<ItemBlueprint> blueprint(Blueprints::instance().getItem(resRef));
 
-    shared_ptr<Item> item(_objectFactory->newItem());
+    shared_ptr<Item> item(_objectFactory->newItem(this));
     item->load(blueprint);
 
     if (item->isEquippable(kInventorySlotBody)) {
@@ -435,6 +435,10 @@ int Creature::xp() const {
     return _xp;
 }
 
+Creature::MovementType Creature::movementType() const {
+    return _movementType;
+}
+
 float Creature::getAttackRange() const {
     float result = kDefaultAttackRange;
 
@@ -104,6 +104,7 @@ public:
     CreatureAttributes &attributes();
     Faction faction() const;
     int xp() const;
+    MovementType movementType() const;
 
     void setMovementType(MovementType type);
     void setTalking(bool talking);
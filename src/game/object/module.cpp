@@ -249,12 +249,18 @@ void Module::onPlaceableClick(const shared_ptr<Placeable> &placeable) {
 }
 
 void Module::update(float dt) {
+    _area->snapshotTransforms();
+
     if (_game->cameraType() == CameraType::ThirdPerson) {
         _player->update(dt);
     }
     _area->update(dt);
 }
 
+void Module::updateScene(float dt, float alpha) {
+    _area->updateScene(dt, alpha);
+}
+
 vector<ContextualAction> Module::getContextualActions(const shared_ptr<Object> &object) const {
     vector<ContextualAction> actions;
 
@@ -270,6 +276,23 @@ vector<ContextualAction> Module::getContextualActions(const shared_ptr<Object> &
     return move(actions);
 }
 
+set<string> Module::getLinkedModules() const {
+    set<string> result;
+
+    for (auto &object : _area->getObjectsByType(ObjectType::Door)) {
+        auto door = static_pointer_cast<Door>(object);
+        result.insert(door->linkedToModule());
+    }
+    for (auto &object : _area->getObjectsByType(ObjectType::Trigger)) {
+        auto trigger = static_pointer_cast<Trigger>(object);
+        result.insert(trigger->linkedToModule());
+    }
+    result.erase("");
+    result.erase(_name);
+
+    return move(result);
+}
+
 const string &Module::name() const {
     return _name;
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <memory>
+#include <set>
 
 #include "glm/vec3.hpp"
 
@@ -62,9 +63,15 @@ public:
 
     bool handle(const SDL_Event &event);
     void update(float dt);
+    void updateScene(float dt, float alpha);
 
     std::vector<ContextualAction> getContextualActions(const std::shared_ptr<Object> &object) const;
 
+    /**
+     * @return names of modules, that doors and triggers of this module lead to
+     */
+    std::set<std::string> getLinkedModules() const;
+
     const std::string &name() const;
     const ModuleInfo &info() const;
     std::shared_ptr<Area> area() const;
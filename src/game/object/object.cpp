@@ -110,6 +110,10 @@ void Object::setMaxHitPoints(int maxHitPoints) {
     _maxHitPoints = maxHitPoints;
 }
 
+void Object::setCurrentHitPoints(int hitPoints) {
+    _currentHitPoints = hitPoints;
+}
+
 void Object::setPlotFlag(int flag) {
     _plotFlag = flag;
 }
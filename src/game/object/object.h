@@ -64,6 +64,7 @@ public:
 
     void setMinOneHP(bool minOneHP);
     void setMaxHitPoints(int maxHitPoints);
+    void setCurrentHitPoints(int hitPoints);
 
     // END Hit Points
 
@@ -29,8 +29,10 @@ namespace reone {
 
 namespace game {
 
+static const uint32_t kFirstPartyObjectId = 0x80000000;
+
 ObjectFactory::ObjectFactory(Game *game, SceneGraph *sceneGraph) :
-    _game(game), _sceneGraph(sceneGraph) {
+    _game(game), _sceneGraph(sceneGraph), _partyCounter(kFirstPartyObjectId) {
 
     if (!game) {
         throw invalid_argument("game must not be null");
@@ -52,6 +54,10 @@ unique_ptr<Creature> ObjectFactory::newCreature() {
     return make_unique<Creature>(_counter++, this, _sceneGraph, &_game->scriptRunner());
 }
 
+unique_ptr<Creature> ObjectFactory::newPartyMember() {
+    return make_unique<Creature>(_partyCounter++, this, _sceneGraph, &_game->scriptRunner());
+}
+
 unique_ptr<Placeable> ObjectFactory::newPlaceable() {
     return make_unique<Placeable>(_counter++, this, _sceneGraph, &_game->scriptRunner());
 }
@@ -68,8 +74,9 @@ unique_ptr<Trigger> ObjectFactory::newTrigger() {
     return make_unique<Trigger>(_counter++, this, _sceneGraph, &_game->scriptRunner());
 }
 
-unique_ptr<Item> ObjectFactory::newItem() {
-    return make_unique<Item>(_counter++);
+unique_ptr<Item> ObjectFactory::newItem(const Object *owner) {
+    bool partyOwned = owner && isPartyObjectId(owner->id());
+    return make_unique<Item>(partyOwned ? _partyCounter++ : _counter++);
 }
 
 unique_ptr<Sound> ObjectFactory::newSound() {
@@ -80,6 +87,10 @@ unique_ptr<PlaceableCamera> ObjectFactory::newCamera() {
     return make_unique<PlaceableCamera>(_counter++, this, _sceneGraph, &_game->scriptRunner());
 }
 
+bool ObjectFactory::isPartyObjectId(uint32_t id) {
+    return id >= kFirstPartyObjectId;
+}
+
 } // namespace game
 
 } // namespace reone
@@ -49,18 +49,39 @@ public:
     std::unique_ptr<Module> newModule();
     std::unique_ptr<Area> newArea();
     std::unique_ptr<Creature> newCreature();
+
+    /**
+     * Creates a creature, that is to join the party. Party members and their
+     * items are assigned IDs from a separate range, so that IDs of module
+     * objects do not depend on the party. This lets a dedicated server, which
+     * has no party, agree with its clients on IDs of module objects.
+     */
+    std::unique_ptr<Creature> newPartyMember();
+
     std::unique_ptr<Placeable> newPlaceable();
     std::unique_ptr<Door> newDoor();
     std::unique_ptr<Waypoint> newWaypoint();
     std::unique_ptr<Trigger> newTrigger();
-    std::unique_ptr<Item> newItem();
+
+    /**
+     * @param owner object, that is to own the item, if any. Items of party
+     *              members are assigned IDs from the party range.
+     */
+    std::unique_ptr<Item> newItem(const Object *owner = nullptr);
+
     std::unique_ptr<Sound> newSound();
     std::unique_ptr<PlaceableCamera> newCamera();
 
+    /**
+     * @return true if the object ID was assigned to a party member or its item
+     */
+    static bool isPartyObjectId(uint32_t id);
+
 private:
     Game *_game { nullptr };
     scene::SceneGraph *_sceneGraph { nullptr };
     uint32_t _counter { 2 }; // ids 0 and 1 are reserved
+    uint32_t _partyCounter { 0 };
 
     ObjectFactory(const ObjectFactory &) = delete;
     ObjectFactory &operator=(const ObjectFactory &) = delete;
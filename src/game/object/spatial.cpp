@@ -18,6 +18,7 @@
 #include "spatial.h"
 
 #include "glm/gtx/euler_angles.hpp"
+#include "glm/gtx/norm.hpp"
 
 #include "../../common/log.h"
 
@@ -36,6 +37,8 @@ namespace reone {
 
 namespace game {
 
+static const float kMaxInterpolationDistance = 1.0f;
+
 SpatialObject::SpatialObject(
     uint32_t id,
     ObjectType type,
@@ -64,7 +67,7 @@ shared_ptr<Item> SpatialObject::addItem(const string &resRef, int stackSize, boo
         result->setStackSize(prevStackSize + stackSize);
 
     } else {
-        result = _objectFactory->newItem();
+        result = _objectFactory->newItem(this);
         result->load(blueprint);
         result->setStackSize(stackSize);
         result->setDropable(dropable);
@@ -146,9 +149,35 @@ void SpatialObject::applyEffect(const shared_ptr<Effect> &effect) {
 
 void SpatialObject::update(float dt) {
     Object::update(dt);
-    if (_model) {
-        _model->update(dt);
+}
+
+void SpatialObject::snapshotTransform() {
+    _prevPosition = _position;
+    _prevFacing = _facing;
+    _hasSnapshot = true;
+}
+
+void SpatialObject::updateScene(float dt, float alpha) {
+    if (!_model) return;
+
+    bool moved = _hasSnapshot && (_prevPosition != _position || _prevFacing != _facing);
+
+    // Objects that were moved too far in a single step, e.g. teleported, are not interpolated
+    if (moved && glm::distance2(_prevPosition, _position) < kMaxInterpolationDistance * kMaxInterpolationDistance) {
+        glm::vec3 position(glm::mix(_prevPosition, _position, alpha));
+
+        float facingDelta = glm::mod(_facing - _prevFacing + glm::pi<float>(), glm::two_pi<float>()) - glm::pi<float>();
+        float facing = _prevFacing + alpha * facingDelta;
+
+        _model->setLocalTransform(getTransform(position, facing));
+        _modelInterpolated = true;
+
+    } else if (_modelInterpolated) {
+        _model->setLocalTransform(_transform);
+        _modelInterpolated = false;
     }
+
+    _model->update(dt);
 }
 
 void SpatialObject::playAnimation(Animation animation, float speed) {
@@ -235,17 +264,24 @@ void SpatialObject::setPosition(const glm::vec3 &position) {
 }
 
 void SpatialObject::updateTransform() {
-    _transform = glm::translate(glm::mat4(1.0f), _position);
-    _transform *= glm::mat4_cast(_orientation);
+    _transform = getTransform(_position, _facing);
 
-    if (_facing != 0.0f) {
-        _transform *= glm::eulerAngleZ(_facing);
-    }
     if (_model) {
         _model->setLocalTransform(_transform);
     }
 }
 
+glm::mat4 SpatialObject::getTransform(const glm::vec3 &position, float facing) const {
+    glm::mat4 transform(glm::translate(glm::mat4(1.0f), position));
+    transform *= glm::mat4_cast(_orientation);
+
+    if (facing != 0.0f) {
+        transform *= glm::eulerAngleZ(facing);
+    }
+
+    return move(transform);
+}
+
 void SpatialObject::setFacing(float facing) {
     _facing = facing;
     updateTransform();
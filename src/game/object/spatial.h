@@ -48,6 +48,20 @@ class SpatialObject : public Object {
 public:
     void update(float dt) override;
 
+    /**
+     * Remembers the current position and facing as the starting point of
+     * interpolation. Called before every simulation step.
+     */
+    void snapshotTransform();
+
+    /**
+     * Interpolates the model transform between the two last simulation steps
+     * and advances model animation. Called once per rendered frame.
+     *
+     * @param alpha fraction of the simulation step, elapsed since the last one
+     */
+    void updateScene(float dt, float alpha);
+
     void face(const SpatialObject &other);
     void face(const glm::vec3 &point);
     void faceAwayFrom(const SpatialObject &other);
@@ -114,6 +128,15 @@ protected:
     std::deque<std::shared_ptr<Effect>> _effects;
     bool _open { false };
 
+    // Interpolation
+
+    glm::vec3 _prevPosition { 0.0f };
+    float _prevFacing { 0.0f };
+    bool _hasSnapshot { false };
+    bool _modelInterpolated { false };
+
+    // END Interpolation
+
     SpatialObject(
         uint32_t id,
         ObjectType type,
@@ -123,6 +146,8 @@ protected:
 
     virtual void updateTransform();
 
+    glm::mat4 getTransform(const glm::vec3 &position, float facing) const;
+
     bool isAnimationLooping(Animation animation) const;
 
 private:
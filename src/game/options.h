@@ -27,11 +27,22 @@ namespace reone {
 
 namespace game {
 
+struct BenchmarkOptions {
+    std::string module;
+    int frames { 0 };
+    std::string output;
+    std::string captureDir;
+    int captureInterval { 0 }; // frames, 0 to disable frame capture
+};
+
 struct Options {
     std::string module;
+    std::string modelCache;
+    int prefetchBudget { 0 }; // megabytes, 0 to disable module prefetching
     render::GraphicsOptions graphics;
     audio::AudioOptions audio;
     net::NetworkOptions network;
+    BenchmarkOptions benchmark;
 };
 
 } // namespace game
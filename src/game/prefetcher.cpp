@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "prefetcher.h"
+
+#include <algorithm>
+#include <map>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+
+#include "../common/jobs.h"
+#include "../common/log.h"
+#include "../common/streamutil.h"
+#include "../render/mesh/modelmesh.h"
+#include "../render/model/mdlfile.h"
+#include "../resource/2dafile.h"
+#include "../resource/gfffile.h"
+#include "../resource/lytfile.h"
+#include "../resource/resources.h"
+
+using namespace std;
+
+using namespace reone::render;
+using namespace reone::resource;
+
+namespace reone {
+
+namespace game {
+
+static const float kIdleDelay = 2.0f; // seconds
+
+ModulePrefetcher::~ModulePrefetcher() {
+    cancel();
+}
+
+void ModulePrefetcher::init(GameVersion version, size_t budget) {
+    _version = version;
+    _budget = budget;
+}
+
+void ModulePrefetcher::setModule(const string &name, const set<string> &linkedModules) {
+    if (_budget == 0) return;
+
+    Resources::instance().retainPrefetchedModules(linkedModules);
+
+    _queue.assign(linkedModules.begin(), linkedModules.end());
+    _idleTime = 0.0f;
+
+    debug(boost::format("ModulePrefetcher: module %s is linked to %d modules") % name % linkedModules.size());
+}
+
+void ModulePrefetcher::update(float dt, bool idle) {
+    if (_budget == 0) return;
+
+    if (!idle) {
+        _idleTime = 0.0f;
+        return;
+    }
+    _idleTime += dt;
+
+    if (_idleTime < kIdleDelay || _running || _queue.empty()) return;
+
+    string name(_queue.front());
+    _queue.pop_front();
+
+    if (Resources::instance().isModulePrefetched(name)) return;
+
+    _running = true;
+    _cancel = false;
+
+    JobExecutor::instance().enqueue([this, name](const atomic_bool &cancel) {
+        prefetch(name, cancel);
+        {
+            lock_guard<mutex> lock(_runningMutex);
+            _running = false;
+        }
+        _runningCondition.notify_all();
+    });
+}
+
+void ModulePrefetcher::cancel() {
+    _cancel = true;
+
+    unique_lock<mutex> lock(_runningMutex);
+    _runningCondition.wait(lock, [this]() { return !_running; });
+}
+
+static shared_ptr<GffStruct> parseGFF(const shared_ptr<ByteArray> &data) {
+    if (!data) return nullptr;
+
+    GffFile gff;
+    gff.load(wrap(data));
+
+    return gff.top();
+}
+
+static shared_ptr<TwoDaTable> parse2DA(const shared_ptr<ByteArray> &data) {
+    if (!data) return nullptr;
+
+    TwoDaFile twoDa;
+    twoDa.load(wrap(data));
+
+    return twoDa.table();
+}
+
+static void countTextures(const ModelNode &node, map<string, int> &refs) {
+    shared_ptr<ModelMesh> mesh(node.mesh());
+    if (mesh) {
+        if (!mesh->diffuseName().empty()) {
+            ++refs[mesh->diffuseName()];
+        }
+        if (!mesh->lightmapName().empty()) {
+            ++refs[mesh->lightmapName()];
+        }
+    }
+    for (auto &child : node.children()) {
+        countTextures(*child, refs);
+    }
+}
+
+/**
+ * @return keys of the specified map, most referenced first
+ */
+static vector<string> sortByRefs(const map<string, int> &refs) {
+    vector<pair<string, int>> pairs(refs.begin(), refs.end());
+    stable_sort(pairs.begin(), pairs.end(), [](auto &left, auto &right) { return left.second > right.second; });
+
+    vector<string> result;
+    for (auto &pair : pairs) {
+        result.push_back(pair.first);
+    }
+
+    return move(result);
+}
+
+void ModulePrefetcher::prefetch(const string &name, const atomic_bool &cancel) {
+    Resources &resources = Resources::instance();
+
+    size_t prefetchedSize = resources.getPrefetchedSize();
+    if (prefetchedSize >= _budget) {
+        debug("ModulePrefetcher: budget exhausted, skip module: " + name);
+        return;
+    }
+    size_t budget = _budget - prefetchedSize;
+
+    try {
+        unique_ptr<PrefetchedModule> module(resources.openModule(name));
+
+        auto fetch = [&](const string &resRef, ResourceType type) -> shared_ptr<ByteArray> {
+            if (cancel || _cancel || module->size >= budget) return nullptr;
+            return resources.prefetch(*module, resRef, type);
+        };
+
+        shared_ptr<GffStruct> ifo(parseGFF(fetch("module", ResourceType::ModuleInfo)));
+        if (ifo) {
+            string areaName(boost::to_lower_copy(ifo->getString("Mod_Entry_Area")));
+
+            fetch(areaName, ResourceType::Area);
+            fetch(areaName, ResourceType::Vis);
+            fetch(areaName, ResourceType::Path);
+
+            shared_ptr<GffStruct> git(parseGFF(fetch(areaName, ResourceType::GameInstance)));
+            shared_ptr<ByteArray> lytData(fetch(areaName, ResourceType::AreaLayout));
+
+            // Room models are always loaded, therefore they come first
+
+            vector<string> models;
+            if (lytData) {
+                LytFile lyt;
+                lyt.load(wrap(lytData));
+
+                for (auto &room : lyt.rooms()) {
+                    models.push_back(room.name);
+                    fetch(room.name, ResourceType::Walkmesh);
+                }
+            }
+
+            // Object models are ordered by the number of references
+
+            map<string, int> modelRefs;
+            if (git) {
+                shared_ptr<TwoDaTable> genericDoors;
+                for (auto &gffs : git->getList("Door List")) {
+                    string resRef(boost::to_lower_copy(gffs->getString("TemplateResRef")));
+                    shared_ptr<GffStruct> utd(parseGFF(fetch(resRef, ResourceType::DoorBlueprint)));
+                    if (!utd) continue;
+
+                    if (!genericDoors) {
+                        genericDoors = parse2DA(fetch("genericdoors", ResourceType::TwoDa));
+                        if (!genericDoors) break;
+                    }
+                    string modelName(boost::to_lower_copy(genericDoors->getString(utd->getInt("GenericType"), "modelname")));
+                    ++modelRefs[modelName];
+                    fetch(modelName + "0", ResourceType::DoorWalkmesh);
+                }
+                shared_ptr<TwoDaTable> placeables;
+                for (auto &gffs : git->getList("Placeable List")) {
+                    string resRef(boost::to_lower_copy(gffs->getString("TemplateResRef")));
+                    shared_ptr<GffStruct> utp(parseGFF(fetch(resRef, ResourceType::PlaceableBlueprint)));
+                    if (!utp) continue;
+
+                    if (!placeables) {
+                        placeables = parse2DA(fetch("placeables", ResourceType::TwoDa));
+                        if (!placeables) break;
+                    }
+                    string modelName(boost::to_lower_copy(placeables->getString(utp->getInt("Appearance"), "modelname")));
+                    ++modelRefs[modelName];
+                    fetch(modelName, ResourceType::PlaceableWalkmesh);
+                }
+                for (auto &gffs : git->getList("Creature List")) {
+                    string resRef(boost::to_lower_copy(gffs->getString("TemplateResRef")));
+                    fetch(resRef, ResourceType::CreatureBlueprint);
+                }
+            }
+            for (auto &modelName : sortByRefs(modelRefs)) {
+                if (find(models.begin(), models.end(), modelName) == models.end()) {
+                    models.push_back(modelName);
+                }
+            }
+
+            // Textures are ordered by the number of references from prefetched models
+
+            map<string, int> textureRefs;
+            for (auto &modelName : models) {
+                shared_ptr<ByteArray> mdlData(fetch(modelName, ResourceType::Model));
+                shared_ptr<ByteArray> mdxData(fetch(modelName, ResourceType::Mdx));
+                if (!mdlData || !mdxData) continue;
+
+                try {
+                    MdlFile mdl(_version, false);
+                    mdl.load(wrap(mdlData), wrap(mdxData));
+
+                    shared_ptr<Model> model(mdl.model());
+                    if (model) {
+                        countTextures(model->rootNode(), textureRefs);
+                    }
+                }
+                catch (const exception &e) {
+                    warn(boost::format("ModulePrefetcher: unable to parse model %s: %s") % modelName % e.what());
+                }
+            }
+            for (auto &textureName : sortByRefs(textureRefs)) {
+                if (!fetch(textureName, ResourceType::Texture)) {
+                    fetch(textureName, ResourceType::Tga);
+                }
+            }
+        }
+
+        // Partially prefetched modules are kept too: indexed archives alone save time
+        resources.addPrefetchedModule(move(module));
+    }
+    catch (const exception &e) {
+        warn(boost::format("ModulePrefetcher: unable to prefetch module %s: %s") % name % e.what());
+    }
+}
+
+} // namespace game
+
+} // namespace reone
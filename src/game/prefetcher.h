@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "../resource/types.h"
+
+namespace reone {
+
+namespace game {
+
+/**
+ * Loads resources of modules, adjacent to the current one, while the player
+ * is idle: module archives, area files, walkmeshes and the most referenced
+ * models and textures. Prefetching runs on a worker thread, one module at a
+ * time, within a memory budget, and gives way to I/O of the game itself.
+ *
+ * @see reone::resource::Resources::prefetch
+ */
+class ModulePrefetcher {
+public:
+    ModulePrefetcher() = default;
+    ~ModulePrefetcher();
+
+    /**
+     * @param budget memory budget in bytes, 0 to disable prefetching
+     */
+    void init(resource::GameVersion version, size_t budget);
+
+    /**
+     * Schedules prefetching of modules, linked to the current one, and
+     * discards previously prefetched modules, that are not linked to it.
+     */
+    void setModule(const std::string &name, const std::set<std::string> &linkedModules);
+
+    /**
+     * Starts prefetching the next module, once the player has been idle for
+     * long enough. Must be called every frame.
+     *
+     * @param idle true if the player is idle in this frame
+     * @see Game::isPlayerIdle
+     */
+    void update(float dt, bool idle);
+
+    /**
+     * Stops prefetching and waits for the worker thread to finish.
+     */
+    void cancel();
+
+private:
+    resource::GameVersion _version { resource::GameVersion::KotOR };
+    size_t _budget { 0 };
+    std::deque<std::string> _queue;
+    float _idleTime { 0.0f };
+    std::atomic_bool _running { false };
+    std::mutex _runningMutex;
+    std::condition_variable _runningCondition;
+    std::atomic_bool _cancel { false };
+
+    ModulePrefetcher(const ModulePrefetcher &) = delete;
+    ModulePrefetcher &operator=(const ModulePrefetcher &) = delete;
+
+    void prefetch(const std::string &name, const std::atomic_bool &cancel);
+};
+
+} // namespace game
+
+} // namespace reone
@@ -22,10 +22,7 @@
 #include "glm/ext.hpp"
 
 #include "../../render/fonts.h"
-#include "../../render/mesh/quad.h"
-#include "../../render/shaders.h"
 #include "../../render/textures.h"
-#include "../../render/util.h"
 #include "../../resource/resources.h"
 #include "../../common/log.h"
 
@@ -36,6 +33,7 @@
 #include "label.h"
 #include "listbox.h"
 #include "panel.h"
+#include "progressbar.h"
 #include "scrollbar.h"
 #include "togglebutton.h"
 
@@ -49,6 +47,8 @@ namespace reone {
 
 namespace gui {
 
+static const size_t kMaxTextLayoutCount = 16;
+
 ControlType Control::getType(const GffStruct &gffs) {
     return static_cast<ControlType>(gffs.getInt("CONTROLTYPE"));
 }
@@ -85,6 +85,9 @@ unique_ptr<Control> Control::of(GUI *gui, ControlType type, const string &tag) {
         case ControlType::ScrollBar:
             control = make_unique<ScrollBar>(gui);
             break;
+        case ControlType::ProgressBar:
+            control = make_unique<ProgressBar>(gui);
+            break;
         default:
             warn("GUI: unsupported control type: " + to_string(static_cast<int>(type)));
             return nullptr;
@@ -230,43 +233,33 @@ void Control::render(const glm::ivec2 &offset, const string &textOverride) const
 }
 
 void Control::drawBorder(const Border &border, const glm::ivec2 &offset, const glm::ivec2 &size) const {
-    glm::vec3 color(getBorderColor());
+    SpriteBatch &batch = SpriteBatch::instance();
+    glm::vec4 color(getBorderColor(), 1.0f);
 
     if (border.fill) {
-        {
-            int x = _extent.left + border.dimension + offset.x;
-            int y = _extent.top + border.dimension + offset.y;
-            int w = size.x - 2 * border.dimension;
-            int h = size.y - 2 * border.dimension;
-
-            glm::mat4 transform(1.0f);
-            transform = glm::translate(transform, glm::vec3(x, y, 0.0f));
-            transform = glm::scale(transform, glm::vec3(w, h, 1.0f));
-
-            LocalUniforms locals;
-            locals.general.discardEnabled = _discardEnabled;
-            locals.general.model = move(transform);
-            locals.general.discardColor = glm::vec4(_discardColor, 1.0f);
-
-            Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
-        }
-
-        border.fill->bind(0);
-
-        bool additive = border.fill->isAdditive();
-        if (additive) {
-            withAdditiveBlending([]() {
-                Quad::getDefault().renderTriangles();
-            });
-        } else {
-            Quad::getDefault().renderTriangles();
-        }
+        int x = _extent.left + border.dimension + offset.x;
+        int y = _extent.top + border.dimension + offset.y;
+        int w = size.x - 2 * border.dimension;
+        int h = size.y - 2 * border.dimension;
+
+        glm::mat4 transform(1.0f);
+        transform = glm::translate(transform, glm::vec3(x, y, 0.0f));
+        transform = glm::scale(transform, glm::vec3(w, h, 1.0f));
+
+        SpriteState state;
+        state.texture = border.fill;
+        state.additive = border.fill->isAdditive();
+        state.discardEnabled = _discardEnabled;
+        state.discardColor = _discardColor;
+
+        batch.draw(state, transform);
     }
     if (border.edge) {
         int width = size.x - 2 * border.dimension;
         int height = size.y - 2 * border.dimension;
 
-        border.edge->bind(0);
+        SpriteState state;
+        state.texture = border.edge;
 
         if (height > 0.0f) {
             int x = _extent.left + offset.x;
@@ -280,13 +273,8 @@ void Control::drawBorder(const Border &border, const glm::ivec2 &offset, const g
                 transform = glm::rotate(transform, glm::half_pi<float>(), glm::vec3(0.0f, 0.0f, 1.0f));
                 transform = glm::rotate(transform, glm::pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f));
 
-                LocalUniforms locals;
-                locals.general.model = move(transform);
-                locals.general.color = glm::vec4(color, 1.0f);
-
-                Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
+                batch.draw(state, transform, color);
             }
-            Quad::getDefault().renderTriangles();
 
             // Right edge
             {
@@ -295,13 +283,8 @@ void Control::drawBorder(const Border &border, const glm::ivec2 &offset, const g
                 transform = glm::scale(transform, glm::vec3(border.dimension, height, 1.0f));
                 transform = glm::rotate(transform, glm::half_pi<float>(), glm::vec3(0.0f, 0.0f, 1.0f));
 
-                LocalUniforms locals;
-                locals.general.model = move(transform);
-                locals.general.color = glm::vec4(color, 1.0f);
-
-                Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
+                batch.draw(state, transform, color, kSpriteFlipX);
             }
-            Quad::getXFlipped().renderTriangles();
         }
 
         if (width > 0.0f) {
@@ -314,13 +297,8 @@ void Control::drawBorder(const Border &border, const glm::ivec2 &offset, const g
                 transform = glm::translate(transform, glm::vec3(x, y, 0.0f));
                 transform = glm::scale(transform, glm::vec3(width, border.dimension, 1.0f));
 
-                LocalUniforms locals;
-                locals.general.model = move(transform);
-                locals.general.color = glm::vec4(color, 1.0f);
-
-                Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
+                batch.draw(state, transform, color);
             }
-            Quad::getDefault().renderTriangles();
 
             // Bottom edge
             {
@@ -328,20 +306,16 @@ void Control::drawBorder(const Border &border, const glm::ivec2 &offset, const g
                 transform = glm::translate(transform, glm::vec3(x, y + size.y - border.dimension, 0.0f));
                 transform = glm::scale(transform, glm::vec3(width, border.dimension, 1.0f));
 
-                LocalUniforms locals;
-                locals.general.model = move(transform);
-                locals.general.color = glm::vec4(color, 1.0f);
-
-                Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
+                batch.draw(state, transform, color, kSpriteFlipY);
             }
-            Quad::getYFlipped().renderTriangles();
         }
     }
     if (border.corner) {
         int x = _extent.left + offset.x;
         int y = _extent.top + offset.y;
 
-        border.corner->bind(0);
+        SpriteState state;
+        state.texture = border.corner;
 
         // Top left corner
         {
@@ -349,13 +323,8 @@ void Control::drawBorder(const Border &border, const glm::ivec2 &offset, const g
             transform = glm::translate(transform, glm::vec3(x, y, 0.0f));
             transform = glm::scale(transform, glm::vec3(border.dimension, border.dimension, 1.0f));
 
-            LocalUniforms locals;
-            locals.general.model = move(transform);
-            locals.general.color = glm::vec4(color, 1.0f);
-
-            Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
+            batch.draw(state, transform, color);
         }
-        Quad::getDefault().renderTriangles();
 
         // Bottom left corner
         {
@@ -363,13 +332,8 @@ void Control::drawBorder(const Border &border, const glm::ivec2 &offset, const g
             transform = glm::translate(transform, glm::vec3(x, y + size.y - border.dimension, 0.0f));
             transform = glm::scale(transform, glm::vec3(border.dimension, border.dimension, 1.0f));
 
-            LocalUniforms locals;
-            locals.general.model = move(transform);
-            locals.general.color = glm::vec4(color, 1.0f);
-
-            Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
+            batch.draw(state, transform, color, kSpriteFlipY);
         }
-        Quad::getYFlipped().renderTriangles();
 
         // Top right corner
         {
@@ -377,13 +341,8 @@ void Control::drawBorder(const Border &border, const glm::ivec2 &offset, const g
             transform = glm::translate(transform, glm::vec3(x + size.x - border.dimension, y, 0.0f));
             transform = glm::scale(transform, glm::vec3(border.dimension, border.dimension, 1.0f));
 
-            LocalUniforms locals;
-            locals.general.model = move(transform);
-            locals.general.color = glm::vec4(color, 1.0f);
-
-            Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
+            batch.draw(state, transform, color, kSpriteFlipX);
         }
-        Quad::getXFlipped().renderTriangles();
 
         // Bottom right corner
         {
@@ -391,13 +350,8 @@ void Control::drawBorder(const Border &border, const glm::ivec2 &offset, const g
             transform = glm::translate(transform, glm::vec3(x + size.x - border.dimension, y + size.y - border.dimension, 0.0f));
             transform = glm::scale(transform, glm::vec3(border.dimension, border.dimension, 1.0f));
 
-            LocalUniforms locals;
-            locals.general.model = move(transform);
-            locals.general.color = glm::vec4(color, 1.0f);
-
-            Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
+            batch.draw(state, transform, color, kSpriteFlipX | kSpriteFlipY);
         }
-        Quad::getXYFlipped().renderTriangles();
     }
 }
 
@@ -409,6 +363,27 @@ const glm::vec3 &Control::getBorderColor() const {
 }
 
 void Control::drawText(const string &text, const glm::ivec2 &offset, const glm::ivec2 &size) const {
+    glm::vec3 color((_focus && _hilight) ? _hilight->color : _text.color);
+
+    // Reuse the cached layout, unless the text, font or transform have changed
+
+    for (auto it = _textLayouts.begin(); it != _textLayouts.end(); ++it) {
+        if (it->text == text && it->font == _text.font && it->offset == offset && it->size == size && it->color == color) {
+            _text.font->render(it->vertices);
+            if (it != _textLayouts.begin()) {
+                iter_swap(it, _textLayouts.begin());
+            }
+            return;
+        }
+    }
+
+    TextLayout layout;
+    layout.text = text;
+    layout.font = _text.font;
+    layout.offset = offset;
+    layout.size = size;
+    layout.color = color;
+
     float textWidth = _text.font->measure(text);
     int lineCount = static_cast<int>(glm::ceil(textWidth / static_cast<float>(size.x)));
 
@@ -423,12 +398,11 @@ void Control::drawText(const string &text, const glm::ivec2 &offset, const glm::
     }
 
     glm::ivec2 position;
-    glm::vec3 color((_focus && _hilight) ? _hilight->color : _text.color);
 
     if (lineCount == 1) {
         getTextPosition(position, 1, size);
         glm::mat4 transform(glm::translate(glm::mat4(1.0f), glm::vec3(position.x + offset.x, position.y + offset.y, 0.0f)));
-        _text.font->render(text, transform, color, gravity);
+        _text.font->layout(text, transform, color, gravity, layout.vertices);
 
     } else {
         vector<string> lines(breakText(text, size.x));
@@ -437,9 +411,16 @@ void Control::drawText(const string &text, const glm::ivec2 &offset, const glm::
         for (auto &line : lines) {
             glm::mat4 transform(glm::translate(glm::mat4(1.0f), glm::vec3(position.x + offset.x, position.y + offset.y, 0.0f)));
             position.y += static_cast<int>(_text.font->height());
-            _text.font->render(line, transform, color, gravity);
+            _text.font->layout(line, transform, color, gravity, layout.vertices);
         }
     }
+
+    _text.font->render(layout.vertices);
+
+    if (_textLayouts.size() >= kMaxTextLayoutCount) {
+        _textLayouts.pop_back();
+    }
+    _textLayouts.insert(_textLayouts.begin(), move(layout));
 }
 
 vector<string> Control::breakText(const string &text, int maxWidth) const {
@@ -497,6 +478,7 @@ void Control::stretch(float x, float y) {
     _extent.top = static_cast<int>(_extent.top * y);
     _extent.width = static_cast<int>(_extent.width * x);
     _extent.height = static_cast<int>(_extent.height * y);
+    _textLayouts.clear();
     updateTransform();
 }
 
@@ -554,6 +536,7 @@ void Control::setFocus(bool focus) {
 
 void Control::setExtent(const Extent &extent) {
     _extent = extent;
+    _textLayouts.clear();
     updateTransform();
 }
 
@@ -607,6 +590,7 @@ void Control::setHilightColor(const glm::vec3 &color) {
 
 void Control::setText(const Text &text) {
     _text = text;
+    _textLayouts.clear();
 }
 
 void Control::setTextMessage(const string &text) {
@@ -20,12 +20,15 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
 
 #include "../../render/font.h"
 #include "../../render/framebuffer.h"
+#include "../../render/spritebatch.h"
 #include "../../render/texture.h"
 #include "../../resource/gfffile.h"
 #include "../../scene/node/modelscenenode.h"
@@ -170,7 +173,17 @@ protected:
     virtual const glm::vec3 &getBorderColor() const;
 
 private:
+    struct TextLayout {
+        std::string text;
+        std::shared_ptr<render::Font> font;
+        glm::ivec2 offset { 0 };
+        glm::ivec2 size { 0 };
+        glm::vec3 color { 1.0f };
+        std::vector<render::SpriteVertex> vertices;
+    };
+
     std::unique_ptr<scene::ControlRenderPipeline> _pipeline;
+    mutable std::vector<TextLayout> _textLayouts; /**< most recently used first */
 
     Control(const Control &) = delete;
     Control &operator=(const Control &) = delete;
@@ -18,7 +18,7 @@
 #include "imagebutton.h"
 
 #include "../../render/fonts.h"
-#include "../../render/mesh/quad.h"
+#include "../../render/spritebatch.h"
 
 using namespace std;
 
@@ -87,24 +87,15 @@ void ImageButton::drawIcon(
     transform = glm::translate(transform, glm::vec3(offset.x + _extent.left, offset.y + _extent.top, 0.0f));
     transform = glm::scale(transform, glm::vec3(_extent.height, _extent.height, 1.0f));
 
-    LocalUniforms locals;
-    locals.general.model = transform;
-    locals.general.color = glm::vec4(color, 1.0f);
-
-    Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
-
     if (iconFrame) {
-        iconFrame->bind(0);
-        Quad::getDefault().renderTriangles();
+        SpriteState state;
+        state.texture = iconFrame;
+        SpriteBatch::instance().draw(state, transform, glm::vec4(color, 1.0f));
     }
-
-    locals.general.color = glm::vec4(1.0f);
-
-    Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
-
     if (iconTexture) {
-        iconTexture->bind(0);
-        Quad::getDefault().renderTriangles();
+        SpriteState state;
+        state.texture = iconTexture;
+        SpriteBatch::instance().draw(state, transform);
     }
     if (!iconText.empty()) {
         transform = glm::mat4(1.0f);
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "progressbar.h"
+
+#include "glm/ext.hpp"
+
+#include "../../render/spritebatch.h"
+#include "../../render/textures.h"
+
+using namespace std;
+
+using namespace reone::render;
+using namespace reone::resource;
+
+namespace reone {
+
+namespace gui {
+
+static const int kMaxValue = 100;
+
+ProgressBar::ProgressBar(GUI *gui) : Control(gui, ControlType::ProgressBar) {
+}
+
+void ProgressBar::load(const GffStruct &gffs) {
+    Control::load(gffs);
+
+    shared_ptr<GffStruct> progress(gffs.getStruct("PROGRESS"));
+    if (progress) {
+        string fill(progress->getString("FILL"));
+        if (!fill.empty()) {
+            _progress.fill = Textures::instance().get(fill, TextureType::GUI);
+        }
+    }
+    setValue(gffs.getInt("CURVALUE"));
+}
+
+void ProgressBar::render(const glm::ivec2 &offset, const string &textOverride) const {
+    Control::render(offset, textOverride);
+
+    if (!_progress.fill || _value == 0) return;
+
+    float width = _extent.width * _value / static_cast<float>(kMaxValue);
+
+    glm::mat4 transform(1.0f);
+    transform = glm::translate(transform, glm::vec3(_extent.left + offset.x, _extent.top + offset.y, 0.0f));
+    transform = glm::scale(transform, glm::vec3(width, _extent.height, 1.0f));
+
+    SpriteState state;
+    state.texture = _progress.fill;
+
+    SpriteBatch::instance().draw(state, transform);
+}
+
+void ProgressBar::setValue(int value) {
+    _value = glm::clamp(value, 0, kMaxValue);
+}
+
+} // namespace gui
+
+} // namespace reone
@@ -17,8 +17,7 @@
 
 #include "scrollbar.h"
 
-#include "../../render/mesh/quad.h"
-#include "../../render/shaders.h"
+#include "../../render/spritebatch.h"
 #include "../../render/textures.h"
 #include "../../resource/resources.h"
 
@@ -47,8 +46,6 @@ void ScrollBar::load(const GffStruct &gffs) {
 void ScrollBar::render(const glm::ivec2 &offset, const string &textOverride) const {
     if (!_dir.image) return;
 
-    _dir.image->bind(0);
-
     if (_canScrollUp) drawUpArrow(offset);
     if (_canScrollDown) drawDownArrow(offset);
 }
@@ -58,11 +55,10 @@ void ScrollBar::drawUpArrow(const glm::vec2 &offset) const {
     transform = glm::translate(transform, glm::vec3(_extent.left + offset.x, _extent.top + offset.y, 0.0f));
     transform = glm::scale(transform, glm::vec3(_extent.width, _extent.width, 1.0f));
 
-    LocalUniforms locals;
-    locals.general.model = move(transform);
+    SpriteState state;
+    state.texture = _dir.image;
 
-    Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
-    Quad::getDefault().renderTriangles();
+    SpriteBatch::instance().draw(state, transform);
 }
 
 void ScrollBar::drawDownArrow(const glm::vec2 &offset) const {
@@ -71,11 +67,10 @@ void ScrollBar::drawDownArrow(const glm::vec2 &offset) const {
     transform = glm::scale(transform, glm::vec3(_extent.width, _extent.width, 1.0f));
     transform = glm::rotate(transform, glm::pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f));
 
-    LocalUniforms locals;
-    locals.general.model = move(transform);
+    SpriteState state;
+    state.texture = _dir.image;
 
-    Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
-    Quad::getDefault().renderTriangles();
+    SpriteBatch::instance().draw(state, transform);
 }
 
 void ScrollBar::setCanScrollUp(bool scroll) {
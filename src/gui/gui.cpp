@@ -17,8 +17,7 @@
 
 #include "gui.h"
 
-#include "../render/mesh/quad.h"
-#include "../render/shaders.h"
+#include "../render/spritebatch.h"
 #include "../render/textures.h"
 #include "../resource/resources.h"
 #include "../common/log.h"
@@ -247,12 +246,16 @@ void GUI::update(float dt) {
 }
 
 void GUI::render() const {
+    SpriteBatch::instance().begin();
+
     if (_background) drawBackground();
     if (_rootControl) _rootControl->render(_rootOffset);
 
     for (auto &control : _controls) {
         control->render(_controlOffset);
     }
+
+    SpriteBatch::instance().end();
 }
 
 void GUI::render3D() const {
@@ -266,14 +269,10 @@ void GUI::drawBackground() const {
     transform = glm::translate(transform, glm::vec3(0.0f, 0.0f, -0.9));
     transform = glm::scale(transform, glm::vec3(_gfxOpts.width, _gfxOpts.height, 1.0f));
 
-    LocalUniforms locals;
-    locals.general.model = move(transform);
-
-    Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
-
-    _background->bind(0);
+    SpriteState state;
+    state.texture = _background;
 
-    Quad::getDefault().renderTriangles();
+    SpriteBatch::instance().draw(state, transform);
 }
 
 void GUI::resetFocus() {
@@ -29,6 +29,7 @@ enum class ControlType {
     Button = 6,
     ToggleButton = 7,
     ScrollBar = 9,
+    ProgressBar = 10,
     ListBox = 11
 };
 
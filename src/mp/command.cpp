@@ -21,6 +21,8 @@
 #include <stdexcept>
 #include <string>
 
+#include <boost/format.hpp>
+
 using namespace std;
 
 namespace reone {
@@ -61,31 +63,34 @@ static void putFloat(float val, ByteArray &arr) {
     arr.push_back((intVal >> 24) & 0xff);
 }
 
-static string getString(const ByteArray &arr, int &offset) {
-    int len = arr[offset++];
-    string s(&arr[offset], len);
+static string getString(const char *data, int &offset) {
+    int len = static_cast<uint8_t>(data[offset++]);
+    string s(&data[offset], len);
     offset += len;
     return move(s);
 }
 
-static uint8_t getUint8(const ByteArray &arr, int &offset) {
-    return arr[offset++];
+static uint8_t getUint8(const char *data, int &offset) {
+    return data[offset++];
 }
 
-static uint16_t getUint16(const ByteArray &arr, int &offset) {
-    uint16_t val = *reinterpret_cast<const uint16_t *>(&arr[offset]);
+static uint16_t getUint16(const char *data, int &offset) {
+    uint16_t val;
+    memcpy(&val, &data[offset], sizeof(uint16_t));
     offset += sizeof(uint16_t);
     return val;
 }
 
-static uint32_t getUint32(const ByteArray &arr, int &offset) {
-    uint32_t val = *reinterpret_cast<const uint32_t *>(&arr[offset]);
+static uint32_t getUint32(const char *data, int &offset) {
+    uint32_t val;
+    memcpy(&val, &data[offset], sizeof(uint32_t));
     offset += sizeof(uint32_t);
     return val;
 }
 
-static float getFloat(const ByteArray &arr, int &offset) {
-    float val = *reinterpret_cast<const float *>(&arr[offset]);
+static float getFloat(const char *data, int &offset) {
+    float val;
+    memcpy(&val, &data[offset], sizeof(float));
     offset += sizeof(float);
     return val;
 }
@@ -93,36 +98,117 @@ static float getFloat(const ByteArray &arr, int &offset) {
 Command::Command(uint32_t id, CommandType type) : net::Command(id), _type(type) {
 }
 
-void Command::load(const ByteArray &data) {
-    _type = static_cast<CommandType>(data[0]);
+static void checkSize(size_t size, size_t required) {
+    if (size < required) {
+        throw runtime_error(str(boost::format("Command: too short: %d bytes, %d expected") % size % required));
+    }
+}
 
-    int offset = 1;
+void Command::load(const char *data, size_t size) {
+    checkSize(size, 5);
 
+    int offset = 0;
+    _type = static_cast<CommandType>(getUint8(data, offset));
     _id = getUint32(data, offset);
 
     switch (_type) {
+        case CommandType::Snapshot:
+            checkSize(size, offset + 8);
+            _tick = getUint32(data, offset);
+            _baselineTick = getUint32(data, offset);
+            _payload.assign(data + offset, data + size);
+            break;
+        case CommandType::SnapshotAck:
+            checkSize(size, offset + 17);
+            _tick = getUint32(data, offset);
+            _viewPosition.x = getFloat(data, offset);
+            _viewPosition.y = getFloat(data, offset);
+            _viewPosition.z = getFloat(data, offset);
+            checkSize(size, offset + 1 + static_cast<uint8_t>(data[offset]));
+            _viewRoom = getString(data, offset);
+            break;
+        case CommandType::Ping:
+        case CommandType::Pong:
+            checkSize(size, offset + 4);
+            _tick = getUint32(data, offset);
+            _payload.assign(data + offset, data + size);
+            break;
         default:
             throw runtime_error("Command: unsupported type: " + to_string(static_cast<int>(_type)));
     }
 }
 
-ByteArray Command::getBytes() const {
-    ByteArray data;
+void Command::serialize(ByteArray &data) const {
     putUint8(static_cast<uint8_t>(_type), data);
     putUint32(_id, data);
 
     switch (_type) {
+        case CommandType::Snapshot:
+            putUint32(_tick, data);
+            putUint32(_baselineTick, data);
+            data.insert(data.end(), _payload.begin(), _payload.end());
+            break;
+        case CommandType::SnapshotAck:
+            putUint32(_tick, data);
+            putFloat(_viewPosition.x, data);
+            putFloat(_viewPosition.y, data);
+            putFloat(_viewPosition.z, data);
+            putString(_viewRoom, data);
+            break;
+        case CommandType::Ping:
+        case CommandType::Pong:
+            putUint32(_tick, data);
+            data.insert(data.end(), _payload.begin(), _payload.end());
+            break;
         default:
             throw runtime_error("Command: unsupported type: " + to_string(static_cast<int>(_type)));
     }
-
-    return move(data);
 }
 
 CommandType Command::type() const {
     return _type;
 }
 
+uint32_t Command::tick() const {
+    return _tick;
+}
+
+uint32_t Command::baselineTick() const {
+    return _baselineTick;
+}
+
+const ByteArray &Command::payload() const {
+    return _payload;
+}
+
+const glm::vec3 &Command::viewPosition() const {
+    return _viewPosition;
+}
+
+const string &Command::viewRoom() const {
+    return _viewRoom;
+}
+
+void Command::setTick(uint32_t tick) {
+    _tick = tick;
+}
+
+void Command::setBaselineTick(uint32_t tick) {
+    _baselineTick = tick;
+}
+
+void Command::setPayload(ByteArray payload) {
+    _payload = move(payload);
+}
+
+void Command::setViewPosition(const glm::vec3 &position) {
+    _viewPosition = position;
+}
+
+void Command::setViewRoom(const string &room) {
+    _viewRoom = room;
+}
+
 } // namespace mp
 
 } // namespace reone
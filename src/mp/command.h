@@ -17,6 +17,11 @@
 
 #pragma once
 
+#include <cstddef>
+#include <string>
+
+#include "glm/vec3.hpp"
+
 #include "../net/command.h"
 
 namespace reone {
@@ -24,7 +29,11 @@ namespace reone {
 namespace mp {
 
 enum class CommandType {
-    None
+    None,
+    Snapshot,
+    SnapshotAck,
+    Ping, /**< server answers with a Pong, echoing the tick and the payload */
+    Pong
 };
 
 class Command : public net::Command {
@@ -32,14 +41,64 @@ public:
     Command() = default;
     Command(uint32_t id, CommandType type);
 
-    void load(const ByteArray &data);
+    /**
+     * @throws std::runtime_error if the data is malformed
+     */
+    void load(const char *data, size_t size);
 
-    ByteArray getBytes() const override;
+    void serialize(ByteArray &data) const override;
 
     CommandType type() const;
 
+    // Snapshots
+
+    /**
+     * @return server tick of the snapshot, or sequence number of the ping
+     */
+    uint32_t tick() const;
+
+    /**
+     * @return server tick of the snapshot, the delta was encoded against, or
+     *         0 if the delta was encoded against an empty snapshot
+     */
+    uint32_t baselineTick() const;
+
+    /**
+     * @return delta-encoded snapshot, or opaque data of the ping
+     */
+    const ByteArray &payload() const;
+
+    void setTick(uint32_t tick);
+    void setBaselineTick(uint32_t tick);
+    void setPayload(ByteArray payload);
+
+    // END Snapshots
+
+    // Snapshot acknowledgements
+
+    /**
+     * @return position of the party leader of the client
+     */
+    const glm::vec3 &viewPosition() const;
+
+    /**
+     * @return name of the room, the party leader of the client is in, or an
+     *         empty string
+     */
+    const std::string &viewRoom() const;
+
+    void setViewPosition(const glm::vec3 &position);
+    void setViewRoom(const std::string &room);
+
+    // END Snapshot acknowledgements
+
 private:
     CommandType _type { CommandType::None };
+    uint32_t _tick { 0 };
+    uint32_t _baselineTick { 0 };
+    ByteArray _payload;
+    glm::vec3 _viewPosition { 0.0f };
+    std::string _viewRoom;
 };
 
 } // namespace mp
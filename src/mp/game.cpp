@@ -17,7 +17,14 @@
 
 #include "game.h"
 
+#include <algorithm>
+
 #include "../common/log.h"
+#include "../game/object/area.h"
+#include "../game/object/module.h"
+#include "../game/object/creature.h"
+#include "../game/object/spatial.h"
+#include "../game/room.h"
 
 #include "util.h"
 
@@ -27,6 +34,7 @@ using namespace std::placeholders;
 using namespace reone::game;
 using namespace reone::net;
 using namespace reone::resource;
+using namespace reone::scene;
 
 namespace fs = boost::filesystem;
 
@@ -34,6 +42,8 @@ namespace reone {
 
 namespace mp {
 
+static const float kReplicationInterval = 1.0f / 30.0f;
+
 MultiplayerGame::MultiplayerGame(MultiplayerMode mode, const fs::path &path, const Options &opts) :
     Game(path, opts), _mode(mode) {
 }
@@ -44,12 +54,10 @@ void MultiplayerGame::init() {
             _server = make_unique<Server>();
             _server->setOnClientConnected(bind(&MultiplayerGame::onClientConnected, this, _1));
             _server->setOnClientDisconnected(bind(&MultiplayerGame::onClientDisconnected, this, _1));
-            _server->setOnCommandReceived(bind(&MultiplayerGame::onCommandReceived, this, _2));
-            _server->start(_options.network.port);
+            _server->start(_options.network.port, _options.network.ioThreads);
             break;
         case MultiplayerMode::Client:
             _client.reset(new Client());
-            _client->setOnCommandReceived(bind(&MultiplayerGame::onCommandReceived, this, _1));
             _client->start(_options.network.host, _options.network.port);
             break;
         default:
@@ -58,41 +66,231 @@ void MultiplayerGame::init() {
     Game::init();
 }
 
-void MultiplayerGame::onClientConnected(const string tag) {
+void MultiplayerGame::onClientConnected(uint32_t client) {
+    _replicator.addClient(client);
 }
 
-void MultiplayerGame::onClientDisconnected(const string tag) {
+void MultiplayerGame::onClientDisconnected(uint32_t client) {
+    _replicator.removeClient(client);
 }
 
-void MultiplayerGame::onCommandReceived(const ByteArray &data) {
+void MultiplayerGame::onCommandReceived(uint32_t client, const char *data, size_t size) {
     Command cmd;
-    cmd.load(data);
+    try {
+        cmd.load(data, size);
+    }
+    catch (const exception &e) {
+        warn("Game: malformed command received: " + string(e.what()));
+        return;
+    }
 
     debug("Game: command received: " + describeCommand(cmd), 2);
 
-    lock_guard<recursive_mutex> lock(_commandsInMutex);
-    _commandsIn.push(cmd);
+    switch (cmd.type()) {
+        case CommandType::Snapshot:
+            processSnapshot(cmd);
+            break;
+        case CommandType::SnapshotAck:
+            processSnapshotAck(client, cmd);
+            break;
+        case CommandType::Ping:
+            processPing(client, cmd);
+            break;
+        default:
+            break;
+    }
 }
 
 void MultiplayerGame::update() {
     processCommands();
     Game::update();
+
+    if (_mode == MultiplayerMode::Server) {
+        replicate();
+    }
 }
 
 void MultiplayerGame::processCommands() {
-    lock_guard<recursive_mutex> lock(_commandsInMutex);
-    while (!_commandsIn.empty()) {
-        const Command &cmd = _commandsIn.front();
-        _commandsIn.pop();
+    // Commands are parsed straight from the network receive buffers
+    switch (_mode) {
+        case MultiplayerMode::Server:
+            _server->poll([this](uint32_t client, const char *data, size_t size) {
+                onCommandReceived(client, data, size);
+            });
+            break;
+        case MultiplayerMode::Client:
+            _client->poll([this](const char *data, size_t size) {
+                onCommandReceived(0, data, size);
+            });
+            break;
+        default:
+            break;
     }
 }
 
-unique_ptr<net::Command> MultiplayerGame::newCommand(CommandType type) {
-    return make_unique<Command>(_cmdCounter++, type);
+void MultiplayerGame::processSnapshot(const Command &cmd) {
+    if (!module()) return;
+
+    WorldSnapshot empty;
+    const WorldSnapshot *baseline = &empty;
+
+    if (cmd.baselineTick() != 0) {
+        baseline = _snapshots.find(cmd.baselineTick());
+        if (!baseline) {
+            warn("Game: snapshot baseline not found: " + to_string(cmd.baselineTick()));
+            return;
+        }
+    }
+    const ByteArray &payload = cmd.payload();
+    BitReader reader(payload.data(), payload.size());
+    WorldSnapshot snapshot;
+    try {
+        snapshot = decodeSnapshotDelta(*baseline, cmd.tick(), reader);
+    }
+    catch (const exception &e) {
+        warn("Game: malformed snapshot dropped: " + string(e.what()));
+        return;
+    }
+
+    applySnapshot(snapshot);
+    _snapshots.add(move(snapshot));
+
+    shared_ptr<Command> ack(newCommand(CommandType::SnapshotAck));
+    ack->setTick(cmd.tick());
+
+    shared_ptr<Creature> partyLeader(party().leader());
+    if (partyLeader) {
+        ack->setViewPosition(partyLeader->position());
+        if (partyLeader->room()) {
+            ack->setViewRoom(partyLeader->room()->name());
+        }
+    }
+    send(ack);
+}
+
+void MultiplayerGame::processSnapshotAck(uint32_t client, const Command &cmd) {
+    _replicator.acknowledge(client, cmd.tick(), cmd.viewPosition(), cmd.viewRoom());
+}
+
+void MultiplayerGame::processPing(uint32_t client, const Command &cmd) {
+    if (_mode != MultiplayerMode::Server) return;
+
+    shared_ptr<Command> pong(newCommand(CommandType::Pong));
+    pong->setTick(cmd.tick());
+    pong->setPayload(cmd.payload());
+    _server->send(client, pong);
+}
+
+void MultiplayerGame::replicate() {
+    if (!module()) return;
+
+    auto now = chrono::steady_clock::now();
+    if (now < _nextReplication) return;
+
+    _nextReplication = now + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<float>(kReplicationInterval));
+
+    updateReplicatedArea();
+
+    WorldSnapshot world;
+    vector<InterestObject> objects;
+    captureSnapshot(world, objects);
+    world.tick = ++_tick;
+
+    _replicator.replicate(world, move(objects), [this, &world](uint32_t client, uint32_t baselineTick, ByteArray payload) {
+        unique_ptr<Command> command(newCommand(CommandType::Snapshot));
+        command->setTick(world.tick);
+        command->setBaselineTick(baselineTick);
+        command->setPayload(move(payload));
+
+        SendBufferPool &pool = SendBufferPool::instance();
+        SendBuffer *frame = pool.serialize(*command);
+        _server->send(client, frame);
+        pool.release(frame);
+    });
 }
 
-void MultiplayerGame::send(const string &client, const shared_ptr<net::Command> &command) {
-    _server->send(client, command);
+void MultiplayerGame::updateReplicatedArea() {
+    shared_ptr<Area> area(module()->area());
+    if (area.get() == _replicatedArea) return;
+
+    vector<string> roomNames;
+    for (auto &room : area->rooms()) {
+        roomNames.push_back(room.first);
+    }
+    _replicator.setRooms(roomNames, area->visibility());
+    _replicatedArea = area.get();
+}
+
+void MultiplayerGame::captureSnapshot(WorldSnapshot &snapshot, vector<InterestObject> &interestObjects) const {
+    shared_ptr<Area> area(module()->area());
+
+    vector<SpatialObject *> objects;
+    objects.reserve(area->objects().size());
+    for (auto &object : area->objects()) {
+        objects.push_back(object.get());
+    }
+    sort(objects.begin(), objects.end(), [](auto &left, auto &right) { return left->id() < right->id(); });
+
+    snapshot.objects.reserve(objects.size());
+    interestObjects.reserve(objects.size());
+
+    for (auto &object : objects) {
+        ObjectState state;
+        state.id = object->id();
+
+        const glm::vec3 &position = object->position();
+        for (int i = 0; i < 3; ++i) {
+            state.position[i] = quantizePosition(position[i]);
+        }
+        state.facing = quantizeFacing(object->facing());
+
+        shared_ptr<ModelSceneNode> model(object->model());
+        if (model) {
+            state.animation = model->animationName();
+            state.animationFlags = model->animationFlags();
+        }
+        state.hitPoints = object->currentHitPoints();
+
+        snapshot.objects.push_back(move(state));
+
+        InterestObject interestObject;
+        interestObject.id = object->id();
+        interestObject.position = position;
+        interestObject.room = object->room() ? _replicator.getRoomIndex(object->room()->name()) : -1;
+
+        interestObjects.push_back(move(interestObject));
+    }
+}
+
+void MultiplayerGame::applySnapshot(const WorldSnapshot &snapshot) {
+    shared_ptr<Area> area(module()->area());
+
+    for (auto &state : snapshot.objects) {
+        shared_ptr<SpatialObject> object(area->find(state.id));
+        if (!object) continue;
+
+        object->setPosition(glm::vec3(
+            dequantizePosition(state.position[0]),
+            dequantizePosition(state.position[1]),
+            dequantizePosition(state.position[2])));
+
+        object->setFacing(dequantizeFacing(state.facing));
+        object->setCurrentHitPoints(state.hitPoints);
+
+        // Restart the animation only when it has changed
+        shared_ptr<ModelSceneNode> model(object->model());
+        if (model && (model->animationName() != state.animation || model->animationFlags() != state.animationFlags)) {
+            if (state.animation.empty()) {
+                model->playDefaultAnimation();
+            } else {
+                model->playAnimation(state.animation, state.animationFlags);
+            }
+        }
+    }
+}
+
+unique_ptr<Command> MultiplayerGame::newCommand(CommandType type) {
+    return make_unique<Command>(_cmdCounter++, type);
 }
 
 void MultiplayerGame::send(const shared_ptr<net::Command> &command) {
@@ -17,7 +17,10 @@
 
 #pragma once
 
+#include <chrono>
+#include <map>
 #include <mutex>
+#include <string>
 
 #include "../game/game.h"
 #include "../game/options.h"
@@ -25,6 +28,8 @@
 #include "../net/server.h"
 
 #include "command.h"
+#include "replication.h"
+#include "replicator.h"
 #include "types.h"
 
 namespace reone {
@@ -44,26 +49,50 @@ private:
     std::unique_ptr<net::Client> _client;
     uint32_t _cmdCounter { 0 };
 
-    // Commands
+    // Replication
 
-    std::queue<Command> _commandsIn;
-    std::recursive_mutex _commandsInMutex;
+    uint32_t _tick { 0 };
+    std::chrono::steady_clock::time_point _nextReplication;
+    SnapshotHistory _snapshots; /**< received snapshots, on a client */
+    Replicator _replicator; /**< on a server */
+    const game::Area *_replicatedArea { nullptr };
 
-    // END Commands
+    // END Replication
 
     void init() override;
     void update() override;
 
     void processCommands();
-    std::unique_ptr<net::Command> newCommand(CommandType type);
+    void processSnapshot(const Command &cmd);
+    void processSnapshotAck(uint32_t client, const Command &cmd);
+    void processPing(uint32_t client, const Command &cmd);
+    std::unique_ptr<Command> newCommand(CommandType type);
     void send(const std::shared_ptr<net::Command> &command);
-    void send(const std::string &client, const std::shared_ptr<net::Command> &command);
+
+    // Replication
+
+    void replicate();
+    void updateReplicatedArea();
+    void applySnapshot(const WorldSnapshot &snapshot);
+
+    /**
+     * Captures state of every object in the current area, along with its
+     * position and room for relevancy filtering.
+     */
+    void captureSnapshot(WorldSnapshot &snapshot, std::vector<InterestObject> &objects) const;
+
+    // END Replication
 
     // Event handlers
 
-    void onClientConnected(const std::string tag);
-    void onClientDisconnected(const std::string tag);
-    void onCommandReceived(const ByteArray &data);
+    void onClientConnected(uint32_t client);
+    void onClientDisconnected(uint32_t client);
+
+    /**
+     * @param client ID of the client that sent the command, 0 if it was sent
+     *               by the server
+     */
+    void onCommandReceived(uint32_t client, const char *data, size_t size);
 
     // END Event handlers
 };
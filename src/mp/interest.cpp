@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "interest.h"
+
+#include <cmath>
+
+#include "glm/geometric.hpp"
+
+using namespace std;
+
+namespace reone {
+
+namespace mp {
+
+static const float kNearDistance = 16.0f;
+static const float kMidDistance = 32.0f;
+static const float kFarDistance = 64.0f;
+static const float kCellSize = kFarDistance;
+
+static const int kNearUpdateInterval = 1; // ticks
+static const int kMidUpdateInterval = 2;
+static const int kFarUpdateInterval = 4;
+
+static int getCellCoord(float val) {
+    return static_cast<int>(floorf(val / kCellSize));
+}
+
+static int64_t getCellKey(int x, int y) {
+    return (static_cast<int64_t>(x) << 32) | static_cast<uint32_t>(y);
+}
+
+void InterestManager::setRooms(const vector<string> &names, const resource::Visibility &visibility) {
+    _roomIndices.clear();
+    _roomCount = static_cast<int>(names.size());
+
+    for (int i = 0; i < _roomCount; ++i) {
+        _roomIndices.insert(make_pair(names[i], i));
+    }
+
+    _roomVisibility.assign(_roomCount * _roomCount, false);
+    for (int i = 0; i < _roomCount; ++i) {
+        _roomVisibility[i * _roomCount + i] = true;
+    }
+    for (auto &pair : visibility) {
+        int from = getRoomIndex(pair.first);
+        int to = getRoomIndex(pair.second);
+        if (from != -1 && to != -1) {
+            _roomVisibility[from * _roomCount + to] = true;
+        }
+    }
+}
+
+void InterestManager::update(vector<InterestObject> objects) {
+    _objects = move(objects);
+
+    // Cell vectors are cleared rather than erased to keep their storage
+    for (auto &cell : _cells) {
+        cell.second.clear();
+    }
+    for (int i = 0; i < static_cast<int>(_objects.size()); ++i) {
+        const glm::vec3 &position = _objects[i].position;
+        _cells[getCellKey(getCellCoord(position.x), getCellCoord(position.y))].push_back(i);
+    }
+}
+
+void InterestManager::getRelevantObjects(const Viewpoint &viewpoint, vector<RelevantObject> &relevant) const {
+    int cellX = getCellCoord(viewpoint.position.x);
+    int cellY = getCellCoord(viewpoint.position.y);
+
+    for (int y = cellY - 1; y <= cellY + 1; ++y) {
+        for (int x = cellX - 1; x <= cellX + 1; ++x) {
+            auto maybeCell = _cells.find(getCellKey(x, y));
+            if (maybeCell == _cells.end()) continue;
+
+            for (int index : maybeCell->second) {
+                const InterestObject &object = _objects[index];
+
+                glm::vec3 delta(object.position - viewpoint.position);
+                float distance2 = glm::dot(delta, delta);
+                bool roomVisible = viewpoint.room == -1 || object.room == -1 || isRoomVisible(viewpoint.room, object.room);
+
+                RelevancyTier tier = getTier(distance2, roomVisible);
+                if (tier == RelevancyTier::None) continue;
+
+                RelevantObject relevantObject;
+                relevantObject.index = index;
+                relevantObject.tier = tier;
+                relevant.push_back(move(relevantObject));
+            }
+        }
+    }
+}
+
+RelevancyTier InterestManager::getTier(float distance2, bool roomVisible) {
+    if (distance2 <= kNearDistance * kNearDistance) return RelevancyTier::Near;
+    if (!roomVisible) return RelevancyTier::None;
+    if (distance2 <= kMidDistance * kMidDistance) return RelevancyTier::Mid;
+    if (distance2 <= kFarDistance * kFarDistance) return RelevancyTier::Far;
+
+    return RelevancyTier::None;
+}
+
+bool InterestManager::isUpdateDue(RelevancyTier tier, uint32_t tick, uint32_t objectId) {
+    switch (tier) {
+        case RelevancyTier::Near:
+            return (tick + objectId) % kNearUpdateInterval == 0;
+        case RelevancyTier::Mid:
+            return (tick + objectId) % kMidUpdateInterval == 0;
+        case RelevancyTier::Far:
+            return (tick + objectId) % kFarUpdateInterval == 0;
+        default:
+            return false;
+    }
+}
+
+bool InterestManager::isRoomVisible(int from, int to) const {
+    return _roomVisibility[from * _roomCount + to];
+}
+
+int InterestManager::getRoomIndex(const string &name) const {
+    auto maybeIndex = _roomIndices.find(name);
+    return maybeIndex != _roomIndices.end() ? maybeIndex->second : -1;
+}
+
+const vector<InterestObject> &InterestManager::objects() const {
+    return _objects;
+}
+
+} // namespace mp
+
+} // namespace reone
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/vec3.hpp"
+
+#include "../resource/types.h"
+
+namespace reone {
+
+namespace mp {
+
+/**
+ * Relevancy of an object to a client. Closer objects are updated more often.
+ */
+enum class RelevancyTier {
+    None,
+    Near,
+    Mid,
+    Far
+};
+
+struct InterestObject {
+    uint32_t id { 0 };
+    glm::vec3 position { 0.0f };
+    int room { -1 }; /**< room index, -1 if unknown */
+};
+
+/**
+ * Point of view of a client, normally its party leader.
+ */
+struct Viewpoint {
+    glm::vec3 position { 0.0f };
+    int room { -1 }; /**< room index, -1 if unknown */
+};
+
+struct RelevantObject {
+    int index { 0 }; /**< index of the object, as passed to InterestManager::update */
+    RelevancyTier tier { RelevancyTier::None };
+};
+
+/**
+ * Decides which objects are relevant to a client and at what rate they are
+ * replicated. Relevancy depends on the distance from the client viewpoint and
+ * on room visibility: objects in rooms that are not visible from the room of
+ * the viewpoint are only relevant at close range.
+ *
+ * Objects are bucketed into a uniform grid on the XY plane, with cells as
+ * large as the relevancy distance, so that a query visits at most nine cells.
+ */
+class InterestManager {
+public:
+    /**
+     * Rebuilds the room index and the room visibility matrix.
+     */
+    void setRooms(const std::vector<std::string> &names, const resource::Visibility &visibility);
+
+    /**
+     * Replaces tracked objects and rebuilds the grid. Called once per
+     * replication tick.
+     */
+    void update(std::vector<InterestObject> objects);
+
+    /**
+     * Appends objects relevant to the viewpoint to the specified vector.
+     */
+    void getRelevantObjects(const Viewpoint &viewpoint, std::vector<RelevantObject> &relevant) const;
+
+    /**
+     * @return room index, or -1 if the room is unknown
+     */
+    int getRoomIndex(const std::string &name) const;
+
+    const std::vector<InterestObject> &objects() const;
+
+    /**
+     * Updates of objects in the same tier are spread evenly between ticks.
+     *
+     * @return true if an object in the specified tier must be updated at the
+     *         specified tick
+     */
+    static bool isUpdateDue(RelevancyTier tier, uint32_t tick, uint32_t objectId);
+
+    static RelevancyTier getTier(float distance2, bool roomVisible);
+
+private:
+    std::unordered_map<std::string, int> _roomIndices;
+    std::vector<bool> _roomVisibility; /**< row-major matrix, from room to room */
+    int _roomCount { 0 };
+
+    std::vector<InterestObject> _objects;
+    std::unordered_map<int64_t, std::vector<int>> _cells; /**< object indices by grid cell */
+
+    bool isRoomVisible(int from, int to) const;
+};
+
+} // namespace mp
+
+} // namespace reone
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "replication.h"
+
+#include <cmath>
+
+#include "glm/gtc/constants.hpp"
+
+using namespace std;
+
+namespace reone {
+
+namespace mp {
+
+static const float kPositionResolution = 1.0f / 128.0f; // world units
+static const int kFacingBits = 12;
+static const size_t kSnapshotHistorySize = 32;
+
+enum ObjectStateField {
+    kFieldPosition = 1,
+    kFieldFacing = 2,
+    kFieldAnimation = 4,
+    kFieldHitPoints = 8,
+    kFieldAll = kFieldPosition | kFieldFacing | kFieldAnimation | kFieldHitPoints
+};
+
+static const int kFieldBits = 4;
+
+bool ObjectState::operator==(const ObjectState &other) const {
+    return
+        id == other.id &&
+        position[0] == other.position[0] &&
+        position[1] == other.position[1] &&
+        position[2] == other.position[2] &&
+        facing == other.facing &&
+        animationFlags == other.animationFlags &&
+        hitPoints == other.hitPoints &&
+        animation == other.animation;
+}
+
+bool ObjectState::operator!=(const ObjectState &other) const {
+    return !(*this == other);
+}
+
+int32_t quantizePosition(float val) {
+    return static_cast<int32_t>(lroundf(val / kPositionResolution));
+}
+
+float dequantizePosition(int32_t val) {
+    return val * kPositionResolution;
+}
+
+uint32_t quantizeFacing(float facing) {
+    float turns = facing / glm::two_pi<float>();
+    turns -= floorf(turns);
+
+    return static_cast<uint32_t>(lroundf(turns * (1 << kFacingBits))) & ((1 << kFacingBits) - 1);
+}
+
+float dequantizeFacing(uint32_t facing) {
+    return facing * glm::two_pi<float>() / (1 << kFacingBits);
+}
+
+static int getChangedFields(const ObjectState *baseline, const ObjectState &state) {
+    if (!baseline) return kFieldAll;
+
+    int fields = 0;
+    if (state.position[0] != baseline->position[0] ||
+        state.position[1] != baseline->position[1] ||
+        state.position[2] != baseline->position[2]) {
+
+        fields |= kFieldPosition;
+    }
+    if (state.facing != baseline->facing) {
+        fields |= kFieldFacing;
+    }
+    if (state.animation != baseline->animation || state.animationFlags != baseline->animationFlags) {
+        fields |= kFieldAnimation;
+    }
+    if (state.hitPoints != baseline->hitPoints) {
+        fields |= kFieldHitPoints;
+    }
+
+    return fields;
+}
+
+static void encodeObject(const ObjectState *baseline, const ObjectState &state, int fields, BitWriter &writer) {
+    writer.putBits(fields, kFieldBits);
+
+    if (fields & kFieldPosition) {
+        for (int i = 0; i < 3; ++i) {
+            writer.putVarInt(state.position[i] - (baseline ? baseline->position[i] : 0));
+        }
+    }
+    if (fields & kFieldFacing) {
+        writer.putBits(state.facing, kFacingBits);
+    }
+    if (fields & kFieldAnimation) {
+        writer.putString(state.animation);
+        writer.putVarUint(state.animationFlags);
+    }
+    if (fields & kFieldHitPoints) {
+        writer.putVarInt(state.hitPoints - (baseline ? baseline->hitPoints : 0));
+    }
+}
+
+static void decodeObject(const ObjectState *baseline, ObjectState &state, BitReader &reader) {
+    if (baseline) {
+        state = *baseline;
+    }
+    int fields = static_cast<int>(reader.getBits(kFieldBits));
+
+    if (fields & kFieldPosition) {
+        for (int i = 0; i < 3; ++i) {
+            state.position[i] = (baseline ? baseline->position[i] : 0) + reader.getVarInt();
+        }
+    }
+    if (fields & kFieldFacing) {
+        state.facing = reader.getBits(kFacingBits);
+    }
+    if (fields & kFieldAnimation) {
+        state.animation = reader.getString();
+        state.animationFlags = static_cast<int>(reader.getVarUint());
+    }
+    if (fields & kFieldHitPoints) {
+        state.hitPoints = (baseline ? baseline->hitPoints : 0) + reader.getVarInt();
+    }
+}
+
+void encodeSnapshotDelta(const WorldSnapshot &baseline, const WorldSnapshot &snapshot, BitWriter &writer) {
+    // Both object lists are sorted by id, so that a single merge pass finds
+    // added, changed and removed objects
+
+    vector<pair<const ObjectState *, const ObjectState *>> changed;
+    vector<uint32_t> removed;
+
+    auto base = baseline.objects.begin();
+    for (auto &state : snapshot.objects) {
+        while (base != baseline.objects.end() && base->id < state.id) {
+            removed.push_back(base->id);
+            ++base;
+        }
+        if (base != baseline.objects.end() && base->id == state.id) {
+            if (*base != state) {
+                changed.push_back(make_pair(&*base, &state));
+            }
+            ++base;
+        } else {
+            changed.push_back(make_pair(nullptr, &state));
+        }
+    }
+    for (; base != baseline.objects.end(); ++base) {
+        removed.push_back(base->id);
+    }
+
+    // Ids are written as differences to the previous id
+
+    writer.putVarUint(static_cast<uint32_t>(changed.size()));
+    uint32_t prevId = 0;
+    for (auto &pair : changed) {
+        const ObjectState &state = *pair.second;
+        writer.putVarUint(state.id - prevId);
+        writer.putBool(pair.first == nullptr);
+        encodeObject(pair.first, state, getChangedFields(pair.first, state), writer);
+        prevId = state.id;
+    }
+
+    writer.putVarUint(static_cast<uint32_t>(removed.size()));
+    prevId = 0;
+    for (auto &id : removed) {
+        writer.putVarUint(id - prevId);
+        prevId = id;
+    }
+}
+
+WorldSnapshot decodeSnapshotDelta(const WorldSnapshot &baseline, uint32_t tick, BitReader &reader) {
+    vector<ObjectState> changed;
+
+    uint32_t changedCount = reader.getVarUint();
+    uint32_t prevId = 0;
+    auto base = baseline.objects.begin();
+
+    for (uint32_t i = 0; i < changedCount; ++i) {
+        uint32_t id = prevId + reader.getVarUint();
+        bool added = reader.getBool();
+
+        while (base != baseline.objects.end() && base->id < id) {
+            ++base;
+        }
+        bool hasBase = !added && base != baseline.objects.end() && base->id == id;
+
+        ObjectState state;
+        decodeObject(hasBase ? &*base : nullptr, state, reader);
+        state.id = id;
+        changed.push_back(move(state));
+
+        prevId = id;
+    }
+
+    vector<uint32_t> removed;
+    uint32_t removedCount = reader.getVarUint();
+    prevId = 0;
+    for (uint32_t i = 0; i < removedCount; ++i) {
+        uint32_t id = prevId + reader.getVarUint();
+        removed.push_back(id);
+        prevId = id;
+    }
+
+    // Merge the baseline with changes, skipping removed objects
+
+    WorldSnapshot snapshot;
+    snapshot.tick = tick;
+    snapshot.objects.reserve(baseline.objects.size() + changed.size());
+
+    auto change = changed.begin();
+    auto remove = removed.begin();
+
+    for (auto &state : baseline.objects) {
+        while (change != changed.end() && change->id < state.id) {
+            snapshot.objects.push_back(move(*change++));
+        }
+        while (remove != removed.end() && *remove < state.id) {
+            ++remove;
+        }
+        if (remove != removed.end() && *remove == state.id) continue;
+
+        if (change != changed.end() && change->id == state.id) {
+            snapshot.objects.push_back(move(*change++));
+        } else {
+            snapshot.objects.push_back(state);
+        }
+    }
+    while (change != changed.end()) {
+        snapshot.objects.push_back(move(*change++));
+    }
+
+    return move(snapshot);
+}
+
+/**
+ * @return baseline state of every object of the snapshot, nullptr if added
+ */
+static vector<const ObjectState *> getBaselineStates(const WorldSnapshot &baseline, const WorldSnapshot &snapshot) {
+    vector<const ObjectState *> result;
+    result.reserve(snapshot.objects.size());
+
+    auto base = baseline.objects.begin();
+    for (auto &state : snapshot.objects) {
+        while (base != baseline.objects.end() && base->id < state.id) {
+            ++base;
+        }
+        bool hasBase = base != baseline.objects.end() && base->id == state.id;
+        result.push_back(hasBase ? &*base : nullptr);
+    }
+
+    return move(result);
+}
+
+int countSnapshotUpdates(const WorldSnapshot &baseline, const WorldSnapshot &snapshot) {
+    vector<const ObjectState *> baseStates(getBaselineStates(baseline, snapshot));
+    int result = 0;
+
+    for (size_t i = 0; i < snapshot.objects.size(); ++i) {
+        if (!baseStates[i] || *baseStates[i] != snapshot.objects[i]) {
+            ++result;
+        }
+    }
+
+    return result;
+}
+
+WorldSnapshot limitSnapshotUpdates(const WorldSnapshot &baseline, const WorldSnapshot &snapshot, int firstUpdate, int maxUpdates) {
+    vector<const ObjectState *> baseStates(getBaselineStates(baseline, snapshot));
+    int updateCount = countSnapshotUpdates(baseline, snapshot);
+
+    WorldSnapshot result;
+    result.tick = snapshot.tick;
+    result.objects.reserve(snapshot.objects.size());
+
+    int update = 0;
+    for (size_t i = 0; i < snapshot.objects.size(); ++i) {
+        const ObjectState &state = snapshot.objects[i];
+        const ObjectState *base = baseStates[i];
+
+        if (base && *base == state) {
+            result.objects.push_back(state);
+            continue;
+        }
+        // Position of this update relative to the first one to keep
+        int order = (update++ - firstUpdate % updateCount + updateCount) % updateCount;
+
+        if (order < maxUpdates) {
+            result.objects.push_back(state);
+        } else if (base) {
+            result.objects.push_back(*base);
+        }
+    }
+
+    return move(result);
+}
+
+void SnapshotHistory::add(WorldSnapshot snapshot) {
+    if (_snapshots.size() < kSnapshotHistorySize) {
+        _snapshots.push_back(move(snapshot));
+        return;
+    }
+    _snapshots[_next] = move(snapshot);
+    _next = (_next + 1) % kSnapshotHistorySize;
+}
+
+void SnapshotHistory::clear() {
+    _snapshots.clear();
+    _next = 0;
+}
+
+const WorldSnapshot *SnapshotHistory::find(uint32_t tick) const {
+    for (auto &snapshot : _snapshots) {
+        if (snapshot.tick == tick) return &snapshot;
+    }
+    return nullptr;
+}
+
+} // namespace mp
+
+} // namespace reone
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "glm/vec3.hpp"
+
+#include "../common/bitstream.h"
+
+namespace reone {
+
+namespace mp {
+
+/**
+ * Replicated state of a single object. Position and facing are quantized.
+ */
+struct ObjectState {
+    uint32_t id { 0 };
+    int32_t position[3] { 0, 0, 0 };
+    uint32_t facing { 0 };
+    std::string animation;
+    int animationFlags { 0 };
+    int hitPoints { 0 };
+
+    bool operator==(const ObjectState &other) const;
+    bool operator!=(const ObjectState &other) const;
+};
+
+/**
+ * State of every replicated object at a single server tick.
+ */
+struct WorldSnapshot {
+    uint32_t tick { 0 };
+    std::vector<ObjectState> objects; /**< sorted by object id */
+};
+
+int32_t quantizePosition(float val);
+float dequantizePosition(int32_t val);
+
+uint32_t quantizeFacing(float facing);
+float dequantizeFacing(uint32_t facing);
+
+/**
+ * Writes objects, that were added or changed since the baseline snapshot,
+ * followed by ids of objects, that were removed. Unchanged objects take no
+ * space, and changed fields are written as differences to the baseline.
+ *
+ * @param baseline snapshot last acknowledged by the client, empty when the
+ *                 client has acknowledged none
+ */
+void encodeSnapshotDelta(const WorldSnapshot &baseline, const WorldSnapshot &snapshot, BitWriter &writer);
+
+/**
+ * Reconstructs the snapshot, encoded by encodeSnapshotDelta.
+ *
+ * @param baseline snapshot the delta was encoded against
+ * @throws std::out_of_range if the data is truncated
+ */
+WorldSnapshot decodeSnapshotDelta(const WorldSnapshot &baseline, uint32_t tick, BitReader &reader);
+
+/**
+ * @return number of objects, that were added or changed since the baseline
+ */
+int countSnapshotUpdates(const WorldSnapshot &baseline, const WorldSnapshot &snapshot);
+
+/**
+ * Limits the number of objects, that were added or changed since the
+ * baseline, so that an oversized snapshot can be spread over several ticks.
+ * Objects beyond the limit keep their baseline state, or are left out if
+ * they were added.
+ *
+ * @param firstUpdate index of the first added or changed object to keep,
+ *                    subsequent ones are kept wrapping around
+ * @param maxUpdates maximum number of added or changed objects to keep
+ */
+WorldSnapshot limitSnapshotUpdates(const WorldSnapshot &baseline, const WorldSnapshot &snapshot, int firstUpdate, int maxUpdates);
+
+/**
+ * Fixed number of most recent snapshots, to be used as baselines.
+ */
+class SnapshotHistory {
+public:
+    void add(WorldSnapshot snapshot);
+    void clear();
+
+    /**
+     * @return snapshot at the specified tick, or nullptr if it is too old
+     */
+    const WorldSnapshot *find(uint32_t tick) const;
+
+private:
+    std::vector<WorldSnapshot> _snapshots;
+    size_t _next { 0 };
+};
+
+} // namespace mp
+
+} // namespace reone
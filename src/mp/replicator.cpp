@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "replicator.h"
+
+#include <algorithm>
+
+#include "../common/log.h"
+
+using namespace std;
+
+namespace reone {
+
+namespace mp {
+
+static const size_t kMaxSnapshotSize = 65000; // bytes, limited by framing
+
+void Replicator::addClient(uint32_t client) {
+    lock_guard<mutex> lock(_clientsMutex);
+    _clients[client] = ClientReplication();
+}
+
+void Replicator::removeClient(uint32_t client) {
+    lock_guard<mutex> lock(_clientsMutex);
+    _clients.erase(client);
+}
+
+void Replicator::setRooms(const vector<string> &names, const resource::Visibility &visibility) {
+    lock_guard<mutex> lock(_clientsMutex);
+    _interest.setRooms(names, visibility);
+
+    for (auto &client : _clients) {
+        ClientReplication &replication = client.second;
+        replication.ackedTick = 0;
+        replication.sentTick = 0;
+        replication.snapshots.clear();
+    }
+}
+
+void Replicator::acknowledge(uint32_t client, uint32_t tick, const glm::vec3 &viewPosition, const string &viewRoom) {
+    lock_guard<mutex> lock(_clientsMutex);
+    auto maybeReplication = _clients.find(client);
+    if (maybeReplication == _clients.end()) return;
+
+    // Acknowledgements can arrive out of order relative to sent snapshots
+    ClientReplication &replication = maybeReplication->second;
+    if (tick < replication.ackedTick) return;
+
+    replication.ackedTick = tick;
+    replication.hasViewpoint = true;
+    replication.viewPosition = viewPosition;
+    replication.viewRoom = viewRoom;
+}
+
+void Replicator::replicate(const WorldSnapshot &world, vector<InterestObject> objects, const SnapshotSender &send) {
+    lock_guard<mutex> lock(_clientsMutex);
+    _interest.update(move(objects));
+
+    for (auto &client : _clients) {
+        replicateTo(client.first, client.second, world, send);
+    }
+}
+
+void Replicator::replicateTo(uint32_t client, ClientReplication &replication, const WorldSnapshot &world, const SnapshotSender &send) {
+    const WorldSnapshot *baseline = replication.ackedTick != 0 ? replication.snapshots.find(replication.ackedTick) : nullptr;
+    const WorldSnapshot *lastSent = replication.sentTick != 0 ? replication.snapshots.find(replication.sentTick) : nullptr;
+
+    WorldSnapshot snapshot;
+    snapshot.tick = world.tick;
+
+    if (replication.hasViewpoint) {
+        Viewpoint viewpoint;
+        viewpoint.position = replication.viewPosition;
+        viewpoint.room = _interest.getRoomIndex(replication.viewRoom);
+
+        _relevant.clear();
+        _interest.getRelevantObjects(viewpoint, _relevant);
+
+        // Interest objects are in the same order as world objects, that is
+        // sorted by id
+        sort(_relevant.begin(), _relevant.end(), [](auto &left, auto &right) { return left.index < right.index; });
+
+        snapshot.objects.reserve(_relevant.size());
+
+        auto sent = lastSent ? lastSent->objects.begin() : vector<ObjectState>::const_iterator();
+        for (auto &object : _relevant) {
+            const ObjectState &state = world.objects[object.index];
+
+            // Objects, that are not due for an update, keep the state that was
+            // last sent to the client
+            if (lastSent && !InterestManager::isUpdateDue(object.tier, world.tick, state.id)) {
+                while (sent != lastSent->objects.end() && sent->id < state.id) {
+                    ++sent;
+                }
+                if (sent != lastSent->objects.end() && sent->id == state.id) {
+                    snapshot.objects.push_back(*sent);
+                    continue;
+                }
+            }
+            snapshot.objects.push_back(state);
+        }
+    }
+
+    WorldSnapshot empty;
+    const WorldSnapshot &base = baseline ? *baseline : empty;
+
+    ByteArray payload(encodeSnapshot(base, snapshot));
+    if (payload.size() > kMaxSnapshotSize) {
+        // Spread updates over several snapshots, halving their number until
+        // the snapshot fits. The first update to send rotates between
+        // snapshots, so that every object is eventually updated.
+
+        int updateCount = countSnapshotUpdates(base, snapshot);
+        int maxUpdates = updateCount;
+        WorldSnapshot limited;
+
+        while (payload.size() > kMaxSnapshotSize && maxUpdates > 1) {
+            maxUpdates /= 2;
+            limited = limitSnapshotUpdates(base, snapshot, replication.nextUpdate, maxUpdates);
+            payload = encodeSnapshot(base, limited);
+        }
+        if (payload.size() > kMaxSnapshotSize) {
+            warn(boost::format("Replicator: snapshot is too large: %d bytes") % payload.size());
+            return;
+        }
+        debug(boost::format("Replicator: snapshot split, %d of %d updates sent") % maxUpdates % updateCount, 2);
+
+        replication.nextUpdate = (replication.nextUpdate + maxUpdates) % updateCount;
+        snapshot = move(limited);
+    }
+    send(client, baseline ? baseline->tick : 0, move(payload));
+
+    replication.sentTick = snapshot.tick;
+    replication.snapshots.add(move(snapshot));
+}
+
+ByteArray Replicator::encodeSnapshot(const WorldSnapshot &baseline, const WorldSnapshot &snapshot) {
+    BitWriter writer;
+    encodeSnapshotDelta(baseline, snapshot, writer);
+
+    ByteArray result;
+    writer.appendTo(result);
+
+    return move(result);
+}
+
+int Replicator::getRoomIndex(const string &name) const {
+    return _interest.getRoomIndex(name);
+}
+
+int Replicator::clientCount() {
+    lock_guard<mutex> lock(_clientsMutex);
+    return static_cast<int>(_clients.size());
+}
+
+} // namespace mp
+
+} // namespace reone
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "glm/vec3.hpp"
+
+#include "../common/types.h"
+#include "../resource/types.h"
+
+#include "interest.h"
+#include "replication.h"
+
+namespace reone {
+
+namespace mp {
+
+/**
+ * Server side of snapshot replication. Keeps a snapshot history per client,
+ * filters objects by relevancy to the client viewpoint and encodes snapshots
+ * as deltas against the last snapshot the client acknowledged.
+ *
+ * Clients may be added, removed and acknowledge snapshots from any thread.
+ */
+class Replicator {
+public:
+    /**
+     * @param client ID of the client
+     * @param baselineTick tick of the baseline snapshot, 0 if none
+     * @param payload delta-encoded snapshot
+     */
+    typedef std::function<void(uint32_t client, uint32_t baselineTick, ByteArray payload)> SnapshotSender;
+
+    /**
+     * Until the client acknowledges a snapshot, reporting its viewpoint, it
+     * receives empty snapshots.
+     */
+    void addClient(uint32_t client);
+
+    void removeClient(uint32_t client);
+
+    /**
+     * Replaces the rooms of the area and resets baselines of all clients, as
+     * snapshots of another area cannot be used as baselines.
+     */
+    void setRooms(const std::vector<std::string> &names, const resource::Visibility &visibility);
+
+    void acknowledge(uint32_t client, uint32_t tick, const glm::vec3 &viewPosition, const std::string &viewRoom);
+
+    /**
+     * Encodes a snapshot for every client.
+     *
+     * @param world states of all objects, sorted by id
+     * @param objects interest objects in the same order as object states
+     * @param send function to pass encoded snapshots to
+     */
+    void replicate(const WorldSnapshot &world, std::vector<InterestObject> objects, const SnapshotSender &send);
+
+    /**
+     * @return room index, or -1 if the room is unknown
+     */
+    int getRoomIndex(const std::string &name) const;
+
+    int clientCount();
+
+private:
+    struct ClientReplication {
+        uint32_t ackedTick { 0 }; /**< 0 if none */
+        uint32_t sentTick { 0 }; /**< 0 if none */
+        bool hasViewpoint { false };
+        glm::vec3 viewPosition { 0.0f };
+        std::string viewRoom;
+        SnapshotHistory snapshots; /**< snapshots sent to the client */
+        int nextUpdate { 0 }; /**< first update to send, if a snapshot must be split */
+    };
+
+    std::map<uint32_t, ClientReplication> _clients;
+    std::mutex _clientsMutex;
+    InterestManager _interest;
+    std::vector<RelevantObject> _relevant; /**< reused between clients */
+
+    void replicateTo(uint32_t client, ClientReplication &replication, const WorldSnapshot &world, const SnapshotSender &send);
+
+    static ByteArray encodeSnapshot(const WorldSnapshot &baseline, const WorldSnapshot &snapshot);
+};
+
+} // namespace mp
+
+} // namespace reone
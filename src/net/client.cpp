@@ -46,9 +46,9 @@ void Client::handleConnect(const boost::system::error_code &ec) {
         error("TCP: connection failed: " + ec.message());
         return;
     }
-    _connection = make_shared<Connection>(_socket);
-    _connection->setOnCommandReceived(_onCommandReceived);
-    _connection->open();
+    auto connection = make_shared<Connection>(_socket);
+    connection->open();
+    atomic_store(&_connection, move(connection));
 }
 
 Client::~Client() {
@@ -58,9 +58,9 @@ Client::~Client() {
 void Client::stop() {
     _service.stop();
 
-    if (_connection) {
-        _connection->close();
-        _connection.reset();
+    shared_ptr<Connection> connection(atomic_exchange(&_connection, shared_ptr<Connection>()));
+    if (connection) {
+        connection->close();
     }
     if (_socket) {
         if (_socket->is_open()) {
@@ -78,11 +78,23 @@ void Client::stop() {
 }
 
 void Client::send(const shared_ptr<Command> &command) {
-    _connection->send(command);
+    shared_ptr<Connection> connection(atomic_load(&_connection));
+    if (!connection) {
+        warn("TCP: not connected");
+        return;
+    }
+    connection->send(command);
 }
 
-void Client::setOnCommandReceived(const function<void(const ByteArray &)> &fn) {
-    _onCommandReceived = fn;
+bool Client::isConnected() const {
+    return static_cast<bool>(atomic_load(&_connection));
+}
+
+void Client::poll(const function<void(const char *, size_t)> &fn) {
+    shared_ptr<Connection> connection(atomic_load(&_connection));
+    if (connection) {
+        connection->poll(fn);
+    }
 }
 
 } // namespace net
@@ -39,14 +39,18 @@ public:
 
     void send(const std::shared_ptr<Command> &command);
 
-    void setOnCommandReceived(const std::function<void(const ByteArray &)> &fn);
+    bool isConnected() const;
+
+    /**
+     * @see Connection::poll
+     */
+    void poll(const std::function<void(const char *, size_t)> &fn);
 
 private:
     boost::asio::io_service _service;
     std::shared_ptr<boost::asio::ip::tcp::socket> _socket;
     std::thread _thread;
-    std::shared_ptr<Connection> _connection;
-    std::function<void(const ByteArray &)> _onCommandReceived;
+    std::shared_ptr<Connection> _connection; /**< set by the network thread, use atomic access */
 
     Client(const Client &) = delete;
     Client &operator=(const Client &) = delete;
@@ -17,6 +17,8 @@
 
 #include "command.h"
 
+using namespace std;
+
 namespace reone {
 
 namespace net {
@@ -24,6 +26,12 @@ namespace net {
 Command::Command(uint32_t id) : _id(id) {
 }
 
+ByteArray Command::getBytes() const {
+    ByteArray data;
+    serialize(data);
+    return move(data);
+}
+
 uint32_t Command::id() const {
     return _id;
 }
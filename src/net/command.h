@@ -31,7 +31,12 @@ public:
     Command(uint32_t id);
     virtual ~Command() = default;
 
-    virtual ByteArray getBytes() const = 0;
+    /**
+     * Appends serialized command to the specified array.
+     */
+    virtual void serialize(ByteArray &data) const = 0;
+
+    ByteArray getBytes() const;
 
     uint32_t id() const;
 
@@ -17,6 +17,8 @@
 
 #include "connection.h"
 
+#include <cstring>
+
 #include <boost/asio.hpp>
 
 #include "../common/log.h"
@@ -30,144 +32,260 @@ namespace reone {
 
 namespace net {
 
-Connection::Connection(shared_ptr<tcp::socket> &socket) : _socket(move(socket)) {
+static const size_t kMaxFramesPerWrite = 256;
+static const size_t kReceiveQueueCapacity = 4096;
+static const size_t kMinReadSize = 16 * 1024;
+static const size_t kMaxFrameSize = kFrameHeaderSize + 0xffff;
+
+static_assert(kMaxFrameSize + kMinReadSize <= kReceiveBlockSize, "Receive block must fit a maximum-size frame");
+
+Connection::Connection(shared_ptr<tcp::socket> &socket) : _socket(move(socket)), _receiveQueue(kReceiveQueueCapacity) {
 }
 
 void Connection::open() {
-    boost::asio::async_read(
-        *_socket,
-        _readBuffer,
-        boost::asio::transfer_exactly(2),
-        bind(&Connection::handleRead, this, _2, _1));
+    _readBlock = ReceiveBlockPool::instance().acquire();
+    startRead();
+}
+
+void Connection::startRead() {
+    prepareReadSpace();
+
+    // Read whatever is available, up to the end of the block: a single read
+    // may complete any number of frames
+    _socket->async_read_some(
+        boost::asio::buffer(&_readBlock->data[_writeOffset], kReceiveBlockSize - _writeOffset),
+        bind(&Connection::handleRead, shared_from_this(), _2, _1));
+}
+
+void Connection::prepareReadSpace() {
+    size_t pending = _writeOffset - _readOffset;
+    bool shared = _readBlock->refCount.load(memory_order_acquire) > 1;
+
+    if (pending == 0 && !shared) {
+        _readOffset = 0;
+        _writeOffset = 0;
+        return;
+    }
+
+    size_t frameEnd = _readOffset + kFrameHeaderSize;
+    if (pending >= kFrameHeaderSize) {
+        const uint8_t *header = reinterpret_cast<const uint8_t *>(&_readBlock->data[_readOffset]);
+        frameEnd += header[0] | (header[1] << 8);
+    }
+    if (frameEnd <= kReceiveBlockSize && kReceiveBlockSize - _writeOffset >= kMinReadSize) return;
+
+    // Move the incomplete frame to the start of a block. The current block is
+    // reused, unless frames handed to the consumer still point into it.
+
+    ReceiveBlockPool &pool = ReceiveBlockPool::instance();
+    ReceiveBlock *block = shared ? pool.acquire() : _readBlock;
+
+    if (pending > 0) {
+        memmove(block->data, &_readBlock->data[_readOffset], pending);
+    }
+    if (block != _readBlock) {
+        pool.release(_readBlock);
+        _readBlock = block;
+    }
+    _readOffset = 0;
+    _writeOffset = pending;
 }
 
 void Connection::handleRead(size_t bytesRead, const boost::system::error_code &ec) {
     if (ec) {
+        if (ec == boost::asio::error::operation_aborted) return;
         if (ec != boost::asio::error::eof) {
             error("Connection: read failed: " + ec.message());
         }
-        if (_onAbort) _onAbort(_tag);
+        if (_onAbort) _onAbort();
         return;
     }
 
-    debug(boost::format("Connection: %d bytes received from %s") % bytesRead % _socket->remote_endpoint(), 3);
+    debug(boost::format("Connection: %d bytes received from %s") % bytesRead % _tag, 3);
 
-    if (_cmdLength == 0) {
-        char buf[2];
-        istream in(&_readBuffer);
-        in.read(buf, 2);
-        _cmdLength = *reinterpret_cast<const uint16_t *>(buf);
+    _writeOffset += bytesRead;
+    continueRead();
+}
 
-        if (_cmdLength == 0) {
-            error("Connection: invalid command length: " + to_string(_cmdLength));
-            if (_onAbort) _onAbort(_tag);
-            return;
-        }
+void Connection::continueRead() {
+    if (!_socket->is_open()) return;
+
+    switch (parseFrames()) {
+        case ParseResult::InvalidFrame:
+            error("Connection: invalid frame received from " + _tag);
+            if (_onAbort) _onAbort();
+            break;
+        case ParseResult::QueueFull:
+            // Reading is resumed by poll, once the consumer catches up
+            _readPaused = true;
+            break;
+        default:
+            startRead();
+            break;
+    }
+}
 
-        boost::asio::async_read(
-            *_socket,
-            _readBuffer,
-            boost::asio::transfer_exactly(_cmdLength),
-            bind(&Connection::handleRead, this, _2, _1));
+Connection::ParseResult Connection::parseFrames() {
+    ReceiveBlockPool &pool = ReceiveBlockPool::instance();
 
-        return;
+    while (_writeOffset - _readOffset >= kFrameHeaderSize) {
+        const uint8_t *header = reinterpret_cast<const uint8_t *>(&_readBlock->data[_readOffset]);
+        size_t length = header[0] | (header[1] << 8);
+        if (length == 0) return ParseResult::InvalidFrame;
+        if (_writeOffset - _readOffset < kFrameHeaderSize + length) break;
+
+        ReceivedFrame frame;
+        frame.block = _readBlock;
+        frame.data = &_readBlock->data[_readOffset + kFrameHeaderSize];
+        frame.size = length;
+
+        pool.addRef(_readBlock);
+        if (!_receiveQueue.push(frame)) {
+            pool.release(_readBlock);
+            return ParseResult::QueueFull;
+        }
+        _readOffset += kFrameHeaderSize + length;
     }
 
-    ByteArray arr(_cmdLength);
-    istream in(&_readBuffer);
-    in.read(&arr[0], _cmdLength);
-    _cmdLength = 0;
+    return ParseResult::NeedMore;
+}
+
+void Connection::poll(const function<void(const char *, size_t)> &fn) {
+    ReceiveBlockPool &pool = ReceiveBlockPool::instance();
+    ReceivedFrame frame;
+
+    while (_receiveQueue.pop(frame)) {
+        try {
+            fn(frame.data, frame.size);
+        }
+        catch (const exception &) {
+            pool.release(frame.block);
+            throw;
+        }
+        pool.release(frame.block);
+    }
+    if (_readPaused.exchange(false)) {
+        boost::asio::post(_socket->get_executor(), bind(&Connection::continueRead, shared_from_this()));
+    }
+}
 
-    if (_onCommandReceived) _onCommandReceived(arr);
+void Connection::releaseReceiveBuffers() {
+    ReceiveBlockPool &pool = ReceiveBlockPool::instance();
+    ReceivedFrame frame;
 
-    boost::asio::async_read(
-        *_socket,
-        _readBuffer,
-        boost::asio::transfer_exactly(2),
-        bind(&Connection::handleRead, this, _2, _1));
+    while (_receiveQueue.pop(frame)) {
+        pool.release(frame.block);
+    }
+    if (_readBlock) {
+        pool.release(_readBlock);
+        _readBlock = nullptr;
+    }
 }
 
 Connection::~Connection() {
     close();
+    releaseReceiveBuffers();
+    releaseSendBuffers();
 }
 
 void Connection::close() {
-    if (!_socket) return;
+    if (!_socket->is_open()) return;
 
-    if (_socket->is_open()) {
-        try {
-            _socket->close();
-        }
-        catch (const boost::system::system_error &) {
-        }
+    try {
+        _socket->close();
+    }
+    catch (const boost::system::system_error &) {
     }
-    _socket.reset();
 }
 
 void Connection::send(const shared_ptr<Command> &command) {
-    lock_guard<recursive_mutex> lock(_cmdOutMutex);
-    _cmdOut.push_back(command);
+    SendBufferPool &pool = SendBufferPool::instance();
+    SendBuffer *buffer = pool.serialize(*command);
+    send(buffer);
+    pool.release(buffer);
+}
 
-    if (_cmdOut.size() == 1) {
-        doSend(*command);
+void Connection::send(SendBuffer *buffer) {
+    _sendQueue.push(SendBufferPool::instance().acquireEntry(buffer));
+
+    if (!_writing.exchange(true)) {
+        boost::asio::post(_socket->get_executor(), bind(&Connection::startWrite, shared_from_this()));
     }
 }
 
-void Connection::doSend(const Command &command) {
-    ByteArray data(command.getBytes());
-    int cmdLength = static_cast<int>(data.size());
-    data.insert(data.begin(), (cmdLength >> 8) & 0xff);
-    data.insert(data.begin(), cmdLength & 0xff);
+void Connection::startWrite() {
+    _writeBuffers.clear();
+
+    while (_inFlight.size() < kMaxFramesPerWrite) {
+        SendQueueEntry *entry = _sendQueue.pop();
+        if (!entry) break;
+
+        _inFlight.push_back(entry);
+        _writeBuffers.push_back(boost::asio::buffer(entry->buffer->data));
+    }
+    if (_inFlight.empty()) {
+        _writing = false;
 
-    shared_ptr<boost::asio::streambuf> buffer(new boost::asio::streambuf());
-    ostream out(buffer.get());
-    out.write(&data[0], data.size());
+        // Frames queued after the last pop, but before the flag was cleared,
+        // would otherwise wait for the next send
+        if (!_sendQueue.empty() && !_writing.exchange(true)) {
+            boost::asio::post(_socket->get_executor(), bind(&Connection::startWrite, shared_from_this()));
+        }
+        return;
+    }
 
-    boost::asio::async_write(
-        *_socket,
-        *buffer,
-        bind(&Connection::handleWrite, this, command.id(), buffer, _1));
+    boost::asio::async_write(*_socket, _writeBuffers, bind(&Connection::handleWrite, shared_from_this(), _1));
 }
 
-void Connection::handleWrite(uint32_t commandId, shared_ptr<boost::asio::streambuf> &buffer, const boost::system::error_code &ec) {
-    buffer.reset();
+void Connection::handleWrite(const boost::system::error_code &ec) {
+    for (auto &entry : _inFlight) {
+        SendBufferPool::instance().releaseEntry(entry);
+    }
+    _inFlight.clear();
 
     if (ec) {
+        if (ec == boost::asio::error::operation_aborted) return;
         error("Connection: write failed: " + ec.message());
         if (_onAbort) {
-            _onAbort(_tag);
+            _onAbort();
         }
+        return;
     }
-    lock_guard<recursive_mutex> lock(_cmdOutMutex);
-    auto command = find_if(
-        _cmdOut.begin(),
-        _cmdOut.end(),
-        [&commandId](const shared_ptr<Command> &cmd) { return cmd->id() == commandId; });
 
-    if (command != _cmdOut.end()) {
-        _cmdOut.erase(command);
+    startWrite();
+}
+
+void Connection::releaseSendBuffers() {
+    for (auto &entry : _inFlight) {
+        SendBufferPool::instance().releaseEntry(entry);
     }
-    if (!_cmdOut.empty()) {
-        doSend(*_cmdOut.front());
+    _inFlight.clear();
+
+    for (SendQueueEntry *entry = _sendQueue.pop(); entry; entry = _sendQueue.pop()) {
+        SendBufferPool::instance().releaseEntry(entry);
     }
 }
 
+uint32_t Connection::id() const {
+    return _id;
+}
+
 const string &Connection::tag() const {
     return _tag;
 }
 
+void Connection::setId(uint32_t id) {
+    _id = id;
+}
+
 void Connection::setTag(const string &tag) {
     _tag = tag;
 }
 
-void Connection::setOnAbort(const function<void(const string &)> &fn) {
+void Connection::setOnAbort(const function<void()> &fn) {
     _onAbort = fn;
 }
 
-void Connection::setOnCommandReceived(const function<void(const ByteArray &)> &fn) {
-    _onCommandReceived = fn;
-}
-
 } // namespace net
 
 } // namespace reone
@@ -17,24 +17,35 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
-#include <mutex>
+#include <memory>
 #include <vector>
 
+#include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
-#include <boost/asio/streambuf.hpp>
 #include <boost/system/error_code.hpp>
 
+#include "../common/mpscqueue.h"
+#include "../common/spscqueue.h"
 #include "../common/types.h"
 
 #include "command.h"
+#include "receivebuffer.h"
+#include "sendbuffer.h"
 #include "types.h"
 
 namespace reone {
 
 namespace net {
 
-class Connection {
+/**
+ * Framed TCP connection. Must be owned by a shared pointer: pending
+ * asynchronous operations keep the connection alive. Completion handlers are
+ * dispatched through the executor of the socket, which must be a strand if
+ * the I/O context is run by several threads.
+ */
+class Connection : public std::enable_shared_from_this<Connection> {
 public:
     Connection(std::shared_ptr<boost::asio::ip::tcp::socket> &socket);
     ~Connection();
@@ -42,40 +53,87 @@ public:
     void open();
     void close();
 
+    /**
+     * Serializes the command and queues it for sending. Thread-safe. Frames
+     * queued while a write is in flight are sent together by the next write.
+     */
     void send(const std::shared_ptr<Command> &command);
 
+    /**
+     * Queues a serialized frame for sending, adding a reference to it. Allows
+     * sending the same buffer to many connections. Thread-safe.
+     */
+    void send(SendBuffer *buffer);
+
+    /**
+     * Passes every frame received since the previous call to the specified
+     * function. Payloads point into the receive buffer and are only valid
+     * during the call. Must only be called from one thread at a time.
+     */
+    void poll(const std::function<void(const char *, size_t)> &fn);
+
+    uint32_t id() const;
     const std::string &tag() const;
 
+    void setId(uint32_t id);
     void setTag(const std::string &tag);
 
     // Callbacks
 
-    void setOnAbort(const std::function<void(const std::string &)> &fn);
-    void setOnCommandReceived(const std::function<void(const ByteArray &)> &fn);
+    void setOnAbort(const std::function<void()> &fn);
 
     // END Callbacks
 
 private:
+    enum class ParseResult {
+        NeedMore,
+        QueueFull,
+        InvalidFrame
+    };
+
     std::shared_ptr<boost::asio::ip::tcp::socket> _socket;
-    std::string _tag;
-    boost::asio::streambuf _readBuffer;
-    int _cmdLength { 0 };
-    std::vector<std::shared_ptr<Command>> _cmdOut;
-    std::recursive_mutex _cmdOutMutex;
+    uint32_t _id { 0 };
+    std::string _tag; /**< remote endpoint, for logging */
+
+    // Receiving
+
+    ReceiveBlock *_readBlock { nullptr };
+    size_t _readOffset { 0 }; /**< start of the first unparsed frame */
+    size_t _writeOffset { 0 }; /**< end of received data */
+    SpscQueue<ReceivedFrame> _receiveQueue;
+    std::atomic_bool _readPaused { false }; /**< reading stopped until the consumer drains the receive queue */
+
+    // END Receiving
+
+    // Sending
+
+    MpscQueue<SendQueueEntry> _sendQueue;
+    std::atomic_bool _writing { false }; /**< a write is in flight or scheduled */
+    std::vector<SendQueueEntry *> _inFlight;
+    std::vector<boost::asio::const_buffer> _writeBuffers;
+
+    // END Sending
 
     // Callbacks
 
-    std::function<void(const std::string &)> _onAbort;
-    std::function<void(const ByteArray &)> _onCommandReceived;
+    std::function<void()> _onAbort;
 
     // END Callbacks
 
     Connection(const Connection &) = delete;
     Connection &operator=(const Connection &) = delete;
 
-    void doSend(const Command &command);
+    void startRead();
     void handleRead(size_t bytesRead, const boost::system::error_code &ec);
-    void handleWrite(uint32_t commandId, std::shared_ptr<boost::asio::streambuf> &buffer, const boost::system::error_code &ec);
+    void continueRead();
+    void prepareReadSpace();
+    void releaseReceiveBuffers();
+
+    ParseResult parseFrames();
+
+    void startWrite();
+    void handleWrite(const boost::system::error_code &ec);
+    void releaseSendBuffers();
 };
 
 } // namespace net
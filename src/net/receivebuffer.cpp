@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "receivebuffer.h"
+
+using namespace std;
+
+namespace reone {
+
+namespace net {
+
+static const size_t kMaxPooledBlockCount = 16;
+
+ReceiveBlockPool &ReceiveBlockPool::instance() {
+    static ReceiveBlockPool instance;
+    return instance;
+}
+
+ReceiveBlock *ReceiveBlockPool::acquire() {
+    unique_ptr<ReceiveBlock> block;
+    {
+        lock_guard<mutex> lock(_mutex);
+        if (!_free.empty()) {
+            block = move(_free.back());
+            _free.pop_back();
+        }
+    }
+    if (!block) {
+        block = make_unique<ReceiveBlock>();
+    }
+    block->refCount.store(1, memory_order_relaxed);
+
+    return block.release();
+}
+
+void ReceiveBlockPool::addRef(ReceiveBlock *block) {
+    block->refCount.fetch_add(1, memory_order_relaxed);
+}
+
+void ReceiveBlockPool::release(ReceiveBlock *block) {
+    if (block->refCount.fetch_sub(1, memory_order_acq_rel) != 1) return;
+
+    unique_ptr<ReceiveBlock> owned(block);
+
+    lock_guard<mutex> lock(_mutex);
+    if (_free.size() < kMaxPooledBlockCount) {
+        _free.push_back(move(owned));
+    }
+}
+
+} // namespace net
+
+} // namespace reone
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace reone {
+
+namespace net {
+
+/**
+ * Large enough to hold several maximum-size frames, so that a block is only
+ * replaced once every few hundred kilobytes received.
+ */
+const size_t kReceiveBlockSize = 256 * 1024;
+
+/**
+ * Block of memory that a connection reads into. Received frames are not
+ * copied out of it: each frame handed to the consumer holds a reference to
+ * the block, which is returned to the pool when the last reference is gone.
+ */
+struct ReceiveBlock {
+    std::atomic_int refCount { 0 };
+    char data[kReceiveBlockSize];
+};
+
+/**
+ * View of a frame payload inside a receive block. The consumer must pass the
+ * block to ReceiveBlockPool::release once it is done with the payload.
+ */
+struct ReceivedFrame {
+    ReceiveBlock *block { nullptr };
+    const char *data { nullptr };
+    size_t size { 0 };
+};
+
+class ReceiveBlockPool {
+public:
+    static ReceiveBlockPool &instance();
+
+    /**
+     * @return block with a single reference, owned by the caller
+     */
+    ReceiveBlock *acquire();
+
+    void addRef(ReceiveBlock *block);
+
+    /**
+     * Drops a reference to the block, returning it to the pool if it was the
+     * last one.
+     */
+    void release(ReceiveBlock *block);
+
+private:
+    std::vector<std::unique_ptr<ReceiveBlock>> _free;
+    std::mutex _mutex;
+
+    ReceiveBlockPool() = default;
+    ReceiveBlockPool(const ReceiveBlockPool &) = delete;
+    ReceiveBlockPool &operator=(const ReceiveBlockPool &) = delete;
+};
+
+} // namespace net
+
+} // namespace reone
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sendbuffer.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "../common/mpscqueue.h"
+
+using namespace std;
+
+namespace reone {
+
+namespace net {
+
+static const size_t kMaxPooledBufferCount = 1024;
+static const size_t kMaxPooledBufferCapacity = 64 * 1024;
+static const size_t kInitialBufferCapacity = 256;
+static const size_t kMaxPooledEntryCount = 4096;
+
+void SendBuffer::finish() {
+    size_t length = data.size() - kFrameHeaderSize;
+    if (length == 0 || length > 0xffff) {
+        throw length_error("Invalid frame length: " + to_string(length));
+    }
+    data[0] = static_cast<char>(length & 0xff);
+    data[1] = static_cast<char>((length >> 8) & 0xff);
+}
+
+/**
+ * Free buffers and entries of a single thread.
+ */
+struct SendBufferCache {
+    vector<SendBuffer *> buffers;
+    vector<SendQueueEntry *> entries;
+    MpscQueue<SendBuffer> returnedBuffers; /**< released on other threads */
+    MpscQueue<SendQueueEntry> returnedEntries; /**< released on other threads */
+
+    ~SendBufferCache() {
+        for (SendBuffer *buffer = returnedBuffers.pop(); buffer; buffer = returnedBuffers.pop()) {
+            buffers.push_back(buffer);
+        }
+        for (SendQueueEntry *entry = returnedEntries.pop(); entry; entry = returnedEntries.pop()) {
+            entries.push_back(entry);
+        }
+        for (auto &buffer : buffers) {
+            delete buffer;
+        }
+        for (auto &entry : entries) {
+            delete entry;
+        }
+    }
+};
+
+/**
+ * Orphans the cache of the thread on thread exit.
+ */
+struct ThreadCacheHolder {
+    SendBufferCache *cache { nullptr };
+
+    ~ThreadCacheHolder() {
+        if (cache) {
+            SendBufferPool::instance().orphanCache(cache);
+        }
+    }
+};
+
+static thread_local ThreadCacheHolder g_threadCache;
+
+/**
+ * Pops a free item, taking items released on other threads if there are no
+ * local ones.
+ *
+ * @return free item, or nullptr if there is none
+ */
+template <class T>
+static T *popFree(vector<T *> &local, MpscQueue<T> &returned, size_t maxCount) {
+    if (local.empty()) {
+        for (T *item = returned.pop(); item; item = returned.pop()) {
+            if (local.size() < maxCount) {
+                local.push_back(item);
+            } else {
+                delete item;
+            }
+        }
+    }
+    if (local.empty()) return nullptr;
+
+    T *result = local.back();
+    local.pop_back();
+
+    return result;
+}
+
+/**
+ * Returns the item to its cache: directly, if released on the thread owning
+ * the cache, or through the lock-free queue otherwise.
+ */
+template <class T>
+static void pushFree(T *item, vector<T *> &local, MpscQueue<T> &returned, size_t maxCount) {
+    if (g_threadCache.cache != item->home) {
+        returned.push(item);
+        return;
+    }
+    if (local.size() < maxCount) {
+        local.push_back(item);
+    } else {
+        delete item;
+    }
+}
+
+SendBufferPool &SendBufferPool::instance() {
+    static SendBufferPool instance;
+    return instance;
+}
+
+SendBufferPool::~SendBufferPool() {
+}
+
+SendBufferCache &SendBufferPool::getThreadCache() {
+    if (g_threadCache.cache) {
+        return *g_threadCache.cache;
+    }
+    lock_guard<mutex> lock(_cachesMutex);
+    if (_orphanedCaches.empty()) {
+        _caches.push_back(make_unique<SendBufferCache>());
+        g_threadCache.cache = _caches.back().get();
+    } else {
+        g_threadCache.cache = _orphanedCaches.back();
+        _orphanedCaches.pop_back();
+    }
+
+    return *g_threadCache.cache;
+}
+
+void SendBufferPool::orphanCache(SendBufferCache *cache) {
+    lock_guard<mutex> lock(_cachesMutex);
+    _orphanedCaches.push_back(cache);
+}
+
+SendBuffer *SendBufferPool::acquire() {
+    SendBufferCache &cache = getThreadCache();
+
+    SendBuffer *buffer = popFree(cache.buffers, cache.returnedBuffers, kMaxPooledBufferCount);
+    if (!buffer) {
+        buffer = new SendBuffer();
+        buffer->data.reserve(kInitialBufferCapacity);
+        buffer->home = &cache;
+    }
+    buffer->refCount.store(1, memory_order_relaxed);
+    buffer->data.resize(kFrameHeaderSize);
+
+    return buffer;
+}
+
+SendBuffer *SendBufferPool::serialize(const Command &command) {
+    SendBuffer *buffer = acquire();
+    try {
+        command.serialize(buffer->data);
+        buffer->finish();
+    }
+    catch (const exception &) {
+        release(buffer);
+        throw;
+    }
+    return buffer;
+}
+
+void SendBufferPool::addRef(SendBuffer *buffer) {
+    buffer->refCount.fetch_add(1, memory_order_relaxed);
+}
+
+void SendBufferPool::release(SendBuffer *buffer) {
+    if (buffer->refCount.fetch_sub(1, memory_order_acq_rel) != 1) return;
+
+    // Occasional large frames should not pin their storage forever
+    if (buffer->data.capacity() > kMaxPooledBufferCapacity) {
+        delete buffer;
+        return;
+    }
+    buffer->data.clear();
+
+    SendBufferCache &home = *buffer->home;
+    pushFree(buffer, home.buffers, home.returnedBuffers, kMaxPooledBufferCount);
+}
+
+SendQueueEntry *SendBufferPool::acquireEntry(SendBuffer *buffer) {
+    SendBufferCache &cache = getThreadCache();
+
+    SendQueueEntry *entry = popFree(cache.entries, cache.returnedEntries, kMaxPooledEntryCount);
+    if (!entry) {
+        entry = new SendQueueEntry();
+        entry->home = &cache;
+    }
+    addRef(buffer);
+    entry->buffer = buffer;
+
+    return entry;
+}
+
+void SendBufferPool::releaseEntry(SendQueueEntry *entry) {
+    release(entry->buffer);
+    entry->buffer = nullptr;
+
+    SendBufferCache &home = *entry->home;
+    pushFree(entry, home.entries, home.returnedEntries, kMaxPooledEntryCount);
+}
+
+} // namespace net
+
+} // namespace reone
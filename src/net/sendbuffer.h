@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../common/types.h"
+
+#include "command.h"
+
+namespace reone {
+
+namespace net {
+
+/**
+ * Size of the length prefix of every frame.
+ */
+const int kFrameHeaderSize = 2;
+
+struct SendBufferCache;
+
+/**
+ * Serialized outbound frame. Data starts with space for the frame header,
+ * which is filled in place once the payload is written. A buffer is shared by
+ * every connection it is sent to, and is returned to the pool when the last
+ * reference is gone.
+ */
+struct SendBuffer {
+    std::atomic_int refCount { 0 };
+    ByteArray data;
+    SendBufferCache *home { nullptr }; /**< cache of the thread that allocated the buffer */
+    std::atomic<SendBuffer *> next { nullptr }; /**< used while the buffer is returned to its cache */
+
+    /**
+     * Writes the payload length into the reserved header space.
+     *
+     * @throws std::length_error if the payload does not fit into a frame
+     */
+    void finish();
+};
+
+/**
+ * Node of the send queue of a single connection, referencing a buffer.
+ */
+struct SendQueueEntry {
+    std::atomic<SendQueueEntry *> next { nullptr };
+    SendBuffer *buffer { nullptr };
+    SendBufferCache *home { nullptr }; /**< cache of the thread that allocated the entry */
+};
+
+/**
+ * Recycles send buffers, so that their storage is allocated once and reused
+ * for subsequent frames.
+ *
+ * Every thread that acquires buffers and entries has its own cache of free
+ * ones. Buffers and entries released on another thread, e.g. on write
+ * completion, are pushed back to the cache they came from through a
+ * lock-free queue, which only the owning thread drains. The mutex is only
+ * taken when a thread acquires for the first time or exits.
+ */
+class SendBufferPool {
+public:
+    static SendBufferPool &instance();
+
+    /**
+     * @return empty buffer with header space reserved and a single reference,
+     *         owned by the caller
+     */
+    SendBuffer *acquire();
+
+    /**
+     * @return buffer with the serialized command, ready to be sent, and a
+     *         single reference, owned by the caller
+     */
+    SendBuffer *serialize(const Command &command);
+
+    void addRef(SendBuffer *buffer);
+
+    /**
+     * Drops a reference to the buffer, returning it to the pool if it was the
+     * last one.
+     */
+    void release(SendBuffer *buffer);
+
+    /**
+     * @return queue entry, holding a reference to the specified buffer
+     */
+    SendQueueEntry *acquireEntry(SendBuffer *buffer);
+
+    /**
+     * Returns the entry to the pool and drops its reference to the buffer.
+     */
+    void releaseEntry(SendQueueEntry *entry);
+
+private:
+    std::vector<std::unique_ptr<SendBufferCache>> _caches; /**< caches of all threads */
+    std::vector<SendBufferCache *> _orphanedCaches; /**< caches of exited threads, to be reused */
+    std::mutex _cachesMutex;
+
+    SendBufferPool() = default;
+    SendBufferPool(const SendBufferPool &) = delete;
+    SendBufferPool &operator=(const SendBufferPool &) = delete;
+
+    ~SendBufferPool();
+
+    /**
+     * @return cache of the calling thread, created or adopted on first call
+     */
+    SendBufferCache &getThreadCache();
+
+    /**
+     * Makes the cache of an exiting thread available to other threads.
+     */
+    void orphanCache(SendBufferCache *cache);
+
+    friend struct ThreadCacheHolder;
+};
+
+} // namespace net
+
+} // namespace reone
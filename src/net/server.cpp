@@ -17,6 +17,10 @@
 
 #include "server.h"
 
+#include <algorithm>
+
+#include <boost/asio/strand.hpp>
+
 #include "../common/log.h"
 
 using namespace std;
@@ -32,54 +36,79 @@ namespace reone {
 
 namespace net {
 
-void Server::start(int port) {
-    info("Starting TCP server on port: " + to_string(port));
+static const int kMaxThreadCount = 8;
 
-    shared_ptr<tcp::socket> socket(new tcp::socket(_service));
+void Server::start(int port, int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = max(1, min(static_cast<int>(thread::hardware_concurrency()), kMaxThreadCount));
+    }
+    info(boost::format("Starting TCP server on port %d with %d threads") % port % threadCount);
 
     _acceptor = make_unique<tcp::acceptor>(_service, tcp::endpoint(ip::address_v4::any(), port));
-    _acceptor->async_accept(*socket, bind(&Server::handleAccept, this, socket, _1));
+    startAccept();
 
-    _thread = thread([this]() { _service.run(); });
+    for (int i = 0; i < threadCount; ++i) {
+        _threads.push_back(thread([this]() { _service.run(); }));
+    }
+}
+
+void Server::startAccept() {
+    // Every socket gets its own strand, so that handlers of different clients
+    // run in parallel, while handlers of a single client never do
+    shared_ptr<tcp::socket> socket(new tcp::socket(boost::asio::make_strand(_service)));
+    _acceptor->async_accept(*socket, bind(&Server::handleAccept, this, socket, _1));
 }
 
 void Server::handleAccept(shared_ptr<tcp::socket> &socket, const boost::system::error_code &ec) {
     if (ec) {
-        error("TCP: accept failed: " + ec.message());
+        if (ec != boost::asio::error::operation_aborted) {
+            error("TCP: accept failed: " + ec.message());
+        }
         return;
     }
 
+    uint32_t id = _nextClientId++;
     string tag(str(boost::format("%s") % socket->remote_endpoint()));
-    info("TCP: client connected: " + tag);
+    info(boost::format("TCP: client %d connected: %s") % id % tag);
 
-    unique_ptr<Connection> client(new Connection(socket));
+    auto client = make_shared<Connection>(socket);
+    client->setId(id);
     client->setTag(tag);
-    client->setOnAbort([this, &client](const string &tag) { stopClient(tag); });
-    client->setOnCommandReceived([this, tag](const ByteArray &data) {
-        _onCommandReceived(tag, data);
-    });
-    client->open();
-    _clients.insert(make_pair(tag, move(client)));
+    client->setOnAbort([this, id]() { stopClient(id); });
 
+    // The client must be registered before it can abort
+    {
+        ClientShard &shard = getShard(id);
+        lock_guard<mutex> lock(shard.mutex);
+        shard.clients.insert(make_pair(id, client));
+    }
     if (_onClientConnected) {
-        _onClientConnected(tag);
+        _onClientConnected(id);
     }
+    client->open();
 
-    shared_ptr<tcp::socket> nextSocket(new tcp::socket(_service));
-    _acceptor->async_accept(*nextSocket, bind(&Server::handleAccept, this, nextSocket, _1));
+    startAccept();
 }
 
-void Server::stopClient(const string &tag) {
-    info(boost::format("TCP: client disconnected: %s") % tag);
+void Server::stopClient(uint32_t id) {
+    shared_ptr<Connection> client;
+    {
+        ClientShard &shard = getShard(id);
+        lock_guard<mutex> lock(shard.mutex);
 
-    Connection &client = *_clients.find(tag)->second;
-    client.close();
+        auto maybeClient = shard.clients.find(id);
+        if (maybeClient == shard.clients.end()) return;
 
-    if (_onClientDisconnected) {
-        _onClientDisconnected(tag);
+        client = move(maybeClient->second);
+        shard.clients.erase(maybeClient);
     }
+    info(boost::format("TCP: client %d disconnected: %s") % id % client->tag());
 
-    _clients.erase(tag);
+    client->close();
+
+    if (_onClientDisconnected) {
+        _onClientDisconnected(id);
+    }
 }
 
 Server::~Server() {
@@ -89,9 +118,11 @@ Server::~Server() {
 void Server::stop() {
     _service.stop();
 
-    if (_thread.joinable()) {
-        _thread.join();
+    for (auto &thread : _threads) {
+        thread.join();
     }
+    _threads.clear();
+
     if (_acceptor) {
         if (_acceptor->is_open()) {
             try {
@@ -103,41 +134,83 @@ void Server::stop() {
         _acceptor.reset();
     }
 
-    for (auto &client : _clients) {
-        client.second->close();
+    for (auto &shard : _shards) {
+        lock_guard<mutex> lock(shard.mutex);
+        for (auto &client : shard.clients) {
+            client.second->close();
+        }
+        shard.clients.clear();
     }
-    _clients.clear();
 }
 
-void Server::send(const string &tag, const shared_ptr<Command> &command) {
-    auto maybeClient = _clients.find(tag);
-    if (maybeClient == _clients.end()) {
-        warn("TCP: invalid client: " + tag);
+void Server::send(uint32_t id, const shared_ptr<Command> &command) {
+    SendBufferPool &pool = SendBufferPool::instance();
+    SendBuffer *buffer = pool.serialize(*command);
+    send(id, buffer);
+    pool.release(buffer);
+}
+
+void Server::send(uint32_t id, SendBuffer *buffer) {
+    ClientShard &shard = getShard(id);
+    lock_guard<mutex> lock(shard.mutex);
+
+    auto maybeClient = shard.clients.find(id);
+    if (maybeClient == shard.clients.end()) {
+        warn("TCP: invalid client: " + to_string(id));
         return;
     }
-    maybeClient->second->send(command);
+    maybeClient->second->send(buffer);
 }
 
 void Server::sendToAll(const shared_ptr<Command> &command) {
-    for (auto &client : _clients) {
-        client.second->send(command);
+    SendBufferPool &pool = SendBufferPool::instance();
+    SendBuffer *buffer = pool.serialize(*command);
+
+    for (auto &shard : _shards) {
+        lock_guard<mutex> lock(shard.mutex);
+        for (auto &client : shard.clients) {
+            client.second->send(buffer);
+        }
     }
+
+    pool.release(buffer);
 }
 
-const ServerClients &Server::clients() const {
-    return _clients;
+void Server::poll(const function<void(uint32_t, const char *, size_t)> &fn) {
+    // Frames are processed without holding locks, so that the callback is free
+    // to send commands
+    for (auto &shard : _shards) {
+        lock_guard<mutex> lock(shard.mutex);
+        for (auto &client : shard.clients) {
+            _pollClients.push_back(client.second);
+        }
+    }
+    for (auto &client : _pollClients) {
+        uint32_t id = client->id();
+        client->poll([&fn, &id](const char *data, size_t size) { fn(id, data, size); });
+    }
+    _pollClients.clear();
 }
 
-void Server::setOnClientConnected(const function<void(const string &)> &fn) {
-    _onClientConnected = fn;
+int Server::clientCount() {
+    int count = 0;
+    for (auto &shard : _shards) {
+        lock_guard<mutex> lock(shard.mutex);
+        count += static_cast<int>(shard.clients.size());
+    }
+    return count;
 }
 
-void Server::setOnClientDisconnected(const function<void(const string &)> &fn) {
-    _onClientDisconnected = fn;
+Server::ClientShard &Server::getShard(uint32_t client) {
+    return _shards[client % kShardCount];
 }
 
-void Server::setOnCommandReceived(const function<void(const string &, const ByteArray &)> &fn) {
-    _onCommandReceived = fn;
+void Server::setOnClientConnected(const function<void(uint32_t)> &fn) {
+    _onClientConnected = fn;
+}
+
+void Server::setOnClientDisconnected(const function<void(uint32_t)> &fn) {
+    _onClientDisconnected = fn;
 }
 
 } // namespace net
@@ -17,63 +17,112 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 #include "connection.h"
 #include "command.h"
+#include "sendbuffer.h"
 #include "types.h"
 
 namespace reone {
 
 namespace net {
 
-typedef std::map<std::string, std::unique_ptr<Connection>> ServerClients;
+typedef std::map<uint32_t, std::shared_ptr<Connection>> ServerClients;
 
+/**
+ * TCP server, running its I/O context on a pool of threads. Handlers of a
+ * single connection are serialized by a strand, so that frames of a client
+ * are processed in order. Clients are identified by integer IDs, starting
+ * from 1, and are split between shards, each guarded by its own mutex.
+ */
 class Server {
 public:
     Server() = default;
     ~Server();
 
-    void start(int port);
+    /**
+     * @param threadCount number of I/O threads, 0 to derive from hardware
+     *                    concurrency
+     */
+    void start(int port, int threadCount = 0);
     void stop();
 
-    void send(const std::string &client, const std::shared_ptr<Command> &command);
+    void send(uint32_t client, const std::shared_ptr<Command> &command);
+
+    /**
+     * Queues a serialized frame for sending to the specified client.
+     *
+     * @see Connection::send
+     */
+    void send(uint32_t client, SendBuffer *buffer);
+
+    /**
+     * Serializes the command once and sends the resulting frame to every
+     * client.
+     */
     void sendToAll(const std::shared_ptr<Command> &command);
 
-    const ServerClients &clients() const;
+    /**
+     * Passes frames received from every client since the previous call to the
+     * specified function, along with the client ID. Must be called from a
+     * single thread.
+     *
+     * @see Connection::poll
+     */
+    void poll(const std::function<void(uint32_t, const char *, size_t)> &fn);
+
+    int clientCount();
 
     // Callbacks
 
-    void setOnClientConnected(const std::function<void(const std::string &)> &fn);
-    void setOnClientDisconnected(const std::function<void(const std::string &)> &fn);
-    void setOnCommandReceived(const std::function<void(const std::string &, const ByteArray &)> &fn);
+    /**
+     * Callbacks are invoked from I/O threads, possibly concurrently.
+     */
+    void setOnClientConnected(const std::function<void(uint32_t)> &fn);
+    void setOnClientDisconnected(const std::function<void(uint32_t)> &fn);
 
     // END Callbacks
 
 private:
+    static const int kShardCount = 16;
+
+    struct ClientShard {
+        ServerClients clients;
+        std::mutex mutex;
+    };
+
     boost::asio::io_service _service;
     std::unique_ptr<boost::asio::ip::tcp::acceptor> _acceptor;
-    std::thread _thread;
-    ServerClients _clients;
+    std::vector<std::thread> _threads;
+    std::array<ClientShard, kShardCount> _shards;
+    std::atomic<uint32_t> _nextClientId { 1 };
+    std::vector<std::shared_ptr<Connection>> _pollClients; /**< reused by poll */
 
     // Callbacks
 
-    std::function<void(const std::string &)> _onClientConnected;
-    std::function<void(const std::string &)> _onClientDisconnected;
-    std::function<void(const std::string &, const ByteArray &)> _onCommandReceived;
+    std::function<void(uint32_t)> _onClientConnected;
+    std::function<void(uint32_t)> _onClientDisconnected;
 
     // END Callbacks
 
     Server(const Server &) = delete;
     Server &operator=(const Server &) = delete;
 
+    void startAccept();
     void handleAccept(std::shared_ptr<boost::asio::ip::tcp::socket> &socket, const boost::system::error_code &ec);
-    void stopClient(const std::string &tag);
+    void stopClient(uint32_t client);
+
+    ClientShard &getShard(uint32_t client);
 };
 
 } // namespace net
@@ -26,6 +26,8 @@ namespace net {
 struct NetworkOptions {
     std::string host;
     int port { 0 };
+    bool dedicated { false }; /**< run a server without a window, rendering and audio */
+    int ioThreads { 0 }; /**< number of server I/O threads, 0 to derive from hardware concurrency */
 };
 
 } // namespace net
@@ -61,20 +61,38 @@ void Program::initOptions() {
     _commonOpts.add_options()
         ("game", po::value<string>(), "path to game directory")
         ("module", po::value<string>(), "name of a module to load")
+        ("modelcache", po::value<string>(), "path to baked model cache directory")
         ("width", po::value<int>()->default_value(800), "window width")
         ("height", po::value<int>()->default_value(600), "window height")
         ("fullscreen", po::value<bool>()->default_value(false), "enable fullscreen")
+        ("vsync", po::value<bool>()->default_value(true), "enable vertical synchronization")
+        ("fpslimit", po::value<int>()->default_value(0), "maximum frame rate, 0 for unlimited")
+        ("texbudget", po::value<int>()->default_value(0), "texture memory budget in MB, 0 for unlimited")
+        ("prefetchbudget", po::value<int>()->default_value(256), "memory budget for prefetching adjacent modules in MB, 0 to disable")
+        ("shadowres", po::value<int>()->default_value(2048), "resolution of the closest shadow maps")
+        ("bloomlevels", po::value<int>()->default_value(4), "number of bloom downsampling levels")
+        ("bloomquality", po::value<int>()->default_value(1), "bloom quality, 0 for low, 1 for high")
         ("musicvol", po::value<int>()->default_value(kDefaultMusicVolume), "music volume in percents")
         ("soundvol", po::value<int>()->default_value(kDefaultSoundVolume), "sound volume in percents")
         ("movievol", po::value<int>()->default_value(kDefaultMovieVolume), "movie volume in percents")
+        ("audiobackend", po::value<string>()->default_value("openal"), "audio backend, openal or mixer")
+        ("voices", po::value<int>()->default_value(32), "maximum number of simultaneously playing sounds")
+        ("audiowav", po::value<string>(), "path to WAV file to write mixer output into")
         ("port", po::value<int>()->default_value(kDefaultMultiplayerPort), "multiplayer port number")
+        ("netthreads", po::value<int>()->default_value(0), "number of multiplayer server network threads, 0 for automatic")
         ("debug", po::value<int>()->default_value(0), "debug log level (0-3)")
         ("logfile", po::value<bool>()->default_value(false), "log to file");
 
     _cmdLineOpts.add(_commonOpts).add_options()
         ("help", "print this message")
         ("serve", "start multiplayer game")
-        ("join", po::value<string>()->implicit_value("127.0.0.1"), "join multiplayer game at specified IP address");
+        ("dedicated", "start multiplayer game as a dedicated server, without a window, rendering and audio")
+        ("join", po::value<string>()->implicit_value("127.0.0.1"), "join multiplayer game at specified IP address")
+        ("benchmark", po::value<string>(), "render a module headless along a scripted camera path and record frame timings")
+        ("frames", po::value<int>()->default_value(600), "number of frames to render in benchmark mode")
+        ("benchout", po::value<string>()->default_value("benchmark.csv"), "path to CSV file with benchmark frame timings")
+        ("capture", po::value<string>(), "path to directory to capture benchmark frames into")
+        ("captureinterval", po::value<int>()->default_value(60), "capture every Nth benchmark frame");
 }
 
 void Program::loadOptions() {
@@ -93,19 +111,48 @@ void Program::loadOptions() {
     _showHelp = vars.count("help") > 0;
     _gamePath = vars.count("game") > 0 ? vars["game"].as<string>() : fs::current_path();
     _gameOpts.module = vars.count("module") > 0 ? vars["module"].as<string>() : "";
+    _gameOpts.modelCache = vars.count("modelcache") > 0 ? vars["modelcache"].as<string>() : "";
+    _gameOpts.prefetchBudget = vars["prefetchbudget"].as<int>();
     _gameOpts.graphics.width = vars["width"].as<int>();
     _gameOpts.graphics.height = vars["height"].as<int>();
     _gameOpts.graphics.fullscreen = vars["fullscreen"].as<bool>();
+    _gameOpts.graphics.vsync = vars["vsync"].as<bool>();
+    _gameOpts.graphics.fpsLimit = vars["fpslimit"].as<int>();
+    _gameOpts.graphics.textureBudget = vars["texbudget"].as<int>();
+    _gameOpts.graphics.shadowResolution = vars["shadowres"].as<int>();
+    _gameOpts.graphics.bloomLevels = vars["bloomlevels"].as<int>();
+    _gameOpts.graphics.bloomQuality = vars["bloomquality"].as<int>() > 0 ? render::BloomQuality::High : render::BloomQuality::Low;
     _gameOpts.audio.musicVolume = vars["musicvol"].as<int>();
     _gameOpts.audio.soundVolume = vars["soundvol"].as<int>();
     _gameOpts.audio.movieVolume = vars["movievol"].as<int>();
+    _gameOpts.audio.backend = vars["audiobackend"].as<string>() == "mixer" ? audio::AudioBackendType::Mixer : audio::AudioBackendType::OpenAL;
+    _gameOpts.audio.voiceCount = vars["voices"].as<int>();
+    _gameOpts.audio.wavOutput = vars.count("audiowav") > 0 ? vars["audiowav"].as<string>() : "";
     _gameOpts.network.host = vars.count("join") > 0 ? vars["join"].as<string>() : "";
     _gameOpts.network.port = vars["port"].as<int>();
+    _gameOpts.network.dedicated = vars.count("dedicated") > 0;
+    _gameOpts.network.ioThreads = vars["netthreads"].as<int>();
+
+    if (vars.count("benchmark") > 0) {
+        _gameOpts.benchmark.module = vars["benchmark"].as<string>();
+        _gameOpts.benchmark.frames = vars["frames"].as<int>();
+        _gameOpts.benchmark.output = vars["benchout"].as<string>();
+        _gameOpts.benchmark.captureDir = vars.count("capture") > 0 ? vars["capture"].as<string>() : "";
+        _gameOpts.benchmark.captureInterval = vars["captureinterval"].as<int>();
+        _gameOpts.graphics.headless = true;
+
+        // Benchmarks must not depend on an audio device
+        if (vars["audiobackend"].defaulted()) {
+            _gameOpts.audio.backend = audio::AudioBackendType::Mixer;
+        }
+        // Nor on I/O in the background
+        _gameOpts.prefetchBudget = 0;
+    }
 
     setDebugLogLevel(vars["debug"].as<int>());
     setLogToFile(vars["logfile"].as<bool>());
 
-    if (vars.count("serve") > 0) {
+    if (vars.count("serve") > 0 || _gameOpts.network.dedicated) {
         _multiplayerMode = MultiplayerMode::Server;
     } else if (vars.count("join") > 0) {
         _multiplayerMode = MultiplayerMode::Client;
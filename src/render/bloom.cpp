@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bloom.h"
+
+#include "GL/glew.h"
+
+#include "SDL2/SDL_opengl.h"
+
+#include "glm/ext.hpp"
+
+#include "mesh/quad.h"
+#include "shaders.h"
+
+using namespace std;
+
+namespace reone {
+
+namespace render {
+
+static const float kBloomScatter = 0.25f; // weight of a smaller level, when it is blended into a larger one
+
+BloomChain::BloomChain(int width, int height, int levelCount, BloomQuality quality) :
+    _width(width), _height(height), _quality(quality) {
+
+    int w = width;
+    int h = height;
+
+    for (int i = 0; i < glm::max(levelCount, 1); ++i) {
+        w /= 2;
+        h /= 2;
+        if (w == 0 || h == 0) break;
+
+        _levels.push_back(make_unique<Framebuffer>(w, h));
+    }
+}
+
+void BloomChain::init() {
+    for (auto &level : _levels) {
+        level->init();
+    }
+}
+
+void BloomChain::deinit() {
+    for (auto &level : _levels) {
+        level->deinit();
+    }
+}
+
+void BloomChain::apply(const Framebuffer &source, int colorBuffer) const {
+    if (_levels.empty()) return;
+
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // With four taps, every level is a 4x4 box filter of the previous one.
+    // With a single tap, it is a 2x2 box filter.
+
+    float downOffset = _quality == BloomQuality::High ? 0.5f : 0.0f;
+    float upOffset = _quality == BloomQuality::High ? 1.0f : 0.0f;
+
+    glActiveTexture(GL_TEXTURE0);
+
+    for (size_t i = 0; i < _levels.size(); ++i) {
+        if (i == 0) {
+            source.bindColorBuffer(colorBuffer);
+        } else {
+            _levels[i - 1]->bindColorBuffer(0);
+        }
+        _levels[i]->bind();
+        glClear(GL_COLOR_BUFFER_BIT);
+        drawLevel(*_levels[i], downOffset);
+    }
+
+    glBlendColor(0.0f, 0.0f, 0.0f, kBloomScatter);
+    glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+
+    for (int i = static_cast<int>(_levels.size()) - 2; i >= 0; --i) {
+        _levels[i + 1]->bindColorBuffer(0);
+        _levels[i]->bind();
+        drawLevel(*_levels[i], upOffset);
+    }
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    _levels[0]->unbindColorBuffer();
+    _levels[0]->unbind();
+
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void BloomChain::drawLevel(const Framebuffer &target, float offset) const {
+    glViewport(0, 0, target.width(), target.height());
+
+    glm::mat4 transform(1.0f);
+    transform = glm::scale(transform, glm::vec3(_width, _height, 1.0f));
+
+    LocalUniforms locals;
+    locals.general.blurEnabled = true;
+    locals.general.model = move(transform);
+    locals.general.blurResolution = glm::vec2(target.width(), target.height());
+    locals.general.blurDirection = glm::vec2(offset);
+
+    Shaders::instance().activate(ShaderProgram::GUIBoxBlur, locals);
+
+    Quad::getDefault().renderTriangles();
+}
+
+void BloomChain::bindResult() const {
+    _levels[0]->bindColorBuffer(0);
+}
+
+void BloomChain::unbindResult() const {
+    _levels[0]->unbindColorBuffer();
+}
+
+} // namespace render
+
+} // namespace reone
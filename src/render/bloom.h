@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "framebuffer.h"
+#include "types.h"
+
+namespace reone {
+
+namespace render {
+
+/**
+ * Blurs a bright-pass buffer by downsampling it through a chain of
+ * framebuffers of decreasing size (1/2, 1/4, 1/8 and so on), and then
+ * upsampling it back, blending every level into the next larger one.
+ */
+class BloomChain {
+public:
+    BloomChain(int width, int height, int levelCount, BloomQuality quality);
+
+    void init();
+    void deinit();
+
+    /**
+     * Blurs a color buffer of the source framebuffer. Expects the global
+     * projection to map a quad of the source size to the whole viewport.
+     */
+    void apply(const Framebuffer &source, int colorBuffer) const;
+
+    /**
+     * Binds the blurred texture, which is half the size of the source, to the
+     * active texture unit.
+     */
+    void bindResult() const;
+    void unbindResult() const;
+
+private:
+    int _width { 0 };
+    int _height { 0 };
+    BloomQuality _quality { BloomQuality::High };
+    std::vector<std::unique_ptr<Framebuffer>> _levels;
+
+    BloomChain(const BloomChain &) = delete;
+    BloomChain &operator=(const BloomChain &) = delete;
+
+    void drawLevel(const Framebuffer &target, float offset) const;
+};
+
+} // namespace render
+
+} // namespace reone
@@ -19,14 +19,8 @@
 
 #include <stdexcept>
 
-#include "GL/glew.h"
-
-#include "SDL2/SDL_opengl.h"
-
 #include "glm/ext.hpp"
 
-#include "shaders.h"
-
 using namespace std;
 
 namespace reone {
@@ -34,13 +28,13 @@ namespace reone {
 namespace render {
 
 static const int kVertexValuesPerGlyph = 20;
-static const int kIndicesPerGlyph = 6;
 
 void Font::load(const shared_ptr<Texture> &texture) {
     if (!texture) {
         throw invalid_argument("Invalid font texture");
     }
     _texture = texture;
+    _spriteState.texture = texture;
 
     const TextureFeatures &features = _texture->features();
 
@@ -48,7 +42,6 @@ void Font::load(const shared_ptr<Texture> &texture) {
     _height = features.fontHeight * 100.0f;
 
     _vertices.resize(kVertexValuesPerGlyph * _glyphCount);
-    _indices.resize(kIndicesPerGlyph * _glyphCount);
     _glyphWidths.resize(_glyphCount);
 
     for (int i = 0; i < _glyphCount; ++i) {
@@ -66,52 +59,20 @@ void Font::load(const shared_ptr<Texture> &texture) {
         pv[10] = width; pv[11] = 0.0f; pv[12] = 0.0f; pv[13] = lr.x; pv[14] = ul.y;
         pv[15] = 0.0f; pv[16] = 0.0f; pv[17] = 0.0f; pv[18] = ul.x; pv[19] = ul.y;
 
-        uint16_t *iv = &_indices[kIndicesPerGlyph * i];
-        int off = 4 * i;
-        iv[0] = off + 0; iv[1] = off + 1; iv[2] = off + 2;
-        iv[3] = off + 2; iv[4] = off + 3; iv[5] = off + 0;
-
         _glyphWidths[i] = width;
     }
 }
 
-void Font::initGL() {
-    if (_glInited) return;
-
-    glGenBuffers(1, &_vertexBufferId);
-    glBindBuffer(GL_ARRAY_BUFFER, _vertexBufferId);
-    glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(float), &_vertices[0], GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    glGenBuffers(1, &_indexBufferId);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferId);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(uint16_t), &_indices[0], GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    glGenVertexArrays(1, &_vertexArrayId);
-    glBindVertexArray(_vertexArrayId);
-    glBindBuffer(GL_ARRAY_BUFFER, _vertexBufferId);
-
-    int stride = 5 * sizeof(float);
-
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(0));
-
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(12));
-
-    glBindVertexArray(0);
-
-    _glInited = true;
-}
-
 void Font::render(const string &text, const glm::mat4 &transform, const glm::vec3 &color, TextGravity gravity) const {
     if (text.empty()) return;
 
-    _texture->bind(0);
+    vector<SpriteVertex> vertices;
+    layout(text, transform, color, gravity, vertices);
+    render(vertices);
+}
 
-    glBindVertexArray(_vertexArrayId);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferId);
+void Font::layout(const string &text, const glm::mat4 &transform, const glm::vec3 &color, TextGravity gravity, vector<SpriteVertex> &vertices) const {
+    if (text.empty()) return;
 
     float textWidth = measure(text);
     glm::vec3 textOffset;
@@ -129,23 +90,26 @@ void Font::render(const string &text, const glm::mat4 &transform, const glm::vec
     }
 
     glm::mat4 textTransform(glm::translate(transform, textOffset));
+    glm::vec4 vertexColor(color, 1.0f);
+    float x = 0.0f;
 
-    for (auto &glyph : text) {
-        LocalUniforms locals;
-        locals.general.model = textTransform;
-        locals.general.color = glm::vec4(color, 1.0f);
-
-        Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
-
-        int off = kIndicesPerGlyph * glyph * sizeof(uint16_t);
-        glDrawElements(GL_TRIANGLES, kIndicesPerGlyph, GL_UNSIGNED_SHORT, reinterpret_cast<void *>(off));
+    vertices.reserve(vertices.size() + 4 * text.size());
 
-        float w = _glyphWidths[glyph];
-        textTransform = glm::translate(textTransform, glm::vec3(w, 0.0f, 0.0f));
+    for (auto &glyph : text) {
+        const float *pv = &_vertices[kVertexValuesPerGlyph * glyph];
+        for (int i = 0; i < 4; ++i, pv += 5) {
+            SpriteVertex vertex;
+            vertex.position = glm::vec3(textTransform * glm::vec4(x + pv[0], pv[1], pv[2], 1.0f));
+            vertex.texCoords = glm::vec2(pv[3], pv[4]);
+            vertex.color = vertexColor;
+            vertices.push_back(move(vertex));
+        }
+        x += _glyphWidths[glyph];
     }
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+void Font::render(const vector<SpriteVertex> &vertices) const {
+    SpriteBatch::instance().draw(_spriteState, vertices);
 }
 
 float Font::measure(const string &text) const {
@@ -18,9 +18,11 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "glm/mat4x4.hpp"
 
+#include "spritebatch.h"
 #include "texture.h"
 
 namespace reone {
@@ -38,7 +40,6 @@ public:
     Font() = default;
 
     void load(const std::shared_ptr<Texture> &texture);
-    void initGL();
 
     void render(
         const std::string &text,
@@ -46,20 +47,32 @@ public:
         const glm::vec3 &color = glm::vec3(1.0f, 1.0f, 1.0f),
         TextGravity align = TextGravity::Center) const;
 
+    /**
+     * Appends glyph quads of the specified text to vertices, so that they
+     * can be cached and later submitted to the sprite batch.
+     */
+    void layout(
+        const std::string &text,
+        const glm::mat4 &transform,
+        const glm::vec3 &color,
+        TextGravity gravity,
+        std::vector<SpriteVertex> &vertices) const;
+
+    /**
+     * Submits previously laid out glyph quads to the sprite batch.
+     */
+    void render(const std::vector<SpriteVertex> &vertices) const;
+
     float measure(const std::string &text) const;
     float height() const;
 
 private:
-    bool _glInited { false };
     std::vector<float> _vertices;
-    std::vector<uint16_t> _indices;
     int _glyphCount { 0 };
     float _height { 0.0f };
     std::vector<float> _glyphWidths;
     std::shared_ptr<Texture> _texture;
-    uint32_t _vertexBufferId { 0 };
-    uint32_t _indexBufferId { 0 };
-    uint32_t _vertexArrayId { 0 };
+    SpriteState _spriteState;
 };
 
 } // namespace render
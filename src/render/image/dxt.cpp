@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dxt.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REONE_DXT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace reone {
+
+namespace render {
+
+static const uint32_t kAlphaMask = 0xff000000;
+
+static inline uint32_t makeColor(int r, int g, int b, int a) {
+    return static_cast<uint32_t>(r) | (static_cast<uint32_t>(g) << 8) | (static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(a) << 24);
+}
+
+static inline void unpack565(uint16_t color, int &r, int &g, int &b) {
+    r = (color >> 11) & 0x1f;
+    g = (color >> 5) & 0x3f;
+    b = color & 0x1f;
+
+    r = (r << 3) | (r >> 2);
+    g = (g << 2) | (g >> 4);
+    b = (b << 3) | (b >> 2);
+}
+
+static void decodeColorPalette(const uint8_t *block, bool allowTransparent, uint32_t palette[4]) {
+    uint16_t c0 = block[0] | (block[1] << 8);
+    uint16_t c1 = block[2] | (block[3] << 8);
+
+    int r0, g0, b0, r1, g1, b1;
+    unpack565(c0, r0, g0, b0);
+    unpack565(c1, r1, g1, b1);
+
+    palette[0] = makeColor(r0, g0, b0, 255);
+    palette[1] = makeColor(r1, g1, b1, 255);
+
+    if (c0 > c1 || !allowTransparent) {
+#ifdef REONE_DXT_SSE2
+        // Compute both interpolated colors at once: x / 3 == (x * 21846) >> 16
+        // for all x in [0, 765]
+        __m128i endpoints = _mm_set_epi16(0, b1, g1, r1, 0, b0, g0, r0);
+        __m128i swapped = _mm_shuffle_epi32(endpoints, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(endpoints, endpoints), swapped);
+        __m128i interpolated = _mm_mulhi_epu16(sum, _mm_set1_epi16(21846));
+        __m128i packed = _mm_packus_epi16(interpolated, _mm_setzero_si128());
+
+        uint32_t colors[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(colors), packed);
+
+        palette[2] = colors[0] | kAlphaMask;
+        palette[3] = colors[1] | kAlphaMask;
+#else
+        palette[2] = makeColor((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, 255);
+        palette[3] = makeColor((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, 255);
+#endif
+    } else {
+        palette[2] = makeColor((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, 255);
+        palette[3] = 0;
+    }
+}
+
+static void decodeColorBlock(const uint8_t *block, bool allowTransparent, uint32_t texels[16]) {
+    uint32_t palette[4];
+    decodeColorPalette(block, allowTransparent, palette);
+
+    uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+    for (int i = 0; i < 16; ++i) {
+        texels[i] = palette[(indices >> (2 * i)) & 3];
+    }
+}
+
+static void applyAlphaBlock(const uint8_t *block, uint32_t texels[16]) {
+    int a0 = block[0];
+    int a1 = block[1];
+
+    uint8_t palette[8];
+    palette[0] = a0;
+    palette[1] = a1;
+
+    if (a0 > a1) {
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1) / 7);
+        }
+    } else {
+        for (int i = 1; i < 5; ++i) {
+            palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1) / 5);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; ++i) {
+        indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+    }
+
+    uint32_t alphas[16];
+    for (int i = 0; i < 16; ++i) {
+        alphas[i] = static_cast<uint32_t>(palette[(indices >> (3 * i)) & 7]) << 24;
+    }
+
+#ifdef REONE_DXT_SSE2
+    __m128i colorMask = _mm_set1_epi32(~kAlphaMask);
+    for (int i = 0; i < 16; i += 4) {
+        __m128i colors = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&texels[i]));
+        __m128i alpha = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&alphas[i]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&texels[i]), _mm_or_si128(_mm_and_si128(colors, colorMask), alpha));
+    }
+#else
+    for (int i = 0; i < 16; ++i) {
+        texels[i] = (texels[i] & ~kAlphaMask) | alphas[i];
+    }
+#endif
+}
+
+static void writeBlock(const uint32_t texels[16], int x, int y, int width, int height, uint8_t *pixels) {
+    if (x + 4 <= width && y + 4 <= height) {
+        for (int row = 0; row < 4; ++row) {
+            memcpy(&pixels[4 * ((y + row) * width + x)], &texels[4 * row], 16);
+        }
+        return;
+    }
+
+    // Blocks on the right and bottom edges of textures, that are not a
+    // multiple of four in size, are clipped
+
+    for (int row = 0; row < 4 && y + row < height; ++row) {
+        for (int col = 0; col < 4 && x + col < width; ++col) {
+            memcpy(&pixels[4 * ((y + row) * width + x + col)], &texels[4 * row + col], 4);
+        }
+    }
+}
+
+void decompressDXT1(const uint8_t *data, int width, int height, uint8_t *pixels) {
+    uint32_t texels[16];
+
+    for (int y = 0; y < height; y += 4) {
+        for (int x = 0; x < width; x += 4) {
+            decodeColorBlock(data, true, texels);
+            writeBlock(texels, x, y, width, height, pixels);
+            data += 8;
+        }
+    }
+}
+
+void decompressDXT5(const uint8_t *data, int width, int height, uint8_t *pixels) {
+    uint32_t texels[16];
+
+    for (int y = 0; y < height; y += 4) {
+        for (int x = 0; x < width; x += 4) {
+            decodeColorBlock(data + 8, false, texels);
+            applyAlphaBlock(data, texels);
+            writeBlock(texels, x, y, width, height, pixels);
+            data += 16;
+        }
+    }
+}
+
+} // namespace render
+
+} // namespace reone
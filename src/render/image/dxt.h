@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace reone {
+
+namespace render {
+
+/**
+ * Decompresses DXT1 (BC1) data into 32-bit RGBA pixels. Used when the
+ * OpenGL implementation does not support S3TC texture compression.
+ *
+ * @param data compressed data, 8 bytes per 4x4 block
+ * @param pixels destination buffer of 4 * width * height bytes
+ */
+void decompressDXT1(const uint8_t *data, int width, int height, uint8_t *pixels);
+
+/**
+ * Decompresses DXT5 (BC3) data into 32-bit RGBA pixels.
+ *
+ * @param data compressed data, 16 bytes per 4x4 block
+ * @param pixels destination buffer of 4 * width * height bytes
+ */
+void decompressDXT5(const uint8_t *data, int width, int height, uint8_t *pixels);
+
+} // namespace render
+
+} // namespace reone
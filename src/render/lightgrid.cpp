@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lightgrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REONE_LIGHTGRID_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace reone {
+
+namespace render {
+
+static_assert(kClusterCountX % 4 == 0, "Cluster count along X must be a multiple of 4");
+
+static const float kMinClusterDepth = 0.1f;
+static const float kMaxClusterDepth = 512.0f;
+
+static inline int getSlice(float depth, float scale, float bias) {
+    if (depth <= 0.0f) return 0;
+
+    int slice = static_cast<int>(floorf(logf(depth) * scale + bias));
+    return max(0, min(slice, kClusterCountZ - 1));
+}
+
+void LightGrid::build(const glm::mat4 &view, const glm::mat4 &projection, const vector<GridLight> &lights) {
+    if (projection != _projection) {
+        computeClusterBounds(projection);
+        _projection = projection;
+    }
+    _clusterLights.resize(kClusterCount * kMaxLightsPerCluster);
+    _clusterLightCounts.assign(kClusterCount, 0);
+
+    _lightData.clear();
+    _lightData.reserve(8 * lights.size());
+
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const GridLight &light = lights[i];
+
+        _lightData.push_back(light.position.x);
+        _lightData.push_back(light.position.y);
+        _lightData.push_back(light.position.z);
+        _lightData.push_back(light.radius);
+        _lightData.push_back(light.color.r);
+        _lightData.push_back(light.color.g);
+        _lightData.push_back(light.color.b);
+        _lightData.push_back(1.0f);
+
+        glm::vec3 center(view * glm::vec4(light.position, 1.0f));
+        assignLight(static_cast<uint32_t>(i), center, light.radius);
+    }
+
+    // Flatten per-cluster light lists
+
+    _clusterData.resize(2 * kClusterCount);
+    uint32_t offset = 2 * kClusterCount;
+
+    for (int i = 0; i < kClusterCount; ++i) {
+        uint32_t count = _clusterLightCounts[i];
+        _clusterData[2 * i + 0] = offset;
+        _clusterData[2 * i + 1] = count;
+
+        const uint32_t *indices = &_clusterLights[i * kMaxLightsPerCluster];
+        _clusterData.insert(_clusterData.end(), indices, indices + count);
+        offset += count;
+    }
+}
+
+void LightGrid::computeClusterBounds(const glm::mat4 &projection) {
+    glm::mat4 invProjection(glm::inverse(projection));
+
+    auto unproject = [&invProjection](float x, float y, float z) {
+        glm::vec4 v(invProjection * glm::vec4(x, y, z, 1.0f));
+        return glm::vec3(v) / v.w;
+    };
+    float zNear = -unproject(0.0f, 0.0f, -1.0f).z;
+    float zFar = -unproject(0.0f, 0.0f, 1.0f).z;
+
+    float sliceNear = max(zNear, kMinClusterDepth);
+    float sliceFar = max(min(zFar, kMaxClusterDepth), 2.0f * sliceNear);
+
+    _depthScale = kClusterCountZ / logf(sliceFar / sliceNear);
+    _depthBias = -_depthScale * logf(sliceNear);
+
+    // First and last slices extend to the near and far planes respectively
+
+    float sliceNdcZ[kClusterCountZ + 1];
+    sliceNdcZ[0] = -1.0f;
+    sliceNdcZ[kClusterCountZ] = 1.0f;
+
+    for (int z = 1; z < kClusterCountZ; ++z) {
+        float depth = sliceNear * powf(sliceFar / sliceNear, z / static_cast<float>(kClusterCountZ));
+        glm::vec4 clip(projection * glm::vec4(0.0f, 0.0f, -depth, 1.0f));
+        sliceNdcZ[z] = glm::clamp(clip.z / clip.w, -1.0f, 1.0f);
+    }
+
+    _minX.resize(kClusterCount);
+    _minY.resize(kClusterCount);
+    _minZ.resize(kClusterCount);
+    _maxX.resize(kClusterCount);
+    _maxY.resize(kClusterCount);
+    _maxZ.resize(kClusterCount);
+
+    for (int z = 0; z < kClusterCountZ; ++z) {
+        for (int y = 0; y < kClusterCountY; ++y) {
+            for (int x = 0; x < kClusterCountX; ++x) {
+                float ndcX[] = { -1.0f + 2.0f * x / kClusterCountX, -1.0f + 2.0f * (x + 1) / kClusterCountX };
+                float ndcY[] = { -1.0f + 2.0f * y / kClusterCountY, -1.0f + 2.0f * (y + 1) / kClusterCountY };
+                float ndcZ[] = { sliceNdcZ[z], sliceNdcZ[z + 1] };
+
+                glm::vec3 minCorner(numeric_limits<float>::max());
+                glm::vec3 maxCorner(-numeric_limits<float>::max());
+
+                for (int i = 0; i < 8; ++i) {
+                    glm::vec3 corner(unproject(ndcX[i & 1], ndcY[(i >> 1) & 1], ndcZ[(i >> 2) & 1]));
+                    minCorner = glm::min(minCorner, corner);
+                    maxCorner = glm::max(maxCorner, corner);
+                }
+
+                int idx = x + kClusterCountX * (y + kClusterCountY * z);
+                _minX[idx] = minCorner.x;
+                _minY[idx] = minCorner.y;
+                _minZ[idx] = minCorner.z;
+                _maxX[idx] = maxCorner.x;
+                _maxY[idx] = maxCorner.y;
+                _maxZ[idx] = maxCorner.z;
+            }
+        }
+    }
+}
+
+void LightGrid::assignLight(uint32_t lightIdx, const glm::vec3 &center, float radius) {
+    int minSlice = getSlice(-center.z - radius, _depthScale, _depthBias);
+    int maxSlice = getSlice(-center.z + radius, _depthScale, _depthBias);
+    float radius2 = radius * radius;
+
+    auto append = [this, &lightIdx](int clusterIdx) {
+        uint32_t &count = _clusterLightCounts[clusterIdx];
+        if (count < kMaxLightsPerCluster) {
+            _clusterLights[clusterIdx * kMaxLightsPerCluster + count++] = lightIdx;
+        }
+    };
+
+#ifdef REONE_LIGHTGRID_SSE2
+    __m128 zero = _mm_setzero_ps();
+    __m128 cx = _mm_set1_ps(center.x);
+    __m128 cy = _mm_set1_ps(center.y);
+    __m128 cz = _mm_set1_ps(center.z);
+    __m128 r2 = _mm_set1_ps(radius2);
+#endif
+
+    for (int z = minSlice; z <= maxSlice; ++z) {
+        for (int y = 0; y < kClusterCountY; ++y) {
+            for (int x = 0; x < kClusterCountX; x += 4) {
+                int base = x + kClusterCountX * (y + kClusterCountY * z);
+
+#ifdef REONE_LIGHTGRID_SSE2
+                // Distance from the light center to four cluster AABBs at once
+                __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_minX[base]), cx), _mm_sub_ps(cx, _mm_loadu_ps(&_maxX[base]))), zero);
+                __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_minY[base]), cy), _mm_sub_ps(cy, _mm_loadu_ps(&_maxY[base]))), zero);
+                __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_minZ[base]), cz), _mm_sub_ps(cz, _mm_loadu_ps(&_maxZ[base]))), zero);
+                __m128 dist2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+                int mask = _mm_movemask_ps(_mm_cmple_ps(dist2, r2));
+                if (mask == 0) continue;
+
+                for (int i = 0; i < 4; ++i) {
+                    if (mask & (1 << i)) {
+                        append(base + i);
+                    }
+                }
+#else
+                for (int i = base; i < base + 4; ++i) {
+                    float dx = max(max(_minX[i] - center.x, center.x - _maxX[i]), 0.0f);
+                    float dy = max(max(_minY[i] - center.y, center.y - _maxY[i]), 0.0f);
+                    float dz = max(max(_minZ[i] - center.z, center.z - _maxZ[i]), 0.0f);
+                    if (dx * dx + dy * dy + dz * dz <= radius2) {
+                        append(i);
+                    }
+                }
+#endif
+            }
+        }
+    }
+}
+
+int LightGrid::getClusterIndex(const glm::vec3 &viewPosition) const {
+    glm::vec4 clip(_projection * glm::vec4(viewPosition, 1.0f));
+    glm::vec2 ndc(glm::vec2(clip) / clip.w);
+
+    int x = glm::clamp(static_cast<int>((0.5f * ndc.x + 0.5f) * kClusterCountX), 0, kClusterCountX - 1);
+    int y = glm::clamp(static_cast<int>((0.5f * ndc.y + 0.5f) * kClusterCountY), 0, kClusterCountY - 1);
+    int z = getSlice(-viewPosition.z, _depthScale, _depthBias);
+
+    return x + kClusterCountX * (y + kClusterCountY * z);
+}
+
+vector<uint32_t> LightGrid::getClusterLights(int clusterIdx) const {
+    uint32_t offset = _clusterData[2 * clusterIdx + 0];
+    uint32_t count = _clusterData[2 * clusterIdx + 1];
+
+    return vector<uint32_t>(_clusterData.begin() + offset, _clusterData.begin() + offset + count);
+}
+
+const vector<float> &LightGrid::lightData() const {
+    return _lightData;
+}
+
+const vector<uint32_t> &LightGrid::clusterData() const {
+    return _clusterData;
+}
+
+float LightGrid::depthScale() const {
+    return _depthScale;
+}
+
+float LightGrid::depthBias() const {
+    return _depthBias;
+}
+
+} // namespace render
+
+} // namespace reone
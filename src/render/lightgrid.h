@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace reone {
+
+namespace render {
+
+// Must match the constants in the common shader header
+const int kClusterCountX = 16;
+const int kClusterCountY = 9;
+const int kClusterCountZ = 24;
+const int kClusterCount = kClusterCountX * kClusterCountY * kClusterCountZ;
+const int kMaxLightsPerCluster = 32;
+
+struct GridLight {
+    glm::vec3 position { 0.0f };
+    float radius { 1.0f };
+    glm::vec3 color { 1.0f };
+};
+
+/**
+ * Splits the view frustum into clusters, uniform in screen space and
+ * exponential in depth, and assigns lights to clusters they intersect.
+ *
+ * The result consists of two arrays, uploaded into texture buffers: light
+ * data, two RGBA texels per light, and cluster data, which starts with an
+ * (offset, count) pair per cluster, followed by light indices.
+ */
+class LightGrid {
+public:
+    /**
+     * Assigns lights to clusters. When a cluster is affected by more than
+     * kMaxLightsPerCluster lights, lights that come first win.
+     *
+     * @param view view matrix of the camera
+     * @param projection projection matrix of the camera
+     * @param lights lights in world space, most important first
+     */
+    void build(const glm::mat4 &view, const glm::mat4 &projection, const std::vector<GridLight> &lights);
+
+    /**
+     * @param viewPosition position in view space
+     * @return index of the cluster, containing the specified position
+     */
+    int getClusterIndex(const glm::vec3 &viewPosition) const;
+
+    /**
+     * @return indices of lights, affecting the specified cluster
+     */
+    std::vector<uint32_t> getClusterLights(int clusterIdx) const;
+
+    const std::vector<float> &lightData() const;
+    const std::vector<uint32_t> &clusterData() const;
+
+    /**
+     * Cluster slice index is computed as log(depth) * scale + bias.
+     */
+    float depthScale() const;
+    float depthBias() const;
+
+private:
+    glm::mat4 _projection { 0.0f };
+    float _depthScale { 0.0f };
+    float _depthBias { 0.0f };
+
+    // Cluster bounds in view space, structure of arrays
+
+    std::vector<float> _minX;
+    std::vector<float> _minY;
+    std::vector<float> _minZ;
+    std::vector<float> _maxX;
+    std::vector<float> _maxY;
+    std::vector<float> _maxZ;
+
+    // END Cluster bounds in view space, structure of arrays
+
+    std::vector<uint32_t> _clusterLights;
+    std::vector<uint32_t> _clusterLightCounts;
+    std::vector<float> _lightData;
+    std::vector<uint32_t> _clusterData;
+
+    void computeClusterBounds(const glm::mat4 &projection);
+    void assignLight(uint32_t lightIdx, const glm::vec3 &center, float radius);
+};
+
+} // namespace render
+
+} // namespace reone
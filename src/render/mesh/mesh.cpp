@@ -23,6 +23,8 @@
 
 #include "glm/ext.hpp"
 
+using namespace std;
+
 namespace reone {
 
 namespace render {
@@ -30,9 +32,9 @@ namespace render {
 void Mesh::computeAABB() {
     _aabb.reset();
 
-    const float *pv = &_vertices[_offsets.vertexCoords / sizeof(float)];
+    const float *pv = vertexData() + _offsets.vertexCoords / sizeof(float);
     int stride = _offsets.stride / sizeof(float);
-    size_t vertexCount = _vertices.size() / stride;
+    size_t vertexCount = vertexValueCount() / stride;
 
     for (size_t i = 0; i < vertexCount; ++i) {
         _aabb.expand(glm::make_vec3(pv));
@@ -45,12 +47,12 @@ void Mesh::initGL() {
 
     glGenBuffers(1, &_vertexBufferId);
     glBindBuffer(GL_ARRAY_BUFFER, _vertexBufferId);
-    glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(float), &_vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexValueCount() * sizeof(float), vertexData(), GL_STATIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     glGenBuffers(1, &_indexBufferId);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferId);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(uint16_t), &_indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount() * sizeof(uint16_t), indexData(), GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     glGenVertexArrays(1, &_vertexArrayId);
@@ -101,11 +103,11 @@ void Mesh::deinitGL() {
 }
 
 void Mesh::renderLines() const {
-    render(GL_LINES, static_cast<int>(_indices.size()), 0);
+    render(GL_LINES, static_cast<int>(indexCount()), 0);
 }
 
 void Mesh::renderTriangles() const {
-    render(GL_TRIANGLES, static_cast<int>(_indices.size()), 0);
+    render(GL_TRIANGLES, static_cast<int>(indexCount()), 0);
 }
 
 void Mesh::render(uint32_t mode, int count, int offset) const {
@@ -118,6 +120,32 @@ void Mesh::render(uint32_t mode, int count, int offset) const {
     glBindVertexArray(0);
 }
 
+void Mesh::setExternalData(shared_ptr<const void> storage, const float *vertices, size_t vertexValueCount, const uint16_t *indices, size_t indexCount) {
+    _vertices.clear();
+    _indices.clear();
+    _externalStorage = move(storage);
+    _externalVertices = vertices;
+    _externalVertexValueCount = vertexValueCount;
+    _externalIndices = indices;
+    _externalIndexCount = indexCount;
+}
+
+const float *Mesh::vertexData() const {
+    return _externalVertices ? _externalVertices : _vertices.data();
+}
+
+size_t Mesh::vertexValueCount() const {
+    return _externalVertices ? _externalVertexValueCount : _vertices.size();
+}
+
+const uint16_t *Mesh::indexData() const {
+    return _externalIndices ? _externalIndices : _indices.data();
+}
+
+size_t Mesh::indexCount() const {
+    return _externalIndices ? _externalIndexCount : _indices.size();
+}
+
 const AABB &Mesh::aabb() const {
     return _aabb;
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "../../common/aabb.h"
@@ -26,6 +27,8 @@ namespace reone {
 
 namespace render {
 
+class BakedModelReader;
+class BakedModelWriter;
 class MdlFile;
 
 /**
@@ -50,6 +53,10 @@ public:
     void renderTriangles() const;
 
     const AABB &aabb() const;
+    const float *vertexData() const;
+    size_t vertexValueCount() const;
+    const uint16_t *indexData() const;
+    size_t indexCount() const;
 
 protected:
     bool _glInited { false };
@@ -65,13 +72,28 @@ protected:
     void computeAABB();
     void render(uint32_t mode, int count, int offset) const;
 
+    /**
+     * Makes this mesh use vertex and index data, owned by another object,
+     * e.g. a memory-mapped file, instead of its own vectors.
+     *
+     * @param storage object to keep alive, while the data is in use
+     */
+    void setExternalData(std::shared_ptr<const void> storage, const float *vertices, size_t vertexValueCount, const uint16_t *indices, size_t indexCount);
+
 private:
     uint32_t _vertexBufferId { 0 };
     AABB _aabb;
+    std::shared_ptr<const void> _externalStorage;
+    const float *_externalVertices { nullptr };
+    size_t _externalVertexValueCount { 0 };
+    const uint16_t *_externalIndices { nullptr };
+    size_t _externalIndexCount { 0 };
 
     Mesh(const Mesh &) = delete;
     Mesh &operator=(const Mesh &) = delete;
 
+    friend class BakedModelReader;
+    friend class BakedModelWriter;
     friend class MdlFile;
 };
 
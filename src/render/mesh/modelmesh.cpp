@@ -21,6 +21,8 @@
 
 #include "SDL2/SDL_opengl.h"
 
+#include "../textures.h"
+
 using namespace std;
 
 namespace reone {
@@ -33,6 +35,31 @@ ModelMesh::ModelMesh(bool render, int transparency, bool shadow) :
     _shadow(shadow) {
 }
 
+void ModelMesh::loadTextures() {
+    if (!_diffuseName.empty() && _diffuseName != "null") {
+        _diffuse = Textures::instance().request(_diffuseName, TextureType::Diffuse);
+    }
+    if (!_lightmapName.empty()) {
+        _lightmap = Textures::instance().request(_lightmapName, TextureType::Lightmap);
+    }
+}
+
+void ModelMesh::loadFeatureTextures() const {
+    if (_featureTexturesLoaded || !_diffuse || !_diffuse->isReady()) return;
+
+    const TextureFeatures &features = _diffuse->features();
+    if (!features.envMapTexture.empty()) {
+        _envmap = Textures::instance().request(features.envMapTexture, TextureType::EnvironmentMap);
+    }
+    if (!features.bumpyShinyTexture.empty()) {
+        _bumpyShiny = Textures::instance().request(features.bumpyShinyTexture, TextureType::EnvironmentMap);
+    }
+    if (!features.bumpMapTexture.empty()) {
+        _bumpmap = Textures::instance().request(features.bumpMapTexture, TextureType::Bumpmap);
+    }
+    _featureTexturesLoaded = true;
+}
+
 void ModelMesh::render(const shared_ptr<Texture> &diffuseOverride) const {
     const shared_ptr<Texture> &diffuse = diffuseOverride ? diffuseOverride : _diffuse;
     bool additive = false;
@@ -41,16 +68,16 @@ void ModelMesh::render(const shared_ptr<Texture> &diffuseOverride) const {
         diffuse->bind(0);
         additive = diffuse->isAdditive();
     }
-    if (_envmap) {
+    if (hasEnvmapTexture()) {
         _envmap->bind(1);
     }
-    if (_lightmap) {
+    if (hasLightmapTexture()) {
         _lightmap->bind(2);
     }
-    if (_bumpyShiny) {
+    if (hasBumpyShinyTexture()) {
         _bumpyShiny->bind(3);
     }
-    if (_bumpmap) {
+    if (hasBumpmapTexture()) {
         _bumpmap->bind(4);
     }
 
@@ -93,23 +120,26 @@ bool ModelMesh::isTransparent() const {
 }
 
 bool ModelMesh::hasDiffuseTexture() const {
-    return static_cast<bool>(_diffuse);
+    return _diffuse && !_diffuse->isMissing();
 }
 
 bool ModelMesh::hasEnvmapTexture() const {
-    return static_cast<bool>(_envmap);
+    loadFeatureTextures();
+    return _envmap && _envmap->isReady();
 }
 
 bool ModelMesh::hasLightmapTexture() const {
-    return static_cast<bool>(_lightmap);
+    return _lightmap && _lightmap->isReady();
 }
 
 bool ModelMesh::hasBumpyShinyTexture() const {
-    return static_cast<bool>(_bumpyShiny);
+    loadFeatureTextures();
+    return _bumpyShiny && _bumpyShiny->isReady();
 }
 
 bool ModelMesh::hasBumpmapTexture() const {
-    return static_cast<bool>(_bumpmap);
+    loadFeatureTextures();
+    return _bumpmap && _bumpmap->isReady();
 }
 
 int ModelMesh::transparency() const {
@@ -120,6 +150,14 @@ const shared_ptr<Texture> &ModelMesh::diffuseTexture() const {
     return _diffuse;
 }
 
+const string &ModelMesh::diffuseName() const {
+    return _diffuseName;
+}
+
+const string &ModelMesh::lightmapName() const {
+    return _lightmapName;
+}
+
 } // namespace render
 
 } // namespace reone
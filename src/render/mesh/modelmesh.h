@@ -18,6 +18,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include "../texture.h"
 
@@ -27,7 +28,10 @@ namespace reone {
 
 namespace render {
 
+class BakedModelReader;
+class BakedModelWriter;
 class MdlFile;
+class Models;
 
 /**
  * Textured mesh, part of a 3D model.
@@ -54,18 +58,40 @@ public:
 
     int transparency() const;
     const std::shared_ptr<Texture> &diffuseTexture() const;
+    const std::string &diffuseName() const;
+    const std::string &lightmapName() const;
 
 private:
     bool _render { false };
     int _transparency { 0 };
     bool _shadow { false };
     std::shared_ptr<Texture> _diffuse;
-    std::shared_ptr<Texture> _envmap;
     std::shared_ptr<Texture> _lightmap;
-    std::shared_ptr<Texture> _bumpyShiny;
-    std::shared_ptr<Texture> _bumpmap;
+    std::string _diffuseName;
+    std::string _lightmapName;
 
+    // Textures referenced by the diffuse texture features. Textures are
+    // loaded asynchronously, therefore these are resolved lazily, once the
+    // diffuse texture is ready.
+
+    mutable bool _featureTexturesLoaded { false };
+    mutable std::shared_ptr<Texture> _envmap;
+    mutable std::shared_ptr<Texture> _bumpyShiny;
+    mutable std::shared_ptr<Texture> _bumpmap;
+
+    // END Textures referenced by the diffuse texture features
+
+    /**
+     * Requests diffuse and lightmap textures by name.
+     */
+    void loadTextures();
+
+    void loadFeatureTextures() const;
+
+    friend class BakedModelReader;
+    friend class BakedModelWriter;
     friend class MdlFile;
+    friend class Models;
 };
 
 } // namespace render
@@ -25,6 +25,8 @@ namespace reone {
 
 namespace render {
 
+class BakedModelReader;
+class BakedModelWriter;
 class MdlFile;
 
 class Animation {
@@ -48,6 +50,8 @@ private:
     Animation(const Animation &) = delete;
     Animation &operator=(const Animation &) = delete;
 
+    friend class BakedModelReader;
+    friend class BakedModelWriter;
     friend class MdlFile;
 };
 
@@ -0,0 +1,557 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bakedmodel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "glm/gtc/quaternion.hpp"
+
+#include "../models.h"
+
+using namespace std;
+
+using namespace reone::resource;
+
+namespace fs = boost::filesystem;
+namespace ipc = boost::interprocess;
+
+namespace reone {
+
+namespace render {
+
+static const char kSignature[] = "RBM ";
+static const uint32_t kFormatVersion = 2;
+static const int kSectionAlignment = 16;
+static const uint32_t kNoMesh = 0xffffffff;
+
+struct BakedArray {
+    uint32_t offset { 0 };
+    uint32_t count { 0 };
+};
+
+struct BakedModelHeader {
+    char signature[4];
+    uint32_t formatVersion { 0 };
+    uint32_t gameVersion { 0 };
+    uint32_t mdlSize { 0 };
+    uint32_t mdxSize { 0 };
+    uint32_t nameOffset { 0 };
+    uint32_t superModelNameOffset { 0 };
+    uint32_t classification { 0 };
+    float animationScale { 1.0f };
+    uint32_t rootNodeIndex { 0 };
+    BakedArray nodes;
+    BakedArray childIndices;
+    BakedArray positionFrames;
+    BakedArray orientationFrames;
+    BakedArray meshes;
+    BakedArray vertices;
+    BakedArray indices;
+    BakedArray bones;
+    BakedArray animations;
+    BakedArray strings;
+};
+
+struct BakedNode {
+    int32_t index { 0 };
+    uint32_t flags { 0 };
+    uint32_t nodeNumber { 0 };
+    uint32_t nameOffset { 0 };
+    glm::vec3 position { 0.0f };
+    glm::quat orientation { 1.0f, 0.0f, 0.0f, 0.0f };
+    glm::mat4 localTransform { 1.0f };
+    glm::mat4 absTransform { 1.0f };
+    glm::mat4 absTransformInv { 1.0f };
+    glm::vec3 color { 0.0f };
+    uint32_t selfIllumEnabled { 0 };
+    glm::vec3 selfIllumColor { 0.0f };
+    float alpha { 1.0f };
+    float radius { 0.0f };
+    float multiplier { 1.0f };
+    uint32_t hasLight { 0 };
+    int32_t lightPriority { 1 };
+    uint32_t lightAmbientOnly { 0 };
+    uint32_t lightAffectDynamic { 0 };
+    uint32_t lightShadow { 0 };
+    uint32_t meshIndex { kNoMesh };
+    uint32_t hasSkin { 0 };
+    BakedArray bones;
+    BakedArray children;
+    BakedArray positionFrames;
+    BakedArray orientationFrames;
+};
+
+struct BakedPositionFrame {
+    float time { 0.0f };
+    glm::vec3 position { 0.0f };
+};
+
+struct BakedOrientationFrame {
+    float time { 0.0f };
+    glm::quat orientation { 1.0f, 0.0f, 0.0f, 0.0f };
+};
+
+struct BakedMesh {
+    uint32_t render { 0 };
+    uint32_t transparency { 0 };
+    uint32_t shadow { 0 };
+    Mesh::VertexOffsets offsets;
+    glm::vec3 aabbMin { 0.0f };
+    glm::vec3 aabbMax { 0.0f };
+    uint32_t diffuseNameOffset { 0 };
+    uint32_t lightmapNameOffset { 0 };
+    BakedArray vertices;
+    BakedArray indices;
+};
+
+struct BakedBone {
+    uint16_t boneIdx { 0 };
+    uint16_t nodeIdx { 0 };
+};
+
+struct BakedAnimation {
+    uint32_t nameOffset { 0 };
+    float length { 0.0f };
+    float transitionTime { 0.0f };
+    uint32_t rootNodeIndex { 0 };
+};
+
+static_assert(is_trivially_copyable<BakedModelHeader>::value, "BakedModelHeader must be trivially copyable");
+static_assert(is_trivially_copyable<BakedNode>::value, "BakedNode must be trivially copyable");
+static_assert(is_trivially_copyable<BakedMesh>::value, "BakedMesh must be trivially copyable");
+
+// Writer
+
+struct BakedModelWriter::Tables {
+    vector<BakedNode> nodes;
+    vector<uint32_t> childIndices;
+    vector<BakedPositionFrame> positionFrames;
+    vector<BakedOrientationFrame> orientationFrames;
+    vector<BakedMesh> meshes;
+    vector<float> vertices;
+    vector<uint16_t> indices;
+    vector<BakedBone> bones;
+    vector<BakedAnimation> animations;
+    ByteArray strings;
+};
+
+template <class T>
+static BakedArray appendSection(ByteArray &data, const vector<T> &items) {
+    size_t padding = (kSectionAlignment - data.size() % kSectionAlignment) % kSectionAlignment;
+    data.resize(data.size() + padding, 0);
+
+    BakedArray result;
+    result.offset = static_cast<uint32_t>(data.size());
+    result.count = static_cast<uint32_t>(items.size());
+
+    if (!items.empty()) {
+        const char *begin = reinterpret_cast<const char *>(&items[0]);
+        data.insert(data.end(), begin, begin + items.size() * sizeof(T));
+    }
+
+    return move(result);
+}
+
+BakedModelWriter::BakedModelWriter(GameVersion version, const BakedModelSource &source) : _version(version), _source(source) {
+}
+
+void BakedModelWriter::save(const Model &model, const fs::path &path) {
+    Tables tables;
+    tables.strings.push_back('\0'); // offset 0 is an empty string
+
+    BakedModelHeader header;
+    memcpy(header.signature, kSignature, 4);
+    header.formatVersion = kFormatVersion;
+    header.gameVersion = static_cast<uint32_t>(_version);
+    header.mdlSize = _source.mdlSize;
+    header.mdxSize = _source.mdxSize;
+    header.nameOffset = appendString(model._name, tables);
+    header.superModelNameOffset = appendString(model._superModelName, tables);
+    header.classification = static_cast<uint32_t>(model._classification);
+    header.animationScale = model._animationScale;
+    header.rootNodeIndex = appendNode(*model._rootNode, tables);
+
+    for (auto &pair : model._animations) {
+        const Animation &anim = *pair.second;
+
+        BakedAnimation bakedAnim;
+        bakedAnim.nameOffset = appendString(anim._name, tables);
+        bakedAnim.length = anim._length;
+        bakedAnim.transitionTime = anim._transitionTime;
+        bakedAnim.rootNodeIndex = appendNode(*anim._rootNode, tables);
+
+        tables.animations.push_back(move(bakedAnim));
+    }
+
+    ByteArray data(sizeof(BakedModelHeader));
+    header.nodes = appendSection(data, tables.nodes);
+    header.childIndices = appendSection(data, tables.childIndices);
+    header.positionFrames = appendSection(data, tables.positionFrames);
+    header.orientationFrames = appendSection(data, tables.orientationFrames);
+    header.meshes = appendSection(data, tables.meshes);
+    header.vertices = appendSection(data, tables.vertices);
+    header.indices = appendSection(data, tables.indices);
+    header.bones = appendSection(data, tables.bones);
+    header.animations = appendSection(data, tables.animations);
+    header.strings = appendSection(data, tables.strings);
+    memcpy(&data[0], &header, sizeof(BakedModelHeader));
+
+    // Write into a temporary file first, so that a partially written file is
+    // never picked up by the reader
+
+    fs::path tmpPath(path);
+    tmpPath += ".tmp";
+    {
+        fs::ofstream out(tmpPath, ios::binary);
+        out.write(&data[0], data.size());
+        if (!out) {
+            throw runtime_error("Unable to write baked model: " + tmpPath.string());
+        }
+    }
+    fs::rename(tmpPath, path);
+}
+
+uint32_t BakedModelWriter::appendNode(const ModelNode &node, Tables &tables) const {
+    uint32_t index = static_cast<uint32_t>(tables.nodes.size());
+    tables.nodes.push_back(BakedNode());
+
+    BakedNode baked;
+    baked.index = node._index;
+    baked.flags = node._flags;
+    baked.nodeNumber = node._nodeNumber;
+    baked.nameOffset = appendString(node._name, tables);
+    baked.position = node._position;
+    baked.orientation = node._orientation;
+    baked.localTransform = node._localTransform;
+    baked.absTransform = node._absTransform;
+    baked.absTransformInv = node._absTransformInv;
+    baked.color = node._color;
+    baked.selfIllumEnabled = node._selfIllumEnabled;
+    baked.selfIllumColor = node._selfIllumColor;
+    baked.alpha = node._alpha;
+    baked.radius = node._radius;
+    baked.multiplier = node._multiplier;
+
+    if (node._light) {
+        baked.hasLight = 1;
+        baked.lightPriority = node._light->priority;
+        baked.lightAmbientOnly = node._light->ambientOnly;
+        baked.lightAffectDynamic = node._light->affectDynamic;
+        baked.lightShadow = node._light->shadow;
+    }
+    if (node._mesh) {
+        int meshIndex = appendMesh(*node._mesh, tables);
+        if (meshIndex != -1) {
+            baked.meshIndex = static_cast<uint32_t>(meshIndex);
+        }
+    }
+    if (node._skin) {
+        baked.hasSkin = 1;
+        baked.bones.offset = static_cast<uint32_t>(tables.bones.size());
+        baked.bones.count = static_cast<uint32_t>(node._skin->nodeIdxByBoneIdx.size());
+        for (auto &pair : node._skin->nodeIdxByBoneIdx) {
+            BakedBone bone;
+            bone.boneIdx = pair.first;
+            bone.nodeIdx = pair.second;
+            tables.bones.push_back(move(bone));
+        }
+
+        // Order of an unordered map depends on the order of insertion, which
+        // would make baking a baked model non-deterministic
+        sort(
+            tables.bones.begin() + baked.bones.offset,
+            tables.bones.end(),
+            [](const BakedBone &left, const BakedBone &right) { return left.boneIdx < right.boneIdx; });
+    }
+
+    baked.positionFrames.offset = static_cast<uint32_t>(tables.positionFrames.size());
+    baked.positionFrames.count = static_cast<uint32_t>(node._positionFrames.size());
+    for (auto &frame : node._positionFrames) {
+        BakedPositionFrame bakedFrame;
+        bakedFrame.time = frame.time;
+        bakedFrame.position = frame.position;
+        tables.positionFrames.push_back(move(bakedFrame));
+    }
+
+    baked.orientationFrames.offset = static_cast<uint32_t>(tables.orientationFrames.size());
+    baked.orientationFrames.count = static_cast<uint32_t>(node._orientationFrames.size());
+    for (auto &frame : node._orientationFrames) {
+        BakedOrientationFrame bakedFrame;
+        bakedFrame.time = frame.time;
+        bakedFrame.orientation = frame.orientation;
+        tables.orientationFrames.push_back(move(bakedFrame));
+    }
+
+    vector<uint32_t> children;
+    children.reserve(node._children.size());
+    for (auto &child : node._children) {
+        children.push_back(appendNode(*child, tables));
+    }
+    baked.children.offset = static_cast<uint32_t>(tables.childIndices.size());
+    baked.children.count = static_cast<uint32_t>(children.size());
+    tables.childIndices.insert(tables.childIndices.end(), children.begin(), children.end());
+
+    tables.nodes[index] = move(baked);
+
+    return index;
+}
+
+int BakedModelWriter::appendMesh(const ModelMesh &mesh, Tables &tables) const {
+    int index = static_cast<int>(tables.meshes.size());
+
+    BakedMesh baked;
+    baked.render = mesh._render;
+    baked.transparency = mesh._transparency;
+    baked.shadow = mesh._shadow;
+    baked.offsets = mesh._offsets;
+    baked.aabbMin = mesh._aabb.min();
+    baked.aabbMax = mesh._aabb.max();
+    baked.diffuseNameOffset = appendString(mesh._diffuseName, tables);
+    baked.lightmapNameOffset = appendString(mesh._lightmapName, tables);
+    baked.vertices.offset = static_cast<uint32_t>(tables.vertices.size());
+    baked.vertices.count = static_cast<uint32_t>(mesh.vertexValueCount());
+    baked.indices.offset = static_cast<uint32_t>(tables.indices.size());
+    baked.indices.count = static_cast<uint32_t>(mesh.indexCount());
+
+    tables.vertices.insert(tables.vertices.end(), mesh.vertexData(), mesh.vertexData() + mesh.vertexValueCount());
+    tables.indices.insert(tables.indices.end(), mesh.indexData(), mesh.indexData() + mesh.indexCount());
+    tables.meshes.push_back(move(baked));
+
+    return index;
+}
+
+uint32_t BakedModelWriter::appendString(const string &s, Tables &tables) const {
+    if (s.empty()) return 0;
+
+    uint32_t offset = static_cast<uint32_t>(tables.strings.size());
+    tables.strings.insert(tables.strings.end(), s.begin(), s.end());
+    tables.strings.push_back('\0');
+
+    return offset;
+}
+
+// END Writer
+
+// Reader
+
+BakedModelReader::BakedModelReader(GameVersion version, bool resolveDependencies) :
+    _version(version),
+    _resolveDependencies(resolveDependencies) {
+}
+
+shared_ptr<Model> BakedModelReader::load(const fs::path &path, const BakedModelSource &source) {
+    // The region outlives the file mapping object, and is shared by meshes
+    // that use vertex and index data from it
+    ipc::file_mapping mapping(path.string().c_str(), ipc::read_only);
+    auto region = make_shared<ipc::mapped_region>(mapping, ipc::read_only);
+
+    _region = region;
+    _data = static_cast<const uint8_t *>(region->get_address());
+    _size = region->get_size();
+
+    if (_size < sizeof(BakedModelHeader)) {
+        throw runtime_error("Baked model is truncated: " + path.string());
+    }
+    _header = reinterpret_cast<const BakedModelHeader *>(_data);
+
+    if (memcmp(_header->signature, kSignature, 4) != 0 ||
+        _header->formatVersion != kFormatVersion ||
+        _header->gameVersion != static_cast<uint32_t>(_version) ||
+        _header->mdlSize != source.mdlSize ||
+        _header->mdxSize != source.mdxSize) {
+
+        _region.reset();
+        return nullptr;
+    }
+
+    const char *strings = getArray<char>(_header->strings.offset, _header->strings.count);
+    if (_header->strings.count == 0 || strings[_header->strings.count - 1] != '\0') {
+        throw runtime_error("Baked model has a malformed string table: " + path.string());
+    }
+
+    unique_ptr<ModelNode> rootNode(readNode(_header->rootNodeIndex, nullptr));
+
+    const BakedAnimation *bakedAnims = getArray<BakedAnimation>(_header->animations.offset, _header->animations.count);
+    vector<unique_ptr<Animation>> anims;
+    anims.reserve(_header->animations.count);
+
+    for (uint32_t i = 0; i < _header->animations.count; ++i) {
+        const BakedAnimation &bakedAnim = bakedAnims[i];
+        unique_ptr<ModelNode> animRootNode(readNode(bakedAnim.rootNodeIndex, nullptr));
+        anims.push_back(make_unique<Animation>(readString(bakedAnim.nameOffset), bakedAnim.length, bakedAnim.transitionTime, move(animRootNode)));
+    }
+
+    string superModelName(readString(_header->superModelNameOffset));
+    shared_ptr<Model> superModel;
+
+    if (_resolveDependencies && !superModelName.empty() && superModelName != "null") {
+        superModel = Models::instance().get(superModelName);
+    }
+
+    shared_ptr<Model> model(new Model(readString(_header->nameOffset), move(rootNode), anims, superModel));
+    model->_superModelName = move(superModelName);
+    model->setClassification(static_cast<Model::Classification>(_header->classification));
+    model->setAnimationScale(_header->animationScale);
+
+    _header = nullptr;
+    _data = nullptr;
+    _size = 0;
+    _region.reset();
+
+    return move(model);
+}
+
+template <class T>
+const T *BakedModelReader::getArray(uint32_t offset, uint32_t count) const {
+    if (offset % alignof(T) != 0 || offset > _size || count > (_size - offset) / sizeof(T)) {
+        throw runtime_error("Baked model array is out of bounds");
+    }
+    return reinterpret_cast<const T *>(_data + offset);
+}
+
+unique_ptr<ModelNode> BakedModelReader::readNode(uint32_t index, const ModelNode *parent) const {
+    if (index >= _header->nodes.count) {
+        throw runtime_error("Baked model node index is out of bounds: " + to_string(index));
+    }
+    const BakedNode &baked = getArray<BakedNode>(_header->nodes.offset, _header->nodes.count)[index];
+
+    unique_ptr<ModelNode> node(new ModelNode(baked.index, parent));
+    node->_flags = baked.flags;
+    node->_nodeNumber = baked.nodeNumber;
+    node->_name = readString(baked.nameOffset);
+    node->_position = baked.position;
+    node->_orientation = baked.orientation;
+    node->_localTransform = baked.localTransform;
+    node->_absTransform = baked.absTransform;
+    node->_absTransformInv = baked.absTransformInv;
+    node->_color = baked.color;
+    node->_selfIllumEnabled = baked.selfIllumEnabled != 0;
+    node->_selfIllumColor = baked.selfIllumColor;
+    node->_alpha = baked.alpha;
+    node->_radius = baked.radius;
+    node->_multiplier = baked.multiplier;
+
+    if (baked.hasLight) {
+        node->_light = make_shared<ModelNode::Light>();
+        node->_light->priority = baked.lightPriority;
+        node->_light->ambientOnly = baked.lightAmbientOnly != 0;
+        node->_light->affectDynamic = baked.lightAffectDynamic != 0;
+        node->_light->shadow = baked.lightShadow != 0;
+    }
+    if (baked.meshIndex != kNoMesh) {
+        node->_mesh = readMesh(baked.meshIndex);
+    }
+    if (baked.hasSkin) {
+        const BakedBone *bones = getArray<BakedBone>(_header->bones.offset, _header->bones.count);
+        if (baked.bones.offset > _header->bones.count || baked.bones.count > _header->bones.count - baked.bones.offset) {
+            throw runtime_error("Baked model bone range is out of bounds");
+        }
+        node->_skin = make_shared<ModelNode::Skin>();
+        for (uint32_t i = 0; i < baked.bones.count; ++i) {
+            const BakedBone &bone = bones[baked.bones.offset + i];
+            node->_skin->nodeIdxByBoneIdx.insert(make_pair(bone.boneIdx, bone.nodeIdx));
+        }
+    }
+
+    const BakedPositionFrame *positionFrames = getArray<BakedPositionFrame>(_header->positionFrames.offset, _header->positionFrames.count);
+    if (baked.positionFrames.offset > _header->positionFrames.count || baked.positionFrames.count > _header->positionFrames.count - baked.positionFrames.offset) {
+        throw runtime_error("Baked model keyframe range is out of bounds");
+    }
+    node->_positionFrames.resize(baked.positionFrames.count);
+    for (uint32_t i = 0; i < baked.positionFrames.count; ++i) {
+        const BakedPositionFrame &frame = positionFrames[baked.positionFrames.offset + i];
+        node->_positionFrames[i].time = frame.time;
+        node->_positionFrames[i].position = frame.position;
+    }
+
+    const BakedOrientationFrame *orientationFrames = getArray<BakedOrientationFrame>(_header->orientationFrames.offset, _header->orientationFrames.count);
+    if (baked.orientationFrames.offset > _header->orientationFrames.count || baked.orientationFrames.count > _header->orientationFrames.count - baked.orientationFrames.offset) {
+        throw runtime_error("Baked model keyframe range is out of bounds");
+    }
+    node->_orientationFrames.resize(baked.orientationFrames.count);
+    for (uint32_t i = 0; i < baked.orientationFrames.count; ++i) {
+        const BakedOrientationFrame &frame = orientationFrames[baked.orientationFrames.offset + i];
+        node->_orientationFrames[i].time = frame.time;
+        node->_orientationFrames[i].orientation = frame.orientation;
+    }
+
+    const uint32_t *childIndices = getArray<uint32_t>(_header->childIndices.offset, _header->childIndices.count);
+    if (baked.children.offset > _header->childIndices.count || baked.children.count > _header->childIndices.count - baked.children.offset) {
+        throw runtime_error("Baked model child range is out of bounds");
+    }
+    node->_children.reserve(baked.children.count);
+    for (uint32_t i = 0; i < baked.children.count; ++i) {
+        uint32_t childIndex = childIndices[baked.children.offset + i];
+
+        // Nodes are stored in pre-order, which rules out cycles
+        if (childIndex <= index) {
+            throw runtime_error("Baked model child index is invalid: " + to_string(childIndex));
+        }
+        node->_children.push_back(readNode(childIndex, node.get()));
+    }
+
+    return move(node);
+}
+
+unique_ptr<ModelMesh> BakedModelReader::readMesh(uint32_t index) const {
+    if (index >= _header->meshes.count) {
+        throw runtime_error("Baked model mesh index is out of bounds: " + to_string(index));
+    }
+    const BakedMesh &baked = getArray<BakedMesh>(_header->meshes.offset, _header->meshes.count)[index];
+
+    if (baked.vertices.offset > _header->vertices.count || baked.vertices.count > _header->vertices.count - baked.vertices.offset ||
+        baked.indices.offset > _header->indices.count || baked.indices.count > _header->indices.count - baked.indices.offset) {
+
+        throw runtime_error("Baked model mesh data is out of bounds");
+    }
+    const float *vertices = getArray<float>(_header->vertices.offset, _header->vertices.count) + baked.vertices.offset;
+    const uint16_t *indices = getArray<uint16_t>(_header->indices.offset, _header->indices.count) + baked.indices.offset;
+
+    unique_ptr<ModelMesh> mesh(new ModelMesh(baked.render != 0, baked.transparency, baked.shadow != 0));
+    mesh->setExternalData(_region, vertices, baked.vertices.count, indices, baked.indices.count);
+    mesh->_offsets = baked.offsets;
+    mesh->_aabb = AABB(baked.aabbMin, baked.aabbMax);
+    mesh->_diffuseName = readString(baked.diffuseNameOffset);
+    mesh->_lightmapName = readString(baked.lightmapNameOffset);
+
+    if (_resolveDependencies) {
+        mesh->loadTextures();
+    }
+
+    return move(mesh);
+}
+
+string BakedModelReader::readString(uint32_t offset) const {
+    if (offset >= _header->strings.count) {
+        throw runtime_error("Baked model string offset is out of bounds: " + to_string(offset));
+    }
+    return string(reinterpret_cast<const char *>(_data + _header->strings.offset + offset));
+}
+
+// END Reader
+
+} // namespace render
+
+} // namespace reone
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include "../../common/types.h"
+#include "../../resource/types.h"
+
+#include "model.h"
+
+namespace reone {
+
+namespace render {
+
+struct BakedModelHeader;
+
+/**
+ * Identifies the MDL and MDX resources a model was baked from. Sizes are
+ * compared instead of contents, so that a baked model can be validated
+ * without reading its source resources.
+ */
+struct BakedModelSource {
+    uint32_t mdlSize { 0 };
+    uint32_t mdxSize { 0 };
+};
+
+/**
+ * Writes a model in the baked format: a flat, relocatable layout, in which
+ * nodes, keyframes, meshes and animations are stored as arrays, and
+ * references between them are stored as array indices. Vertex and index
+ * data is stored exactly as it is uploaded to the GPU.
+ *
+ * @see reone::render::BakedModelReader
+ */
+class BakedModelWriter {
+public:
+    BakedModelWriter(resource::GameVersion version, const BakedModelSource &source);
+
+    void save(const Model &model, const boost::filesystem::path &path);
+
+private:
+    struct Tables;
+
+    resource::GameVersion _version { resource::GameVersion::KotOR };
+    BakedModelSource _source;
+
+    BakedModelWriter(const BakedModelWriter &) = delete;
+    BakedModelWriter &operator=(const BakedModelWriter &) = delete;
+
+    uint32_t appendNode(const ModelNode &node, Tables &tables) const;
+    int appendMesh(const ModelMesh &mesh, Tables &tables) const;
+    uint32_t appendString(const std::string &s, Tables &tables) const;
+};
+
+/**
+ * Maps a baked model file into memory and builds a model from it. Offsets
+ * stored in the file are resolved into pointers into the mapped region.
+ * Meshes use vertex and index data directly from the mapped region, which
+ * stays mapped as long as any of them is alive.
+ *
+ * @see reone::render::BakedModelWriter
+ */
+class BakedModelReader {
+public:
+    /**
+     * @param resolveDependencies whether to load textures and the supermodel,
+     *                            which requires an OpenGL context
+     */
+    BakedModelReader(resource::GameVersion version, bool resolveDependencies = true);
+
+    /**
+     * @return loaded model, or nullptr if the file was baked for another game,
+     *         by another version of the format or from different resources
+     * @throws std::runtime_error if the file is malformed
+     */
+    std::shared_ptr<Model> load(const boost::filesystem::path &path, const BakedModelSource &source);
+
+private:
+    resource::GameVersion _version { resource::GameVersion::KotOR };
+    bool _resolveDependencies { true };
+    std::shared_ptr<const void> _region;
+    const uint8_t *_data { nullptr };
+    size_t _size { 0 };
+    const BakedModelHeader *_header { nullptr };
+
+    BakedModelReader(const BakedModelReader &) = delete;
+    BakedModelReader &operator=(const BakedModelReader &) = delete;
+
+    std::unique_ptr<ModelNode> readNode(uint32_t index, const ModelNode *parent) const;
+    std::unique_ptr<ModelMesh> readMesh(uint32_t index) const;
+    std::string readString(uint32_t offset) const;
+
+    template <class T>
+    const T *getArray(uint32_t offset, uint32_t count) const;
+};
+
+} // namespace render
+
+} // namespace reone
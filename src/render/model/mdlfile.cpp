@@ -25,7 +25,6 @@
 #include "../../resource/resources.h"
 
 #include "../models.h"
-#include "../textures.h"
 
 using namespace std;
 
@@ -64,7 +63,10 @@ enum class ControllerType {
     Multiplier = 140
 };
 
-MdlFile::MdlFile(GameVersion version) : BinaryFile(kSignatureSize, kSignature), _version(version) {
+MdlFile::MdlFile(GameVersion version, bool resolveDependencies) :
+    BinaryFile(kSignatureSize, kSignature),
+    _version(version),
+    _resolveDependencies(resolveDependencies) {
 }
 
 void MdlFile::load(const shared_ptr<istream> &mdl, const shared_ptr<istream> &mdx) {
@@ -125,11 +127,12 @@ void MdlFile::doLoad() {
     vector<unique_ptr<Animation>> anims(readAnimations(animOffsets));
     shared_ptr<Model> superModel;
 
-    if (!superModelName.empty() && superModelName != "null") {
+    if (_resolveDependencies && !superModelName.empty() && superModelName != "null") {
         superModel = Models::instance().get(superModelName);
     }
 
     _model = make_unique<Model>(_name, move(rootNode), anims, superModel);
+    _model->_superModelName = move(superModelName);
     _model->setClassification(getClassification(classification));
     _model->setAnimationScale(scale);
 }
@@ -509,23 +512,11 @@ unique_ptr<ModelMesh> MdlFile::readMesh() {
     mesh->_offsets = move(offsets);
     mesh->computeAABB();
 
-    if (!diffuse.empty() && diffuse != "null") {
-        mesh->_diffuse = Textures::instance().get(diffuse, TextureType::Diffuse);
-        if (mesh->_diffuse) {
-            const TextureFeatures &features = mesh->_diffuse->features();
-            if (!features.envMapTexture.empty()) {
-                mesh->_envmap = Textures::instance().get(features.envMapTexture, TextureType::EnvironmentMap);
-            }
-            if (!features.bumpyShinyTexture.empty()) {
-                mesh->_bumpyShiny = Textures::instance().get(features.bumpyShinyTexture, TextureType::EnvironmentMap);
-            }
-            if (!features.bumpMapTexture.empty()) {
-                mesh->_bumpmap = Textures::instance().get(features.bumpMapTexture, TextureType::Bumpmap);
-            }
-        }
-    }
-    if (!lightmap.empty()) {
-        mesh->_lightmap = Textures::instance().get(lightmap, TextureType::Lightmap);
+    mesh->_diffuseName = move(diffuse);
+    mesh->_lightmapName = move(lightmap);
+
+    if (_resolveDependencies) {
+        mesh->loadTextures();
     }
 
     return move(mesh);
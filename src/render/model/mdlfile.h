@@ -28,13 +28,18 @@ namespace render {
 
 class MdlFile : public resource::BinaryFile {
 public:
-    MdlFile(resource::GameVersion version);
+    /**
+     * @param resolveDependencies whether to load textures and the supermodel,
+     *                            which requires an OpenGL context
+     */
+    MdlFile(resource::GameVersion version, bool resolveDependencies = true);
 
     void load(const std::shared_ptr<std::istream> &mdl, const std::shared_ptr<std::istream> &mdx);
     std::shared_ptr<render::Model> model() const;
 
 private:
     resource::GameVersion _version { resource::GameVersion::KotOR };
+    bool _resolveDependencies { true };
     std::shared_ptr<std::istream> _mdx;
     std::unique_ptr<StreamReader> _mdxReader;
     std::string _name;
@@ -79,6 +79,7 @@ private:
     std::shared_ptr<ModelNode> _rootNode;
     std::unordered_map<std::string, std::unique_ptr<Animation>> _animations;
     std::shared_ptr<Model> _superModel;
+    std::string _superModelName;
     std::unordered_map<uint16_t, std::shared_ptr<ModelNode>> _nodeByNumber;
     std::unordered_map<std::string, std::shared_ptr<ModelNode>> _nodeByName;
     AABB _aabb;
@@ -90,7 +91,10 @@ private:
 
     void init(const std::shared_ptr<ModelNode> &node);
 
+    friend class BakedModelReader;
+    friend class BakedModelWriter;
     friend class MdlFile;
+    friend class Models;
 };
 
 } // namespace render
@@ -115,6 +115,8 @@ private:
     ModelNode(const ModelNode &) = delete;
     ModelNode &operator=(const ModelNode &) = delete;
 
+    friend class BakedModelReader;
+    friend class BakedModelWriter;
     friend class MdlFile;
 };
 
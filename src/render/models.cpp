@@ -17,15 +17,22 @@
 
 #include "models.h"
 
+#include <boost/filesystem.hpp>
+
+#include "../common/log.h"
 #include "../common/streamutil.h"
 #include "../resource/resources.h"
 
+#include "mesh/modelmesh.h"
+#include "model/bakedmodel.h"
 #include "model/mdlfile.h"
 
 using namespace std;
 
 using namespace reone::resource;
 
+namespace fs = boost::filesystem;
+
 namespace reone {
 
 namespace render {
@@ -35,41 +42,179 @@ Models &Models::instance() {
     return instance;
 }
 
-void Models::init(GameVersion version) {
+void Models::init(GameVersion version, const fs::path &cachePath, bool glEnabled) {
     _version = version;
+    _cachePath = cachePath;
+    _glEnabled = glEnabled;
+
+    if (!_cachePath.empty() && !fs::exists(_cachePath)) {
+        boost::system::error_code ec;
+        fs::create_directories(_cachePath, ec);
+        if (ec) {
+            warn("Models: unable to create model cache directory: " + _cachePath.string());
+            _cachePath.clear();
+        }
+    }
 }
 
 void Models::invalidateCache() {
+    lock_guard<mutex> lock(_cacheMutex);
     _cache.clear();
+    _preloaded.clear();
 }
 
 shared_ptr<Model> Models::get(const string &resRef) {
+    // Only the main thread modifies the cache, so lookups need no lock here
     auto maybeModel = _cache.find(resRef);
     if (maybeModel != _cache.end()) {
         return maybeModel->second;
     }
-    auto inserted = _cache.insert(make_pair(resRef, doGet(resRef)));
+    shared_ptr<Model> model(doGet(resRef));
+
+    lock_guard<mutex> lock(_cacheMutex);
+    auto inserted = _cache.insert(make_pair(resRef, move(model)));
 
     return inserted.first->second;
 }
 
+void Models::preload(const string &resRef) {
+    if (resRef.empty()) return;
+    {
+        lock_guard<mutex> lock(_cacheMutex);
+        if (_cache.count(resRef) > 0 || _preloaded.count(resRef) > 0) return;
+        if (!_preloading.insert(resRef).second) return;
+    }
+    shared_ptr<Model> model;
+    try {
+        model = decode(resRef, false);
+    }
+    catch (...) {
+        {
+            lock_guard<mutex> lock(_cacheMutex);
+            _preloading.erase(resRef);
+        }
+        _preloadedCondition.notify_all();
+        throw;
+    }
+    {
+        lock_guard<mutex> lock(_cacheMutex);
+        _preloading.erase(resRef);
+        _preloaded.insert(make_pair(resRef, move(model)));
+    }
+    _preloadedCondition.notify_all();
+}
+
 shared_ptr<Model> Models::doGet(const string &resRef) {
-    shared_ptr<ByteArray> mdlData(Resources::instance().get(resRef, ResourceType::Model));
-    shared_ptr<ByteArray> mdxData(Resources::instance().get(resRef, ResourceType::Mdx));
     shared_ptr<Model> model;
+    bool preloaded = false;
+    {
+        // Decoding the same model twice would waste time and race on the baked model file
+        unique_lock<mutex> lock(_cacheMutex);
+        _preloadedCondition.wait(lock, [&]() { return _preloading.count(resRef) == 0; });
+
+        auto maybePreloaded = _preloaded.find(resRef);
+        if (maybePreloaded != _preloaded.end()) {
+            model = move(maybePreloaded->second);
+            preloaded = true;
+            _preloaded.erase(maybePreloaded);
+        }
+    }
+    if (!preloaded) {
+        model = decode(resRef, true);
+    } else if (model) {
+        resolveDependencies(*model);
+    }
+    if (model && _glEnabled) {
+        model->initGL();
+    }
+
+    return move(model);
+}
+
+shared_ptr<Model> Models::decode(const string &resRef, bool resolveDependencies) {
+    Resources &resources = Resources::instance();
+    shared_ptr<Model> model;
+
+    // Baked models are validated against sizes of the source resources, so
+    // that a cache hit does not have to read them
+
+    fs::path bakedPath;
+    BakedModelSource source;
+    size_t mdlSize = 0;
+    size_t mdxSize = 0;
+
+    if (!_cachePath.empty() &&
+        resources.getSize(resRef, ResourceType::Model, mdlSize) &&
+        resources.getSize(resRef, ResourceType::Mdx, mdxSize)) {
+
+        source.mdlSize = static_cast<uint32_t>(mdlSize);
+        source.mdxSize = static_cast<uint32_t>(mdxSize);
+        bakedPath = _cachePath;
+        bakedPath.append(resRef + ".rbm");
+        model = loadBaked(bakedPath, source, resolveDependencies);
+        if (model) return move(model);
+    }
+
+    shared_ptr<ByteArray> mdlData(resources.get(resRef, ResourceType::Model));
+    shared_ptr<ByteArray> mdxData(resources.get(resRef, ResourceType::Mdx));
 
     if (mdlData && mdxData) {
-        MdlFile mdl(_version);
+        MdlFile mdl(_version, resolveDependencies);
         mdl.load(wrap(mdlData), wrap(mdxData));
         model = mdl.model();
-        if (model) {
-            model->initGL();
+
+        if (model && !bakedPath.empty()) {
+            saveBaked(*model, bakedPath, source);
         }
     }
 
     return move(model);
 }
 
+shared_ptr<Model> Models::loadBaked(const fs::path &path, const BakedModelSource &source, bool resolveDependencies) {
+    if (!fs::exists(path)) return nullptr;
+
+    try {
+        BakedModelReader reader(_version, resolveDependencies);
+        shared_ptr<Model> model(reader.load(path, source));
+        if (!model) {
+            debug("Models: baked model is stale: " + path.string(), 2);
+        }
+        return move(model);
+    }
+    catch (const exception &ex) {
+        warn(boost::format("Models: unable to load baked model: %s: %s") % path.string() % ex.what());
+        return nullptr;
+    }
+}
+
+void Models::resolveDependencies(Model &model) {
+    if (!model._superModelName.empty() && model._superModelName != "null") {
+        model._superModel = get(model._superModelName);
+    }
+    resolveTextures(*model._rootNode);
+}
+
+void Models::resolveTextures(const ModelNode &node) {
+    shared_ptr<ModelMesh> mesh(node.mesh());
+    if (mesh) {
+        mesh->loadTextures();
+    }
+    for (auto &child : node.children()) {
+        resolveTextures(*child);
+    }
+}
+
+void Models::saveBaked(const Model &model, const fs::path &path, const BakedModelSource &source) {
+    try {
+        BakedModelWriter writer(_version, source);
+        writer.save(model, path);
+    }
+    catch (const exception &ex) {
+        warn(boost::format("Models: unable to save baked model: %s: %s") % path.string() % ex.what());
+    }
+}
+
 } // namespace render
 
 } // namespace reone
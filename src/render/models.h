@@ -17,9 +17,14 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
+
+#include <boost/filesystem/path.hpp>
 
 #include "../resource/types.h"
 
@@ -30,25 +35,53 @@ namespace reone {
 namespace render {
 
 class Model;
+class ModelNode;
+
+struct BakedModelSource;
 
 class Models {
 public:
     static Models &instance();
 
-    void init(resource::GameVersion version);
+    /**
+     * @param cachePath path to a directory with baked models, empty to disable
+     *                  the model cache
+     * @param glEnabled if false, meshes are never uploaded to the GPU, e.g.
+     *                  when running a dedicated server without a GL context
+     */
+    void init(resource::GameVersion version, const boost::filesystem::path &cachePath = boost::filesystem::path(), bool glEnabled = true);
     void invalidateCache();
 
     std::shared_ptr<Model> get(const std::string &resRef);
 
+    /**
+     * Decodes a model ahead of time, without its textures and supermodel, so
+     * that a subsequent call to get only has to resolve those and upload the
+     * model to the GPU. Models that are already cached are skipped, and get
+     * waits for a preload of the same model to finish. Thread-safe.
+     */
+    void preload(const std::string &resRef);
+
 private:
     resource::GameVersion _version { resource::GameVersion::KotOR };
+    boost::filesystem::path _cachePath;
+    bool _glEnabled { true };
     std::unordered_map<std::string, std::shared_ptr<Model>> _cache;
+    std::unordered_map<std::string, std::shared_ptr<Model>> _preloaded; /**< nullptr if not found */
+    std::unordered_set<std::string> _preloading; /**< models being decoded by preload */
+    std::mutex _cacheMutex; /**< guards the above, except main thread reads of the cache */
+    std::condition_variable _preloadedCondition;
 
     Models() = default;
     Models(const Models &) = delete;
     Models &operator=(const Models &) = delete;
 
     std::shared_ptr<Model> doGet(const std::string &resRef);
+    std::shared_ptr<Model> decode(const std::string &resRef, bool resolveDependencies);
+    std::shared_ptr<Model> loadBaked(const boost::filesystem::path &path, const BakedModelSource &source, bool resolveDependencies);
+    void resolveDependencies(Model &model);
+    void resolveTextures(const ModelNode &node);
+    void saveBaked(const Model &model, const boost::filesystem::path &path, const BakedModelSource &source);
 };
 
 } // namespace render
@@ -39,18 +39,17 @@ static const int kLightingBindingPointIndex = 3;
 static const int kShadowsBindingPointIndex = 4;
 static const int kSkeletalBindingPointIndex = 5;
 
+static const int kUniformRingRegionSize = 8 * 1024 * 1024;
+static const int kUniformRingRegionCount = 3;
+
 static const GLchar kCommonShaderHeader[] = R"END(
 #version 330
 
-const int MAX_LIGHTS = 8;
 const int MAX_SHADOW_LIGHTS = 2;
 const int MAX_BONES = 128;
-
-struct Light {
-    vec4 position;
-    vec4 color;
-    float radius;
-};
+const int CLUSTER_COUNT_X = 16;
+const int CLUSTER_COUNT_Y = 9;
+const int CLUSTER_COUNT_Z = 24;
 
 struct ShadowLight {
     vec4 position;
@@ -82,8 +81,8 @@ layout(std140) uniform General {
 
 layout(std140) uniform Lighting {
     vec4 uAmbientLightColor;
-    int uLightCount;
-    Light uLights[MAX_LIGHTS];
+    float uClusterDepthScale;
+    float uClusterDepthBias;
 };
 
 layout(std140) uniform Shadows {
@@ -164,6 +163,24 @@ void main() {
 }
 )END";
 
+static const GLchar kSpriteVertexShader[] = R"END(
+uniform mat4 uProjection;
+uniform mat4 uView;
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 2) in vec2 aTexCoords;
+layout(location = 6) in vec4 aColor;
+
+out vec2 fragTexCoords;
+out vec4 fragVertexColor;
+
+void main() {
+    gl_Position = uProjection * uView * vec4(aPosition, 1.0);
+    fragTexCoords = aTexCoords;
+    fragVertexColor = aColor;
+}
+)END";
+
 static const GLchar kWhiteFragmentShader[] = R"END(
 layout(location = 0) out vec4 fragColor;
 layout(location = 1) out vec4 fragColorBright;
@@ -194,6 +211,27 @@ void main() {
 }
 )END";
 
+static const GLchar kSpriteFragmentShader[] = R"END(
+uniform sampler2D uTexture;
+
+in vec2 fragTexCoords;
+in vec4 fragVertexColor;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec4 fragColorBright;
+
+void main() {
+    vec4 textureSample = texture(uTexture, fragTexCoords);
+    vec3 finalColor = fragVertexColor.rgb * textureSample.rgb;
+
+    if (uDiscardEnabled && length(uDiscardColor.rgb - finalColor) < 0.01) {
+        discard;
+    }
+    fragColor = vec4(finalColor, fragVertexColor.a * textureSample.a);
+    fragColorBright = vec4(0.0, 0.0, 0.0, 1.0);
+}
+)END";
+
 static const GLchar kModelFragmentShader[] = R"END(
 const vec3 RGB_TO_LUMINOSITY = vec3(0.2126, 0.7152, 0.0722);
 
@@ -203,7 +241,11 @@ uniform sampler2D uBumpmap;
 uniform samplerCube uEnvmap;
 uniform samplerCube uBumpyShiny;
 uniform sampler2D uShadowmaps[MAX_SHADOW_LIGHTS];
+uniform samplerBuffer uLights;
+uniform usamplerBuffer uClusters;
 
+uniform mat4 uProjection;
+uniform mat4 uView;
 uniform vec3 uCameraPosition;
 
 in vec3 fragPosition;
@@ -227,13 +269,32 @@ void applyEnvmap(samplerCube image, vec3 normal, float a, inout vec3 color) {
     color += sample.rgb * a;
 }
 
+int getClusterIndex() {
+    vec4 viewPos = uView * vec4(fragPosition, 1.0);
+    vec4 clipPos = uProjection * viewPos;
+    vec2 ndc = clipPos.xy / clipPos.w;
+    float depth = max(-viewPos.z, 1e-3);
+
+    int x = clamp(int((0.5 * ndc.x + 0.5) * CLUSTER_COUNT_X), 0, CLUSTER_COUNT_X - 1);
+    int y = clamp(int((0.5 * ndc.y + 0.5) * CLUSTER_COUNT_Y), 0, CLUSTER_COUNT_Y - 1);
+    int z = clamp(int(floor(log(depth) * uClusterDepthScale + uClusterDepthBias)), 0, CLUSTER_COUNT_Z - 1);
+
+    return x + CLUSTER_COUNT_X * (y + CLUSTER_COUNT_Y * z);
+}
+
 void applyLighting(vec3 normal, inout vec3 color) {
     color += uAmbientLightColor.rgb;
 
-    if (uLightCount == 0) return;
+    int clusterIdx = getClusterIndex();
+    int offset = int(texelFetch(uClusters, 2 * clusterIdx).r);
+    int count = int(texelFetch(uClusters, 2 * clusterIdx + 1).r);
+
+    for (int i = offset; i < offset + count; ++i) {
+        int lightIdx = int(texelFetch(uClusters, i).r);
+        vec4 lightPosition = texelFetch(uLights, 2 * lightIdx);
+        vec4 lightColor = texelFetch(uLights, 2 * lightIdx + 1);
 
-    for (int i = 0; i < uLightCount; ++i) {
-        vec3 surfaceToLight = uLights[i].position.xyz - fragPosition;
+        vec3 surfaceToLight = lightPosition.xyz - fragPosition;
         vec3 lightDir = normalize(surfaceToLight);
 
         vec3 surfaceToCamera = normalize(uCameraPosition - fragPosition);
@@ -245,10 +306,10 @@ void applyLighting(vec3 normal, inout vec3 color) {
         }
         float distToLight = length(surfaceToLight);
 
-        float attenuation = clamp(1.0 - distToLight / uLights[i].radius, 0.0, 1.0);
+        float attenuation = clamp(1.0 - distToLight / lightPosition.w, 0.0, 1.0);
         attenuation *= attenuation;
 
-        color += attenuation * (diffuse + specular) * uLights[i].color.rgb;
+        color += attenuation * (diffuse + specular) * lightColor.rgb;
     }
 }
 
@@ -346,6 +407,29 @@ void main() {
 }
 )END";
 
+static const GLchar kBoxBlurFragmentShader[] = R"END(
+uniform sampler2D uTexture;
+
+out vec4 fragColor;
+
+void main() {
+    vec2 uv = vec2(gl_FragCoord.xy / uBlurResolution);
+    vec2 off = uBlurDirection / uBlurResolution;
+
+    if (off == vec2(0.0)) {
+        fragColor = texture(uTexture, uv);
+        return;
+    }
+    vec4 color = vec4(0.0);
+    color += texture(uTexture, uv + vec2(-off.x, -off.y));
+    color += texture(uTexture, uv + vec2(off.x, -off.y));
+    color += texture(uTexture, uv + vec2(-off.x, off.y));
+    color += texture(uTexture, uv + vec2(off.x, off.y));
+
+    fragColor = 0.25 * color;
+}
+)END";
+
 static const GLchar kBloomFragmentShader[] = R"END(
 uniform sampler2D uGeometry;
 uniform sampler2D uBloom;
@@ -362,37 +446,76 @@ void main() {
 }
 )END";
 
+static const GLchar kVideoFragmentShader[] = R"END(
+uniform sampler2D uTexture;
+uniform sampler2D uChromaU;
+uniform sampler2D uChromaV;
+
+in vec2 fragTexCoords;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec4 fragColorBright;
+
+void main() {
+    // BT.601, limited range
+    float y = 1.164383 * (texture(uTexture, fragTexCoords).r - 0.062745);
+    float u = texture(uChromaU, fragTexCoords).r - 0.501961;
+    float v = texture(uChromaV, fragTexCoords).r - 0.501961;
+
+    vec3 color = vec3(
+        y + 1.596027 * v,
+        y - 0.391762 * u - 0.812968 * v,
+        y + 2.017232 * u);
+
+    fragColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+    fragColorBright = vec4(0.0, 0.0, 0.0, 1.0);
+}
+)END";
+
 Shaders &Shaders::instance() {
     static Shaders instance;
     return instance;
 }
 
-Shaders::Shaders() {
-    _lightingUniforms = make_shared<LightingUniforms>();
+Shaders::Shaders() : _uniformRing(kUniformRingRegionSize, kUniformRingRegionCount) {
     _skeletalUniforms = make_shared<SkeletalUniforms>();
 }
 
 void Shaders::initGL() {
     initShader(ShaderName::VertexGUI, GL_VERTEX_SHADER, kGUIVertexShader);
     initShader(ShaderName::VertexModel, GL_VERTEX_SHADER, kModelVertexShader);
+    initShader(ShaderName::VertexSprite, GL_VERTEX_SHADER, kSpriteVertexShader);
     initShader(ShaderName::FragmentWhite, GL_FRAGMENT_SHADER, kWhiteFragmentShader);
     initShader(ShaderName::FragmentGUI, GL_FRAGMENT_SHADER, kGUIFragmentShader);
     initShader(ShaderName::FragmentModel, GL_FRAGMENT_SHADER, kModelFragmentShader);
     initShader(ShaderName::FragmentBlur, GL_FRAGMENT_SHADER, kGaussianBlurFragmentShader);
+    initShader(ShaderName::FragmentBoxBlur, GL_FRAGMENT_SHADER, kBoxBlurFragmentShader);
     initShader(ShaderName::FragmentBloom, GL_FRAGMENT_SHADER, kBloomFragmentShader);
+    initShader(ShaderName::FragmentSprite, GL_FRAGMENT_SHADER, kSpriteFragmentShader);
+    initShader(ShaderName::FragmentVideo, GL_FRAGMENT_SHADER, kVideoFragmentShader);
 
     initProgram(ShaderProgram::GUIGUI, ShaderName::VertexGUI, ShaderName::FragmentGUI);
     initProgram(ShaderProgram::GUIBlur, ShaderName::VertexGUI, ShaderName::FragmentBlur);
+    initProgram(ShaderProgram::GUIBoxBlur, ShaderName::VertexGUI, ShaderName::FragmentBoxBlur);
     initProgram(ShaderProgram::GUIBloom, ShaderName::VertexGUI, ShaderName::FragmentBloom);
     initProgram(ShaderProgram::GUIWhite, ShaderName::VertexGUI, ShaderName::FragmentWhite);
+    initProgram(ShaderProgram::GUIVideo, ShaderName::VertexGUI, ShaderName::FragmentVideo);
     initProgram(ShaderProgram::ModelWhite, ShaderName::VertexModel, ShaderName::FragmentWhite);
     initProgram(ShaderProgram::ModelModel, ShaderName::VertexModel, ShaderName::FragmentModel);
+    initProgram(ShaderProgram::SpriteSprite, ShaderName::VertexSprite, ShaderName::FragmentSprite);
 
     glGenBuffers(1, &_generalUbo);
     glGenBuffers(1, &_lightingUbo);
     glGenBuffers(1, &_shadowsUbo);
     glGenBuffers(1, &_skeletalUbo);
 
+    _uniformRing.initGL();
+
+    glGenBuffers(1, &_lightsBuffer);
+    glGenTextures(1, &_lightsTexture);
+    glGenBuffers(1, &_clustersBuffer);
+    glGenTextures(1, &_clustersTexture);
+
     for (auto &program : _programs) {
         glUseProgram(program.second);
         _activeOrdinal = program.second;
@@ -421,6 +544,10 @@ void Shaders::initGL() {
         setUniform("uBumpyShiny", TextureUniforms::bumpyShiny);
         setUniform("uBumpmap", TextureUniforms::bumpmap);
         setUniform("uBloom", TextureUniforms::bloom);
+        setUniform("uLights", TextureUniforms::lights);
+        setUniform("uClusters", TextureUniforms::clusters);
+        setUniform("uChromaU", TextureUniforms::chromaU);
+        setUniform("uChromaV", TextureUniforms::chromaV);
 
         for (int i = 0; i < kMaxShadowLightCount; ++i) {
             string name(str(boost::format("uShadowmaps[%d]") % i));
@@ -478,6 +605,24 @@ Shaders::~Shaders() {
 }
 
 void Shaders::deinitGL() {
+    _uniformRing.deinitGL();
+
+    if (_clustersTexture) {
+        glDeleteTextures(1, &_clustersTexture);
+        _clustersTexture = 0;
+    }
+    if (_clustersBuffer) {
+        glDeleteBuffers(1, &_clustersBuffer);
+        _clustersBuffer = 0;
+    }
+    if (_lightsTexture) {
+        glDeleteTextures(1, &_lightsTexture);
+        _lightsTexture = 0;
+    }
+    if (_lightsBuffer) {
+        glDeleteBuffers(1, &_lightsBuffer);
+        _lightsBuffer = 0;
+    }
     if (_skeletalUbo) {
         glDeleteBuffers(1, &_skeletalUbo);
         _skeletalUbo = 0;
@@ -525,19 +670,20 @@ unsigned int Shaders::getOrdinal(ShaderProgram program) const {
 }
 
 void Shaders::setLocalUniforms(const LocalUniforms &locals) {
-    glBindBufferBase(GL_UNIFORM_BUFFER, kGeneralBindingPointIndex, _generalUbo);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(GeneralUniforms), &locals.general, GL_STATIC_DRAW);
+    setUniformBlock(kGeneralBindingPointIndex, _generalUbo, &locals.general, sizeof(GeneralUniforms));
 
     if (locals.general.skeletalEnabled) {
-        glBindBufferBase(GL_UNIFORM_BUFFER, kSkeletalBindingPointIndex, _skeletalUbo);
-        glBufferData(GL_UNIFORM_BUFFER, sizeof(SkeletalUniforms), locals.skeletal.get(), GL_STATIC_DRAW);
-    }
-    if (locals.general.lightingEnabled) {
-        glBindBufferBase(GL_UNIFORM_BUFFER, kLightingBindingPointIndex, _lightingUbo);
-        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightingUniforms), locals.lighting.get(), GL_STATIC_DRAW);
+        setUniformBlock(kSkeletalBindingPointIndex, _skeletalUbo, locals.skeletal.get(), sizeof(SkeletalUniforms));
     }
 }
 
+void Shaders::setUniformBlock(int bindingPoint, uint32_t ubo, const void *data, int size) {
+    if (_uniformRing.push(bindingPoint, data, size)) return;
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, size, data, GL_STREAM_DRAW);
+}
+
 void Shaders::setUniform(const string &name, const glm::mat4 &m) {
     setUniform(name, [this, &m](int loc) {
         glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(m));
@@ -592,6 +738,14 @@ void Shaders::setUniform(const string &name, const vector<glm::mat4> &arr) {
     });
 }
 
+void Shaders::beginFrame() {
+    _uniformRing.beginFrame();
+}
+
+void Shaders::endFrame() {
+    _uniformRing.endFrame();
+}
+
 void Shaders::deactivate() {
     if (_activeProgram == ShaderProgram::None) return;
 
@@ -600,10 +754,6 @@ void Shaders::deactivate() {
     _activeOrdinal = 0;
 }
 
-shared_ptr<LightingUniforms> Shaders::lightingUniforms() const {
-    return _lightingUniforms;
-}
-
 shared_ptr<SkeletalUniforms> Shaders::skeletalUniforms() const {
     return _skeletalUniforms;
 }
@@ -618,12 +768,40 @@ void Shaders::setGlobalUniforms(const GlobalUniforms &globals) {
         setUniform("uProjection", globals.projection);
         setUniform("uView", globals.view);
         setUniform("uCameraPosition", globals.cameraPosition);
-
-        glBindBufferBase(GL_UNIFORM_BUFFER, kShadowsBindingPointIndex, _shadowsUbo);
-        glBufferData(GL_UNIFORM_BUFFER, sizeof(ShadowsUniforms), &globals.shadows, GL_STATIC_DRAW);
     }
     glUseProgram(ordinal);
     _activeOrdinal = ordinal;
+
+    setUniformBlock(kShadowsBindingPointIndex, _shadowsUbo, &globals.shadows, sizeof(ShadowsUniforms));
+    setUniformBlock(kLightingBindingPointIndex, _lightingUbo, &globals.lighting, sizeof(LightingUniforms));
+}
+
+void Shaders::setLightGrid(const LightGrid &grid) {
+    const vector<float> &lightData = grid.lightData();
+    const vector<uint32_t> &clusterData = grid.clusterData();
+
+    // Texture buffers must not be empty
+    static const float kNoLights[8] { 0.0f };
+
+    glBindBuffer(GL_TEXTURE_BUFFER, _lightsBuffer);
+    if (lightData.empty()) {
+        glBufferData(GL_TEXTURE_BUFFER, sizeof(kNoLights), kNoLights, GL_STREAM_DRAW);
+    } else {
+        glBufferData(GL_TEXTURE_BUFFER, lightData.size() * sizeof(float), &lightData[0], GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, _clustersBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, clusterData.size() * sizeof(uint32_t), &clusterData[0], GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glActiveTexture(GL_TEXTURE0 + TextureUniforms::lights);
+    glBindTexture(GL_TEXTURE_BUFFER, _lightsTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, _lightsBuffer);
+
+    glActiveTexture(GL_TEXTURE0 + TextureUniforms::clusters);
+    glBindTexture(GL_TEXTURE_BUFFER, _clustersTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, _clustersBuffer);
+
+    glActiveTexture(GL_TEXTURE0);
 }
 
 } // namespace render
@@ -26,23 +26,27 @@
 
 #include "glm/glm.hpp"
 
+#include "lightgrid.h"
 #include "types.h"
+#include "uniformring.h"
 
 namespace reone {
 
 namespace render {
 
-const int kMaxLightCount = 8;
 const int kMaxBoneCount = 128;
 
 enum class ShaderProgram {
     None,
     GUIGUI,
     GUIBlur,
+    GUIBoxBlur,
     GUIBloom,
     GUIWhite,
+    GUIVideo,
     ModelWhite,
-    ModelModel
+    ModelModel,
+    SpriteSprite
 };
 
 struct TextureUniforms {
@@ -52,6 +56,10 @@ struct TextureUniforms {
     static constexpr int bumpmap { 4 };
     static constexpr int bloom { 5 };
     static constexpr int shadowmap0 { 6 };
+    static constexpr int lights { 8 };
+    static constexpr int clusters { 9 };
+    static constexpr int chromaU { 10 };
+    static constexpr int chromaV { 11 };
 };
 
 struct ShadowsUniforms {
@@ -60,11 +68,19 @@ struct ShadowsUniforms {
     ShadowLight shadowLights[kMaxShadowLightCount];
 };
 
+struct LightingUniforms {
+    glm::vec4 ambientLightColor { 1.0f };
+    float clusterDepthScale { 0.0f };
+    float clusterDepthBias { 0.0f };
+    char padding[8];
+};
+
 struct GlobalUniforms {
     glm::mat4 projection { 1.0f };
     glm::mat4 view { 1.0f };
     glm::vec3 cameraPosition { 0.0f };
     ShadowsUniforms shadows;
+    LightingUniforms lighting;
 };
 
 struct GeneralUniforms {
@@ -97,24 +113,9 @@ struct SkeletalUniforms {
     glm::mat4 bones[kMaxBoneCount];
 };
 
-struct ShaderLight {
-    glm::vec4 position { 0.0f };
-    glm::vec4 color { 1.0f };
-    float radius { 1.0f };
-    char padding[12];
-};
-
-struct LightingUniforms {
-    glm::vec4 ambientLightColor { 1.0f };
-    int lightCount { 0 };
-    char padding[12];
-    ShaderLight lights[kMaxLightCount];
-};
-
 struct LocalUniforms {
     GeneralUniforms general;
     std::shared_ptr<SkeletalUniforms> skeletal;
-    std::shared_ptr<LightingUniforms> lighting;
 };
 
 class Shaders {
@@ -126,27 +127,42 @@ public:
     void activate(ShaderProgram program, const LocalUniforms &uniforms);
     void deactivate();
 
-    std::shared_ptr<LightingUniforms> lightingUniforms() const;
+    /**
+     * Marks the start of a frame. Uniforms set between beginFrame and endFrame
+     * are written into the uniform ring instead of being uploaded per draw.
+     */
+    void beginFrame();
+    void endFrame();
+
     std::shared_ptr<SkeletalUniforms> skeletalUniforms() const;
 
     void setGlobalUniforms(const GlobalUniforms &globals);
 
+    /**
+     * Uploads lights and per-cluster light lists into texture buffers, read
+     * by the model shader.
+     */
+    void setLightGrid(const LightGrid &grid);
+
 private:
     enum class ShaderName {
         VertexGUI,
         VertexModel,
+        VertexSprite,
         FragmentWhite,
         FragmentGUI,
         FragmentModel,
         FragmentBlur,
-        FragmentBloom
+        FragmentBoxBlur,
+        FragmentBloom,
+        FragmentSprite,
+        FragmentVideo
     };
 
     std::unordered_map<ShaderName, uint32_t> _shaders;
     std::unordered_map<ShaderProgram, uint32_t> _programs;
     ShaderProgram _activeProgram { ShaderProgram::None };
     uint32_t _activeOrdinal { 0 };
-    std::shared_ptr<LightingUniforms> _lightingUniforms;
     std::shared_ptr<SkeletalUniforms> _skeletalUniforms;
 
     // Uniform buffer objects
@@ -155,9 +171,19 @@ private:
     uint32_t _lightingUbo { 0 };
     uint32_t _shadowsUbo { 0 };
     uint32_t _skeletalUbo { 0 };
+    UniformRing _uniformRing;
 
     // END Uniform buffer objects
 
+    // Light grid
+
+    uint32_t _lightsBuffer { 0 };
+    uint32_t _lightsTexture { 0 };
+    uint32_t _clustersBuffer { 0 };
+    uint32_t _clustersTexture { 0 };
+
+    // END Light grid
+
     Shaders();
     Shaders(const Shaders &) = delete;
     ~Shaders();
@@ -168,6 +194,7 @@ private:
     void initProgram(ShaderProgram program, ShaderName vertexShader, ShaderName fragmentShader);
     unsigned int getOrdinal(ShaderProgram program) const;
     void setLocalUniforms(const LocalUniforms &locals);
+    void setUniformBlock(int bindingPoint, uint32_t ubo, const void *data, int size);
     void setUniform(const std::string &name, int value);
     void setUniform(const std::string &name, const std::function<void(int)> &setter);
     void setUniform(const std::string &name, float value);
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "spritebatch.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "GL/glew.h"
+
+#include "SDL2/SDL_opengl.h"
+
+#include "glm/common.hpp"
+
+#include "shaders.h"
+#include "texture.h"
+#include "util.h"
+
+using namespace std;
+
+namespace reone {
+
+namespace render {
+
+static const int kMaxQuadCount = 16384; // 4 vertices per quad, must fit into 16-bit indices
+static const int kMaxBatchLookback = 32;
+
+bool SpriteState::operator==(const SpriteState &other) const {
+    return
+        texture == other.texture &&
+        additive == other.additive &&
+        discardEnabled == other.discardEnabled &&
+        (!discardEnabled || discardColor == other.discardColor);
+}
+
+SpriteBatch &SpriteBatch::instance() {
+    static SpriteBatch instance;
+    return instance;
+}
+
+void SpriteBatch::initGL() {
+    if (_glInited) return;
+
+    vector<uint16_t> indices(6 * kMaxQuadCount);
+    for (int i = 0; i < kMaxQuadCount; ++i) {
+        uint16_t *iv = &indices[6 * i];
+        int off = 4 * i;
+        iv[0] = off + 0; iv[1] = off + 1; iv[2] = off + 2;
+        iv[3] = off + 2; iv[4] = off + 3; iv[5] = off + 0;
+    }
+
+    glGenBuffers(1, &_indexBufferId);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferId);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), &indices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    glGenBuffers(1, &_vertexBufferId);
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexBufferId);
+    glBufferData(GL_ARRAY_BUFFER, 4 * kMaxQuadCount * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+
+    glGenVertexArrays(1, &_vertexArrayId);
+    glBindVertexArray(_vertexArrayId);
+
+    int stride = sizeof(SpriteVertex);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(offsetof(SpriteVertex, position)));
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(offsetof(SpriteVertex, texCoords)));
+
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(offsetof(SpriteVertex, color)));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    _quad.resize(4);
+    _glInited = true;
+}
+
+SpriteBatch::~SpriteBatch() {
+    deinitGL();
+}
+
+void SpriteBatch::deinitGL() {
+    if (!_glInited) return;
+
+    _batches.clear();
+
+    glDeleteVertexArrays(1, &_vertexArrayId);
+    glDeleteBuffers(1, &_vertexBufferId);
+    glDeleteBuffers(1, &_indexBufferId);
+
+    _glInited = false;
+}
+
+void SpriteBatch::begin() {
+    ++_depth;
+}
+
+void SpriteBatch::end() {
+    if (_depth == 0) return;
+
+    if (--_depth == 0) {
+        flush();
+    }
+}
+
+void SpriteBatch::draw(const SpriteState &state, const glm::mat4 &transform, const glm::vec4 &color, int flags) {
+    static const glm::vec2 kCorners[] = {
+        { 0.0f, 0.0f },
+        { 1.0f, 0.0f },
+        { 1.0f, 1.0f },
+        { 0.0f, 1.0f }
+    };
+    for (int i = 0; i < 4; ++i) {
+        const glm::vec2 &corner = kCorners[i];
+        SpriteVertex &vertex = _quad[i];
+        vertex.position = glm::vec3(transform * glm::vec4(corner, 0.0f, 1.0f));
+        vertex.texCoords.x = (flags & kSpriteFlipX) ? 1.0f - corner.x : corner.x;
+        vertex.texCoords.y = (flags & kSpriteFlipY) ? corner.y : 1.0f - corner.y;
+        vertex.color = color;
+    }
+    append(state, &_quad[0], 4);
+}
+
+void SpriteBatch::draw(const SpriteState &state, const vector<SpriteVertex> &vertices) {
+    if (vertices.empty()) return;
+
+    append(state, &vertices[0], static_cast<int>(vertices.size()));
+}
+
+void SpriteBatch::append(const SpriteState &state, const SpriteVertex *vertices, int count) {
+    if (!_glInited || !state.texture) return;
+
+    glm::vec4 bounds(vertices[0].position.x, vertices[0].position.y, vertices[0].position.x, vertices[0].position.y);
+    for (int i = 1; i < count; ++i) {
+        const glm::vec3 &position = vertices[i].position;
+        bounds.x = glm::min(bounds.x, position.x);
+        bounds.y = glm::min(bounds.y, position.y);
+        bounds.z = glm::max(bounds.z, position.x);
+        bounds.w = glm::max(bounds.w, position.y);
+    }
+
+    // Look for a batch with the same state, that can be drawn later without
+    // changing the order of overlapping quads
+
+    Batch *target = nullptr;
+    int lookback = 0;
+
+    for (auto it = _batches.rbegin(); it != _batches.rend() && lookback < kMaxBatchLookback; ++it, ++lookback) {
+        if (it->state == state) {
+            target = &*it;
+            break;
+        }
+        const glm::vec4 &other = it->bounds;
+        bool overlaps = bounds.x < other.z && bounds.z > other.x && bounds.y < other.w && bounds.w > other.y;
+        if (overlaps) break;
+    }
+    if (target) {
+        target->bounds.x = glm::min(target->bounds.x, bounds.x);
+        target->bounds.y = glm::min(target->bounds.y, bounds.y);
+        target->bounds.z = glm::max(target->bounds.z, bounds.z);
+        target->bounds.w = glm::max(target->bounds.w, bounds.w);
+    } else {
+        Batch batch;
+        batch.state = state;
+        batch.bounds = bounds;
+        _batches.push_back(move(batch));
+        target = &_batches.back();
+    }
+    target->vertices.insert(target->vertices.end(), vertices, vertices + count);
+
+    if (_depth == 0) {
+        flush();
+    }
+}
+
+void SpriteBatch::flush() {
+    if (_batches.empty()) return;
+
+    glBindVertexArray(_vertexArrayId);
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexBufferId);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferId);
+
+    // Upload as many batches as fit into the vertex buffer at once, then draw them
+
+    size_t batchIdx = 0;
+    int batchQuadOffset = 0;
+
+    while (batchIdx < _batches.size()) {
+        glBufferData(GL_ARRAY_BUFFER, 4 * kMaxQuadCount * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+
+        struct Range {
+            const SpriteState *state;
+            int firstQuad;
+            int quadCount;
+        };
+        vector<Range> ranges;
+        int quadCount = 0;
+
+        while (batchIdx < _batches.size() && quadCount < kMaxQuadCount) {
+            const Batch &batch = _batches[batchIdx];
+            int batchQuadCount = static_cast<int>(batch.vertices.size() / 4);
+            int count = min(batchQuadCount - batchQuadOffset, kMaxQuadCount - quadCount);
+
+            glBufferSubData(
+                GL_ARRAY_BUFFER,
+                4 * quadCount * sizeof(SpriteVertex),
+                4 * count * sizeof(SpriteVertex),
+                &batch.vertices[4 * batchQuadOffset]);
+
+            ranges.push_back(Range { &batch.state, quadCount, count });
+            quadCount += count;
+            batchQuadOffset += count;
+
+            if (batchQuadOffset == batchQuadCount) {
+                ++batchIdx;
+                batchQuadOffset = 0;
+            }
+        }
+        for (auto &range : ranges) {
+            LocalUniforms locals;
+            locals.general.discardEnabled = range.state->discardEnabled;
+            locals.general.discardColor = glm::vec4(range.state->discardColor, 1.0f);
+
+            Shaders::instance().activate(ShaderProgram::SpriteSprite, locals);
+
+            range.state->texture->bind(0);
+
+            int count = 6 * range.quadCount;
+            int off = 6 * range.firstQuad * sizeof(uint16_t);
+
+            if (range.state->additive) {
+                withAdditiveBlending([&count, &off]() {
+                    glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, reinterpret_cast<void *>(off));
+                });
+            } else {
+                glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, reinterpret_cast<void *>(off));
+            }
+        }
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    _batches.clear();
+}
+
+} // namespace render
+
+} // namespace reone
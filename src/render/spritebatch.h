@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "glm/mat4x4.hpp"
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+
+namespace reone {
+
+namespace render {
+
+enum SpriteFlags {
+    kSpriteFlipX = 1,
+    kSpriteFlipY = 2
+};
+
+class Texture;
+
+struct SpriteVertex {
+    glm::vec3 position { 0.0f };
+    glm::vec2 texCoords { 0.0f };
+    glm::vec4 color { 1.0f };
+};
+
+struct SpriteState {
+    std::shared_ptr<Texture> texture;
+    bool additive { false };
+    bool discardEnabled { false };
+    glm::vec3 discardColor { 0.0f };
+
+    bool operator==(const SpriteState &other) const;
+};
+
+/**
+ * Accumulates textured 2D quads into a streaming vertex buffer and renders
+ * them in as few draw calls as possible. Quads sharing a texture are grouped
+ * into a single draw, unless that would change the order in which
+ * overlapping quads are drawn.
+ *
+ * Quads submitted outside of a begin/end pair are drawn immediately.
+ */
+class SpriteBatch {
+public:
+    static SpriteBatch &instance();
+
+    void initGL();
+    void deinitGL();
+
+    void begin();
+    void end();
+
+    /**
+     * Draws a unit quad, transformed by the specified matrix.
+     *
+     * @param flags bitmask of SpriteFlags
+     */
+    void draw(const SpriteState &state, const glm::mat4 &transform, const glm::vec4 &color = glm::vec4(1.0f), int flags = 0);
+
+    /**
+     * Draws quads from the specified vertices, four vertices per quad.
+     */
+    void draw(const SpriteState &state, const std::vector<SpriteVertex> &vertices);
+
+    void flush();
+
+private:
+    struct Batch {
+        SpriteState state;
+        std::vector<SpriteVertex> vertices;
+        glm::vec4 bounds { 0.0f }; // min x, min y, max x, max y
+    };
+
+    bool _glInited { false };
+    int _depth { 0 };
+    std::vector<Batch> _batches;
+    std::vector<SpriteVertex> _quad;
+    uint32_t _vertexBufferId { 0 };
+    uint32_t _indexBufferId { 0 };
+    uint32_t _vertexArrayId { 0 };
+
+    SpriteBatch() = default;
+    SpriteBatch(const SpriteBatch &) = delete;
+    ~SpriteBatch();
+
+    SpriteBatch &operator=(const SpriteBatch &) = delete;
+
+    void append(const SpriteState &state, const SpriteVertex *vertices, int count);
+};
+
+} // namespace render
+
+} // namespace reone
@@ -23,6 +23,8 @@
 
 #include "SDL2/SDL_opengl.h"
 
+#include "textures.h"
+
 using namespace std;
 
 namespace reone {
@@ -56,7 +58,10 @@ void Texture::initGL() {
     } else {
         glBindTexture(GL_TEXTURE_2D, _textureId);
         const Layer &layer = _layers.front();
-        int mipMapCount = static_cast<int>(layer.mipMaps.size());
+
+        // Top mip levels may be dropped to save memory, but are kept in main
+        // memory, so that they can be restored
+        int mipMapCount = static_cast<int>(layer.mipMaps.size()) - _droppedMipMapCount;
         if (mipMapCount > 1) {
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipMapCount - 1);
@@ -69,9 +74,9 @@ void Texture::initGL() {
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         }
 
-        int i = 0;
-        for (auto &mipMap : layer.mipMaps) {
-            fillTextureTarget(GL_TEXTURE_2D, i++, mipMap.width, mipMap.height, mipMap.data);
+        for (int i = 0; i < mipMapCount; ++i) {
+            const MipMap &mipMap = layer.mipMaps[_droppedMipMapCount + i];
+            fillTextureTarget(GL_TEXTURE_2D, i, mipMap.width, mipMap.height, mipMap.data);
         }
         if (mipMapCount == 1) {
             glGenerateMipmap(GL_TEXTURE_2D);
@@ -88,18 +93,23 @@ bool Texture::isCubeMap() const {
 }
 
 void Texture::fillTextureTarget(uint32_t target, int level, int width, int height, const ByteArray &data) {
+    const void *pixels = &data[0];
+
     switch (_pixelFormat) {
         case PixelFormat::Grayscale:
         case PixelFormat::RGB:
         case PixelFormat::RGBA:
         case PixelFormat::BGR:
         case PixelFormat::BGRA:
-            glTexImage2D(target, level, glInternalPixelFormat(), width, height, 0, glPixelFormat(), GL_UNSIGNED_BYTE, &data[0]);
+            // Rows of small RGB and grayscale mip levels are not 4-byte aligned
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(target, level, glInternalPixelFormat(), width, height, 0, glPixelFormat(), GL_UNSIGNED_BYTE, pixels);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
             break;
 
         case PixelFormat::DXT1:
         case PixelFormat::DXT5:
-            glCompressedTexImage2D(target, level, glInternalPixelFormat(), width, height, 0, static_cast<int>(data.size()), &data[0]);
+            glCompressedTexImage2D(target, level, glInternalPixelFormat(), width, height, 0, static_cast<int>(data.size()), pixels);
             break;
     }
 }
@@ -155,6 +165,11 @@ void Texture::deinitGL() {
 }
 
 void Texture::bind(int unit) {
+    if (!_glInited) {
+        Textures::instance().bindPlaceholder(unit);
+        return;
+    }
+    _lastUsedFrame = Textures::instance().frame();
     glActiveTexture(GL_TEXTURE0 + unit);
     glBindTexture(isCubeMap() ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D, _textureId);
 }
@@ -163,6 +178,14 @@ bool Texture::isAdditive() const {
     return _features.blending == TextureBlending::Additive;
 }
 
+bool Texture::isReady() const {
+    return _glInited;
+}
+
+bool Texture::isMissing() const {
+    return _missing;
+}
+
 const string &Texture::name() const {
     return _name;
 }
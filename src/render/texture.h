@@ -39,6 +39,7 @@ enum class PixelFormat {
 
 class CurFile;
 class TgaFile;
+class Textures;
 class TpcFile;
 
 class Texture {
@@ -48,10 +49,25 @@ public:
 
     void initGL();
     void deinitGL();
+
+    /**
+     * Binds this texture to the specified texture unit. Until this texture is
+     * uploaded, binds a placeholder texture instead.
+     */
     void bind(int unit);
 
     bool isAdditive() const;
 
+    /**
+     * @return true if this texture is uploaded and can be sampled
+     */
+    bool isReady() const;
+
+    /**
+     * @return true if this texture was requested asynchronously, but could not be loaded
+     */
+    bool isMissing() const;
+
     const std::string &name() const;
     int width() const;
     int height() const;
@@ -70,6 +86,10 @@ private:
     };
 
     bool _glInited { false };
+    bool _missing { false };
+    uint32_t _lastUsedFrame { 0 };
+    int _droppedMipMapCount { 0 }; /**< top mip levels, that are not uploaded */
+    int _targetDroppedMipMapCount { 0 }; /**< applied by Textures::update within the upload budget */
     std::string _name;
     TextureType _type { TextureType::Diffuse };
     PixelFormat _pixelFormat { PixelFormat::BGR };
@@ -83,13 +103,14 @@ private:
 
     Texture &operator=(const Texture &) = delete;
 
-    inline bool isCubeMap() const;
+    bool isCubeMap() const;
     void fillTextureTarget(uint32_t target, int level, int width, int height, const ByteArray &data);
     int glInternalPixelFormat() const;
     uint32_t glPixelFormat() const;
 
     friend class CurFile;
     friend class TgaFile;
+    friend class Textures;
     friend class TpcFile;
 };
 
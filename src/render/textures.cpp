@@ -17,10 +17,20 @@
 
 #include "textures.h"
 
+#include <algorithm>
+
+#include <boost/asio/post.hpp>
+
+#include "GL/glew.h"
+
+#include "SDL2/SDL_opengl.h"
+
+#include "../common/log.h"
 #include "../common/streamutil.h"
 #include "../resource/resources.h"
 
 #include "image/curfile.h"
+#include "image/dxt.h"
 #include "image/tgafile.h"
 #include "image/tpcfile.h"
 
@@ -32,30 +42,357 @@ namespace reone {
 
 namespace render {
 
+static const int kDecodeThreadCount = 2;
+static const size_t kUploadBudgetPerFrame = 4 * 1024 * 1024;
+static const uint8_t kPlaceholderColor[] = { 0x80, 0x80, 0x80, 0xff };
+static const int kMemoryBudgetCheckInterval = 30; // frames
+static const int kMinDroppedMipMapSize = 64;
+static const uint32_t kDropMipMapAfterFrames = 300; // textures not in view for this long may lose mip levels
+
 Textures &Textures::instance() {
     static Textures instance;
     return instance;
 }
 
-void Textures::init(GameVersion version) {
+void Textures::init(GameVersion version, bool glEnabled) {
     _version = version;
+    _enabled = glEnabled;
+
+    if (!_enabled) {
+        info("Textures: texture loading is disabled");
+        return;
+    }
+
+    if (!_pool) {
+        _cancel = false;
+        _pool = make_unique<boost::asio::thread_pool>(kDecodeThreadCount);
+    }
+    if (!_glInited) {
+        _s3tcSupported = GLEW_EXT_texture_compression_s3tc;
+        if (!_s3tcSupported) {
+            info("Textures: S3TC is not supported, compressed textures will be decompressed");
+        }
+
+        glGenTextures(1, &_placeholderId);
+        glBindTexture(GL_TEXTURE_2D, _placeholderId);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, kPlaceholderColor);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        _glInited = true;
+    }
+}
+
+Textures::~Textures() {
+    deinit();
+}
+
+void Textures::deinit() {
+    if (_pool) {
+        _cancel = true;
+        _pool->join();
+        _pool.reset();
+    }
+    {
+        lock_guard<mutex> lock(_decodedMutex);
+        _decoded.clear();
+    }
+    _uploads.clear();
+    _resizes.clear();
+    _cache.clear();
+
+    if (_glInited) {
+        glDeleteTextures(1, &_placeholderId);
+        _glInited = false;
+    }
 }
 
 void Textures::invalidateCache() {
     _cache.clear();
 }
 
+void Textures::update() {
+    ++_frame;
+    {
+        lock_guard<mutex> lock(_decodedMutex);
+        while (!_decoded.empty()) {
+            _uploads.push_back(move(_decoded.front()));
+            _decoded.pop_front();
+        }
+    }
+    size_t uploaded = 0;
+
+    while (!_uploads.empty() && uploaded < kUploadBudgetPerFrame) {
+        DecodedTexture decoded(move(_uploads.front()));
+        _uploads.pop_front();
+
+        shared_ptr<Texture> texture(decoded.texture.lock());
+        if (!texture || texture->isReady()) continue;
+
+        if (!decoded.staging) {
+            texture->_missing = true;
+            continue;
+        }
+        adopt(*texture, *decoded.staging);
+        texture->initGL();
+        texture->_lastUsedFrame = _frame;
+
+        uploaded += getDataSize(*texture);
+    }
+
+    if (_frame % kMemoryBudgetCheckInterval == 0) {
+        enforceMemoryBudget();
+    }
+
+    // Re-uploads, requested by the memory budget check, share the budget with
+    // uploads of new textures
+
+    while (!_resizes.empty() && uploaded < kUploadBudgetPerFrame) {
+        shared_ptr<Texture> texture(_resizes.front().lock());
+        _resizes.pop_front();
+
+        if (!texture || !texture->isReady() || texture->_droppedMipMapCount == texture->_targetDroppedMipMapCount) continue;
+
+        resize(*texture);
+        uploaded += getDataSize(*texture);
+    }
+}
+
+void Textures::setMemoryBudget(size_t bytes) {
+    _memoryBudget = bytes;
+}
+
+size_t Textures::getResidentBytes() const {
+    size_t result = 0;
+    for (auto &pair : _cache) {
+        if (pair.second && pair.second->isReady()) {
+            result += getDataSize(*pair.second);
+        }
+    }
+    return result;
+}
+
+vector<TextureMemoryUsage> Textures::getMemoryReport() const {
+    vector<TextureMemoryUsage> result;
+
+    for (auto &pair : _cache) {
+        const shared_ptr<Texture> &texture = pair.second;
+        if (!texture || !texture->isReady()) continue;
+
+        TextureMemoryUsage usage;
+        usage.name = texture->_name;
+        usage.width = texture->_width;
+        usage.height = texture->_height;
+        usage.bytes = getDataSize(*texture);
+        usage.droppedMipMapCount = texture->_droppedMipMapCount;
+        usage.lastUsedFrame = texture->_lastUsedFrame;
+
+        result.push_back(move(usage));
+    }
+    sort(result.begin(), result.end(), [](const TextureMemoryUsage &left, const TextureMemoryUsage &right) {
+        return left.bytes > right.bytes;
+    });
+
+    return move(result);
+}
+
+void Textures::enforceMemoryBudget() {
+    // Budget is checked against the memory textures will use once pending
+    // re-uploads are done
+
+    size_t resident = 0;
+    for (auto &pair : _cache) {
+        if (pair.second && pair.second->isReady()) {
+            resident += getDataSize(*pair.second, pair.second->_targetDroppedMipMapCount);
+        }
+    }
+
+    if (_memoryBudget != 0 && resident > _memoryBudget) {
+        vector<shared_ptr<Texture>> candidates;
+        for (auto &pair : _cache) {
+            const shared_ptr<Texture> &texture = pair.second;
+            if (texture && canDropMipMap(*texture) && _frame - texture->_lastUsedFrame >= kDropMipMapAfterFrames) {
+                candidates.push_back(texture);
+            }
+        }
+
+        // Least recently used textures go first, larger ones first among equally used
+
+        sort(candidates.begin(), candidates.end(), [this](auto &left, auto &right) {
+            if (left->_lastUsedFrame != right->_lastUsedFrame) {
+                return left->_lastUsedFrame < right->_lastUsedFrame;
+            }
+            return getDataSize(*left) > getDataSize(*right);
+        });
+
+        // At most one mip level is dropped from a texture per check
+
+        for (auto &texture : candidates) {
+            if (resident <= _memoryBudget) break;
+
+            size_t sizeBefore = getDataSize(*texture, texture->_targetDroppedMipMapCount);
+            ++texture->_targetDroppedMipMapCount;
+            resident -= sizeBefore - getDataSize(*texture, texture->_targetDroppedMipMapCount);
+
+            _resizes.push_back(texture);
+        }
+
+    } else {
+        vector<shared_ptr<Texture>> candidates;
+        for (auto &pair : _cache) {
+            const shared_ptr<Texture> &texture = pair.second;
+            if (texture && texture->isReady() && texture->_targetDroppedMipMapCount > 0 && isInView(*texture)) {
+                candidates.push_back(texture);
+            }
+        }
+
+        // Smaller textures go first, so that as many of them as possible are restored
+
+        sort(candidates.begin(), candidates.end(), [this](auto &left, auto &right) {
+            return getDataSize(*left) < getDataSize(*right);
+        });
+
+        // At most one mip level is restored to a texture per check
+
+        for (auto &texture : candidates) {
+            size_t sizeBefore = getDataSize(*texture, texture->_targetDroppedMipMapCount);
+            size_t sizeAfter = getDataSize(*texture, texture->_targetDroppedMipMapCount - 1);
+            if (_memoryBudget != 0 && resident + sizeAfter - sizeBefore > _memoryBudget) break;
+
+            --texture->_targetDroppedMipMapCount;
+            resident += sizeAfter - sizeBefore;
+
+            _resizes.push_back(texture);
+        }
+    }
+
+    debug(boost::format("Textures: resident %d KB, budget %d KB") % (resident / 1024) % (_memoryBudget / 1024), 2);
+}
+
+void Textures::resize(Texture &texture) {
+    texture._droppedMipMapCount = texture._targetDroppedMipMapCount;
+
+    const Texture::MipMap &top = texture._layers.front().mipMaps[texture._droppedMipMapCount];
+    debug(boost::format("Textures: %s is now %dx%d, %d mip levels dropped") % texture._name % top.width % top.height % texture._droppedMipMapCount, 2);
+
+    texture.deinitGL();
+    texture.initGL();
+}
+
+bool Textures::canDropMipMap(const Texture &texture) const {
+    if (!texture.isReady() || texture.isCubeMap()) return false;
+
+    switch (texture._type) {
+        case TextureType::Diffuse:
+        case TextureType::Lightmap:
+        case TextureType::EnvironmentMap:
+        case TextureType::Bumpmap:
+            break;
+        default:
+            return false;
+    }
+
+    const vector<Texture::MipMap> &mipMaps = texture._layers.front().mipMaps;
+    int top = texture._targetDroppedMipMapCount;
+
+    return static_cast<int>(mipMaps.size()) - top > 1 && mipMaps[top].width > kMinDroppedMipMapSize && mipMaps[top].height > kMinDroppedMipMapSize;
+}
+
+bool Textures::isInView(const Texture &texture) const {
+    // Textures are bound when rendered, and the budget is checked every so many frames
+    return _frame - texture._lastUsedFrame <= kMemoryBudgetCheckInterval;
+}
+
+uint32_t Textures::frame() const {
+    return _frame;
+}
+
+void Textures::bindPlaceholder(int unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, _placeholderId);
+}
+
 shared_ptr<Texture> Textures::get(const string &resRef, TextureType type) {
+    if (!_enabled) return nullptr;
+
     auto maybeTexture = _cache.find(resRef);
     if (maybeTexture != _cache.end()) {
-        return maybeTexture->second;
+        shared_ptr<Texture> texture(maybeTexture->second);
+
+        // Texture was requested asynchronously, but is needed right away
+        if (texture && !texture->isReady() && !texture->isMissing()) {
+            shared_ptr<Texture> staging(decode(resRef, type));
+            if (staging) {
+                adopt(*texture, *staging);
+                texture->initGL();
+            } else {
+                texture->_missing = true;
+            }
+        }
+
+        return texture && !texture->isMissing() ? texture : nullptr;
     }
     auto inserted = _cache.insert(make_pair(resRef, doGet(resRef, type)));
 
     return inserted.first->second;
 }
 
+shared_ptr<Texture> Textures::request(const string &resRef, TextureType type) {
+    if (!_enabled) return nullptr;
+
+    auto maybeTexture = _cache.find(resRef);
+    if (maybeTexture != _cache.end()) {
+        if (maybeTexture->second) {
+            return maybeTexture->second;
+        }
+        // Texture was previously requested synchronously and was not found
+        auto missing = make_shared<Texture>(resRef, type);
+        missing->_missing = true;
+        return move(missing);
+    }
+    auto texture = make_shared<Texture>(resRef, type);
+    _cache.insert(make_pair(resRef, texture));
+
+    if (_pool) {
+        weak_ptr<Texture> weakTexture(texture);
+        boost::asio::post(*_pool, [this, resRef, type, weakTexture]() {
+            if (_cancel || weakTexture.expired()) return;
+
+            DecodedTexture decoded;
+            decoded.texture = weakTexture;
+            try {
+                decoded.staging = decode(resRef, type);
+            }
+            catch (const exception &ex) {
+                warn(boost::format("Textures: unable to decode texture: %s: %s") % resRef % ex.what());
+            }
+            lock_guard<mutex> lock(_decodedMutex);
+            _decoded.push_back(move(decoded));
+        });
+    } else {
+        shared_ptr<Texture> staging(decode(resRef, type));
+        if (staging) {
+            adopt(*texture, *staging);
+            texture->initGL();
+        } else {
+            texture->_missing = true;
+        }
+    }
+
+    return move(texture);
+}
+
 shared_ptr<Texture> Textures::doGet(const string &resRef, TextureType type) {
+    shared_ptr<Texture> texture(decode(resRef, type));
+    if (texture) {
+        texture->initGL();
+    }
+
+    return move(texture);
+}
+
+shared_ptr<Texture> Textures::decode(const string &resRef, TextureType type) const {
     shared_ptr<Texture> texture;
 
     bool tryTpc = _version == GameVersion::TheSithLords || type != TextureType::Lightmap;
@@ -76,13 +413,116 @@ shared_ptr<Texture> Textures::doGet(const string &resRef, TextureType type) {
             texture = tga.texture();
         }
     }
-    if (texture) {
-        texture->initGL();
+    if (texture && !_s3tcSupported) {
+        decompress(*texture);
+    }
+    if (texture && type != TextureType::GUI && type != TextureType::Cursor) {
+        generateMipMaps(*texture);
     }
 
     return move(texture);
 }
 
+void Textures::generateMipMaps(Texture &texture) const {
+    // Only uncompressed 32-bit single-level textures are handled here, so
+    // that glGenerateMipmap need not be called on the main thread
+
+    bool supported =
+        (texture._pixelFormat == PixelFormat::RGBA || texture._pixelFormat == PixelFormat::BGRA) &&
+        texture._layers.size() == 1 &&
+        texture._layers.front().mipMaps.size() == 1;
+
+    if (!supported) return;
+
+    vector<Texture::MipMap> &mipMaps = texture._layers.front().mipMaps;
+
+    while (mipMaps.back().width > 1 || mipMaps.back().height > 1) {
+        const Texture::MipMap &src = mipMaps.back();
+
+        Texture::MipMap dst;
+        dst.width = max(1, src.width / 2);
+        dst.height = max(1, src.height / 2);
+        dst.data.resize(4 * dst.width * dst.height);
+
+        for (int y = 0; y < dst.height; ++y) {
+            int y0 = min(2 * y, src.height - 1);
+            int y1 = min(2 * y + 1, src.height - 1);
+
+            for (int x = 0; x < dst.width; ++x) {
+                int x0 = min(2 * x, src.width - 1);
+                int x1 = min(2 * x + 1, src.width - 1);
+
+                const uint8_t *p00 = reinterpret_cast<const uint8_t *>(&src.data[4 * (y0 * src.width + x0)]);
+                const uint8_t *p01 = reinterpret_cast<const uint8_t *>(&src.data[4 * (y0 * src.width + x1)]);
+                const uint8_t *p10 = reinterpret_cast<const uint8_t *>(&src.data[4 * (y1 * src.width + x0)]);
+                const uint8_t *p11 = reinterpret_cast<const uint8_t *>(&src.data[4 * (y1 * src.width + x1)]);
+                uint8_t *out = reinterpret_cast<uint8_t *>(&dst.data[4 * (y * dst.width + x)]);
+
+                for (int i = 0; i < 4; ++i) {
+                    out[i] = static_cast<uint8_t>((p00[i] + p01[i] + p10[i] + p11[i] + 2) / 4);
+                }
+            }
+        }
+        mipMaps.push_back(move(dst));
+    }
+}
+
+void Textures::decompress(Texture &texture) const {
+    PixelFormat format = texture._pixelFormat;
+    if (format != PixelFormat::DXT1 && format != PixelFormat::DXT5) return;
+
+    for (auto &layer : texture._layers) {
+        for (auto &mipMap : layer.mipMaps) {
+            mipMap.width = max(1, mipMap.width);
+            mipMap.height = max(1, mipMap.height);
+
+            ByteArray pixels(4 * mipMap.width * mipMap.height);
+            const uint8_t *data = reinterpret_cast<const uint8_t *>(&mipMap.data[0]);
+            uint8_t *out = reinterpret_cast<uint8_t *>(&pixels[0]);
+
+            if (format == PixelFormat::DXT1) {
+                decompressDXT1(data, mipMap.width, mipMap.height, out);
+
+                // DXT1 textures are uploaded without alpha, keep them that way
+                int pixelCount = mipMap.width * mipMap.height;
+                for (int i = 0; i < pixelCount; ++i) {
+                    out[3 * i + 0] = out[4 * i + 0];
+                    out[3 * i + 1] = out[4 * i + 1];
+                    out[3 * i + 2] = out[4 * i + 2];
+                }
+                pixels.resize(3 * pixelCount);
+
+            } else {
+                decompressDXT5(data, mipMap.width, mipMap.height, out);
+            }
+            mipMap.data = move(pixels);
+        }
+    }
+    texture._pixelFormat = format == PixelFormat::DXT1 ? PixelFormat::RGB : PixelFormat::RGBA;
+}
+
+void Textures::adopt(Texture &texture, Texture &staging) const {
+    texture._width = staging._width;
+    texture._height = staging._height;
+    texture._pixelFormat = staging._pixelFormat;
+    texture._layers = move(staging._layers);
+    texture._features = move(staging._features);
+}
+
+size_t Textures::getDataSize(const Texture &texture, int droppedMipMapCount) const {
+    size_t result = 0;
+    for (auto &layer : texture._layers) {
+        for (size_t i = droppedMipMapCount; i < layer.mipMaps.size(); ++i) {
+            result += layer.mipMaps[i].data.size();
+        }
+    }
+    return result;
+}
+
+size_t Textures::getDataSize(const Texture &texture) const {
+    return getDataSize(texture, texture._droppedMipMapCount);
+}
+
 } // namespace render
 
 } // namespace reone
@@ -17,9 +17,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
+
+#include <boost/asio/thread_pool.hpp>
 
 #include "../resource/types.h"
 
@@ -31,24 +37,121 @@ namespace render {
 
 class Texture;
 
+struct TextureMemoryUsage {
+    std::string name;
+    int width { 0 };
+    int height { 0 };
+    size_t bytes { 0 };
+    int droppedMipMapCount { 0 };
+    uint32_t lastUsedFrame { 0 };
+};
+
 class Textures {
 public:
     static Textures &instance();
 
-    void init(resource::GameVersion version);
+    /**
+     * @param glEnabled if false, textures are never loaded, and both get and
+     *                  request return nullptr, e.g. when running a dedicated
+     *                  server without a GL context
+     */
+    void init(resource::GameVersion version, bool glEnabled = true);
+    void deinit();
     void invalidateCache();
 
+    /**
+     * Uploads textures decoded by worker threads, until the per-frame upload
+     * budget is exhausted. Must be called once per frame from the thread that
+     * owns the OpenGL context.
+     */
+    void update();
+
+    void bindPlaceholder(int unit);
+
+    /**
+     * Sets the maximum amount of texture memory. When exceeded, top mip
+     * levels of the least recently used textures, that have not been in view
+     * for a while, are dropped. Dropped mip levels are restored once
+     * textures are in view again and there is room in the budget. Textures
+     * are re-uploaded incrementally, within the per-frame upload budget.
+     *
+     * @param bytes memory budget in bytes, or 0 for unlimited
+     */
+    void setMemoryBudget(size_t bytes);
+
+    size_t getResidentBytes() const;
+
+    /**
+     * @return memory usage of every resident texture, largest first
+     */
+    std::vector<TextureMemoryUsage> getMemoryReport() const;
+
+    /**
+     * Loads, decodes and uploads a texture synchronously.
+     *
+     * @return texture, or nullptr if not found
+     */
     std::shared_ptr<Texture> get(const std::string &resRef, TextureType type);
 
+    /**
+     * Returns a texture immediately and decodes it on a worker thread. The
+     * texture is uploaded by a subsequent call to update. Until then, binding
+     * it binds a placeholder texture.
+     */
+    std::shared_ptr<Texture> request(const std::string &resRef, TextureType type);
+
+    uint32_t frame() const;
+
 private:
+    struct DecodedTexture {
+        std::weak_ptr<Texture> texture;
+        std::shared_ptr<Texture> staging; // nullptr if not found
+    };
+
     resource::GameVersion _version { resource::GameVersion::KotOR };
     std::unordered_map<std::string, std::shared_ptr<Texture>> _cache;
+    bool _enabled { true };
+    bool _glInited { false };
+    uint32_t _placeholderId { 0 };
+    bool _s3tcSupported { true };
+    uint32_t _frame { 0 };
+    size_t _memoryBudget { 0 };
+
+    // Asynchronous loading
+
+    std::unique_ptr<boost::asio::thread_pool> _pool;
+    std::atomic_bool _cancel { false };
+    std::mutex _decodedMutex;
+    std::deque<DecodedTexture> _decoded;
+    std::deque<DecodedTexture> _uploads;
+
+    // END Asynchronous loading
+
+    std::deque<std::weak_ptr<Texture>> _resizes; /**< textures to re-upload with another number of dropped mip levels */
 
     Textures() = default;
     Textures(const Textures &) = delete;
+    ~Textures();
+
     Textures &operator=(const Textures &) = delete;
 
     std::shared_ptr<Texture> doGet(const std::string &resRef, TextureType type);
+    std::shared_ptr<Texture> decode(const std::string &resRef, TextureType type) const;
+    void generateMipMaps(Texture &texture) const;
+    void decompress(Texture &texture) const;
+    void enforceMemoryBudget();
+    void resize(Texture &texture);
+    bool canDropMipMap(const Texture &texture) const;
+    bool isInView(const Texture &texture) const;
+    void adopt(Texture &texture, Texture &staging) const;
+
+    /**
+     * @param droppedMipMapCount number of top mip levels, that are not uploaded
+     * @return size of data uploaded to the GPU with the specified number of dropped mip levels
+     */
+    size_t getDataSize(const Texture &texture, int droppedMipMapCount) const;
+
+    size_t getDataSize(const Texture &texture) const;
 };
 
 } // namespace render
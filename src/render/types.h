@@ -46,10 +46,22 @@ enum class TextureBlending {
     Additive
 };
 
+enum class BloomQuality {
+    Low,
+    High
+};
+
 struct GraphicsOptions {
     int width { 0 };
     int height { 0 };
     bool fullscreen { false };
+    bool headless { false }; // render offscreen, never show the window
+    bool vsync { true };
+    int fpsLimit { 0 }; // 0 for unlimited
+    int textureBudget { 0 }; // megabytes, 0 for unlimited
+    int shadowResolution { 2048 };
+    int bloomLevels { 4 };
+    BloomQuality bloomQuality { BloomQuality::High };
 };
 
 struct TextureFeatures {
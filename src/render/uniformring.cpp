@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "uniformring.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "GL/glew.h"
+
+#include "../common/log.h"
+
+using namespace std;
+
+namespace reone {
+
+namespace render {
+
+static const GLuint64 kFenceTimeoutNanos = 1000000000ull;
+
+UniformRing::UniformRing(int regionSize, int regionCount) :
+    _regionSize(regionSize),
+    _regionCount(regionCount),
+    _fences(regionCount, nullptr) {
+
+    if (regionSize <= 0) {
+        throw invalid_argument("regionSize must be greater than zero");
+    }
+    if (regionCount <= 0) {
+        throw invalid_argument("regionCount must be greater than zero");
+    }
+}
+
+UniformRing::~UniformRing() {
+    deinitGL();
+}
+
+void UniformRing::initGL() {
+    if (_glInited) return;
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0) {
+        _alignment = alignment;
+    }
+    _regionSize = (_regionSize + _alignment - 1) / _alignment * _alignment;
+
+    GLsizeiptr totalSize = static_cast<GLsizeiptr>(_regionSize) * _regionCount;
+
+    glGenBuffers(1, &_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+
+    if (GLEW_ARB_buffer_storage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags);
+        _mapped = reinterpret_cast<uint8_t *>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags));
+    } else {
+        glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    debug(boost::format("UniformRing: %d regions of %d bytes, %s") % _regionCount % _regionSize % (_mapped ? "persistently mapped" : "buffer sub-data"));
+
+    _glInited = true;
+}
+
+void UniformRing::deinitGL() {
+    if (!_glInited) return;
+
+    for (auto &fence : _fences) {
+        if (fence) {
+            glDeleteSync(static_cast<GLsync>(fence));
+            fence = nullptr;
+        }
+    }
+    if (_mapped) {
+        glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        _mapped = nullptr;
+    }
+    glDeleteBuffers(1, &_buffer);
+    _buffer = 0;
+    _region = -1;
+    _frameActive = false;
+
+    _glInited = false;
+}
+
+void UniformRing::beginFrame() {
+    if (!_glInited || _frameActive) return;
+
+    _region = (_region + 1) % _regionCount;
+    _offset = 0;
+
+    waitForRegion(_region);
+
+    _frameActive = true;
+}
+
+void UniformRing::waitForRegion(int region) {
+    GLsync fence = static_cast<GLsync>(_fences[region]);
+    if (!fence) return;
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    while (result == GL_TIMEOUT_EXPIRED) {
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeoutNanos);
+    }
+    if (result == GL_WAIT_FAILED) {
+        warn("UniformRing: waiting for a fence failed");
+    }
+    glDeleteSync(fence);
+    _fences[region] = nullptr;
+}
+
+void UniformRing::endFrame() {
+    if (!_frameActive) return;
+
+    _fences[_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _frameActive = false;
+}
+
+bool UniformRing::push(int bindingPoint, const void *data, int size) {
+    if (!_frameActive) return false;
+
+    int alignedSize = (size + _alignment - 1) / _alignment * _alignment;
+    if (_offset + alignedSize > _regionSize) {
+        if (!_overflowReported) {
+            warn("UniformRing: region exhausted, falling back to per-draw uploads");
+            _overflowReported = true;
+        }
+        return false;
+    }
+    GLintptr offset = static_cast<GLintptr>(_region) * _regionSize + _offset;
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, _buffer, offset, size);
+
+    if (_mapped) {
+        memcpy(_mapped + offset, data, size);
+    } else {
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    }
+    _offset += alignedSize;
+
+    return true;
+}
+
+} // namespace render
+
+} // namespace reone
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace reone {
+
+namespace render {
+
+/**
+ * Per-frame ring allocator for uniform block data. A single uniform buffer is
+ * split into regions, one per frame in flight. Draws write their uniforms
+ * into the current region and bind a sub-range of it. Before a region is
+ * reused, the fence inserted at the end of the frame that last used it is
+ * waited upon.
+ *
+ * When ARB_buffer_storage is available, the buffer is persistently mapped.
+ * Otherwise, uniforms are written using glBufferSubData.
+ */
+class UniformRing {
+public:
+    UniformRing(int regionSize, int regionCount);
+    ~UniformRing();
+
+    void initGL();
+    void deinitGL();
+
+    void beginFrame();
+    void endFrame();
+
+    /**
+     * Copies data into the current region and binds it to the specified
+     * uniform buffer binding point.
+     *
+     * @return false if there is no active frame or the region is exhausted
+     */
+    bool push(int bindingPoint, const void *data, int size);
+
+private:
+    int _regionSize { 0 };
+    int _regionCount { 0 };
+    bool _glInited { false };
+    uint32_t _buffer { 0 };
+    uint8_t *_mapped { nullptr };
+    int _alignment { 256 };
+    std::vector<void *> _fences;
+    int _region { -1 };
+    int _offset { 0 };
+    bool _frameActive { false };
+    bool _overflowReported { false };
+
+    UniformRing(const UniformRing &) = delete;
+    UniformRing &operator=(const UniformRing &) = delete;
+
+    void waitForRegion(int region);
+};
+
+} // namespace render
+
+} // namespace reone
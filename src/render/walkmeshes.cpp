@@ -36,15 +36,22 @@ Walkmeshes &Walkmeshes::instance() {
 }
 
 void Walkmeshes::invalidateCache() {
+    lock_guard<mutex> lock(_cacheMutex);
     _cache.clear();
 }
 
 shared_ptr<Walkmesh> Walkmeshes::get(const string &resRef, ResourceType type) {
-    auto maybeWalkmesh = _cache.find(resRef);
-    if (maybeWalkmesh != _cache.end()) {
-        return maybeWalkmesh->second;
+    {
+        lock_guard<mutex> lock(_cacheMutex);
+        auto maybeWalkmesh = _cache.find(resRef);
+        if (maybeWalkmesh != _cache.end()) {
+            return maybeWalkmesh->second;
+        }
     }
-    auto inserted = _cache.insert(make_pair(resRef, doGet(resRef, type)));
+    shared_ptr<Walkmesh> walkmesh(doGet(resRef, type));
+
+    lock_guard<mutex> lock(_cacheMutex);
+    auto inserted = _cache.insert(make_pair(resRef, move(walkmesh)));
 
     return inserted.first->second;
 }
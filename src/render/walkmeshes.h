@@ -19,6 +19,7 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "../resource/types.h"
@@ -37,10 +38,14 @@ public:
 
     void invalidateCache();
 
+    /**
+     * Thread-safe.
+     */
     std::shared_ptr<Walkmesh> get(const std::string &resRef, resource::ResourceType type);
 
 private:
     std::unordered_map<std::string, std::shared_ptr<Walkmesh>> _cache;
+    std::mutex _cacheMutex;
 
     Walkmeshes() = default;
     Walkmeshes(const Walkmeshes &) = delete;
@@ -34,6 +34,7 @@
 #include "mesh/cube.h"
 #include "mesh/quad.h"
 #include "shaders.h"
+#include "spritebatch.h"
 
 using namespace std;
 
@@ -45,12 +46,20 @@ RenderWindow::RenderWindow(const GraphicsOptions &opts, IEventHandler *eventHand
 }
 
 void RenderWindow::init() {
-    SDL_Init(SDL_INIT_VIDEO);
+    if (_opts.headless) {
+        // Prefer the offscreen video driver, which creates GL contexts through
+        // EGL and requires no display. Mesa falls back to llvmpipe when no GPU
+        // is available. Does not override SDL_VIDEODRIVER if already set.
+        SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+    }
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        throw runtime_error("Failed to initialize SDL video: " + string(SDL_GetError()));
+    }
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
 
     int flags = SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN;
-    if (_opts.fullscreen) {
+    if (_opts.fullscreen && !_opts.headless) {
         flags |= SDL_WINDOW_FULLSCREEN;
     }
     _window = SDL_CreateWindow(
@@ -69,7 +78,9 @@ void RenderWindow::init() {
     if (!_context) {
         throw runtime_error("Failed to create a GL context: " + string(SDL_GetError()));
     }
-    SDL_GL_SetSwapInterval(0);
+    if (SDL_GL_SetSwapInterval(_opts.vsync && !_opts.headless ? 1 : 0) != 0) {
+        warn("RenderWindow: unable to change swap interval: " + string(SDL_GetError()));
+    }
     glewInit();
 
     Shaders::instance().initGL();
@@ -79,6 +90,7 @@ void RenderWindow::init() {
     Quad::getXFlipped().initGL();
     Quad::getYFlipped().initGL();
     Quad::getXYFlipped().initGL();
+    SpriteBatch::instance().initGL();
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -88,6 +100,7 @@ void RenderWindow::deinit() {
     if (_fpsGlobal.hasAverage()) {
         debug("Average FPS: " + to_string(static_cast<int>(_fpsGlobal.average())));
     }
+    SpriteBatch::instance().deinitGL();
     Quad::getDefault().deinitGL();
     Quad::getXFlipped().deinitGL();
     Quad::getYFlipped().deinitGL();
@@ -102,6 +115,8 @@ void RenderWindow::deinit() {
 }
 
 void RenderWindow::show() {
+    if (_opts.headless) return;
+
     SDL_ShowWindow(_window);
 }
 
@@ -173,6 +188,18 @@ void RenderWindow::swapBuffers() const {
     SDL_GL_SwapWindow(_window);
 }
 
+void RenderWindow::finish() const {
+    glFinish();
+}
+
+void RenderWindow::readPixels(vector<uint8_t> &pixels) const {
+    pixels.resize(4ll * _opts.width * _opts.height);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, _opts.width, _opts.height, GL_BGRA, GL_UNSIGNED_BYTE, &pixels[0]);
+}
+
 void RenderWindow::setRelativeMouseMode(bool enabled) {
     SDL_SetRelativeMouseMode(enabled ? SDL_TRUE : SDL_FALSE);
     _relativeMouseMode = enabled;
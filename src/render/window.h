@@ -19,6 +19,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "fps.h"
 #include "texture.h"
@@ -50,6 +51,16 @@ public:
     void drawCursor() const;
     void swapBuffers() const;
 
+    /**
+     * Blocks until all previously issued GL commands complete.
+     */
+    void finish() const;
+
+    /**
+     * Reads the back buffer into pixels as bottom-up BGRA rows.
+     */
+    void readPixels(std::vector<uint8_t> &pixels) const;
+
     // END Rendering
 
 private:
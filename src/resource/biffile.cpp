@@ -46,6 +46,13 @@ ByteArray BifFile::getResourceData(int idx) {
     return readArray<char>(entry.offset, entry.fileSize);
 }
 
+size_t BifFile::getResourceSize(int idx) {
+    if (idx >= _resourceCount) {
+        throw out_of_range("BIF: resource index out of range: " + to_string(idx));
+    }
+    return readResourceEntry(idx).fileSize;
+}
+
 BifFile::ResourceEntry BifFile::readResourceEntry(int idx) {
     seek(_tableOffset + 16 * idx);
 
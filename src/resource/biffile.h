@@ -27,6 +27,7 @@ class BifFile : public BinaryFile {
 public:
     BifFile();
     ByteArray getResourceData(int idx);
+    size_t getResourceSize(int idx);
 
 private:
     struct ResourceEntry {
@@ -112,19 +112,32 @@ bool ErfFile::supports(ResourceType type) const {
 }
 
 shared_ptr<ByteArray> ErfFile::find(const string &resRef, ResourceType type) {
+    int idx = findIndex(resRef, type);
+    if (idx == -1) return nullptr;
+    const Resource &res = _resources[idx];
+
+    return make_shared<ByteArray>(getResourceData(res));
+}
+
+bool ErfFile::findSize(const string &resRef, ResourceType type, size_t &size) {
+    int idx = findIndex(resRef, type);
+    if (idx == -1) return false;
+
+    size = _resources[idx].size;
+
+    return true;
+}
+
+int ErfFile::findIndex(const string &resRef, ResourceType type) const {
     string lcResRef(boost::to_lower_copy(resRef));
-    int idx = -1;
 
     for (int i = 0; i < _entryCount; ++i) {
         if (_keys[i].resRef == lcResRef && _keys[i].resType == type) {
-            idx = i;
-            break;
+            return i;
         }
     }
-    if (idx == -1) return nullptr;
-    const Resource &res = _resources[idx];
 
-    return make_shared<ByteArray>(getResourceData(res));
+    return -1;
 }
 
 ByteArray ErfFile::getResourceData(const Resource &res) {
@@ -41,6 +41,7 @@ public:
 
     bool supports(ResourceType type) const override;
     std::shared_ptr<ByteArray> find(const std::string &resRef, ResourceType type) override;
+    bool findSize(const std::string &resRef, ResourceType type, size_t &size) override;
     ByteArray getResourceData(int idx);
 
     int entryCount() const;
@@ -60,6 +61,7 @@ private:
     Key readKey();
     void loadResources();
     Resource readResource();
+    int findIndex(const std::string &resRef, ResourceType type) const;
     ByteArray getResourceData(const Resource &res);
 };
 
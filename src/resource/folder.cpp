@@ -64,13 +64,7 @@ bool Folder::supports(ResourceType type) const {
 }
 
 shared_ptr<ByteArray> Folder::find(const string &resRef, ResourceType type) {
-    fs::path path;
-    for (auto &res : _resources) {
-        if (res.first == resRef && res.second.type == type) {
-            path = res.second.path;
-            break;
-        }
-    }
+    fs::path path(findPath(resRef, type));
     if (path.empty()) {
         return shared_ptr<ByteArray>();
     }
@@ -86,6 +80,24 @@ shared_ptr<ByteArray> Folder::find(const string &resRef, ResourceType type) {
     return make_shared<ByteArray>(move(data));
 }
 
+bool Folder::findSize(const string &resRef, ResourceType type, size_t &size) {
+    fs::path path(findPath(resRef, type));
+    if (path.empty()) return false;
+
+    size = static_cast<size_t>(fs::file_size(path));
+
+    return true;
+}
+
+fs::path Folder::findPath(const string &resRef, ResourceType type) const {
+    for (auto &res : _resources) {
+        if (res.first == resRef && res.second.type == type) {
+            return res.second.path;
+        }
+    }
+    return fs::path();
+}
+
 } // namespace resource
 
 } // namespace reone
@@ -36,6 +36,7 @@ public:
 
     bool supports(ResourceType type) const override;
     std::shared_ptr<ByteArray> find(const std::string &resRef, ResourceType type) override;
+    bool findSize(const std::string &resRef, ResourceType type, size_t &size) override;
 
 private:
     struct Resource {
@@ -50,6 +51,7 @@ private:
     Folder &operator=(const Folder &) = delete;
 
     void loadDirectory(const boost::filesystem::path &path);
+    boost::filesystem::path findPath(const std::string &resRef, ResourceType type) const;
 };
 
 } // namespace resource
@@ -18,6 +18,7 @@
 #include "resources.h"
 
 #include <map>
+#include <thread>
 
 #include <boost/algorithm/string.hpp>
 
@@ -186,13 +187,18 @@ Resources::~Resources() {
 }
 
 void Resources::deinit() {
+    lock_guard<recursive_mutex> lock(_mutex);
+
     invalidateCache();
 
+    _prefetchedModules.clear();
     _transientProviders.clear();
     _providers.clear();
 }
 
 void Resources::invalidateCache() {
+    lock_guard<recursive_mutex> lock(_mutex);
+
     g_2daCache.clear();
     g_gffCache.clear();
     g_resCache.clear();
@@ -200,53 +206,145 @@ void Resources::invalidateCache() {
 }
 
 void Resources::loadModule(const string &name) {
+    lock_guard<recursive_mutex> lock(_mutex);
+
     invalidateCache();
     _transientProviders.clear();
 
+    auto maybePrefetched = _prefetchedModules.find(name);
+    if (maybePrefetched == _prefetchedModules.end()) {
+        indexModule(name, _transientProviders);
+        return;
+    }
+    PrefetchedModule &module = *maybePrefetched->second;
+    _transientProviders = move(module.providers);
+    g_resCache.insert(module.resources.begin(), module.resources.end());
+
+    debug(boost::format("Resources: use prefetched module: %s, %d resources") % name % module.resources.size());
+
+    _prefetchedModules.erase(maybePrefetched);
+}
+
+void Resources::indexModule(const string &name, vector<unique_ptr<IResourceProvider>> &providers) const {
     fs::path modulesPath(getPathIgnoreCase(_gamePath, kModulesDirectoryName));
     fs::path rimPath(getPathIgnoreCase(modulesPath, name + ".rim"));
     fs::path rimsPath(getPathIgnoreCase(modulesPath, name + "_s.rim"));
 
-    indexTransientRimFile(rimPath);
-    indexTransientRimFile(rimsPath);
+    unique_ptr<RimFile> rim(new RimFile());
+    rim->load(rimPath);
+    providers.push_back(move(rim));
+
+    unique_ptr<RimFile> rims(new RimFile());
+    rims->load(rimsPath);
+    providers.push_back(move(rims));
 
     if (_version == GameVersion::TheSithLords) {
         fs::path dlgPath(getPathIgnoreCase(modulesPath, name + "_dlg.erf"));
-        indexTransientErfFile(dlgPath);
+        unique_ptr<ErfFile> erf(new ErfFile());
+        erf->load(dlgPath);
+        providers.push_back(move(erf));
     }
+
+    debug("Resources: indexed module: " + name);
 }
 
-void Resources::indexTransientRimFile(const fs::path &path) {
-    unique_ptr<RimFile> rim(new RimFile());
-    rim->load(path);
+unique_ptr<PrefetchedModule> Resources::openModule(const string &name) {
+    auto module = make_unique<PrefetchedModule>();
+    module->name = name;
+    indexModule(name, module->providers);
 
-    _transientProviders.push_back(move(rim));
+    return move(module);
+}
 
-    debug(boost::format("Resources: indexed: %s") % path);
+shared_ptr<ByteArray> Resources::prefetch(PrefetchedModule &module, const string &resRef, ResourceType type) {
+    string cacheKey(getCacheKey(resRef, type));
+    auto maybeResource = module.resources.find(cacheKey);
+    if (maybeResource != module.resources.end()) {
+        return maybeResource->second;
+    }
+
+    // Module archives are owned by the caller and need no locking
+    shared_ptr<ByteArray> data(get(module.providers, resRef, type));
+
+    if (!data) {
+        while (_waitingRequests > 0) {
+            this_thread::yield();
+        }
+        lock_guard<recursive_mutex> lock(_mutex);
+
+        data = get(_providers, resRef, type);
+        if (!data) {
+            data = getFromKeyFile(resRef, type);
+        }
+    }
+    if (data) {
+        module.size += data->size();
+    }
+    module.resources.insert(make_pair(cacheKey, data));
+
+    return move(data);
 }
 
-void Resources::indexTransientErfFile(const fs::path &path) {
-    unique_ptr<ErfFile> erf(new ErfFile());
-    erf->load(path);
+void Resources::addPrefetchedModule(unique_ptr<PrefetchedModule> module) {
+    lock_guard<recursive_mutex> lock(_mutex);
 
-    _transientProviders.push_back(move(erf));
+    debug(boost::format("Resources: prefetched module: %s, %d bytes") % module->name % module->size);
 
-    debug(boost::format("Resources: indexed: %s") % path);
+    string name(module->name);
+    _prefetchedModules[name] = move(module);
+}
+
+void Resources::retainPrefetchedModules(const set<string> &names) {
+    lock_guard<recursive_mutex> lock(_mutex);
+
+    for (auto it = _prefetchedModules.begin(); it != _prefetchedModules.end();) {
+        if (names.count(it->first) == 0) {
+            it = _prefetchedModules.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool Resources::isModulePrefetched(const string &name) {
+    lock_guard<recursive_mutex> lock(_mutex);
+    return _prefetchedModules.count(name) > 0;
+}
+
+size_t Resources::getPrefetchedSize() {
+    lock_guard<recursive_mutex> lock(_mutex);
+
+    size_t size = 0;
+    for (auto &module : _prefetchedModules) {
+        size += module.second->size;
+    }
+
+    return size;
 }
 
 template <class T>
-static shared_ptr<T> findResource(const string &key, map<string, shared_ptr<T>> &cache, const function<shared_ptr<T>()> &getter) {
-    auto maybeResource = cache.find(key);
-    if (maybeResource != cache.end()) {
-        return maybeResource->second;
-    };
-    auto inserted = cache.insert(make_pair(key, getter()));
+static shared_ptr<T> findResource(const string &key, map<string, shared_ptr<T>> &cache, recursive_mutex &mutex, const function<shared_ptr<T>()> &getter) {
+    {
+        lock_guard<recursive_mutex> lock(mutex);
+        auto maybeResource = cache.find(key);
+        if (maybeResource != cache.end()) {
+            return maybeResource->second;
+        }
+    }
+
+    // Resources are parsed without holding the lock, so that worker threads
+    // can parse them concurrently. When two threads parse the same resource,
+    // the first one to finish wins.
+    shared_ptr<T> resource(getter());
+
+    lock_guard<recursive_mutex> lock(mutex);
+    auto inserted = cache.insert(make_pair(key, move(resource)));
 
     return inserted.first->second;
 }
 
 shared_ptr<TwoDaTable> Resources::get2DA(const string &resRef) {
-    return findResource<TwoDaTable>(resRef, g_2daCache, [this, &resRef]() {
+    return findResource<TwoDaTable>(resRef, g_2daCache, _mutex, [this, &resRef]() {
         shared_ptr<ByteArray> data(get(resRef, ResourceType::TwoDa));
         shared_ptr<TwoDaTable> table;
 
@@ -261,6 +359,12 @@ shared_ptr<TwoDaTable> Resources::get2DA(const string &resRef) {
 }
 
 shared_ptr<ByteArray> Resources::get(const string &resRef, ResourceType type, bool logNotFound) {
+    // Resources may be requested from worker threads, e.g. texture decoding.
+    // Prefetching gives way to requests, waiting for the mutex.
+    ++_waitingRequests;
+    lock_guard<recursive_mutex> lock(_mutex);
+    --_waitingRequests;
+
     string cacheKey(getCacheKey(resRef, type));
     auto res = g_resCache.find(cacheKey);
     if (res != g_resCache.end()) {
@@ -273,18 +377,7 @@ shared_ptr<ByteArray> Resources::get(const string &resRef, ResourceType type, bo
         data = get(_providers, resRef, type);
     }
     if (!data) {
-        KeyFile::KeyEntry key;
-        if (_keyFile.find(resRef, type, key)) {
-            string filename(_keyFile.getFilename(key.bifIdx).c_str());
-            boost::replace_all(filename, "\\", "/");
-
-            fs::path bifPath(getPathIgnoreCase(_gamePath, filename));
-
-            BifFile bif;
-            bif.load(bifPath);
-
-            data = make_shared<ByteArray>(bif.getResourceData(key.resIdx));
-        }
+        data = getFromKeyFile(resRef, type);
     }
     if (!data && logNotFound) {
         warn("Resources: not found: " + cacheKey);
@@ -294,6 +387,64 @@ shared_ptr<ByteArray> Resources::get(const string &resRef, ResourceType type, bo
     return pair.first->second;
 }
 
+shared_ptr<ByteArray> Resources::getFromKeyFile(const string &resRef, ResourceType type) {
+    KeyFile::KeyEntry key;
+    if (!_keyFile.find(resRef, type, key)) return nullptr;
+
+    BifFile bif;
+    bif.load(getBifPath(key.bifIdx));
+
+    return make_shared<ByteArray>(bif.getResourceData(key.resIdx));
+}
+
+bool Resources::getSize(const string &resRef, ResourceType type, size_t &size) {
+    ++_waitingRequests;
+    lock_guard<recursive_mutex> lock(_mutex);
+    --_waitingRequests;
+
+    auto res = g_resCache.find(getCacheKey(resRef, type));
+    if (res != g_resCache.end()) {
+        if (!res->second) return false;
+        size = res->second->size();
+        return true;
+    }
+
+    return
+        getSize(_transientProviders, resRef, type, size) ||
+        getSize(_providers, resRef, type, size) ||
+        getSizeFromKeyFile(resRef, type, size);
+}
+
+bool Resources::getSize(const vector<unique_ptr<IResourceProvider>> &providers, const string &resRef, ResourceType type, size_t &size) {
+    for (auto provider = providers.rbegin(); provider != providers.rend(); ++provider) {
+        if (!(*provider)->supports(type)) continue;
+
+        if ((*provider)->findSize(resRef, type, size)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Resources::getSizeFromKeyFile(const string &resRef, ResourceType type, size_t &size) {
+    KeyFile::KeyEntry key;
+    if (!_keyFile.find(resRef, type, key)) return false;
+
+    BifFile bif;
+    bif.load(getBifPath(key.bifIdx));
+    size = bif.getResourceSize(key.resIdx);
+
+    return true;
+}
+
+fs::path Resources::getBifPath(int bifIdx) const {
+    string filename(_keyFile.getFilename(bifIdx).c_str());
+    boost::replace_all(filename, "\\", "/");
+
+    return getPathIgnoreCase(_gamePath, filename);
+}
+
 string Resources::getCacheKey(const string &resRef, resource::ResourceType type) const {
     return str(boost::format("%s.%s") % resRef % getExtByResType(type));
 }
@@ -314,7 +465,7 @@ shared_ptr<ByteArray> Resources::get(const vector<unique_ptr<IResourceProvider>>
 shared_ptr<GffStruct> Resources::getGFF(const string &resRef, ResourceType type) {
     string cacheKey(getCacheKey(resRef, type));
 
-    return findResource<GffStruct>(cacheKey, g_gffCache, [this, &resRef, &type]() {
+    return findResource<GffStruct>(cacheKey, g_gffCache, _mutex, [this, &resRef, &type]() {
         shared_ptr<ByteArray> data(get(resRef, type));
         shared_ptr<GffStruct> gffs;
 
@@ -329,7 +480,7 @@ shared_ptr<GffStruct> Resources::getGFF(const string &resRef, ResourceType type)
 }
 
 shared_ptr<TalkTable> Resources::getTalkTable(const string &resRef) {
-    return findResource<TalkTable>(resRef, g_talkTableCache, [this, &resRef]() {
+    return findResource<TalkTable>(resRef, g_talkTableCache, _mutex, [this, &resRef]() {
         shared_ptr<ByteArray> data(get(resRef, ResourceType::Conversation));
         shared_ptr<TalkTable> table;
 
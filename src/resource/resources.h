@@ -17,9 +17,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/filesystem/path.hpp>
@@ -40,6 +45,19 @@ namespace reone {
 
 namespace resource {
 
+/**
+ * Resources of a module, loaded ahead of time, so that loading the module
+ * does not have to wait for I/O.
+ *
+ * @see Resources::prefetch
+ */
+struct PrefetchedModule {
+    std::string name;
+    std::vector<std::unique_ptr<IResourceProvider>> providers;
+    std::unordered_map<std::string, std::shared_ptr<ByteArray>> resources; /**< by cache key, nullptr if not found */
+    size_t size { 0 }; /**< total size of resources in bytes */
+};
+
 class Resources {
 public:
     static Resources &instance();
@@ -51,6 +69,14 @@ public:
     void loadModule(const std::string &name);
 
     std::shared_ptr<ByteArray> get(const std::string &resRef, ResourceType type, bool logNotFound = true);
+
+    /**
+     * Looks up the size of a resource, without reading it, unless it is
+     * already cached.
+     *
+     * @return true if the resource was found, false otherwise
+     */
+    bool getSize(const std::string &resRef, ResourceType type, size_t &size);
     std::shared_ptr<TwoDaTable> get2DA(const std::string &resRef);
     std::shared_ptr<GffStruct> getGFF(const std::string &resRef, ResourceType type);
     std::shared_ptr<ByteArray> getFromExe(uint32_t name, PEResourceType type);
@@ -60,6 +86,43 @@ public:
 
     const std::vector<std::string> &moduleNames() const;
 
+    // Prefetching
+
+    /**
+     * Indexes archives of a module, without making it current. Thread-safe.
+     */
+    std::unique_ptr<PrefetchedModule> openModule(const std::string &name);
+
+    /**
+     * Loads a resource of a module ahead of time. Resources, that are not part
+     * of the module archives, are read from shared archives, giving way to
+     * concurrent requests. Thread-safe, as long as the module is accessed by
+     * one thread at a time.
+     *
+     * @return resource data, or nullptr if not found
+     */
+    std::shared_ptr<ByteArray> prefetch(PrefetchedModule &module, const std::string &resRef, ResourceType type);
+
+    /**
+     * Keeps a prefetched module until it is loaded or discarded, replacing a
+     * module of the same name.
+     */
+    void addPrefetchedModule(std::unique_ptr<PrefetchedModule> module);
+
+    /**
+     * Discards prefetched modules, except for the specified ones.
+     */
+    void retainPrefetchedModules(const std::set<std::string> &names);
+
+    bool isModulePrefetched(const std::string &name);
+
+    /**
+     * @return total size of kept prefetched modules in bytes
+     */
+    size_t getPrefetchedSize();
+
+    // END Prefetching
+
 private:
     GameVersion _version { GameVersion::KotOR };
     boost::filesystem::path _gamePath;
@@ -69,6 +132,9 @@ private:
     std::vector<std::string> _moduleNames;
     std::vector<std::unique_ptr<IResourceProvider>> _providers;
     std::vector<std::unique_ptr<IResourceProvider>> _transientProviders;
+    std::recursive_mutex _mutex;
+    std::atomic_int _waitingRequests { 0 }; /**< requests, waiting for the mutex */
+    std::map<std::string, std::unique_ptr<PrefetchedModule>> _prefetchedModules;
 
     Resources() = default;
     Resources(const Resources &) = delete;
@@ -84,12 +150,15 @@ private:
     void indexOverrideDirectory();
     void indexTalkTable();
     void indexTexturePacks();
-    void indexTransientErfFile(const boost::filesystem::path &path);
-    void indexTransientRimFile(const boost::filesystem::path &path);
+    void indexModule(const std::string &name, std::vector<std::unique_ptr<IResourceProvider>> &providers) const;
     void loadModuleNames();
     void stripDeveloperNotes(std::string &text) const;
 
     std::shared_ptr<ByteArray> get(const std::vector<std::unique_ptr<IResourceProvider>> &providers, const std::string &resRef, ResourceType type);
+    std::shared_ptr<ByteArray> getFromKeyFile(const std::string &resRef, ResourceType type);
+    bool getSize(const std::vector<std::unique_ptr<IResourceProvider>> &providers, const std::string &resRef, ResourceType type, size_t &size);
+    bool getSizeFromKeyFile(const std::string &resRef, ResourceType type, size_t &size);
+    boost::filesystem::path getBifPath(int bifIdx) const;
     inline std::string getCacheKey(const std::string &resRef, ResourceType type) const;
 };
 
@@ -72,16 +72,28 @@ bool RimFile::supports(ResourceType type) const {
 }
 
 shared_ptr<ByteArray> RimFile::find(const string &resRef, ResourceType type) {
+    auto it = findResource(resRef, type);
+    if (it == _resources.end()) return nullptr;
+
+    return make_shared<ByteArray>(getResourceData(*it));
+}
+
+bool RimFile::findSize(const string &resRef, ResourceType type, size_t &size) {
+    auto it = findResource(resRef, type);
+    if (it == _resources.end()) return false;
+
+    size = it->size;
+
+    return true;
+}
+
+vector<RimFile::Resource>::const_iterator RimFile::findResource(const string &resRef, ResourceType type) const {
     string lcResRef(boost::to_lower_copy(resRef));
 
-    auto it = find_if(
+    return find_if(
         _resources.begin(),
         _resources.end(),
         [&](const Resource &res) { return res.resRef == lcResRef && res.type == type; });
-
-    if (it == _resources.end()) return nullptr;
-
-    return make_shared<ByteArray>(getResourceData(*it));
 }
 
 ByteArray RimFile::getResourceData(const Resource &res) {
@@ -37,6 +37,7 @@ public:
 
     bool supports(ResourceType type) const override;
     std::shared_ptr<ByteArray> find(const std::string &resRef, ResourceType type) override;
+    bool findSize(const std::string &resRef, ResourceType type, size_t &size) override;
     ByteArray getResourceData(int idx);
 
     const std::vector<Resource> &resources() const;
@@ -49,6 +50,7 @@ private:
     void doLoad() override;
     void loadResources();
     Resource readResource();
+    std::vector<Resource>::const_iterator findResource(const std::string &resRef, ResourceType type) const;
     ByteArray getResourceData(const Resource &res);
 };
 
@@ -98,6 +98,13 @@ public:
 
     virtual bool supports(ResourceType type) const = 0;
     virtual std::shared_ptr<ByteArray> find(const std::string &resRef, ResourceType type) = 0;
+
+    /**
+     * Looks up the size of a resource, without reading it.
+     *
+     * @return true if the resource was found, false otherwise
+     */
+    virtual bool findSize(const std::string &resRef, ResourceType type, size_t &size) = 0;
 };
 
 } // namespace resource
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frustum.h"
+
+namespace reone {
+
+namespace scene {
+
+Frustum::Frustum(const glm::mat4 &vp) {
+    for (int i = 3; i >= 0; --i) {
+        _planes[0][i] = vp[i][3] + vp[i][0];
+        _planes[1][i] = vp[i][3] - vp[i][0];
+        _planes[2][i] = vp[i][3] + vp[i][1];
+        _planes[3][i] = vp[i][3] - vp[i][1];
+        _planes[4][i] = vp[i][3] + vp[i][2];
+        _planes[5][i] = vp[i][3] - vp[i][2];
+    }
+    for (int i = 0; i < kFrustumPlaneCount; ++i) {
+        _planes[i] = glm::normalize(_planes[i]);
+    }
+}
+
+bool Frustum::contains(const glm::vec3 &point) const {
+    glm::vec4 point4(point, 1.0f);
+    for (int i = 0; i < kFrustumPlaneCount; ++i) {
+        if (glm::dot(_planes[i], point4) < 0.0f) return false;
+    }
+    return true;
+}
+
+bool Frustum::intersects(const AABB &aabb) const {
+    glm::vec3 center(aabb.center());
+    glm::vec3 halfSize(aabb.size() * 0.5f);
+
+    for (int i = 0; i < kFrustumPlaneCount; ++i) {
+        if (glm::dot(_planes[i], glm::vec4(center.x - halfSize.x, center.y - halfSize.y, center.z - halfSize.z, 1.0f)) >= 0.0f) continue;
+        if (glm::dot(_planes[i], glm::vec4(center.x + halfSize.x, center.y - halfSize.y, center.z - halfSize.z, 1.0f)) >= 0.0f) continue;
+        if (glm::dot(_planes[i], glm::vec4(center.x - halfSize.x, center.y + halfSize.y, center.z - halfSize.z, 1.0f)) >= 0.0f) continue;
+        if (glm::dot(_planes[i], glm::vec4(center.x - halfSize.x, center.y - halfSize.y, center.z + halfSize.z, 1.0f)) >= 0.0f) continue;
+        if (glm::dot(_planes[i], glm::vec4(center.x + halfSize.x, center.y + halfSize.y, center.z - halfSize.z, 1.0f)) >= 0.0f) continue;
+        if (glm::dot(_planes[i], glm::vec4(center.x + halfSize.x, center.y - halfSize.y, center.z + halfSize.z, 1.0f)) >= 0.0f) continue;
+        if (glm::dot(_planes[i], glm::vec4(center.x - halfSize.x, center.y + halfSize.y, center.z + halfSize.z, 1.0f)) >= 0.0f) continue;
+        if (glm::dot(_planes[i], glm::vec4(center.x + halfSize.x, center.y + halfSize.y, center.z + halfSize.z, 1.0f)) >= 0.0f) continue;
+
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace scene
+
+} // namespace reone
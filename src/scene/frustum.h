@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include "../common/aabb.h"
+
+namespace reone {
+
+namespace scene {
+
+const int kFrustumPlaneCount = 6;
+
+/**
+ * Frustum, defined by six planes extracted from a view-projection matrix.
+ */
+class Frustum {
+public:
+    Frustum() = default;
+    Frustum(const glm::mat4 &viewProjection);
+
+    bool contains(const glm::vec3 &point) const;
+    bool intersects(const AABB &aabb) const;
+
+private:
+    glm::vec4 _planes[kFrustumPlaneCount];
+};
+
+} // namespace scene
+
+} // namespace reone
@@ -40,46 +40,15 @@ void CameraSceneNode::updateView() {
 }
 
 void CameraSceneNode::updateFrustum() {
-    glm::mat4 vp(_projection * _view);
-    for (int i = 3; i >= 0; --i) {
-        _frustum[0][i] = vp[i][3] + vp[i][0];
-        _frustum[1][i] = vp[i][3] - vp[i][0];
-        _frustum[2][i] = vp[i][3] + vp[i][1];
-        _frustum[3][i] = vp[i][3] - vp[i][1];
-        _frustum[4][i] = vp[i][3] + vp[i][2];
-        _frustum[5][i] = vp[i][3] - vp[i][2];
-    }
-    for (int i = 0; i < kFrustumPlaneCount; ++i) {
-        _frustum[i] = glm::normalize(_frustum[i]);
-    }
+    _frustum = Frustum(_projection * _view);
 }
 
 bool CameraSceneNode::isInFrustum(const glm::vec3 &point) const {
-    glm::vec4 point4(point, 1.0f);
-    for (int i = 0; i < kFrustumPlaneCount; ++i) {
-        if (glm::dot(_frustum[i], point4) < 0.0f) return false;
-    }
-    return true;
+    return _frustum.contains(point);
 }
 
 bool CameraSceneNode::isInFrustum(const AABB &aabb) const {
-    glm::vec3 center(aabb.center());
-    glm::vec3 halfSize(aabb.size() * 0.5f);
-
-    for (int i = 0; i < kFrustumPlaneCount; ++i) {
-        if (glm::dot(_frustum[i], glm::vec4(center.x - halfSize.x, center.y - halfSize.y, center.z - halfSize.z, 1.0f)) >= 0.0f) continue;
-        if (glm::dot(_frustum[i], glm::vec4(center.x + halfSize.x, center.y - halfSize.y, center.z - halfSize.z, 1.0f)) >= 0.0f) continue;
-        if (glm::dot(_frustum[i], glm::vec4(center.x - halfSize.x, center.y + halfSize.y, center.z - halfSize.z, 1.0f)) >= 0.0f) continue;
-        if (glm::dot(_frustum[i], glm::vec4(center.x - halfSize.x, center.y - halfSize.y, center.z + halfSize.z, 1.0f)) >= 0.0f) continue;
-        if (glm::dot(_frustum[i], glm::vec4(center.x + halfSize.x, center.y + halfSize.y, center.z - halfSize.z, 1.0f)) >= 0.0f) continue;
-        if (glm::dot(_frustum[i], glm::vec4(center.x + halfSize.x, center.y - halfSize.y, center.z + halfSize.z, 1.0f)) >= 0.0f) continue;
-        if (glm::dot(_frustum[i], glm::vec4(center.x - halfSize.x, center.y + halfSize.y, center.z + halfSize.z, 1.0f)) >= 0.0f) continue;
-        if (glm::dot(_frustum[i], glm::vec4(center.x + halfSize.x, center.y + halfSize.y, center.z + halfSize.z, 1.0f)) >= 0.0f) continue;
-
-        return false;
-    }
-
-    return true;
+    return _frustum.intersects(aabb);
 }
 
 const glm::mat4 &CameraSceneNode::projection() const {
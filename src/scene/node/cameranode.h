@@ -21,12 +21,12 @@
 
 #include "../../common/aabb.h"
 
+#include "../frustum.h"
+
 namespace reone {
 
 namespace scene {
 
-const int kFrustumPlaneCount = 6;
-
 class CameraSceneNode : public SceneNode {
 public:
     CameraSceneNode(SceneGraph *sceneGraph, const glm::mat4 &projection);
@@ -42,7 +42,7 @@ public:
 private:
     glm::mat4 _projection { 1.0f };
     glm::mat4 _view { 1.0f };
-    glm::vec4 _frustum[kFrustumPlaneCount];
+    Frustum _frustum;
 
     void updateAbsoluteTransform() override;
 
@@ -34,6 +34,10 @@ void CubeSceneNode::render() const {
     CubeMesh::instance().render(glm::scale(_absoluteTransform, glm::vec3(_size)));
 }
 
+float CubeSceneNode::size() const {
+    return _size;
+}
+
 } // namespace render
 
 } // namespace reone
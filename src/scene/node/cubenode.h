@@ -29,6 +29,8 @@ public:
 
     void render() const override;
 
+    float size() const;
+
 private:
     float _size;
 };
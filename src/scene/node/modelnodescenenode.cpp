@@ -21,7 +21,6 @@
 
 #include "../scenegraph.h"
 
-#include "lightnode.h"
 #include "modelscenenode.h"
 
 using namespace std;
@@ -63,78 +62,58 @@ bool ModelNodeSceneNode::isTransparent() const {
     return mesh->isTransparent() || _modelNode->alpha() < 1.0f;
 }
 
-void ModelNodeSceneNode::renderSingle(bool shadowPass) const {
+void ModelNodeSceneNode::fillUniforms(LocalUniforms &locals) const {
     shared_ptr<ModelMesh> mesh(_modelNode->mesh());
     if (!mesh) return;
 
-    LocalUniforms locals;
     locals.general.model = _absoluteTransform;
     locals.general.alpha = _modelSceneNode->alpha() * _modelNode->alpha();
 
-    if (!shadowPass) {
-        if (mesh->hasEnvmapTexture()) {
-            locals.general.envmapEnabled = true;
-        }
-        if (mesh->hasLightmapTexture()) {
-            locals.general.lightmapEnabled = true;
-        }
-        if (mesh->hasBumpyShinyTexture()) {
-            locals.general.bumpyShinyEnabled = true;
-        }
-        if (mesh->hasBumpmapTexture()) {
-            locals.general.bumpmapEnabled = true;
-        }
+    if (mesh->hasEnvmapTexture()) {
+        locals.general.envmapEnabled = true;
+    }
+    if (mesh->hasLightmapTexture()) {
+        locals.general.lightmapEnabled = true;
+    }
+    if (mesh->hasBumpyShinyTexture()) {
+        locals.general.bumpyShinyEnabled = true;
+    }
+    if (mesh->hasBumpmapTexture()) {
+        locals.general.bumpmapEnabled = true;
+    }
 
-        bool receivesShadows = _modelSceneNode->model()->classification() == Model::Classification::Other;
-        if (receivesShadows) {
-            locals.general.shadowsEnabled = true;
-        }
+    bool receivesShadows = _modelSceneNode->model()->classification() == Model::Classification::Other;
+    if (receivesShadows) {
+        locals.general.shadowsEnabled = true;
+    }
 
-        shared_ptr<ModelNode::Skin> skin(_modelNode->skin());
-        if (!shadowPass && skin) {
-            locals.general.skeletalEnabled = true;
-            locals.skeletal = Shaders::instance().skeletalUniforms();
-            locals.skeletal->absTransform = _modelNode->absoluteTransform();
-            locals.skeletal->absTransformInv = _modelNode->absoluteTransformInverse();
+    shared_ptr<ModelNode::Skin> skin(_modelNode->skin());
+    if (skin && locals.skeletal) {
+        locals.general.skeletalEnabled = true;
+        locals.skeletal->absTransform = _modelNode->absoluteTransform();
+        locals.skeletal->absTransformInv = _modelNode->absoluteTransformInverse();
 
-            for (int i = 0; i < kMaxBoneCount; ++i) {
-                locals.skeletal->bones[i] = glm::mat4(1.0f);
-            }
-            for (auto &pair : skin->nodeIdxByBoneIdx) {
-                uint16_t boneIdx = pair.first;
-                uint16_t nodeIdx = pair.second;
-
-                ModelNodeSceneNode *bone = _modelSceneNode->getModelNodeByIndex(nodeIdx);
-                if (bone) {
-                    locals.skeletal->bones[boneIdx] = bone->boneTransform();
-                }
-            }
+        for (int i = 0; i < kMaxBoneCount; ++i) {
+            locals.skeletal->bones[i] = glm::mat4(1.0f);
         }
+        for (auto &pair : skin->nodeIdxByBoneIdx) {
+            uint16_t boneIdx = pair.first;
+            uint16_t nodeIdx = pair.second;
 
-        if (!shadowPass && _modelNode->isSelfIllumEnabled()) {
-            locals.general.selfIllumEnabled = true;
-            locals.general.selfIllumColor = glm::vec4(_modelNode->selfIllumColor(), 1.0f);
-        }
-        if (!shadowPass && _modelSceneNode->isLightingEnabled()) {
-            const vector<LightSceneNode *> &lights = _modelSceneNode->lightsAffectedBy();
-
-            locals.general.lightingEnabled = true;
-            locals.lighting = Shaders::instance().lightingUniforms();
-            locals.lighting->ambientLightColor = glm::vec4(_sceneGraph->ambientLightColor(), 1.0f);
-            locals.lighting->lightCount = static_cast<int>(lights.size());
-
-            for (int i = 0; i < locals.lighting->lightCount; ++i) {
-                ShaderLight &shaderLight = locals.lighting->lights[i];
-                shaderLight.position = lights[i]->absoluteTransform()[3];
-                shaderLight.radius = lights[i]->radius();
-                shaderLight.color = glm::vec4(lights[i]->color(), 1.0f);
+            ModelNodeSceneNode *bone = _modelSceneNode->getModelNodeByIndex(nodeIdx);
+            if (bone) {
+                locals.skeletal->bones[boneIdx] = bone->boneTransform();
             }
         }
     }
-    ShaderProgram program = shadowPass ? ShaderProgram::ModelWhite : ShaderProgram::ModelModel;
-    Shaders::instance().activate(program, locals);
 
-    mesh->render(_modelSceneNode->textureOverride());
+    if (_modelNode->isSelfIllumEnabled()) {
+        locals.general.selfIllumEnabled = true;
+        locals.general.selfIllumColor = glm::vec4(_modelNode->selfIllumColor(), 1.0f);
+    }
+    if (_modelSceneNode->isLightingEnabled()) {
+        locals.general.lightingEnabled = true;
+    }
 }
 
 const ModelSceneNode *ModelNodeSceneNode::modelSceneNode() const {
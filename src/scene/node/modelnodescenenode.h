@@ -20,6 +20,7 @@
 #include "scenenode.h"
 
 #include "../../render/model/model.h"
+#include "../../render/shaders.h"
 
 namespace reone {
 
@@ -36,7 +37,11 @@ class ModelNodeSceneNode : public SceneNode {
 public:
     ModelNodeSceneNode(SceneGraph *sceneGraph, const ModelSceneNode *modelSceneNode, render::ModelNode *modelNode);
 
-    void renderSingle(bool shadowPass) const;
+    /**
+     * Fills uniforms required to draw the mesh of this node. Skeletal
+     * uniforms are only filled when allocated by the caller.
+     */
+    void fillUniforms(render::LocalUniforms &locals) const;
 
     bool shouldRender() const;
     bool shouldCastShadows() const;
@@ -96,6 +96,8 @@ void ModelSceneNode::render() const {
 
 void ModelSceneNode::playDefaultAnimation() {
     _animator.playDefaultAnimation();
+    _animationName.clear();
+    _animationFlags = 0;
 
     for (auto &attached : _attachedModels) {
         attached.second->playDefaultAnimation();
@@ -104,6 +106,8 @@ void ModelSceneNode::playDefaultAnimation() {
 
 void ModelSceneNode::playAnimation(const string &name, int flags, float speed) {
     _animator.playAnimation(name, flags, speed);
+    _animationName = name;
+    _animationFlags = flags;
 
     if (flags & kAnimationPropagate) {
         for (auto &attached : _attachedModels) {
@@ -181,29 +185,6 @@ void ModelSceneNode::attach(const string &parent, const shared_ptr<SceneNode> &n
     }
 }
 
-void ModelSceneNode::updateAbsoluteTransform() {
-    SceneNode::updateAbsoluteTransform();
-    _lightingDirty = true;
-}
-
-void ModelSceneNode::updateLighting() {
-    if (!_lightingEnabled || !_lightingDirty) return;
-
-    _lightsAffectedBy.clear();
-    glm::vec3 center(_absoluteTransform * glm::vec4(_model->aabb().center(), 1.0f));
-
-    _sceneGraph->getLightsAt(center, _lightsAffectedBy);
-    _lightingDirty = false;
-
-    for (auto &attached : _attachedModels) {
-        attached.second->setLightsAffectedBy(_lightsAffectedBy);
-    }
-}
-
-void ModelSceneNode::setLightingIsDirty() {
-    _lightingDirty = true;
-}
-
 bool ModelSceneNode::getNodeAbsolutePosition(const string &name, glm::vec3 &position) const {
     shared_ptr<ModelNode> node(_model->findNodeByName(name));
     if (!node) {
@@ -259,10 +240,6 @@ bool ModelSceneNode::isLightingEnabled() const {
     return _lightingEnabled;
 }
 
-const vector<LightSceneNode *> &ModelSceneNode::lightsAffectedBy() const {
-    return _lightsAffectedBy;
-}
-
 void ModelSceneNode::setTextureOverride(const shared_ptr<Texture> &texture) {
     _textureOverride = texture;
 }
@@ -275,9 +252,6 @@ void ModelSceneNode::setVisible(bool visible) {
     for (auto &attached : _attachedModels) {
         attached.second->setVisible(visible);
     }
-    if (visible) {
-        _lightingDirty = true;
-    }
 }
 
 void ModelSceneNode::setOnScreen(bool onScreen) {
@@ -300,6 +274,18 @@ bool ModelSceneNode::isAnimationFinished() const {
     return _model ? _animator.isAnimationFinished() : false;
 }
 
+bool ModelSceneNode::isAnimating() const {
+    return _model ? _animator.isAnimating() : false;
+}
+
+const string &ModelSceneNode::animationName() const {
+    return _animationName;
+}
+
+int ModelSceneNode::animationFlags() const {
+    return _animationFlags;
+}
+
 void ModelSceneNode::setDefaultAnimation(const string &name) {
     _animator.setDefaultAnimation(name);
 
@@ -312,10 +298,6 @@ void ModelSceneNode::setLightingEnabled(bool enabled) {
     _lightingEnabled = enabled;
 }
 
-void ModelSceneNode::setLightsAffectedBy(const vector<LightSceneNode *> &lights) {
-    _lightsAffectedBy = lights;
-}
-
 } // namespace scene
 
 } // namespace reone
@@ -32,7 +32,6 @@ namespace reone {
 
 namespace scene {
 
-class LightSceneNode;
 class ModelNodeSceneNode;
 
 class ModelSceneNode : public SceneNode {
@@ -71,6 +70,14 @@ public:
     void playAnimation(const std::string &name, int flags = 0, float speed = 1.0f);
 
     bool isAnimationFinished() const;
+    bool isAnimating() const;
+
+    /**
+     * @return name of the last played animation, or an empty string if the
+     *         default animation is playing
+     */
+    const std::string &animationName() const;
+    int animationFlags() const;
 
     void setDefaultAnimation(const std::string &name);
 
@@ -78,20 +85,17 @@ public:
 
     // Dynamic lighting
 
-    void updateLighting();
-    void setLightingIsDirty();
-
     bool isLightingEnabled() const;
-    const std::vector<LightSceneNode *> &lightsAffectedBy() const;
 
     void setLightingEnabled(bool affected);
-    void setLightsAffectedBy(const std::vector<LightSceneNode *> &lights);
 
     // END Dynamic lighting
 
 private:
     std::shared_ptr<render::Model> _model;
     SceneNodeAnimator _animator;
+    std::string _animationName;
+    int _animationFlags { 0 };
     std::unordered_map<uint16_t, ModelNodeSceneNode *> _modelNodeByIndex;
     std::unordered_map<uint16_t, ModelNodeSceneNode *> _modelNodeByNumber;
     std::unordered_map<uint16_t, std::shared_ptr<ModelSceneNode>> _attachedModels;
@@ -101,12 +105,9 @@ private:
     float _alpha { 1.0f };
     bool _drawAABB { false };
     bool _lightingEnabled { false };
-    std::vector<LightSceneNode *> _lightsAffectedBy;
-    bool _lightingDirty { true };
 
     void initModelNodes();
     std::unique_ptr<ModelNodeSceneNode> getModelNodeSceneNode(render::ModelNode &node) const;
-    void updateAbsoluteTransform() override;
 };
 
 } // namespace scene
@@ -21,6 +21,7 @@
 
 #include "GL/glew.h"
 
+#include "../../common/profiler.h"
 #include "../../render/mesh/quad.h"
 #include "../../render/shaders.h"
 #include "../../render/util.h"
@@ -33,31 +34,23 @@ namespace reone {
 
 namespace scene {
 
-static const int kShadowResolution = 2048;
-
 WorldRenderPipeline::WorldRenderPipeline(SceneGraph *scene, const GraphicsOptions &opts) :
     _scene(scene),
     _opts(opts),
     _geometry(opts.width, opts.height, 2),
-    _verticalBlur(opts.width, opts.height),
-    _horizontalBlur(opts.width, opts.height) {
+    _bloom(opts.width, opts.height, opts.bloomLevels, opts.bloomQuality) {
 
-    for (int i = 0; i < kMaxShadowLightCount; ++i) {
-        _shadows.push_back(make_unique<Framebuffer>(kShadowResolution, kShadowResolution, 0));
-    }
+    _shadows.resize(kMaxShadowLightCount * kShadowTierCount);
 }
 
 void WorldRenderPipeline::init() {
     _geometry.init();
-    _verticalBlur.init();
-    _horizontalBlur.init();
-
-    for (auto &shadows : _shadows) {
-        shadows->init();
-    }
+    _bloom.init();
 }
 
 void WorldRenderPipeline::render() const {
+    PROFILE_ZONE("WorldRenderPipeline::render");
+
     drawShadows();
     drawGeometry();
 
@@ -69,13 +62,13 @@ void WorldRenderPipeline::render() const {
 
     Shaders::instance().setGlobalUniforms(globals);
 
-    applyHorizontalBlur();
-    applyVerticalBlur();
+    _bloom.apply(_geometry, 1);
     drawResult();
 }
 
 void WorldRenderPipeline::drawShadows() const {
     const vector<ShadowLight> &lights = _scene->shadowLights();
+    const vector<ShadowCasters> &casters = _scene->shadowCasters();
 
     int lightCount = static_cast<int>(lights.size());
     if (lightCount == 0) return;
@@ -83,12 +76,23 @@ void WorldRenderPipeline::drawShadows() const {
     int viewport[4];
     glGetIntegerv(GL_VIEWPORT, viewport);
 
-    glViewport(0, 0, kShadowResolution, kShadowResolution);
-
     GlobalUniforms globals;
 
     for (int i = 0; i < lightCount; ++i) {
-        _shadows[i]->bind();
+        int resolution = casters[i].resolution;
+        ShadowMap &shadows = getShadowMap(i, casters[i].tier);
+
+        if (!shadows.framebuffer) {
+            shadows.framebuffer = make_unique<Framebuffer>(resolution, resolution, 0);
+            shadows.framebuffer->init();
+        } else if (!casters[i].dynamic && casters[i].hash == shadows.hash) {
+            continue;
+        }
+        shadows.hash = casters[i].hash;
+
+        glViewport(0, 0, resolution, resolution);
+
+        shadows.framebuffer->bind();
 
         glDrawBuffer(GL_NONE);
         glClear(GL_DEPTH_BUFFER_BIT);
@@ -99,14 +103,18 @@ void WorldRenderPipeline::drawShadows() const {
 
         Shaders::instance().setGlobalUniforms(globals);
 
-        withDepthTest([this]() { _scene->renderNoGlobalUniforms(true); });
+        withDepthTest([this, &i]() { _scene->renderShadowCasters(i); });
 
-        _shadows[i]->unbind();
+        shadows.framebuffer->unbind();
     }
 
     glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 }
 
+WorldRenderPipeline::ShadowMap &WorldRenderPipeline::getShadowMap(int lightIdx, int tier) const {
+    return _shadows[lightIdx * kShadowTierCount + tier];
+}
+
 void WorldRenderPipeline::drawGeometry() const {
     _geometry.bind();
 
@@ -115,77 +123,18 @@ void WorldRenderPipeline::drawGeometry() const {
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    const vector<ShadowCasters> &casters = _scene->shadowCasters();
     int lightCount = static_cast<int>(_scene->shadowLights().size());
 
     for (int i = 0; i < lightCount; ++i) {
         glActiveTexture(GL_TEXTURE0 + TextureUniforms::shadowmap0 + i);
-        _shadows[i]->bindDepthBuffer();
+        getShadowMap(i, casters[i].tier).framebuffer->bindDepthBuffer();
     }
     withDepthTest([this]() { _scene->render(); });
 
     _geometry.unbind();
 }
 
-void WorldRenderPipeline::applyHorizontalBlur() const {
-    float w = static_cast<float>(_opts.width);
-    float h = static_cast<float>(_opts.height);
-
-    _horizontalBlur.bind();
-
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    glm::mat4 transform(1.0f);
-    transform = glm::scale(transform, glm::vec3(w, h, 1.0f));
-
-    LocalUniforms locals;
-    locals.general.blurEnabled = true;
-    locals.general.model = move(transform);
-    locals.general.blurResolution = glm::vec2(w, h);
-    locals.general.blurDirection = glm::vec2(1.0f, 0.0f);
-
-    Shaders::instance().activate(ShaderProgram::GUIBlur, locals);
-
-    glActiveTexture(GL_TEXTURE0);
-    _geometry.bindColorBuffer(1);
-
-    withDepthTest([]() {
-        Quad::getDefault().renderTriangles();
-    });
-
-    _geometry.unbindColorBuffer();
-    _horizontalBlur.unbind();
-}
-
-void WorldRenderPipeline::applyVerticalBlur() const {
-    float w = static_cast<float>(_opts.width);
-    float h = static_cast<float>(_opts.height);
-
-    _verticalBlur.bind();
-
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    glm::mat4 transform(1.0f);
-    transform = glm::scale(transform, glm::vec3(w, h, 1.0f));
-
-    LocalUniforms locals;
-    locals.general.blurEnabled = true;
-    locals.general.model = move(transform);
-    locals.general.blurResolution = glm::vec2(_opts.width, _opts.height);
-    locals.general.blurDirection = glm::vec2(0.0f, 1.0f);
-
-    Shaders::instance().activate(ShaderProgram::GUIBlur, locals);
-
-    glActiveTexture(GL_TEXTURE0);
-    _horizontalBlur.bindColorBuffer(0);
-
-    withDepthTest([]() {
-        Quad::getDefault().renderTriangles();
-    });
-
-    _horizontalBlur.unbindColorBuffer();
-    _verticalBlur.unbind();
-}
-
 void WorldRenderPipeline::drawResult() const {
     float w = static_cast<float>(_opts.width);
     float h = static_cast<float>(_opts.height);
@@ -204,12 +153,12 @@ void WorldRenderPipeline::drawResult() const {
     //_shadows[0]->bindDepthBuffer();
 
     glActiveTexture(GL_TEXTURE0 + TextureUniforms::bloom);
-    _verticalBlur.bindColorBuffer(0);
+    _bloom.bindResult();
 
     Quad::getDefault().renderTriangles();
 
     glActiveTexture(GL_TEXTURE0 + TextureUniforms::bloom);
-    _verticalBlur.unbindColorBuffer();
+    _bloom.unbindResult();
 
     glActiveTexture(GL_TEXTURE0);
     _geometry.unbindColorBuffer();
@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
+#include "../../render/bloom.h"
 #include "../../render/framebuffer.h"
 #include "../../render/types.h"
 #include "../../scene/scenegraph.h"
@@ -39,17 +41,28 @@ private:
     SceneGraph *_scene { nullptr };
     render::GraphicsOptions _opts;
     render::Framebuffer _geometry;
-    render::Framebuffer _verticalBlur;
-    render::Framebuffer _horizontalBlur;
-    std::vector<std::unique_ptr<render::Framebuffer>> _shadows;
+    render::BloomChain _bloom;
+
+    // Shadow maps are redrawn only when their casters change. Every light
+    // has a shadow map per resolution tier, allocated on first use, so that
+    // switching between tiers neither reallocates nor invalidates them.
+
+    struct ShadowMap {
+        std::unique_ptr<render::Framebuffer> framebuffer;
+        size_t hash { 0 };
+    };
+
+    mutable std::vector<ShadowMap> _shadows; /**< indexed by light index and tier */
+
+    // END Shadow maps are redrawn only when their casters change
 
     WorldRenderPipeline(const WorldRenderPipeline &) = delete;
     WorldRenderPipeline &operator=(const WorldRenderPipeline &) = delete;
 
     void drawShadows() const;
+
+    ShadowMap &getShadowMap(int lightIdx, int tier) const;
     void drawGeometry() const;
-    void applyHorizontalBlur() const;
-    void applyVerticalBlur() const;
     void drawResult() const;
 };
 
@@ -18,11 +18,24 @@
 #include "scenegraph.h"
 
 #include <algorithm>
+#include <functional>
 #include <stack>
+#include <utility>
 
+#include <boost/functional/hash.hpp>
+
+#include "glm/ext.hpp"
+
+#include "../common/profiler.h"
+#include "../render/mesh/aabb.h"
+#include "../render/mesh/cube.h"
 #include "../render/mesh/quad.h"
 
+#include "frustum.h"
+
+#include "node/aabbnode.h"
 #include "node/cameranode.h"
+#include "node/cubenode.h"
 #include "node/lightnode.h"
 #include "node/modelnodescenenode.h"
 #include "node/modelscenenode.h"
@@ -36,11 +49,52 @@ namespace reone {
 namespace scene {
 
 static const float kMaxLightDistance = 16.0f;
+static const float kShadowResolutionFalloff = 16.0f; // distance from the camera at which shadow resolution is halved
+static const int kMinShadowResolution = 256;
+
+static void sortLightsByPriority(const glm::vec3 &position, vector<const LightDraw *> &lights) {
+    unordered_map<const LightDraw *, float> distances;
+    for (auto &light : lights) {
+        distances.insert(make_pair(light, glm::distance(light->position, position)));
+    }
 
-SceneGraph::SceneGraph(const GraphicsOptions &opts) : _opts(opts) {
+    sort(lights.begin(), lights.end(), [&distances](const LightDraw *left, const LightDraw *right) {
+        int leftPriority = left->priority;
+        int rightPriority = right->priority;
+
+        if (leftPriority < rightPriority) return true;
+        if (leftPriority > rightPriority) return false;
+
+        float leftDistance = distances.find(left)->second;
+        float rightDistance = distances.find(right)->second;
+
+        return leftDistance < rightDistance;
+    });
+}
+
+SceneGraph::SceneGraph(const GraphicsOptions &opts) :
+    _opts(opts),
+    _front(make_unique<FrameSnapshot>()),
+    _back(make_unique<FrameSnapshot>()) {
+}
+
+SceneGraph::~SceneGraph() {
+    if (!_prepThread.joinable()) return;
+
+    {
+        lock_guard<mutex> lock(_prepMutex);
+        _prepQuit = true;
+    }
+    _prepCondition.notify_all();
+    _prepThread.join();
 }
 
 void SceneGraph::clear() {
+    // Snapshots reference meshes of the scene nodes being removed
+    endPrepareFrame();
+    _front->clear();
+    _back->clear();
+
     _roots.clear();
 }
 
@@ -59,96 +113,195 @@ void SceneGraph::build() {
 }
 
 void SceneGraph::prepareFrame() {
-    if (!_activeCamera) return;
+    endPrepareFrame();
 
-    refreshMeshesAndLights();
-    refreshShadowLights();
+    captureFrame(*_back);
+    prepareSnapshot(*_back);
 
-    for (auto &root : _roots) {
-        ModelSceneNode *modelNode = dynamic_cast<ModelSceneNode *>(root.get());
-        if (modelNode) {
-            modelNode->updateLighting();
-        }
+    swap(_front, _back);
+}
+
+void SceneGraph::beginPrepareFrame() {
+    endPrepareFrame();
+
+    captureFrame(*_back);
+
+    if (!_prepThread.joinable()) {
+        _prepThread = thread(bind(&SceneGraph::prepareThreadStart, this));
     }
-    unordered_map<ModelNodeSceneNode *, float> cameraDistances;
-    glm::vec3 cameraPosition(_activeCamera->absoluteTransform()[3]);
+    {
+        lock_guard<mutex> lock(_prepMutex);
+        _prepRequested = true;
+    }
+    _prepCondition.notify_all();
+    _prepPending = true;
+}
 
-    for (auto &mesh : _transparentMeshes) {
-        cameraDistances.insert(make_pair(mesh, mesh->distanceTo(cameraPosition)));
+void SceneGraph::endPrepareFrame() {
+    if (!_prepPending) return;
+
+    PROFILE_ZONE("SceneGraph::endPrepareFrame");
+    {
+        unique_lock<mutex> lock(_prepMutex);
+        _prepCondition.wait(lock, [this]() { return !_prepRequested; });
     }
-    sort(_transparentMeshes.begin(), _transparentMeshes.end(), [&cameraDistances](auto &left, auto &right) {
-        int leftTransparency = left->modelNode()->mesh()->transparency();
-        int rightTransparency = right->modelNode()->mesh()->transparency();
+    _prepPending = false;
 
-        if (leftTransparency < rightTransparency) return true;
-        if (leftTransparency > rightTransparency) return false;
+    swap(_front, _back);
+}
 
-        float leftDistance = cameraDistances.find(left)->second;
-        float rightDistance = cameraDistances.find(right)->second;
+void SceneGraph::prepareThreadStart() {
+    Profiler::instance().setThreadName("Render Prep");
 
-        return leftDistance > rightDistance;
-    });
+    unique_lock<mutex> lock(_prepMutex);
+
+    while (true) {
+        _prepCondition.wait(lock, [this]() { return _prepRequested || _prepQuit; });
+        if (_prepQuit) break;
+
+        // The back snapshot is owned by this thread until the request is cleared
+        lock.unlock();
+        prepareSnapshot(*_back);
+        lock.lock();
+
+        _prepRequested = false;
+        _prepCondition.notify_all();
+    }
 }
 
-void SceneGraph::refreshMeshesAndLights() {
-    _opaqueMeshes.clear();
-    _transparentMeshes.clear();
-    _shadowMeshes.clear();
-    _lights.clear();
+void SceneGraph::captureFrame(FrameSnapshot &frame) const {
+    PROFILE_ZONE("SceneGraph::captureFrame");
+
+    frame.clear();
+
+    if (!_activeCamera) return;
+
+    frame.projection = _activeCamera->projection();
+    frame.view = _activeCamera->view();
+    frame.cameraPosition = _activeCamera->absoluteTransform()[3];
+    frame.ambientLightColor = _ambientLightColor;
+
+    if (_refNode) {
+        frame.hasReferencePosition = true;
+        frame.referencePosition = _refNode->absoluteTransform()[3];
+    }
 
     for (auto &root : _roots) {
-        stack<SceneNode *> nodes;
-        nodes.push(root.get());
+        // Primitives inside models are not rendered
+        stack<pair<SceneNode *, bool>> nodes;
+        nodes.push(make_pair(root.get(), false));
 
         while (!nodes.empty()) {
-            SceneNode *node = nodes.top();
+            SceneNode *node = nodes.top().first;
+            bool insideModel = nodes.top().second;
             nodes.pop();
 
             ModelSceneNode *model = dynamic_cast<ModelSceneNode *>(node);
             if (model) {
                 if (!model->isVisible() || !model->isOnScreen()) continue;
-
-            } else {
-                ModelNodeSceneNode *modelNode = dynamic_cast<ModelNodeSceneNode *>(node);
-                if (modelNode) {
-                    if (modelNode->shouldRender()) {
-                        if (modelNode->isTransparent()) {
-                            _transparentMeshes.push_back(modelNode);
-                        } else {
-                            _opaqueMeshes.push_back(modelNode);
-                        }
+                insideModel = true;
+
+            } else if (auto modelNode = dynamic_cast<ModelNodeSceneNode *>(node)) {
+                bool render = modelNode->shouldRender();
+                bool castShadows = modelNode->shouldCastShadows();
+
+                if (render || castShadows) {
+                    const ModelSceneNode *modelSceneNode = modelNode->modelSceneNode();
+                    shared_ptr<ModelMesh> mesh(modelNode->modelNode()->mesh());
+
+                    MeshDraw draw;
+                    draw.mesh = mesh;
+                    draw.textureOverride = modelSceneNode->textureOverride();
+                    draw.key = reinterpret_cast<uintptr_t>(modelNode);
+                    draw.position = modelNode->absoluteTransform()[3];
+                    draw.modelBounds = modelSceneNode->aabb() * modelSceneNode->absoluteTransform();
+                    draw.transparency = mesh->transparency();
+                    draw.animating = modelSceneNode->isAnimating();
+
+                    if (render && modelNode->modelNode()->skin()) {
+                        draw.locals.skeletal = frame.allocateSkeletal();
                     }
-                    if (modelNode->shouldCastShadows()) {
-                        _shadowMeshes.push_back(modelNode);
-                    }
-                } else {
-                    LightSceneNode *light = dynamic_cast<LightSceneNode *>(node);
-                    if (light) {
-                        _lights.push_back(light);
+                    modelNode->fillUniforms(draw.locals);
+
+                    if (castShadows) {
+                        frame.shadowMeshes.push_back(move(draw));
+                    } else if (modelNode->isTransparent()) {
+                        frame.transparentMeshes.push_back(move(draw));
+                    } else {
+                        frame.opaqueMeshes.push_back(move(draw));
                     }
                 }
+            } else if (auto light = dynamic_cast<LightSceneNode *>(node)) {
+                LightDraw draw;
+                draw.position = light->absoluteTransform()[3];
+                draw.color = light->color();
+                draw.radius = light->radius();
+                draw.priority = light->priority();
+                draw.shadow = light->shadow();
+                frame.lights.push_back(move(draw));
+
+            } else if (!insideModel) {
+                if (auto cube = dynamic_cast<CubeSceneNode *>(node)) {
+                    PrimitiveDraw draw;
+                    draw.type = PrimitiveDraw::Type::Cube;
+                    draw.transform = glm::scale(cube->absoluteTransform(), glm::vec3(cube->size()));
+                    frame.primitives.push_back(move(draw));
+
+                } else if (auto aabb = dynamic_cast<AABBSceneNode *>(node)) {
+                    PrimitiveDraw draw;
+                    draw.type = PrimitiveDraw::Type::AABB;
+                    draw.transform = aabb->absoluteTransform();
+                    draw.aabb = aabb->aabb();
+                    frame.primitives.push_back(move(draw));
+                }
             }
             for (auto &child : node->children()) {
-                nodes.push(child.get());
+                nodes.push(make_pair(child.get(), insideModel));
             }
         }
     }
+
+    frame.valid = true;
 }
 
-void SceneGraph::refreshShadowLights() {
-    _shadowLights.clear();
+void SceneGraph::prepareSnapshot(FrameSnapshot &frame) const {
+    PROFILE_ZONE("SceneGraph::prepareFrame");
+
+    if (!frame.valid) return;
+
+    refreshShadowLights(frame);
+    refreshLightGrid(frame);
+
+    unordered_map<uintptr_t, float> cameraDistances;
+    for (auto &mesh : frame.transparentMeshes) {
+        cameraDistances.insert(make_pair(mesh.key, glm::distance(mesh.position, frame.cameraPosition)));
+    }
+    sort(frame.transparentMeshes.begin(), frame.transparentMeshes.end(), [&cameraDistances](auto &left, auto &right) {
+        int leftTransparency = left.transparency;
+        int rightTransparency = right.transparency;
+
+        if (leftTransparency < rightTransparency) return true;
+        if (leftTransparency > rightTransparency) return false;
+
+        float leftDistance = cameraDistances.find(left.key)->second;
+        float rightDistance = cameraDistances.find(right.key)->second;
+
+        return leftDistance > rightDistance;
+    });
+}
 
-    if (!_refNode) return;
+void SceneGraph::refreshShadowLights(FrameSnapshot &frame) const {
+    if (!frame.hasReferencePosition) return;
 
-    glm::vec3 refNodePos(_refNode->absoluteTransform()[3]);
-    vector<LightSceneNode *> lights;
-    getLightsAt(refNodePos, lights);
+    glm::vec3 refNodePos(frame.referencePosition);
+    vector<const LightDraw *> lights;
+    getLightsAt(frame, refNodePos, lights);
 
     for (auto &light : lights) {
-        if (!light->shadow()) continue;
-        if (_shadowLights.size() >= kMaxShadowLightCount) break;
+        if (!light->shadow) continue;
+        if (frame.shadowLights.size() >= kMaxShadowLightCount) break;
 
-        glm::vec3 lightPos(light->absoluteTransform()[3]);
+        glm::vec3 lightPos(light->position);
         glm::vec3 lightToRefNode(lightPos - refNodePos);
         glm::vec3 lightDir(glm::normalize(lightToRefNode));
 
@@ -161,81 +314,157 @@ void SceneGraph::refreshShadowLights() {
         shadowLight.position = glm::vec4(lightPos, 1.0f);
         shadowLight.view = view;
         shadowLight.projection = getLightProjection();
-        _shadowLights.push_back(move(shadowLight));
+
+        // Cull shadow casters against the light frustum
+
+        ShadowCasters casters;
+        casters.tier = getShadowTier(frame, lightPos);
+        casters.resolution = getShadowResolution(casters.tier);
+
+        size_t hash = 0;
+        boost::hash_combine(hash, casters.resolution);
+        for (int i = 0; i < 16; ++i) {
+            boost::hash_combine(hash, glm::value_ptr(shadowLight.view)[i]);
+        }
+
+        Frustum frustum(shadowLight.projection * shadowLight.view);
+
+        for (int i = 0; i < static_cast<int>(frame.shadowMeshes.size()); ++i) {
+            const MeshDraw &mesh = frame.shadowMeshes[i];
+
+            // Skinned meshes can leave their own bounds, so test against the bounds of the whole model
+            if (!frustum.intersects(mesh.modelBounds)) continue;
+
+            casters.meshes.push_back(i);
+            casters.dynamic |= mesh.animating;
+
+            boost::hash_combine(hash, mesh.key);
+            const float *transform = glm::value_ptr(mesh.locals.general.model);
+            for (int j = 0; j < 16; ++j) {
+                boost::hash_combine(hash, transform[j]);
+            }
+        }
+        casters.hash = hash;
+
+        frame.shadowLights.push_back(move(shadowLight));
+        frame.shadowCasters.push_back(move(casters));
+    }
+}
+
+int SceneGraph::getShadowTier(const FrameSnapshot &frame, const glm::vec3 &lightPosition) const {
+    int tier = static_cast<int>(glm::distance(frame.cameraPosition, lightPosition) / kShadowResolutionFalloff);
+
+    return glm::min(tier, kShadowTierCount - 1);
+}
+
+int SceneGraph::getShadowResolution(int tier) const {
+    return glm::max(_opts.shadowResolution >> tier, kMinShadowResolution);
+}
+
+void SceneGraph::refreshLightGrid(FrameSnapshot &frame) const {
+    // Lights with higher priority and closer to the camera win, when there
+    // are too many of them in a single cluster
+
+    vector<const LightDraw *> lights;
+    lights.reserve(frame.lights.size());
+    for (auto &light : frame.lights) {
+        lights.push_back(&light);
+    }
+    sortLightsByPriority(frame.cameraPosition, lights);
+
+    vector<GridLight> gridLights;
+    gridLights.reserve(lights.size());
+
+    for (auto &light : lights) {
+        GridLight gridLight;
+        gridLight.position = light->position;
+        gridLight.radius = light->radius;
+        gridLight.color = light->color;
+        gridLights.push_back(move(gridLight));
     }
+
+    frame.lightGrid.build(frame.view, frame.projection, gridLights);
 }
 
 void SceneGraph::render() const {
-    if (!_activeCamera) return;
+    const FrameSnapshot &frame = *_front;
+    if (!frame.valid) return;
 
     GlobalUniforms globals;
-    globals.projection = _activeCamera->projection();
-    globals.view = _activeCamera->view();
-    globals.cameraPosition = _activeCamera->absoluteTransform()[3];
+    globals.projection = frame.projection;
+    globals.view = frame.view;
+    globals.cameraPosition = frame.cameraPosition;
 
-    int lightCount = static_cast<int>(_shadowLights.size());
+    int lightCount = static_cast<int>(frame.shadowLights.size());
     globals.shadows.shadowLightCount = lightCount;
     for (int i = 0; i < lightCount; ++i) {
         ShadowLight &light = globals.shadows.shadowLights[i];
-        light = _shadowLights[i];
+        light = frame.shadowLights[i];
     }
 
-    Shaders::instance().setGlobalUniforms(globals);
-
-    renderNoGlobalUniforms(false);
-}
+    globals.lighting.ambientLightColor = glm::vec4(frame.ambientLightColor, 1.0f);
+    globals.lighting.clusterDepthScale = frame.lightGrid.depthScale();
+    globals.lighting.clusterDepthBias = frame.lightGrid.depthBias();
 
-void SceneGraph::renderNoGlobalUniforms(bool shadowPass) const {
-    if (shadowPass) {
-        for (auto &mesh : _shadowMeshes) {
-            mesh->renderSingle(true);
+    Shaders::instance().setGlobalUniforms(globals);
+    Shaders::instance().setLightGrid(frame.lightGrid);
+
+    for (auto &primitive : frame.primitives) {
+        switch (primitive.type) {
+            case PrimitiveDraw::Type::Cube:
+                CubeMesh::instance().render(primitive.transform);
+                break;
+            case PrimitiveDraw::Type::AABB:
+                AABBMesh::instance().render(primitive.aabb, primitive.transform);
+                break;
         }
-        return;
     }
-    for (auto &root : _roots) {
-        root->render();
-    }
-    for (auto &mesh : _opaqueMeshes) {
-        mesh->renderSingle(false);
+    for (auto &mesh : frame.opaqueMeshes) {
+        drawMesh(mesh, false);
     }
-    for (auto &mesh : _transparentMeshes) {
-        mesh->renderSingle(false);
+    for (auto &mesh : frame.transparentMeshes) {
+        drawMesh(mesh, false);
     }
 }
 
-const vector<ShadowLight> &SceneGraph::shadowLights() const {
-    return _shadowLights;
-}
+void SceneGraph::renderShadowCasters(int lightIdx) const {
+    const FrameSnapshot &frame = *_front;
 
-void SceneGraph::getLightsAt(const glm::vec3 &position, vector<LightSceneNode *> &lights) const {
-    unordered_map<LightSceneNode *, float> distances;
-    lights.clear();
-
-    for (auto &light : _lights) {
-        float distance = light->distanceTo(position);
-        float radius = light->radius();
-        if (distance > radius) continue;
+    for (auto &meshIdx : frame.shadowCasters[lightIdx].meshes) {
+        drawMesh(frame.shadowMeshes[meshIdx], true);
+    }
+}
 
-        distances.insert(make_pair(light, distance));
-        lights.push_back(light);
+void SceneGraph::drawMesh(const MeshDraw &draw, bool shadowPass) const {
+    if (shadowPass) {
+        LocalUniforms locals;
+        locals.general.model = draw.locals.general.model;
+        locals.general.alpha = draw.locals.general.alpha;
+        Shaders::instance().activate(ShaderProgram::ModelWhite, locals);
+    } else {
+        Shaders::instance().activate(ShaderProgram::ModelModel, draw.locals);
     }
+    draw.mesh->render(draw.textureOverride);
+}
 
-    sort(lights.begin(), lights.end(), [&distances](LightSceneNode *left, LightSceneNode *right) {
-        int leftPriority = left->priority();
-        int rightPriority = right->priority();
+const vector<ShadowLight> &SceneGraph::shadowLights() const {
+    return _front->shadowLights;
+}
 
-        if (leftPriority < rightPriority) return true;
-        if (leftPriority > rightPriority) return false;
+const vector<ShadowCasters> &SceneGraph::shadowCasters() const {
+    return _front->shadowCasters;
+}
 
-        float leftDistance = distances.find(left)->second;
-        float rightDistance = distances.find(right)->second;
+void SceneGraph::getLightsAt(const FrameSnapshot &frame, const glm::vec3 &position, vector<const LightDraw *> &lights) const {
+    lights.clear();
 
-        return leftDistance < rightDistance;
-    });
+    for (auto &light : frame.lights) {
+        if (glm::distance(light.position, position) > light.radius) continue;
 
-    if (lights.size() > kMaxLightCount) {
-        lights.erase(lights.begin() + kMaxLightCount, lights.end());
+        lights.push_back(&light);
     }
+
+    sortLightsByPriority(position, lights);
 }
 
 glm::mat4 SceneGraph::getLightProjection() const {
@@ -17,29 +17,45 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <cstddef>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "glm/vec3.hpp"
 
 #include "../render/types.h"
 
+#include "snapshot.h"
+
 namespace reone {
 
 namespace scene {
 
 class CameraSceneNode;
-class LightSceneNode;
-class ModelNodeSceneNode;
 class SceneNode;
 
+/**
+ * Renders a frame from a snapshot of the scene graph. Each frame is captured
+ * into a snapshot, which is then prepared (sorted, culled and lit) and
+ * rendered. Capturing must happen on the main thread, as it reads scene
+ * nodes, while preparation only reads the snapshot.
+ *
+ * There are two ways to prepare a frame: synchronously, via prepareFrame, or
+ * pipelined, via beginPrepareFrame and endPrepareFrame. In the latter case,
+ * preparation happens on a dedicated thread, and a frame is rendered one
+ * frame after it was captured.
+ */
 class SceneGraph {
 public:
     SceneGraph(const render::GraphicsOptions &opts);
+    ~SceneGraph();
 
     void render() const;
-    void renderNoGlobalUniforms(bool shadowPass) const;
+    void renderShadowCasters(int lightIdx) const;
 
     void clear();
 
@@ -47,16 +63,31 @@ public:
     void removeRoot(const std::shared_ptr<SceneNode> &node);
 
     void build();
+
+    /**
+     * Captures and prepares a frame synchronously.
+     */
     void prepareFrame();
 
+    /**
+     * Captures a frame and starts preparing it on the frame preparation
+     * thread. The frame will be rendered after a call to endPrepareFrame.
+     */
+    void beginPrepareFrame();
+
+    /**
+     * Waits until the frame, captured in beginPrepareFrame, is prepared and
+     * makes it the one to render. Does nothing if no frame is in preparation.
+     */
+    void endPrepareFrame();
+
     void setActiveCamera(const std::shared_ptr<CameraSceneNode> &camera);
     void setReferenceNode(const std::shared_ptr<SceneNode> &node);
 
     // Lights
 
     const std::vector<render::ShadowLight> &shadowLights() const;
-
-    void getLightsAt(const glm::vec3 &position, std::vector<LightSceneNode *> &lights) const;
+    const std::vector<ShadowCasters> &shadowCasters() const;
 
     const glm::vec3 &ambientLightColor() const;
     void setAmbientLightColor(const glm::vec3 &color);
@@ -66,23 +97,43 @@ public:
 private:
     render::GraphicsOptions _opts;
     std::vector<std::shared_ptr<SceneNode>> _roots;
-    std::vector<ModelNodeSceneNode *> _opaqueMeshes;
-    std::vector<ModelNodeSceneNode *> _transparentMeshes;
-    std::vector<ModelNodeSceneNode *> _shadowMeshes;
-    std::vector<LightSceneNode *> _lights;
     std::shared_ptr<CameraSceneNode> _activeCamera;
     glm::vec3 _ambientLightColor { 0.5f };
-    uint32_t _textureId { 0 };
-    std::vector<render::ShadowLight> _shadowLights;
     std::shared_ptr<SceneNode> _refNode;
 
+    // Snapshots
+
+    std::unique_ptr<FrameSnapshot> _front; /**< frame to render */
+    std::unique_ptr<FrameSnapshot> _back; /**< frame being captured or prepared */
+
+    // END Snapshots
+
+    // Frame preparation thread
+
+    std::thread _prepThread;
+    std::mutex _prepMutex;
+    std::condition_variable _prepCondition;
+    bool _prepRequested { false };
+    bool _prepPending { false };
+    bool _prepQuit { false };
+
+    // END Frame preparation thread
+
     SceneGraph(const SceneGraph &) = delete;
     SceneGraph &operator=(const SceneGraph &) = delete;
 
-    void refreshMeshesAndLights();
-    void refreshShadowLights();
+    void captureFrame(FrameSnapshot &frame) const;
+    void prepareSnapshot(FrameSnapshot &frame) const;
+    void prepareThreadStart();
+
+    void refreshShadowLights(FrameSnapshot &frame) const;
+    void refreshLightGrid(FrameSnapshot &frame) const;
+    void drawMesh(const MeshDraw &draw, bool shadowPass) const;
 
+    void getLightsAt(const FrameSnapshot &frame, const glm::vec3 &position, std::vector<const LightDraw *> &lights) const;
     glm::mat4 getLightProjection() const;
+    int getShadowTier(const FrameSnapshot &frame, const glm::vec3 &lightPosition) const;
+    int getShadowResolution(int tier) const;
 };
 
 } // namespace scene
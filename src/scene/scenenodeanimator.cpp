@@ -250,6 +250,13 @@ bool SceneNodeAnimator::isAnimationFinished() const {
     return !_channels[0].isActive();
 }
 
+bool SceneNodeAnimator::isAnimating() const {
+    for (int i = 0; i < kChannelCount; ++i) {
+        if (_channels[i].isActive() && !_channels[i].freeze) return true;
+    }
+    return false;
+}
+
 void SceneNodeAnimator::setDefaultAnimation(const string &name) {
     _defaultAnim = name;
 }
@@ -55,6 +55,11 @@ public:
 
     bool isAnimationFinished() const;
 
+    /**
+     * @return true if node transforms are being updated by an animation
+     */
+    bool isAnimating() const;
+
     void setDefaultAnimation(const std::string &name);
 
 private:
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "glm/mat4x4.hpp"
+#include "glm/vec3.hpp"
+
+#include "../common/aabb.h"
+#include "../render/lightgrid.h"
+#include "../render/mesh/modelmesh.h"
+#include "../render/shaders.h"
+#include "../render/texture.h"
+
+namespace reone {
+
+namespace scene {
+
+/**
+ * Everything required to draw a single mesh, copied from a scene node.
+ */
+struct MeshDraw {
+    std::shared_ptr<render::ModelMesh> mesh;
+    std::shared_ptr<render::Texture> textureOverride;
+    render::LocalUniforms locals;
+    uintptr_t key { 0 }; /**< identity of the scene node, stable between frames */
+    glm::vec3 position { 0.0f };
+    AABB modelBounds; /**< world space bounds of the whole model */
+    int transparency { 0 };
+    bool animating { false };
+};
+
+struct LightDraw {
+    glm::vec3 position { 0.0f };
+    glm::vec3 color { 1.0f };
+    float radius { 1.0f };
+    int priority { 0 };
+    bool shadow { false };
+};
+
+struct PrimitiveDraw {
+    enum class Type {
+        Cube,
+        AABB
+    };
+
+    Type type { Type::Cube };
+    glm::mat4 transform { 1.0f };
+    AABB aabb;
+};
+
+/**
+ * Shadow map resolution is halved with every tier.
+ */
+const int kShadowTierCount = 3;
+
+/**
+ * Meshes that cast shadows from a single shadow light.
+ */
+struct ShadowCasters {
+    std::vector<int> meshes; /**< indices into FrameSnapshot::shadowMeshes */
+    int tier { 0 };
+    int resolution { 0 };
+    bool dynamic { false }; /**< some of the meshes are animated */
+    size_t hash { 0 }; /**< changes when the light or any of the meshes moves */
+};
+
+/**
+ * Immutable copy of the scene graph state, from which a frame is rendered.
+ * Captured from the scene graph on the main thread, then prepared (sorted,
+ * culled and lit) independently of the scene graph, so that preparation can
+ * run on another thread while the simulation advances.
+ */
+struct FrameSnapshot {
+    bool valid { false };
+
+    // Captured
+
+    glm::mat4 projection { 1.0f };
+    glm::mat4 view { 1.0f };
+    glm::vec3 cameraPosition { 0.0f };
+    bool hasReferencePosition { false };
+    glm::vec3 referencePosition { 0.0f };
+    glm::vec3 ambientLightColor { 0.5f };
+    std::vector<MeshDraw> opaqueMeshes;
+    std::vector<MeshDraw> transparentMeshes;
+    std::vector<MeshDraw> shadowMeshes;
+    std::vector<LightDraw> lights;
+    std::vector<PrimitiveDraw> primitives;
+
+    // END Captured
+
+    // Prepared
+
+    std::vector<render::ShadowLight> shadowLights;
+    std::vector<ShadowCasters> shadowCasters;
+    render::LightGrid lightGrid;
+
+    // END Prepared
+
+    /**
+     * Skeletal uniforms are reused between frames, as they are large.
+     */
+    std::vector<std::shared_ptr<render::SkeletalUniforms>> skeletalPool;
+    size_t skeletalUsed { 0 };
+
+    void clear() {
+        valid = false;
+        hasReferencePosition = false;
+        opaqueMeshes.clear();
+        transparentMeshes.clear();
+        shadowMeshes.clear();
+        lights.clear();
+        primitives.clear();
+        shadowLights.clear();
+        shadowCasters.clear();
+        skeletalUsed = 0;
+    }
+
+    std::shared_ptr<render::SkeletalUniforms> allocateSkeletal() {
+        if (skeletalUsed == skeletalPool.size()) {
+            skeletalPool.push_back(std::make_shared<render::SkeletalUniforms>());
+        }
+        return skeletalPool[skeletalUsed++];
+    }
+};
+
+} // namespace scene
+
+} // namespace reone
@@ -17,13 +17,16 @@
 
 #include "bikfile.h"
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 #include <boost/filesystem.hpp>
 
+#include "../audio/decoder.h"
 #include "../audio/stream.h"
 #include "../common/log.h"
-#include "../common/streamreader.h"
+#include "../common/mediastream.h"
 
 #include "video.h"
 
@@ -53,268 +56,293 @@ static const char kSignature[] = "BIKi";
 
 #if REONE_ENABLE_VIDEO
 
-class BinkVideoDecoder : public MediaStream<Video::Frame> {
-public:
-    BinkVideoDecoder(const fs::path &path) : _path(path) {
+static void openInput(const fs::path &path, AVFormatContext *&formatCtx) {
+    if (avformat_open_input(&formatCtx, path.string().c_str(), nullptr, nullptr) != 0) {
+        throw runtime_error("BIK: failed to open");
+    }
+    if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
+        throw runtime_error("BIK: failed to find stream info");
     }
+}
 
-    ~BinkVideoDecoder() {
-        deinit();
+static int findStream(AVFormatContext *formatCtx, AVMediaType type) {
+    for (uint32_t i = 0; i < formatCtx->nb_streams; ++i) {
+        if (formatCtx->streams[i]->codec->codec_type == type) return i;
+    }
+    return -1;
+}
+
+static AVCodecContext *openCodec(AVFormatContext *formatCtx, int streamIdx) {
+    AVCodecContext *codecCtx = formatCtx->streams[streamIdx]->codec;
+    AVCodec *codec = avcodec_find_decoder(codecCtx->codec_id);
+    if (!codec) {
+        throw runtime_error("BIK: codec not found");
+    }
+    AVCodecContext *result = avcodec_alloc_context3(codec);
+    if (avcodec_copy_context(result, codecCtx) != 0) {
+        throw runtime_error("BIK: failed to copy a codec context");
+    }
+    if (avcodec_open2(result, codec, nullptr) != 0) {
+        throw runtime_error("BIK: failed to open a codec");
     }
+    return result;
+}
 
-    void deinit() {
-        if (_videoBuffer) {
-            av_free(_videoBuffer);
-            _videoBuffer = nullptr;
-        }
-        if (_frameRgb) {
-            av_free(_frameRgb);
-            _frameRgb = nullptr;
-        }
+static void copyPlane(const uint8_t *src, int srcStride, int width, int height, ByteArray &dest) {
+    dest.resize(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        memcpy(&dest[static_cast<size_t>(y) * width], src + static_cast<ptrdiff_t>(y) * srcStride, width);
+    }
+}
+
+/**
+ * Decodes the audio track of a Bink Video file into mono 16-bit chunks. Has a
+ * demuxer of its own, so that audio is decoded on the audio streaming thread,
+ * independently from video. The file is opened on the first call to decode.
+ */
+class BinkAudioDecoder : public AudioDecoder {
+public:
+    BinkAudioDecoder(const fs::path &path) : _path(path) {
+    }
+
+    ~BinkAudioDecoder() {
         if (_frame) {
-            av_free(_frame);
-            _frame = nullptr;
+            av_frame_free(&_frame);
         }
         if (_swrContext) {
             swr_free(&_swrContext);
         }
-        if (_swsContext) {
-            sws_freeContext(_swsContext);
-            _swsContext = nullptr;
-        }
-        if (_audioCodecCtx) {
-            avcodec_close(_audioCodecCtx);
-            _audioCodecCtx = nullptr;
-        }
-        if (_videoCodecCtx) {
-            avcodec_close(_videoCodecCtx);
-            _videoCodecCtx = nullptr;
+        if (_codecCtx) {
+            avcodec_close(_codecCtx);
+            avcodec_free_context(&_codecCtx);
         }
         if (_formatCtx) {
             avformat_close_input(&_formatCtx);
         }
     }
 
-    void ignoreFrames(int count) override {
-        readVideoFrames(count, true);
-    }
-
-    void fetchFrames(int count) override {
-        readVideoFrames(count);
-    }
-
-    void load() {
-        openInput(_path);
-        findStreams();
-        openVideoCodec();
+    bool decode(AudioStream::Frame &frame) override {
+        if (!_formatCtx) {
+            open();
+        }
+        frame.format = AudioFormat::Mono16;
+        frame.sampleRate = _codecCtx->sample_rate;
+        frame.samples.clear();
 
-        if (hasAudio()) {
-            openAudioCodec();
+        // Bink audio packets are small, accumulate them into a chunk
+        AVPacket packet;
+        while (frame.samples.size() < static_cast<size_t>(kAudioChunkSize) && av_read_frame(_formatCtx, &packet) >= 0) {
+            if (packet.stream_index == _streamIdx && avcodec_send_packet(_codecCtx, &packet) == 0) {
+                while (avcodec_receive_frame(_codecCtx, _frame) == 0) {
+                    appendSamples(frame.samples);
+                }
+            }
+            av_packet_unref(&packet);
         }
-        initConverters();
-        initFrames();
-        initVideo();
-        readAudioFrames();
+
+        return !frame.samples.empty();
     }
 
-    shared_ptr<Video> video() const {
-        return _video;
+    void rewind() override {
+        if (!_formatCtx) return;
+
+        av_seek_frame(_formatCtx, _streamIdx, 0, AVSEEK_FLAG_BACKWARD);
+        avcodec_flush_buffers(_codecCtx);
     }
 
 private:
     fs::path _path;
     AVFormatContext *_formatCtx { nullptr };
-    int _videoStreamIdx { -1 };
-    int _audioStreamIdx { -1 };
-    AVCodecContext *_videoCodecCtx { nullptr };
-    AVCodecContext *_audioCodecCtx { nullptr };
-    SwsContext *_swsContext { nullptr };
+    int _streamIdx { -1 };
+    AVCodecContext *_codecCtx { nullptr };
     SwrContext *_swrContext { nullptr };
     AVFrame *_frame { nullptr };
-    AVFrame *_frameRgb { nullptr };
-    uint8_t *_videoBuffer { nullptr };
-    shared_ptr<Video> _video;
 
-    void openInput(const fs::path &path) {
-        if (avformat_open_input(&_formatCtx, path.string().c_str(), nullptr, nullptr) != 0) {
-            throw runtime_error("BIK: failed to open");
-        }
-    }
+    void open() {
+        openInput(_path, _formatCtx);
 
-    void findStreams() {
-        if (avformat_find_stream_info(_formatCtx, nullptr) != 0) {
-            throw runtime_error("BIK: failed to find stream info");
-        }
-        for (uint32_t i = 0; i < _formatCtx->nb_streams; ++i) {
-            AVMediaType codecType = _formatCtx->streams[i]->codec->codec_type;
-            switch (codecType) {
-                case AVMEDIA_TYPE_VIDEO:
-                    _videoStreamIdx = i;
-                    break;
-                case AVMEDIA_TYPE_AUDIO:
-                    _audioStreamIdx = i;
-                    break;
-                default:
-                    break;
-            }
-        }
-        if (_videoStreamIdx == -1) {
-            throw runtime_error("BIK: video stream not found");
+        _streamIdx = findStream(_formatCtx, AVMEDIA_TYPE_AUDIO);
+        if (_streamIdx == -1) {
+            throw runtime_error("BIK: audio stream not found");
         }
-    }
+        _codecCtx = openCodec(_formatCtx, _streamIdx);
 
-    void openVideoCodec() {
-        AVCodecContext *codecCtx = _formatCtx->streams[_videoStreamIdx]->codec;
-        AVCodec *codec = avcodec_find_decoder(codecCtx->codec_id);
-        if (!codec) {
-            throw runtime_error("BIK: video codec not found");
-        }
-        _videoCodecCtx = avcodec_alloc_context3(codec);
-        if (avcodec_copy_context(_videoCodecCtx, codecCtx) != 0) {
-            throw runtime_error("BIK: failed to copy a video codec context");
-        }
-        if (avcodec_open2(_videoCodecCtx, codec, nullptr) != 0) {
-            throw runtime_error("BIK: failed to open a video codec");
-        }
-    }
+        _swrContext = swr_alloc_set_opts(
+            nullptr,
+            AV_CH_LAYOUT_MONO, AV_SAMPLE_FMT_S16, _codecCtx->sample_rate,
+            _codecCtx->channel_layout, _codecCtx->sample_fmt, _codecCtx->sample_rate,
+            0, nullptr);
 
-    bool hasAudio() const {
-        return _audioStreamIdx != -1;
-    }
+        swr_init(_swrContext);
 
-    void openAudioCodec() {
-        AVCodecContext *codecCtx = _formatCtx->streams[_audioStreamIdx]->codec;
-        AVCodec *codec = avcodec_find_decoder(codecCtx->codec_id);
-        if (!codec) {
-            throw runtime_error("BIK: audio codec not found");
-        }
-        _audioCodecCtx = avcodec_alloc_context3(codec);
-        if (avcodec_copy_context(_audioCodecCtx, codecCtx) != 0) {
-            throw runtime_error("BIK: failed to copy an audio codec context");
-        }
-        if (avcodec_open2(_audioCodecCtx, codec, nullptr) != 0) {
-            throw runtime_error("BIK: failed to open an audio codec");
-        }
+        _frame = av_frame_alloc();
     }
 
-    void initConverters() {
-        _swsContext = sws_getContext(
-            _videoCodecCtx->width, _videoCodecCtx->height,
-            _videoCodecCtx->pix_fmt,
-            _videoCodecCtx->width, _videoCodecCtx->height,
-            AV_PIX_FMT_RGB24,
-            SWS_BILINEAR,
-            nullptr, nullptr, nullptr);
+    void appendSamples(ByteArray &samples) {
+        int sampleCount = swr_get_out_samples(_swrContext, _frame->nb_samples);
+        size_t offset = samples.size();
+        samples.resize(offset + 2ll * sampleCount);
+        uint8_t *samplesPtr = reinterpret_cast<uint8_t *>(&samples[offset]);
 
-        if (hasAudio()) {
-            _swrContext = swr_alloc_set_opts(
-                nullptr,
-                AV_CH_LAYOUT_MONO, AV_SAMPLE_FMT_S16, _audioCodecCtx->sample_rate,
-                _audioCodecCtx->channel_layout, _audioCodecCtx->sample_fmt, _audioCodecCtx->sample_rate,
-                0, nullptr);
+        int converted = swr_convert(
+            _swrContext,
+            &samplesPtr, sampleCount,
+            const_cast<const uint8_t **>(&_frame->extended_data[0]), _frame->nb_samples);
 
-            swr_init(_swrContext);
-        }
+        samples.resize(offset + 2ll * max(converted, 0));
     }
+};
 
-    void initFrames() {
-        _frame = av_frame_alloc();
-        _frameRgb = av_frame_alloc();
-
-        int bufSize = avpicture_get_size(AV_PIX_FMT_RGB24, _videoCodecCtx->width, _videoCodecCtx->height);
-        _videoBuffer = static_cast<uint8_t *>(av_malloc(bufSize));
-        avpicture_fill(reinterpret_cast<AVPicture *>(_frameRgb), _videoBuffer, AV_PIX_FMT_RGB24, _videoCodecCtx->width, _videoCodecCtx->height);
+/**
+ * Decodes video frames of a Bink Video file on the decoding thread of the
+ * media stream. Planes of decoded pictures are copied as they are, and
+ * converted into RGB by the video shader.
+ */
+class BinkVideoDecoder : public MediaStream<Video::Frame> {
+public:
+    BinkVideoDecoder(const fs::path &path) : _path(path) {
     }
 
-    void initVideo() {
-        AVRational &frameRate = _formatCtx->streams[_videoStreamIdx]->r_frame_rate;
+    ~BinkVideoDecoder() {
+        stop();
+        deinit();
+    }
 
-        _video = make_shared<Video>();
-        _video->_width = _videoCodecCtx->width;
-        _video->_height = _videoCodecCtx->height;
-        _video->_fps = frameRate.num / static_cast<float>(frameRate.den);
+    /**
+     * Opens the file and starts decoding.
+     *
+     * @return video, which frames are to be fetched from this stream
+     */
+    shared_ptr<Video> load() {
+        openInput(_path, _formatCtx);
 
-        if (hasAudio()) {
-            _video->_audio = make_shared<AudioStream>();
+        _videoStreamIdx = findStream(_formatCtx, AVMEDIA_TYPE_VIDEO);
+        if (_videoStreamIdx == -1) {
+            throw runtime_error("BIK: video stream not found");
         }
-    }
+        _videoCodecCtx = openCodec(_formatCtx, _videoStreamIdx);
+        _frame = av_frame_alloc();
 
-    void readVideoFrames(int count, bool ignore = false) {
-        if (count == 0 || _ended) return;
+        initConverter();
+        shared_ptr<Video> video(createVideo());
+        start();
 
-        AVPacket packet;
+        return video;
+    }
 
-        while (count > 0) {
-            if (av_read_frame(_formatCtx, &packet) < 0) {
-                _ended = true;
-                break;
-            }
-            if (packet.stream_index != _videoStreamIdx) continue;
+protected:
+    bool decodeFrame(Video::Frame &frame) override {
+        AVPacket packet;
 
+        while (av_read_frame(_formatCtx, &packet) >= 0) {
             int gotFrame = 0;
-            avcodec_decode_video2(_videoCodecCtx, _frame, &gotFrame, &packet);
-            if (gotFrame == 0) continue;
+            if (packet.stream_index == _videoStreamIdx) {
+                avcodec_decode_video2(_videoCodecCtx, _frame, &gotFrame, &packet);
+            }
+            av_packet_unref(&packet);
 
-            --count;
+            if (gotFrame) {
+                copyFrame(frame);
+                return true;
+            }
+        }
 
-            if (ignore) continue;
+        return false;
+    }
 
-            sws_scale(
-                _swsContext,
-                _frame->data, _frame->linesize, 0, _videoCodecCtx->height,
-                _frameRgb->data, _frameRgb->linesize);
+private:
+    fs::path _path;
+    AVFormatContext *_formatCtx { nullptr };
+    int _videoStreamIdx { -1 };
+    AVCodecContext *_videoCodecCtx { nullptr };
+    AVFrame *_frame { nullptr };
+    SwsContext *_swsContext { nullptr }; /**< pictures not in YUV 4:2:0 only */
+    AVFrame *_frameYuv { nullptr };
+    uint8_t *_yuvBuffer { nullptr };
 
-            ByteArray data(3ll * _videoCodecCtx->width * _videoCodecCtx->height);
-            for (int y = 0; y < _videoCodecCtx->height; ++y) {
-                int dstIdx = 3 * _videoCodecCtx->width * y;
-                uint8_t *src = _frameRgb->data[0] + static_cast<long long>(y) * _frameRgb->linesize[0];
-                memcpy(&data[dstIdx], src, 3ll * _videoCodecCtx->width);
-            }
+    void deinit() {
+        if (_yuvBuffer) {
+            av_free(_yuvBuffer);
+            _yuvBuffer = nullptr;
+        }
+        if (_frameYuv) {
+            av_frame_free(&_frameYuv);
+        }
+        if (_swsContext) {
+            sws_freeContext(_swsContext);
+            _swsContext = nullptr;
+        }
+        if (_frame) {
+            av_frame_free(&_frame);
+        }
+        if (_videoCodecCtx) {
+            avcodec_close(_videoCodecCtx);
+            avcodec_free_context(&_videoCodecCtx);
+        }
+        if (_formatCtx) {
+            avformat_close_input(&_formatCtx);
+        }
+    }
 
-            auto frame = make_shared<Video::Frame>();
-            frame->data = move(data);
-            _frames.push_back(move(frame));
+    void initConverter() {
+        switch (_videoCodecCtx->pix_fmt) {
+            case AV_PIX_FMT_YUV420P:
+            case AV_PIX_FMT_YUVJ420P:
+            case AV_PIX_FMT_YUVA420P:
+                return;
+            default:
+                break;
         }
+        int width = _videoCodecCtx->width;
+        int height = _videoCodecCtx->height;
+
+        _swsContext = sws_getContext(
+            width, height, _videoCodecCtx->pix_fmt,
+            width, height, AV_PIX_FMT_YUV420P,
+            SWS_BILINEAR,
+            nullptr, nullptr, nullptr);
 
-        av_free_packet(&packet);
+        _frameYuv = av_frame_alloc();
+        _yuvBuffer = static_cast<uint8_t *>(av_malloc(avpicture_get_size(AV_PIX_FMT_YUV420P, width, height)));
+        avpicture_fill(reinterpret_cast<AVPicture *>(_frameYuv), _yuvBuffer, AV_PIX_FMT_YUV420P, width, height);
     }
 
-    void readAudioFrames() {
-        if (!hasAudio()) return;
+    shared_ptr<Video> createVideo() const {
+        AVRational &frameRate = _formatCtx->streams[_videoStreamIdx]->r_frame_rate;
 
-        AVPacket packet;
+        auto video = make_shared<Video>();
+        video->_width = _videoCodecCtx->width;
+        video->_height = _videoCodecCtx->height;
+        video->_fps = frameRate.num / static_cast<float>(frameRate.den);
 
-        while (av_read_frame(_formatCtx, &packet) >= 0) {
-            if (packet.stream_index != _audioStreamIdx) continue;
-
-            avcodec_send_packet(_audioCodecCtx, &packet);
-            avcodec_receive_frame(_audioCodecCtx, _frame);
-
-            int sampleCount = swr_get_out_samples(_swrContext, _frame->nb_samples);
-            int bufSize = av_samples_get_buffer_size(nullptr, 1, sampleCount, AV_SAMPLE_FMT_S16, 1);
-            ByteArray samples(bufSize);
-            uint8_t *samplesPtr = reinterpret_cast<uint8_t *>(&samples[0]);
-
-            swr_convert(
-                _swrContext,
-                &samplesPtr, sampleCount,
-                const_cast<const uint8_t **>(&_frame->extended_data[0]), _frame->nb_samples);
-
-            AudioStream::Frame frame;
-            frame.format = AudioFormat::Mono16;
-            frame.sampleRate = _audioCodecCtx->sample_rate;
-            frame.samples = move(samples);
-            _video->_audio->add(move(frame));
+        int audioStreamIdx = findStream(_formatCtx, AVMEDIA_TYPE_AUDIO);
+        if (audioStreamIdx != -1) {
+            fs::path path(_path);
+            float duration = _formatCtx->duration != AV_NOPTS_VALUE ? 1000.0f * _formatCtx->duration / AV_TIME_BASE : 0.0f;
+            video->_audio = make_shared<AudioStream>([path]() { return make_unique<BinkAudioDecoder>(path); }, duration);
         }
 
-        av_free_packet(&packet);
-
-        seekBeginning();
+        return video;
     }
 
-    void seekBeginning() {
-        int64_t pos = av_rescale_q(0ll, { 1, AV_TIME_BASE }, _formatCtx->streams[_audioStreamIdx]->time_base);
-        av_seek_frame(_formatCtx, _audioStreamIdx, pos, AVSEEK_FLAG_ANY);
+    void copyFrame(Video::Frame &frame) {
+        AVFrame *src = _frame;
+        if (_swsContext) {
+            sws_scale(
+                _swsContext,
+                _frame->data, _frame->linesize, 0, _videoCodecCtx->height,
+                _frameYuv->data, _frameYuv->linesize);
+
+            src = _frameYuv;
+        }
+        int width = _videoCodecCtx->width;
+        int height = _videoCodecCtx->height;
+        int chromaWidth = (width + 1) / 2;
+        int chromaHeight = (height + 1) / 2;
+
+        copyPlane(src->data[0], src->linesize[0], width, height, frame.y);
+        copyPlane(src->data[1], src->linesize[1], chromaWidth, chromaHeight, frame.u);
+        copyPlane(src->data[2], src->linesize[2], chromaWidth, chromaHeight, frame.v);
     }
 };
 
@@ -330,9 +358,8 @@ void BikFile::load() {
     }
 
     auto decoder = make_shared<BinkVideoDecoder>(_path);
-    decoder->load();
 
-    _video = decoder->video();
+    _video = decoder->load();
     _video->setMediaStream(decoder);
     _video->init();
 #endif // REONE_ENABLE_VIDEO
@@ -40,14 +40,20 @@ namespace video {
 void Video::init() {
     if (_inited) return;
 
-    glGenTextures(1, &_textureId);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureId);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glGenTextures(3, _textures);
+
+    for (int i = 0; i < 3; ++i) {
+        int width = i == 0 ? _width : (_width + 1) / 2;
+        int height = i == 0 ? _height : (_height + 1) / 2;
+
+        glBindTexture(GL_TEXTURE_2D, _textures[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
 
     _inited = true;
 }
@@ -55,7 +61,7 @@ void Video::init() {
 void Video::deinit() {
     if (!_inited) return;
 
-    glDeleteTextures(1, &_textureId);
+    glDeleteTextures(3, _textures);
 
     _inited = false;
 }
@@ -64,44 +70,67 @@ void Video::update(float dt) {
     if (_finished) return;
 
     updateFrame(dt);
-    updateFrameTexture();
 }
 
 void Video::updateFrame(float dt) {
     _time += dt;
 
     int frame = static_cast<int>(_fps * _time);
-    _frame = _stream->get(frame);
+    const Frame *nextFrame = _stream->get(frame);
 
-    if (!_frame) {
+    if (!nextFrame) {
         _finished = true;
+        return;
+    }
+    int nextFrameIndex = _stream->currentIndex();
+    if (nextFrameIndex != _frameIndex) {
+        _frame = nextFrame;
+        _frameIndex = nextFrameIndex;
+        updateFrameTextures();
     }
 }
 
-void Video::updateFrameTexture() {
-    if (!_frame) return;
+void Video::updateFrameTextures() {
+    const ByteArray *planes[] = { &_frame->y, &_frame->u, &_frame->v };
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureId);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, _width, _height, 0, GL_RGB, GL_UNSIGNED_BYTE, &_frame->data[0]);
+    // Planes are tightly packed, rows of chroma planes are not 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (int i = 0; i < 3; ++i) {
+        int width = i == 0 ? _width : (_width + 1) / 2;
+        int height = i == 0 ? _height : (_height + 1) / 2;
+
+        glBindTexture(GL_TEXTURE_2D, _textures[i]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, &(*planes[i])[0]);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
 void Video::render() {
-    if (!_inited) return;
+    if (!_inited || !_frame) return;
 
     GlobalUniforms globals;
     globals.projection = glm::ortho(0.0f, 1.0f, 0.0f, 1.0f);
     Shaders::instance().setGlobalUniforms(globals);
 
     LocalUniforms locals;
-    Shaders::instance().activate(ShaderProgram::GUIGUI, locals);
+    Shaders::instance().activate(ShaderProgram::GUIVideo, locals);
 
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureId);
+    glBindTexture(GL_TEXTURE_2D, _textures[0]);
+    glActiveTexture(GL_TEXTURE0 + TextureUniforms::chromaU);
+    glBindTexture(GL_TEXTURE_2D, _textures[1]);
+    glActiveTexture(GL_TEXTURE0 + TextureUniforms::chromaV);
+    glBindTexture(GL_TEXTURE_2D, _textures[2]);
 
     Quad::getDefault().renderTriangles();
 
     glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0 + TextureUniforms::chromaU);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Video::finish() {
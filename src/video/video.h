@@ -37,8 +37,14 @@ class BikFile;
 
 class Video {
 public:
+    /**
+     * Planes of a YUV 4:2:0 picture, chroma planes being half the size of
+     * the luma plane in either dimension.
+     */
     struct Frame {
-        ByteArray data;
+        ByteArray y;
+        ByteArray u;
+        ByteArray v;
     };
 
     void init();
@@ -59,16 +65,17 @@ private:
     int _width { 0 };
     int _height { 0 };
     float _fps { 0.0f };
-    std::shared_ptr<Frame> _frame;
+    const Frame *_frame { nullptr };
+    int _frameIndex { -1 };
     bool _inited { false };
-    uint32_t _textureId { 0 };
+    uint32_t _textures[3] { 0 }; /**< Y, U and V planes */
     float _time { 0.0f };
     bool _finished { false };
     std::shared_ptr<MediaStream<Frame>> _stream;
     std::shared_ptr<audio::AudioStream> _audio;
 
     void updateFrame(float dt);
-    void updateFrameTexture();
+    void updateFrameTextures();
 
     friend class BinkVideoDecoder;
 };
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE audiomixer
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/audio/backend/mixerbackend.h"
+
+using namespace std;
+
+using namespace reone;
+using namespace reone::audio;
+
+static const int kSampleRate = 44100;
+static const float kTolerance = 1e-4f;
+
+static AudioStream::Frame makeMonoFrame(const vector<int16_t> &samples, int sampleRate) {
+    AudioStream::Frame frame;
+    frame.format = AudioFormat::Mono16;
+    frame.sampleRate = sampleRate;
+    frame.samples.resize(samples.size() * sizeof(int16_t));
+    memcpy(&frame.samples[0], &samples[0], frame.samples.size());
+    return frame;
+}
+
+BOOST_AUTO_TEST_CASE(test_mixer_pans_mono_voices_with_constant_power) {
+    MixerBackend mixer(2, kSampleRate, make_unique<NullSink>());
+    mixer.init();
+
+    // Centered, 10 samples, so that both vectorized and scalar paths are used
+    uint32_t centered = mixer.acquireVoice();
+    mixer.setPosition(centered, glm::vec3(0.0f), true);
+    mixer.queue(centered, makeMonoFrame(vector<int16_t>(10, 16384), kSampleRate));
+    mixer.play(centered);
+
+    mixer.mix(10);
+
+    for (int i = 0; i < 10; ++i) {
+        BOOST_TEST(abs(mixer.output()[2 * i + 0] - 0.5f * 0.70710678f) < kTolerance);
+        BOOST_TEST(abs(mixer.output()[2 * i + 1] - 0.5f * 0.70710678f) < kTolerance);
+    }
+    mixer.releaseVoice(centered);
+
+    // Four units to the right of the listener
+    mixer.setListenerPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+    uint32_t positional = mixer.acquireVoice();
+    mixer.setPosition(positional, glm::vec3(5.0f, 0.0f, 0.0f), false);
+    mixer.queue(positional, makeMonoFrame(vector<int16_t>(10, 16384), kSampleRate));
+    mixer.play(positional);
+
+    mixer.mix(10);
+
+    for (int i = 0; i < 10; ++i) {
+        BOOST_TEST(abs(mixer.output()[2 * i + 0]) < kTolerance);
+        BOOST_TEST(abs(mixer.output()[2 * i + 1] - 0.5f / 4.0f) < kTolerance);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_mixer_resamples_and_processes_finished_buffers) {
+    MixerBackend mixer(1, kSampleRate, make_unique<NullSink>());
+    mixer.init();
+
+    uint32_t voice = mixer.acquireVoice();
+    mixer.setPosition(voice, glm::vec3(0.0f), true);
+    mixer.setGain(voice, 1.41421356f);
+    mixer.queue(voice, makeMonoFrame(vector<int16_t> { 0, 8192, 16384, 16384 }, kSampleRate / 2));
+    mixer.queue(voice, makeMonoFrame(vector<int16_t> { 8192 }, kSampleRate));
+    mixer.play(voice);
+
+    // Eight frames of the first buffer, one frame of the second and silence
+    mixer.mix(12);
+
+    vector<float> expected { 0.0f, 0.125f, 0.25f, 0.375f, 0.5f, 0.5f, 0.5f, 0.5f, 0.25f, 0.0f, 0.0f, 0.0f };
+    for (size_t i = 0; i < expected.size(); ++i) {
+        BOOST_TEST(abs(mixer.output()[2 * i + 0] - expected[i]) < kTolerance);
+    }
+    BOOST_TEST(!mixer.isPlaying(voice));
+    BOOST_TEST(mixer.unqueueProcessed(voice) == 2);
+    BOOST_TEST(mixer.getQueuedCount(voice) == 0);
+}
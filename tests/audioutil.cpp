@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE audioutil
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/audio/util.h"
+
+using namespace std;
+
+using namespace reone::audio;
+
+static const int kFracBits = 28;
+static const int32_t kOne = 1 << kFracBits;
+
+BOOST_AUTO_TEST_CASE(test_convert_fixed_stereo_interleaves_and_clips) {
+    // 10 samples per channel, so that both vectorized and scalar paths are used
+    vector<int32_t> left { 0, kOne / 2, -kOne / 2, kOne, -kOne, 2 * kOne, -2 * kOne, 1 << 12, 0, kOne };
+    vector<int32_t> right { kOne - 1, 0, 0, 0, 0, 0, 0, 0, -kOne - 1, -2 * kOne };
+    vector<int16_t> out(2 * left.size());
+
+    convertFixedToPCM16(&left[0], &right[0], static_cast<int>(left.size()), kFracBits, &out[0]);
+
+    vector<int16_t> expected {
+        0, 32767, 16384, 0, -16384, 0, 32767, 0, -32768, 0,
+        32767, 0, -32768, 0, 1, 0, 0, -32768, 32767, -32768
+    };
+    BOOST_TEST(out == expected, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_fixed_mono) {
+    vector<int32_t> samples(11, kOne / 4);
+    vector<int16_t> out(samples.size());
+
+    convertFixedToPCM16(&samples[0], nullptr, static_cast<int>(samples.size()), kFracBits, &out[0]);
+
+    BOOST_TEST(out == vector<int16_t>(samples.size(), 8192), boost::test_tools::per_element());
+}
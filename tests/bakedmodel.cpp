@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE bakedmodel
+
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "glm/gtc/quaternion.hpp"
+
+#include "../src/common/streamutil.h"
+#include "../src/render/model/bakedmodel.h"
+#include "../src/render/model/mdlfile.h"
+#include "../src/render/model/modelnode.h"
+
+using namespace std;
+
+using namespace reone;
+using namespace reone::render;
+using namespace reone::resource;
+
+namespace fs = boost::filesystem;
+
+static const int kValuesPerVertex = 11; // position, bone weights, bone indices
+
+static const uint16_t kNodeHasHeader = 1;
+static const uint16_t kNodeHasMesh = 32;
+static const uint16_t kNodeHasSkin = 64;
+
+static const uint32_t kPositionController = 8;
+static const uint32_t kOrientationController = 20;
+
+static const vector<float> g_vertices {
+    0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+    1.0f, 0.0f, 0.0f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 2.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f
+};
+
+static const vector<uint16_t> g_indices { 0, 1, 2 };
+
+static BakedModelSource makeSource(uint32_t mdlSize, uint32_t mdxSize) {
+    BakedModelSource source;
+    source.mdlSize = mdlSize;
+    source.mdxSize = mdxSize;
+    return move(source);
+}
+
+static shared_ptr<Model> makeModel() {
+    vector<unique_ptr<Animation>> anims;
+    anims.push_back(make_unique<Animation>("pause1", 2.5f, 0.25f, make_shared<ModelNode>(1)));
+
+    auto model = make_shared<Model>("test_model", make_shared<ModelNode>(0), anims);
+    model->setClassification(Model::Classification::Placeable);
+    model->setAnimationScale(0.5f);
+
+    return move(model);
+}
+
+/**
+ * Appends little-endian values to a byte array, as they are laid out in MDL
+ * and MDX files.
+ */
+class MdlWriter {
+public:
+    size_t tell() const {
+        return _data.size();
+    }
+
+    template <class T>
+    size_t put(T value) {
+        size_t offset = _data.size();
+        _data.resize(offset + sizeof(T));
+        memcpy(&_data[offset], &value, sizeof(T));
+        return offset;
+    }
+
+    template <class T>
+    size_t putArray(const vector<T> &values) {
+        size_t offset = _data.size();
+        for (auto &value : values) {
+            put(value);
+        }
+        return offset;
+    }
+
+    void putString(const string &s, int length) {
+        size_t offset = _data.size();
+        _data.resize(offset + length, 0);
+        memcpy(&_data[offset], s.c_str(), min(static_cast<int>(s.size()), length - 1));
+    }
+
+    void putArrayDefinition(size_t offset, uint32_t count) {
+        put(static_cast<uint32_t>(offset));
+        put(count);
+        put(count);
+    }
+
+    void ignore(int count) {
+        _data.resize(_data.size() + count, 0);
+    }
+
+    template <class T>
+    void patch(size_t offset, T value) {
+        memcpy(&_data[offset], &value, sizeof(T));
+    }
+
+    const ByteArray &data() const {
+        return _data;
+    }
+
+private:
+    ByteArray _data;
+};
+
+struct MdlController {
+    uint32_t type { 0 };
+    uint8_t columnCount { 0 };
+    vector<float> times;
+    vector<float> values;
+};
+
+static size_t writeNode(MdlWriter &mdl, uint16_t flags, uint16_t nodeNumber, const vector<size_t> &children, const vector<MdlController> &controllers) {
+    vector<uint32_t> childOffsets;
+    for (size_t child : children) {
+        childOffsets.push_back(static_cast<uint32_t>(child));
+    }
+    size_t childrenOffset = mdl.putArray(childOffsets);
+
+    vector<float> controllerData;
+    size_t keysOffset = mdl.tell();
+    for (auto &controller : controllers) {
+        uint16_t timeIndex = static_cast<uint16_t>(controllerData.size());
+        controllerData.insert(controllerData.end(), controller.times.begin(), controller.times.end());
+        uint16_t dataIndex = static_cast<uint16_t>(controllerData.size());
+        controllerData.insert(controllerData.end(), controller.values.begin(), controller.values.end());
+
+        mdl.put(controller.type);
+        mdl.ignore(2);
+        mdl.put(static_cast<uint16_t>(controller.times.size()));
+        mdl.put(timeIndex);
+        mdl.put(dataIndex);
+        mdl.put(controller.columnCount);
+        mdl.ignore(3);
+    }
+    size_t dataOffset = mdl.putArray(controllerData);
+
+    size_t offset = mdl.tell();
+    mdl.put(flags);
+    mdl.ignore(2);
+    mdl.put(nodeNumber);
+    mdl.ignore(10);
+    mdl.putArray(vector<float> { 1.0f, 2.0f, 3.0f }); // position
+    mdl.putArray(vector<float> { 1.0f, 0.0f, 0.0f, 0.0f }); // orientation
+    mdl.putArrayDefinition(childrenOffset, static_cast<uint32_t>(childOffsets.size()));
+    mdl.putArrayDefinition(keysOffset, static_cast<uint32_t>(controllers.size()));
+    mdl.putArrayDefinition(dataOffset, static_cast<uint32_t>(controllerData.size()));
+
+    return offset;
+}
+
+static size_t writeSkinnedMeshNode(MdlWriter &mdl, uint16_t nodeNumber) {
+    size_t indicesOffset = mdl.putArray(g_indices);
+    size_t indexOffsetsOffset = mdl.put(static_cast<uint32_t>(indicesOffset));
+
+    // Bone 1 is bound to node 0 and bone 0 to node 1
+    size_t bonesOffset = mdl.putArray(vector<float> { 1.0f, 0.0f });
+
+    size_t offset = writeNode(mdl, kNodeHasHeader | kNodeHasMesh | kNodeHasSkin, nodeNumber, vector<size_t>(), vector<MdlController>());
+
+    mdl.ignore(8);
+    mdl.putArrayDefinition(0, 1); // faces
+    mdl.ignore(64);
+    mdl.put<uint32_t>(0); // transparency
+    mdl.putString("diffuse", 32);
+    mdl.putString("lightmap", 32);
+    mdl.ignore(36);
+    mdl.putArrayDefinition(indexOffsetsOffset, 1);
+    mdl.ignore(52);
+    mdl.put<uint32_t>(kValuesPerVertex * sizeof(float));
+    mdl.ignore(4);
+    mdl.put<uint32_t>(0); // vertex coordinates
+    mdl.put<uint32_t>(0xffff); // normals
+    mdl.ignore(4);
+    mdl.put<uint32_t>(0xffff); // texture coordinates
+    mdl.put<uint32_t>(0xffff); // lightmap coordinates
+    mdl.ignore(24);
+    mdl.put(static_cast<uint16_t>(g_vertices.size() / kValuesPerVertex));
+    mdl.put<uint16_t>(0); // texture count
+    mdl.ignore(3);
+    mdl.put<uint8_t>(1); // shadow
+    mdl.ignore(1);
+    mdl.put<uint8_t>(1); // render
+    mdl.ignore(10);
+    mdl.put<uint32_t>(0); // MDX data offset
+    mdl.ignore(4);
+
+    mdl.ignore(12);
+    mdl.put<uint32_t>(3 * sizeof(float)); // bone weights
+    mdl.put<uint32_t>(7 * sizeof(float)); // bone indices
+    mdl.put(static_cast<uint32_t>(bonesOffset));
+    mdl.put<uint32_t>(2);
+
+    return offset;
+}
+
+/**
+ * Writes a model with a skinned mesh, a position controller and an
+ * animation with an orientation controller.
+ */
+static void makeMdl(ByteArray &mdlData, ByteArray &mdxData) {
+    MdlWriter mdl;
+
+    mdl.ignore(8);
+    mdl.putString("test_model", 32);
+    size_t rootNodeOffsetOffset = mdl.put<uint32_t>(0);
+    mdl.put<uint32_t>(2); // node count
+    mdl.ignore(28);
+    mdl.put<uint8_t>(2); // type
+    mdl.ignore(3);
+    mdl.put<uint8_t>(4); // classification: character
+    mdl.ignore(2);
+    mdl.put<uint8_t>(0); // fogged
+    mdl.ignore(4);
+    size_t animArrayOffset = mdl.tell();
+    mdl.putArrayDefinition(0, 0);
+    mdl.ignore(28);
+    mdl.put(1.0f); // radius
+    mdl.put(0.5f); // animation scale
+    mdl.putString("null", 32);
+    mdl.ignore(16);
+    size_t nameArrayOffset = mdl.tell();
+    mdl.putArrayDefinition(0, 0);
+
+    vector<uint32_t> nameOffsets;
+    for (auto &name : vector<string> { "root", "torso" }) {
+        nameOffsets.push_back(static_cast<uint32_t>(mdl.tell()));
+        mdl.putString(name, static_cast<int>(name.size()) + 1);
+    }
+    size_t nameOffsetsOffset = mdl.putArray(nameOffsets);
+
+    MdlController position;
+    position.type = kPositionController;
+    position.columnCount = 3;
+    position.times = { 0.0f, 1.0f };
+    position.values = { 0.0f, 0.0f, 0.0f, 2.0f, 4.0f, 6.0f };
+
+    size_t torsoOffset = writeSkinnedMeshNode(mdl, 1);
+    size_t rootOffset = writeNode(mdl, kNodeHasHeader, 0, vector<size_t> { torsoOffset }, vector<MdlController> { position });
+
+    MdlController orientation;
+    orientation.type = kOrientationController;
+    orientation.columnCount = 4;
+    orientation.times = { 0.0f, 1.0f };
+    orientation.values = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+
+    size_t animRootOffset = writeNode(mdl, kNodeHasHeader, 0, vector<size_t>(), vector<MdlController> { orientation });
+
+    size_t animOffset = mdl.tell();
+    mdl.ignore(8);
+    mdl.putString("pause1", 32);
+    mdl.put(static_cast<uint32_t>(animRootOffset));
+    mdl.ignore(36);
+    mdl.put(2.5f); // length
+    mdl.put(0.25f); // transition time
+    mdl.ignore(48);
+    size_t animOffsetsOffset = mdl.putArray(vector<uint32_t> { static_cast<uint32_t>(animOffset) });
+
+    mdl.patch(rootNodeOffsetOffset, static_cast<uint32_t>(rootOffset));
+    mdl.patch(animArrayOffset, static_cast<uint32_t>(animOffsetsOffset));
+    mdl.patch(animArrayOffset + 4, 1u);
+    mdl.patch(nameArrayOffset, static_cast<uint32_t>(nameOffsetsOffset));
+    mdl.patch(nameArrayOffset + 4, static_cast<uint32_t>(nameOffsets.size()));
+
+    MdlWriter file;
+    file.put<uint32_t>(0);
+    file.put(static_cast<uint32_t>(mdl.data().size()));
+    file.put(static_cast<uint32_t>(g_vertices.size() * sizeof(float)));
+
+    mdlData = file.data();
+    mdlData.insert(mdlData.end(), mdl.data().begin(), mdl.data().end());
+
+    MdlWriter mdx;
+    mdx.putArray(g_vertices);
+    mdxData = mdx.data();
+}
+
+static vector<char> readFile(const fs::path &path) {
+    fs::ifstream in(path, ios::binary);
+    return vector<char>(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+struct TempDirectory {
+    fs::path path;
+
+    TempDirectory() : path(fs::temp_directory_path() / fs::unique_path()) {
+        fs::create_directories(path);
+    }
+
+    ~TempDirectory() {
+        fs::remove_all(path);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(test_baked_model_round_trip) {
+    TempDirectory dir;
+    fs::path path(dir.path / "test_model.rbm");
+    BakedModelSource source(makeSource(100, 200));
+
+    BakedModelWriter(GameVersion::KotOR, source).save(*makeModel(), path);
+
+    BakedModelReader reader(GameVersion::KotOR, false);
+    shared_ptr<Model> model(reader.load(path, source));
+
+    BOOST_TEST_REQUIRE(model);
+    BOOST_TEST(model->name() == "test_model");
+    BOOST_TEST((model->classification() == Model::Classification::Placeable));
+    BOOST_TEST(model->animationScale() == 0.5f);
+    BOOST_TEST(model->rootNode().index() == 0);
+    BOOST_TEST(model->rootNode().children().empty());
+
+    Animation *anim = model->getAnimation("pause1");
+    BOOST_TEST_REQUIRE(anim);
+    BOOST_TEST(anim->length() == 2.5f);
+    BOOST_TEST(anim->transitionTime() == 0.25f);
+    BOOST_TEST(anim->rootNode()->index() == 1);
+
+    // Baking the loaded model again must yield an identical file, i.e. the
+    // reader must not drop anything the writer stores
+    fs::path rebakedPath(dir.path / "rebaked.rbm");
+    BakedModelWriter(GameVersion::KotOR, source).save(*model, rebakedPath);
+
+    BOOST_TEST((readFile(path) == readFile(rebakedPath)));
+}
+
+BOOST_AUTO_TEST_CASE(test_baked_model_keeps_meshes_skins_and_keyframes) {
+    ByteArray mdlData, mdxData;
+    makeMdl(mdlData, mdxData);
+
+    MdlFile mdl(GameVersion::KotOR, false);
+    mdl.load(wrap(mdlData), wrap(mdxData));
+    BOOST_TEST_REQUIRE(mdl.model());
+
+    TempDirectory dir;
+    fs::path path(dir.path / "test_model.rbm");
+    BakedModelSource source(makeSource(static_cast<uint32_t>(mdlData.size()), static_cast<uint32_t>(mdxData.size())));
+
+    BakedModelWriter(GameVersion::KotOR, source).save(*mdl.model(), path);
+
+    shared_ptr<Model> model(BakedModelReader(GameVersion::KotOR, false).load(path, source));
+    BOOST_TEST_REQUIRE(model);
+    BOOST_TEST((model->classification() == Model::Classification::Character));
+
+    // Mesh
+
+    shared_ptr<ModelNode> torso(model->findNodeByName("torso"));
+    BOOST_TEST_REQUIRE(torso);
+    BOOST_TEST(torso->index() == 1);
+
+    shared_ptr<ModelMesh> mesh(torso->mesh());
+    BOOST_TEST_REQUIRE(mesh);
+    BOOST_TEST(mesh->shouldRender());
+    BOOST_TEST(mesh->shouldCastShadows());
+    BOOST_TEST(mesh->diffuseName() == "diffuse");
+    BOOST_TEST(mesh->lightmapName() == "lightmap");
+    BOOST_TEST((mesh->aabb().min() == glm::vec3(0.0f)));
+    BOOST_TEST((mesh->aabb().max() == glm::vec3(1.0f, 2.0f, 0.0f)));
+    BOOST_TEST((vector<float>(mesh->vertexData(), mesh->vertexData() + mesh->vertexValueCount()) == g_vertices));
+    BOOST_TEST((vector<uint16_t>(mesh->indexData(), mesh->indexData() + mesh->indexCount()) == g_indices));
+
+    // Skin
+
+    shared_ptr<ModelNode::Skin> skin(torso->skin());
+    BOOST_TEST_REQUIRE(skin);
+    BOOST_TEST(skin->nodeIdxByBoneIdx.size() == 2u);
+    BOOST_TEST(skin->nodeIdxByBoneIdx.at(0) == 1);
+    BOOST_TEST(skin->nodeIdxByBoneIdx.at(1) == 0);
+
+    // Keyframes
+
+    glm::vec3 position(0.0f);
+    BOOST_TEST(model->rootNode().getPosition(0.5f, position));
+    BOOST_TEST((position == glm::vec3(1.0f, 2.0f, 3.0f)));
+    BOOST_TEST(!torso->getPosition(0.5f, position));
+
+    Animation *anim = model->getAnimation("pause1");
+    BOOST_TEST_REQUIRE(anim);
+    glm::quat orientation;
+    BOOST_TEST(anim->rootNode()->getOrientation(1.0f, orientation));
+    BOOST_TEST(glm::abs(glm::dot(orientation, glm::quat(0.0f, 0.0f, 1.0f, 0.0f))) > 0.9999f);
+
+    // Models loaded from the baked file and from the MDL must bake into
+    // identical files
+    fs::path rebakedPath(dir.path / "rebaked.rbm");
+    BakedModelWriter(GameVersion::KotOR, source).save(*model, rebakedPath);
+
+    BOOST_TEST((readFile(path) == readFile(rebakedPath)));
+}
+
+BOOST_AUTO_TEST_CASE(test_baked_model_is_rejected_if_stale) {
+    TempDirectory dir;
+    fs::path path(dir.path / "test_model.rbm");
+
+    BakedModelWriter(GameVersion::KotOR, makeSource(100, 200)).save(*makeModel(), path);
+
+    BOOST_TEST(!BakedModelReader(GameVersion::KotOR, false).load(path, makeSource(101, 200)));
+    BOOST_TEST(!BakedModelReader(GameVersion::KotOR, false).load(path, makeSource(100, 201)));
+    BOOST_TEST(!BakedModelReader(GameVersion::TheSithLords, false).load(path, makeSource(100, 200)));
+}
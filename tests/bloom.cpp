@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE bloom
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "GL/glew.h"
+
+#include "SDL2/SDL.h"
+
+#include "glm/ext.hpp"
+
+#include "../src/render/bloom.h"
+#include "../src/render/framebuffer.h"
+#include "../src/render/mesh/quad.h"
+#include "../src/render/shaders.h"
+
+using namespace std;
+
+using namespace reone::render;
+
+static const int kImageWidth = 160;
+static const int kImageHeight = 96;
+
+/**
+ * Creates a hidden window with a GL context, preferring software rendering
+ * and the offscreen video driver, so that the test depends on neither the GPU
+ * nor a display.
+ */
+struct GLContext {
+    SDL_Window *window { nullptr };
+    SDL_GLContext context { nullptr };
+    string error;
+
+    GLContext() {
+#ifndef _WIN32
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 0);
+#endif
+        SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+
+        if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+            error = SDL_GetError();
+            return;
+        }
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+
+        window = SDL_CreateWindow("test", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, kImageWidth, kImageHeight, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+        if (!window) {
+            error = SDL_GetError();
+            return;
+        }
+        context = SDL_GL_CreateContext(window);
+        if (!context) {
+            error = SDL_GetError();
+            return;
+        }
+
+        glewInit();
+        Shaders::instance().initGL();
+        Quad::getDefault().initGL();
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glViewport(0, 0, kImageWidth, kImageHeight);
+
+        GlobalUniforms globals;
+        globals.projection = glm::ortho(0.0f, static_cast<float>(kImageWidth), static_cast<float>(kImageHeight), 0.0f);
+        Shaders::instance().setGlobalUniforms(globals);
+    }
+
+    ~GLContext() {
+        if (context) {
+            Quad::getDefault().deinitGL();
+            Shaders::instance().deinitGL();
+            SDL_GL_DeleteContext(context);
+        }
+        if (window) {
+            SDL_DestroyWindow(window);
+        }
+        SDL_Quit();
+    }
+};
+
+static GLContext &getGLContext() {
+    static GLContext gl;
+    return gl;
+}
+
+/**
+ * Reports the test case as skipped, rather than passed, if there is no GL
+ * context to render with.
+ */
+static boost::test_tools::assertion_result isGLAvailable(boost::unit_test::test_unit_id) {
+    GLContext &gl = getGLContext();
+
+    boost::test_tools::assertion_result result(gl.context != nullptr);
+    result.message() << "GL context is not available: " << gl.error;
+
+    return result;
+}
+
+static void fillBrightPass(const Framebuffer &framebuffer) {
+    vector<uint8_t> pixels(4 * kImageWidth * kImageHeight, 0);
+
+    auto fill = [&pixels](int x0, int y0, int x1, int y1, uint8_t value) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                uint8_t *pixel = &pixels[4 * (y * kImageWidth + x)];
+                pixel[0] = pixel[1] = pixel[2] = value;
+            }
+        }
+    };
+    fill(40, 40, 56, 56, 255);
+    fill(20, 80, 100, 84, 204);
+    fill(10, 10, 11, 11, 255);
+
+    for (int i = 3; i < static_cast<int>(pixels.size()); i += 4) {
+        pixels[i] = 255;
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    framebuffer.bindColorBuffer(0);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, kImageWidth, kImageHeight, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    framebuffer.unbindColorBuffer();
+}
+
+static void drawFullscreen(ShaderProgram program, const glm::vec2 &direction) {
+    glm::mat4 transform(1.0f);
+    transform = glm::scale(transform, glm::vec3(kImageWidth, kImageHeight, 1.0f));
+
+    LocalUniforms locals;
+    locals.general.blurEnabled = true;
+    locals.general.model = move(transform);
+    locals.general.blurResolution = glm::vec2(kImageWidth, kImageHeight);
+    locals.general.blurDirection = direction;
+
+    Shaders::instance().activate(program, locals);
+    Quad::getDefault().renderTriangles();
+}
+
+static vector<uint8_t> readPixels(const Framebuffer &framebuffer) {
+    vector<uint8_t> pixels(4 * kImageWidth * kImageHeight);
+
+    framebuffer.bind();
+    glReadPixels(0, 0, kImageWidth, kImageHeight, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    framebuffer.unbind();
+
+    return pixels;
+}
+
+BOOST_AUTO_TEST_CASE(test_bloom_chain_matches_full_resolution_blur, *boost::unit_test::precondition(isGLAvailable)) {
+    Framebuffer brightPass(kImageWidth, kImageHeight);
+    Framebuffer horizontalBlur(kImageWidth, kImageHeight);
+    Framebuffer expected(kImageWidth, kImageHeight);
+    Framebuffer actual(kImageWidth, kImageHeight);
+    brightPass.init();
+    horizontalBlur.init();
+    expected.init();
+    actual.init();
+
+    fillBrightPass(brightPass);
+
+    // Separable Gaussian blur at full resolution, as it was done before the bloom chain
+
+    glActiveTexture(GL_TEXTURE0);
+    horizontalBlur.bind();
+    brightPass.bindColorBuffer(0);
+    drawFullscreen(ShaderProgram::GUIBlur, glm::vec2(1.0f, 0.0f));
+
+    expected.bind();
+    horizontalBlur.bindColorBuffer(0);
+    drawFullscreen(ShaderProgram::GUIBlur, glm::vec2(0.0f, 1.0f));
+
+    // Bloom chain, upscaled to full resolution with a single bilinear tap
+
+    BloomChain bloom(kImageWidth, kImageHeight, 4, BloomQuality::High);
+    bloom.init();
+    bloom.apply(brightPass, 0);
+
+    actual.bind();
+    glActiveTexture(GL_TEXTURE0);
+    bloom.bindResult();
+    drawFullscreen(ShaderProgram::GUIBoxBlur, glm::vec2(0.0f));
+    bloom.unbindResult();
+    actual.unbind();
+
+    vector<uint8_t> expectedPixels(readPixels(expected));
+    vector<uint8_t> actualPixels(readPixels(actual));
+
+    double totalDiff = 0.0;
+    int maxDiff = 0;
+
+    for (size_t i = 0; i < expectedPixels.size(); i += 4) {
+        int diff = abs(static_cast<int>(expectedPixels[i]) - static_cast<int>(actualPixels[i]));
+        totalDiff += diff;
+        maxDiff = max(maxDiff, diff);
+    }
+    double meanDiff = totalDiff / (kImageWidth * kImageHeight);
+
+    BOOST_TEST(meanDiff < 3.0);
+    BOOST_TEST(maxDiff < 40);
+
+    bloom.deinit();
+}
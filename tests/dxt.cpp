@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE dxt
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/render/image/dxt.h"
+
+using namespace std;
+
+using namespace reone::render;
+
+static uint32_t getPixel(const vector<uint8_t> &pixels, int width, int x, int y) {
+    const uint8_t *p = &pixels[4 * (y * width + x)];
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+BOOST_AUTO_TEST_CASE(test_dxt1_four_color_block) {
+    // Red and blue endpoints, every row uses indices 0, 1, 2, 3
+    vector<uint8_t> data { 0x00, 0xf8, 0x1f, 0x00, 0xe4, 0xe4, 0xe4, 0xe4 };
+    vector<uint8_t> pixels(4 * 4 * 4);
+
+    decompressDXT1(&data[0], 4, 4, &pixels[0]);
+
+    for (int y = 0; y < 4; ++y) {
+        BOOST_TEST(getPixel(pixels, 4, 0, y) == 0xff0000ff);
+        BOOST_TEST(getPixel(pixels, 4, 1, y) == 0xffff0000);
+        BOOST_TEST(getPixel(pixels, 4, 2, y) == 0xff5500aa);
+        BOOST_TEST(getPixel(pixels, 4, 3, y) == 0xffaa0055);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_dxt1_transparent_block) {
+    // First endpoint is not greater than the second, index 3 is transparent black
+    vector<uint8_t> data { 0x1f, 0x00, 0x00, 0xf8, 0xff, 0xff, 0xff, 0xff };
+    vector<uint8_t> pixels(4 * 4 * 4);
+
+    decompressDXT1(&data[0], 4, 4, &pixels[0]);
+
+    BOOST_TEST(getPixel(pixels, 4, 0, 0) == 0x00000000);
+    BOOST_TEST(getPixel(pixels, 4, 3, 3) == 0x00000000);
+}
+
+BOOST_AUTO_TEST_CASE(test_dxt5_alpha_and_clipping) {
+    // Alpha endpoints 255 and 0, first texel uses index 0, the rest use index 1.
+    // Color block is solid white. Destination is 2x2, so the block is clipped.
+    vector<uint8_t> data {
+        0xff, 0x00, 0x48, 0x92, 0x24, 0x49, 0x92, 0x24,
+        0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00
+    };
+    vector<uint8_t> pixels(4 * 2 * 2);
+
+    decompressDXT5(&data[0], 2, 2, &pixels[0]);
+
+    BOOST_TEST(getPixel(pixels, 2, 0, 0) == 0xffffffff);
+    BOOST_TEST(getPixel(pixels, 2, 1, 0) == 0x00ffffff);
+    BOOST_TEST(getPixel(pixels, 2, 0, 1) == 0x00ffffff);
+    BOOST_TEST(getPixel(pixels, 2, 1, 1) == 0x00ffffff);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE interest
+
+#include <algorithm>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/mp/interest.h"
+
+using namespace std;
+
+using namespace reone::mp;
+using namespace reone::resource;
+
+static InterestObject makeObject(uint32_t id, const glm::vec3 &position, int room) {
+    InterestObject object;
+    object.id = id;
+    object.position = position;
+    object.room = room;
+    return move(object);
+}
+
+static vector<RelevantObject> getRelevantObjects(const InterestManager &interest, const glm::vec3 &position, int room) {
+    Viewpoint viewpoint;
+    viewpoint.position = position;
+    viewpoint.room = room;
+
+    vector<RelevantObject> relevant;
+    interest.getRelevantObjects(viewpoint, relevant);
+    sort(relevant.begin(), relevant.end(), [](auto &left, auto &right) { return left.index < right.index; });
+
+    return move(relevant);
+}
+
+BOOST_AUTO_TEST_CASE(test_interest_tiers_by_distance_and_room_visibility) {
+    Visibility visibility;
+    visibility.insert(make_pair("room1", "room2"));
+
+    InterestManager interest;
+    interest.setRooms({ "room1", "room2", "room3" }, visibility);
+
+    interest.update({
+        makeObject(1, glm::vec3(4.0f, 0.0f, 0.0f), 0),
+        makeObject(2, glm::vec3(24.0f, 0.0f, 0.0f), 1),
+        makeObject(3, glm::vec3(0.0f, -48.0f, 0.0f), -1),
+        makeObject(4, glm::vec3(20.0f, 0.0f, 0.0f), 2),
+        makeObject(5, glm::vec3(10.0f, 10.0f, 0.0f), 2),
+        makeObject(6, glm::vec3(200.0f, 0.0f, 0.0f), 0)
+    });
+
+    vector<RelevantObject> relevant(getRelevantObjects(interest, glm::vec3(0.0f), interest.getRoomIndex("room1")));
+
+    // Object 4 is in a room that is not visible, object 6 is too far
+    BOOST_TEST(relevant.size() == 4ull);
+    BOOST_TEST(relevant[0].index == 0);
+    BOOST_TEST((relevant[0].tier == RelevancyTier::Near));
+    BOOST_TEST(relevant[1].index == 1);
+    BOOST_TEST((relevant[1].tier == RelevancyTier::Mid));
+    BOOST_TEST(relevant[2].index == 2);
+    BOOST_TEST((relevant[2].tier == RelevancyTier::Far));
+    BOOST_TEST(relevant[3].index == 4);
+    BOOST_TEST((relevant[3].tier == RelevancyTier::Near));
+}
+
+BOOST_AUTO_TEST_CASE(test_interest_spreads_updates_between_ticks) {
+    int midUpdates = 0;
+    int farUpdates = 0;
+
+    for (uint32_t tick = 0; tick < 8; ++tick) {
+        BOOST_TEST(InterestManager::isUpdateDue(RelevancyTier::Near, tick, 7));
+        BOOST_TEST(!InterestManager::isUpdateDue(RelevancyTier::None, tick, 7));
+        if (InterestManager::isUpdateDue(RelevancyTier::Mid, tick, 7)) ++midUpdates;
+        if (InterestManager::isUpdateDue(RelevancyTier::Far, tick, 7)) ++farUpdates;
+    }
+
+    BOOST_TEST(midUpdates == 4);
+    BOOST_TEST(farUpdates == 2);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE jobgraph
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/common/jobgraph.h"
+
+using namespace std;
+
+using namespace reone;
+
+BOOST_AUTO_TEST_CASE(test_job_graph_respects_dependencies) {
+    static const int kWorkerJobCount = 64;
+
+    JobGraph graph;
+    thread::id mainThreadId(this_thread::get_id());
+    atomic_int workersDone { 0 };
+    vector<int> mainOrder;
+    bool mainOnCallingThread = true;
+    int workersDoneBeforeMain = -1;
+
+    vector<int> workerJobs;
+    for (int i = 0; i < kWorkerJobCount; ++i) {
+        workerJobs.push_back(graph.add([&workersDone]() {
+            this_thread::sleep_for(chrono::microseconds(100));
+            ++workersDone;
+        }));
+    }
+    graph.add([&]() {
+        mainOnCallingThread &= this_thread::get_id() == mainThreadId;
+        mainOrder.push_back(0);
+    }, vector<int>(), true);
+    graph.add([&]() {
+        mainOnCallingThread &= this_thread::get_id() == mainThreadId;
+        workersDoneBeforeMain = workersDone;
+        mainOrder.push_back(1);
+    }, workerJobs, true);
+
+    int lastCompleted = -1;
+    bool monotonic = true;
+
+    graph.run([&](int completed, int total) {
+        monotonic &= completed > lastCompleted && total == kWorkerJobCount + 2;
+        lastCompleted = completed;
+    });
+
+    BOOST_TEST(mainOnCallingThread);
+    BOOST_TEST((mainOrder == vector<int> { 0, 1 }));
+    BOOST_TEST(workersDoneBeforeMain == kWorkerJobCount);
+    BOOST_TEST(monotonic);
+    BOOST_TEST(lastCompleted == kWorkerJobCount + 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_job_graph_rethrows_and_skips_dependents) {
+    JobGraph graph;
+    bool dependentRun = false;
+
+    int failing = graph.add([]() { throw runtime_error("failed"); });
+    graph.add([&dependentRun]() { dependentRun = true; }, { failing }, true);
+
+    BOOST_CHECK_THROW(graph.run(), runtime_error);
+    BOOST_TEST(!dependentRun);
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE lightgrid
+
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "glm/ext.hpp"
+
+#include "../src/render/lightgrid.h"
+
+using namespace std;
+
+using namespace reone::render;
+
+static glm::mat4 getProjection() {
+    return glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+}
+
+static GridLight makeLight(const glm::vec3 &position, float radius) {
+    GridLight light;
+    light.position = position;
+    light.radius = radius;
+    return light;
+}
+
+BOOST_AUTO_TEST_CASE(test_light_affects_only_nearby_clusters) {
+    LightGrid grid;
+    grid.build(glm::mat4(1.0f), getProjection(), vector<GridLight> { makeLight(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f) });
+
+    vector<uint32_t> lights(grid.getClusterLights(grid.getClusterIndex(glm::vec3(0.0f, 0.0f, -10.0f))));
+    BOOST_TEST((lights == vector<uint32_t> { 0 }));
+    BOOST_TEST(grid.getClusterLights(grid.getClusterIndex(glm::vec3(0.0f, 0.0f, -100.0f))).empty());
+    BOOST_TEST(grid.getClusterLights(grid.getClusterIndex(glm::vec3(4.0f, 0.0f, -5.0f))).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_lights_beyond_cluster_capacity_are_dropped) {
+    vector<GridLight> lights;
+    for (int i = 0; i < kMaxLightsPerCluster + 8; ++i) {
+        lights.push_back(makeLight(glm::vec3(0.0f, 0.0f, -10.0f), 2.0f));
+    }
+    LightGrid grid;
+    grid.build(glm::mat4(1.0f), getProjection(), lights);
+
+    vector<uint32_t> clusterLights(grid.getClusterLights(grid.getClusterIndex(glm::vec3(0.0f, 0.0f, -10.0f))));
+    BOOST_TEST(clusterLights.size() == kMaxLightsPerCluster);
+    BOOST_TEST(clusterLights.front() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_view_transform_is_applied_to_lights) {
+    glm::mat4 view(glm::lookAt(glm::vec3(0.0f, -10.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+
+    LightGrid grid;
+    grid.build(view, getProjection(), vector<GridLight> { makeLight(glm::vec3(0.0f), 0.5f) });
+
+    glm::vec3 viewPosition(view * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    BOOST_TEST(grid.getClusterLights(grid.getClusterIndex(viewPosition)).size() == 1);
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE mediastream
+
+#include <chrono>
+#include <thread>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/common/mediastream.h"
+
+using namespace std;
+
+using namespace reone;
+
+struct TestFrame {
+    int value { -1 };
+};
+
+class TestMediaStream : public MediaStream<TestFrame> {
+public:
+    TestMediaStream(int frameCount) : _frameCount(frameCount) {
+        start();
+    }
+
+    ~TestMediaStream() {
+        stop();
+    }
+
+protected:
+    bool decodeFrame(TestFrame &frame) override {
+        if (_nextValue == _frameCount) return false;
+
+        frame.value = _nextValue++;
+        return true;
+    }
+
+private:
+    int _frameCount { 0 };
+    int _nextValue { 0 };
+};
+
+BOOST_AUTO_TEST_CASE(test_media_stream_returns_requested_frames_and_ends) {
+    TestMediaStream stream(20);
+
+    for (int i = 0; i < 20; ++i) {
+        // Frames must be decoded ahead of time, rather than on request
+        this_thread::sleep_for(chrono::milliseconds(1));
+
+        const TestFrame *frame = stream.get(i);
+        BOOST_TEST_REQUIRE(frame);
+        BOOST_TEST(frame->value == i);
+    }
+    BOOST_TEST(!stream.get(20));
+}
+
+BOOST_AUTO_TEST_CASE(test_media_stream_skips_frames_and_recycles_them) {
+    static const int kFrameCount = 10 * MediaStream<TestFrame>::kQueueSize;
+
+    TestMediaStream stream(kFrameCount);
+
+    for (int i = 0; i < kFrameCount; i += 3) {
+        const TestFrame *frame = stream.get(i);
+        BOOST_TEST_REQUIRE(frame);
+        BOOST_TEST(frame->value <= i);
+        BOOST_TEST(stream.currentIndex() == frame->value);
+    }
+
+    // Decoding stalls unless skipped frames are returned to the pool
+    const TestFrame *last = nullptr;
+    for (int i = 0; i < 1000 && (!last || last->value < kFrameCount - 1); ++i) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+        last = stream.get(kFrameCount - 1);
+    }
+    BOOST_TEST_REQUIRE(last);
+    BOOST_TEST(last->value == kFrameCount - 1);
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE mpscqueue
+
+#include <thread>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/common/mpscqueue.h"
+
+using namespace std;
+
+using namespace reone;
+
+struct Node {
+    atomic<Node *> next { nullptr };
+    int producer { 0 };
+    int value { 0 };
+};
+
+BOOST_AUTO_TEST_CASE(test_mpsc_queue_preserves_order_per_producer) {
+    static const int kProducerCount = 4;
+    static const int kNodesPerProducer = 10000;
+
+    vector<Node> nodes(kProducerCount * kNodesPerProducer);
+    MpscQueue<Node> queue;
+
+    vector<thread> producers;
+    for (int p = 0; p < kProducerCount; ++p) {
+        producers.push_back(thread([&, p]() {
+            for (int i = 0; i < kNodesPerProducer; ++i) {
+                Node &node = nodes[p * kNodesPerProducer + i];
+                node.producer = p;
+                node.value = i;
+                queue.push(&node);
+            }
+        }));
+    }
+
+    vector<int> expected(kProducerCount, 0);
+    int popped = 0;
+    bool ordered = true;
+
+    while (popped < kProducerCount * kNodesPerProducer) {
+        Node *node = queue.pop();
+        if (!node) {
+            this_thread::yield();
+            continue;
+        }
+        ordered &= node->value == expected[node->producer];
+        expected[node->producer] = node->value + 1;
+        ++popped;
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    BOOST_TEST(ordered);
+    BOOST_TEST(queue.empty());
+    BOOST_TEST(!queue.pop());
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE objectfactory
+
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/game/game.h"
+#include "../src/game/object/objectfactory.h"
+
+using namespace std;
+
+using namespace reone;
+using namespace reone::game;
+
+namespace fs = boost::filesystem;
+
+/**
+ * Creates objects in the same order as loading a module does: the module,
+ * the area, then objects of the area and their items.
+ *
+ * @return IDs of the created objects
+ */
+static vector<uint32_t> loadModuleObjects(ObjectFactory &factory) {
+    vector<uint32_t> ids;
+    ids.push_back(factory.newModule()->id());
+    ids.push_back(factory.newArea()->id());
+
+    unique_ptr<Creature> creature(factory.newCreature());
+    ids.push_back(creature->id());
+    ids.push_back(factory.newItem(creature.get())->id());
+
+    unique_ptr<Placeable> placeable(factory.newPlaceable());
+    ids.push_back(placeable->id());
+    ids.push_back(factory.newItem(placeable.get())->id());
+
+    ids.push_back(factory.newDoor()->id());
+    ids.push_back(factory.newWaypoint()->id());
+    ids.push_back(factory.newTrigger()->id());
+    ids.push_back(factory.newSound()->id());
+    ids.push_back(factory.newCamera()->id());
+
+    return move(ids);
+}
+
+BOOST_AUTO_TEST_CASE(test_module_object_ids_do_not_depend_on_party) {
+    Options opts;
+    Game server(fs::temp_directory_path(), opts);
+    Game client(fs::temp_directory_path(), opts);
+
+    // A client creates its party before loading a module, whereas a dedicated
+    // server has no party
+    vector<unique_ptr<Creature>> party;
+    for (int i = 0; i < 2; ++i) {
+        unique_ptr<Creature> member(client.objectFactory().newPartyMember());
+        unique_ptr<Item> weapon(client.objectFactory().newItem(member.get()));
+        unique_ptr<Item> armor(client.objectFactory().newItem(member.get()));
+
+        BOOST_TEST(ObjectFactory::isPartyObjectId(member->id()));
+        BOOST_TEST(ObjectFactory::isPartyObjectId(weapon->id()));
+        BOOST_TEST(ObjectFactory::isPartyObjectId(armor->id()));
+
+        party.push_back(move(member));
+    }
+
+    vector<uint32_t> serverIds(loadModuleObjects(server.objectFactory()));
+    vector<uint32_t> clientIds(loadModuleObjects(client.objectFactory()));
+
+    BOOST_TEST(serverIds == clientIds, boost::test_tools::per_element());
+
+    for (uint32_t id : clientIds) {
+        BOOST_TEST(!ObjectFactory::isPartyObjectId(id));
+        for (auto &member : party) {
+            BOOST_TEST(id != member->id());
+        }
+    }
+}
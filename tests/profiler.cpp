@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE profiler
+
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/common/profiler.h"
+
+using namespace std;
+
+using namespace reone;
+
+BOOST_AUTO_TEST_CASE(test_profiler_aggregates_nested_zones_per_thread) {
+    Profiler &profiler = Profiler::instance();
+    profiler.setThreadName("Main");
+    {
+        ProfilerZone outer("outer");
+        ProfilerZone inner("inner");
+    }
+    thread worker([&profiler]() {
+        profiler.setThreadName("Worker");
+        ProfilerZone zone("job");
+    });
+    worker.join();
+
+    profiler.endFrame();
+    vector<ProfilerZoneStats> stats(profiler.getZoneStats());
+
+    BOOST_TEST((stats.size() == 3ll));
+    BOOST_TEST((stats[0].thread == "Main"));
+    BOOST_TEST((stats[0].name == "outer"));
+    BOOST_TEST(stats[0].depth == 0);
+    BOOST_TEST((stats[1].name == "inner"));
+    BOOST_TEST(stats[1].depth == 1);
+    BOOST_TEST(stats[1].time <= stats[0].time);
+    BOOST_TEST((stats[2].thread == "Worker"));
+    BOOST_TEST((stats[2].name == "job"));
+}
+
+BOOST_AUTO_TEST_CASE(test_profiler_exports_chrome_trace) {
+    Profiler &profiler = Profiler::instance();
+    profiler.startTrace("profiler_trace.json", 1);
+    {
+        ProfilerZone zone("traced");
+    }
+    profiler.endFrame();
+
+    BOOST_TEST(!profiler.isTracing());
+
+    ifstream json("profiler_trace.json");
+    string contents((istreambuf_iterator<char>(json)), istreambuf_iterator<char>());
+
+    BOOST_TEST((contents.find("\"traceEvents\"") != string::npos));
+    BOOST_TEST((contents.find("{\"name\":\"traced\",\"ph\":\"X\",\"pid\":1,\"tid\":0") != string::npos));
+    BOOST_TEST((contents.find("\"args\":{\"name\":\"Worker\"}") != string::npos));
+}
+
+BOOST_AUTO_TEST_CASE(test_profiler_drops_overwritten_events) {
+    Profiler &profiler = Profiler::instance();
+    for (int i = 0; i < 2 * kProfilerRingSize; ++i) {
+        ProfilerZone zone("spam");
+    }
+    profiler.endFrame();
+
+    for (auto &stats : profiler.getZoneStats()) {
+        if (stats.name == "spam") {
+            // Smoothed call count after a single frame of kProfilerRingSize - 1 events
+            BOOST_TEST(stats.calls <= 0.1f * kProfilerRingSize);
+            BOOST_TEST(stats.calls >= 0.1f * (kProfilerRingSize - 1));
+        }
+    }
+}
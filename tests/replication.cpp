@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE replication
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "glm/gtc/constants.hpp"
+
+#include "../src/mp/replication.h"
+
+using namespace std;
+
+using namespace reone;
+using namespace reone::mp;
+
+static WorldSnapshot makeSnapshot(uint32_t tick, int objectCount) {
+    WorldSnapshot snapshot;
+    snapshot.tick = tick;
+    for (int i = 0; i < objectCount; ++i) {
+        ObjectState state;
+        state.id = 2 * i + 1;
+        state.position[0] = quantizePosition(i * 1.5f);
+        state.position[1] = quantizePosition(-i * 0.25f);
+        state.position[2] = quantizePosition(0.1f);
+        state.facing = quantizeFacing(0.5f * i);
+        state.animation = "pause1";
+        state.hitPoints = 10 + i;
+        snapshot.objects.push_back(move(state));
+    }
+    return move(snapshot);
+}
+
+static WorldSnapshot roundTrip(const WorldSnapshot &baseline, const WorldSnapshot &snapshot, size_t &bytes) {
+    BitWriter writer;
+    encodeSnapshotDelta(baseline, snapshot, writer);
+
+    ByteArray data;
+    writer.appendTo(data);
+    bytes = data.size();
+
+    BitReader reader(data.data(), data.size());
+    return decodeSnapshotDelta(baseline, snapshot.tick, reader);
+}
+
+BOOST_AUTO_TEST_CASE(test_bitstream_round_trip) {
+    BitWriter writer;
+    writer.putBits(5, 3);
+    writer.putBool(true);
+    writer.putVarUint(1000);
+    writer.putVarInt(-70000);
+    writer.putString("walk");
+    writer.putBits(0xdeadbeef, 32);
+
+    ByteArray data;
+    writer.appendTo(data);
+
+    BitReader reader(data.data(), data.size());
+    BOOST_TEST(reader.getBits(3) == 5u);
+    BOOST_TEST(reader.getBool());
+    BOOST_TEST(reader.getVarUint() == 1000u);
+    BOOST_TEST(reader.getVarInt() == -70000);
+    BOOST_TEST(reader.getString() == "walk");
+    BOOST_TEST(reader.getBits(32) == 0xdeadbeefu);
+    BOOST_CHECK_THROW(reader.getBits(8), out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(test_snapshot_delta_round_trip) {
+    WorldSnapshot baseline(makeSnapshot(1, 50));
+    WorldSnapshot snapshot(makeSnapshot(2, 50));
+
+    // Move one object, kill another, remove a third and add a new one
+    snapshot.objects[3].position[0] += quantizePosition(0.2f);
+    snapshot.objects[7].hitPoints = 0;
+    snapshot.objects[7].animation = "dead";
+    snapshot.objects.erase(snapshot.objects.begin() + 10);
+
+    ObjectState added;
+    added.id = 1000;
+    added.position[2] = quantizePosition(-3.0f);
+    snapshot.objects.push_back(added);
+
+    size_t bytes = 0;
+    WorldSnapshot decoded(roundTrip(baseline, snapshot, bytes));
+
+    BOOST_TEST(decoded.tick == 2u);
+    BOOST_TEST(decoded.objects.size() == snapshot.objects.size());
+    for (size_t i = 0; i < snapshot.objects.size(); ++i) {
+        BOOST_TEST((decoded.objects[i] == snapshot.objects[i]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_snapshot_delta_size_does_not_depend_on_unchanged_objects) {
+    size_t smallBytes = 0;
+    size_t largeBytes = 0;
+
+    for (int objectCount : { 10, 1000 }) {
+        WorldSnapshot baseline(makeSnapshot(1, objectCount));
+        WorldSnapshot snapshot(makeSnapshot(2, objectCount));
+        snapshot.objects[5].facing = quantizeFacing(1.0f);
+
+        roundTrip(baseline, snapshot, objectCount == 10 ? smallBytes : largeBytes);
+    }
+
+    BOOST_TEST(smallBytes == largeBytes);
+}
+
+BOOST_AUTO_TEST_CASE(test_limited_snapshots_eventually_deliver_every_update) {
+    WorldSnapshot baseline(makeSnapshot(1, 10));
+    baseline.objects.erase(baseline.objects.begin() + 9);
+
+    // Every object has moved, and the last one is added
+    WorldSnapshot snapshot(makeSnapshot(2, 10));
+    for (auto &state : snapshot.objects) {
+        state.position[2] += quantizePosition(1.0f);
+    }
+    BOOST_TEST(countSnapshotUpdates(baseline, snapshot) == 10);
+
+    WorldSnapshot limited(limitSnapshotUpdates(baseline, snapshot, 8, 3));
+
+    // Updates 8, 9 and 0 are kept, others keep their baseline state
+    BOOST_TEST(limited.objects.size() == 10ull);
+    BOOST_TEST((limited.objects[0] == snapshot.objects[0]));
+    BOOST_TEST((limited.objects[1] == baseline.objects[1]));
+    BOOST_TEST((limited.objects[8] == snapshot.objects[8]));
+    BOOST_TEST((limited.objects[9] == snapshot.objects[9]));
+
+    // Acknowledged limited snapshots become baselines, until nothing is left
+    int firstUpdate = 0;
+    for (int i = 0; i < 4; ++i) {
+        size_t bytes = 0;
+        baseline = roundTrip(baseline, limitSnapshotUpdates(baseline, snapshot, firstUpdate, 3), bytes);
+        firstUpdate += 3;
+    }
+    BOOST_TEST(countSnapshotUpdates(baseline, snapshot) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_snapshot_quantization) {
+    BOOST_TEST(abs(dequantizePosition(quantizePosition(12.345f)) - 12.345f) < 0.005f);
+    BOOST_TEST(quantizeFacing(0.0f) == quantizeFacing(glm::two_pi<float>()));
+}
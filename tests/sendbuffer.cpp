@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE sendbuffer
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/common/mpscqueue.h"
+#include "../src/net/sendbuffer.h"
+
+using namespace std;
+
+using namespace reone;
+using namespace reone::net;
+
+BOOST_AUTO_TEST_CASE(test_send_buffers_released_on_another_thread_are_reused) {
+    static const int kBufferCount = 64;
+    static const int kRoundCount = 100;
+
+    SendBufferPool &pool = SendBufferPool::instance();
+    set<SendBuffer *> allocated;
+    bool intact = true;
+
+    // The calling thread acquires buffers and entries, like the replication
+    // thread, and another thread releases them, like an io thread on write
+    // completion
+
+    for (int round = 0; round < kRoundCount; ++round) {
+        MpscQueue<SendQueueEntry> queue;
+        for (int i = 0; i < kBufferCount; ++i) {
+            SendBuffer *buffer = pool.acquire();
+            buffer->data.push_back(static_cast<char>(i));
+            buffer->finish();
+            allocated.insert(buffer);
+
+            queue.push(pool.acquireEntry(buffer));
+            pool.release(buffer);
+        }
+        thread releaser([&]() {
+            for (int released = 0; released < kBufferCount;) {
+                SendQueueEntry *entry = queue.pop();
+                if (!entry) {
+                    this_thread::yield();
+                    continue;
+                }
+                intact &= entry->buffer->data.size() == 3;
+                pool.releaseEntry(entry);
+                ++released;
+            }
+        });
+        releaser.join();
+    }
+    BOOST_TEST(intact);
+
+    // Buffers come back to the cache of the acquiring thread, so they are
+    // allocated once rather than every round
+    BOOST_TEST(allocated.size() < 2ull * kBufferCount);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE spscqueue
+
+#include <thread>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "../src/common/spscqueue.h"
+
+using namespace std;
+
+using namespace reone;
+
+BOOST_AUTO_TEST_CASE(test_spsc_queue_rejects_push_when_full) {
+    SpscQueue<int> queue(3);
+    BOOST_TEST(queue.capacity() == 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        BOOST_TEST(queue.push(i));
+    }
+    BOOST_TEST(!queue.push(4));
+
+    int value = -1;
+    BOOST_TEST(queue.pop(value));
+    BOOST_TEST(value == 0);
+    BOOST_TEST(queue.push(4));
+
+    for (int i = 1; i <= 4; ++i) {
+        BOOST_TEST(queue.pop(value));
+        BOOST_TEST(value == i);
+    }
+    BOOST_TEST(queue.empty());
+    BOOST_TEST(!queue.pop(value));
+}
+
+BOOST_AUTO_TEST_CASE(test_spsc_queue_preserves_order_across_threads) {
+    static const int kValueCount = 100000;
+
+    SpscQueue<int> queue(64);
+
+    thread producer([&queue]() {
+        for (int i = 0; i < kValueCount; ++i) {
+            while (!queue.push(i)) {
+                this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    bool ordered = true;
+
+    while (expected < kValueCount) {
+        int value;
+        if (!queue.pop(value)) {
+            this_thread::yield();
+            continue;
+        }
+        ordered &= value == expected++;
+    }
+    producer.join();
+
+    BOOST_TEST(ordered);
+    BOOST_TEST(queue.empty());
+}
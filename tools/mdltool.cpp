@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020 The reone project contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tools.h"
+
+#include <iterator>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include "../src/common/streamutil.h"
+#include "../src/render/model/bakedmodel.h"
+#include "../src/render/model/mdlfile.h"
+
+using namespace std;
+
+using namespace reone::render;
+using namespace reone::resource;
+
+namespace fs = boost::filesystem;
+
+namespace reone {
+
+namespace tools {
+
+static ByteArray readFile(const fs::path &path) {
+    fs::ifstream in(path, ios::binary);
+    return ByteArray((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+}
+
+MdlTool::MdlTool(GameVersion version) : _version(version) {
+}
+
+void MdlTool::convert(const fs::path &path, const fs::path &destPath) const {
+    fs::path mdxPath(path);
+    mdxPath.replace_extension(".mdx");
+
+    if (!fs::exists(mdxPath)) {
+        throw runtime_error("MDX file not found: " + mdxPath.string());
+    }
+    ByteArray mdlData(readFile(path));
+    ByteArray mdxData(readFile(mdxPath));
+
+    MdlFile mdl(_version, false);
+    mdl.load(wrap(mdlData), wrap(mdxData));
+
+    shared_ptr<Model> model(mdl.model());
+    if (!model) {
+        throw runtime_error("Unable to load MDL file: " + path.string());
+    }
+
+    // Baked models are looked up by resource reference
+    string resRef(path.stem().string());
+    boost::to_lower(resRef);
+
+    fs::path bakedPath(destPath);
+    bakedPath.append(resRef + ".rbm");
+
+    BakedModelSource source;
+    source.mdlSize = static_cast<uint32_t>(mdlData.size());
+    source.mdxSize = static_cast<uint32_t>(mdxData.size());
+
+    BakedModelWriter writer(_version, source);
+    writer.save(*model, bakedPath);
+}
+
+} // namespace tools
+
+} // namespace reone
@@ -67,7 +67,7 @@ void Program::initOptions() {
         ("help", "print this message")
         ("list", "list file contents")
         ("extract", "extract file contents")
-        ("convert", "convert 2DA or GFF file to JSON")
+        ("convert", "convert 2DA or GFF file to JSON, MDL file to baked model")
         ("game", po::value<string>(), "path to game directory")
         ("dest", po::value<string>(), "path to destination directory")
         ("input-file", po::value<string>(), "path to input file");
@@ -42,7 +42,7 @@ namespace tools {
  * Operations:
  * - list — list file contents
  * - extract — extract file contents
- * - convert — convert file to JSON
+ * - convert — convert file to JSON, or to another binary format
  */
 class Tool {
 public:
@@ -92,6 +92,19 @@ public:
     void convert(const boost::filesystem::path &path, const boost::filesystem::path &destPath) const override;
 };
 
+class MdlTool : public Tool {
+public:
+    MdlTool(resource::GameVersion version);
+
+    /**
+     * Converts MDL and MDX file pair into a baked model.
+     */
+    void convert(const boost::filesystem::path &path, const boost::filesystem::path &destPath) const override;
+
+private:
+    resource::GameVersion _version { resource::GameVersion::KotOR };
+};
+
 class GffTool : public Tool {
 public:
     void convert(const boost::filesystem::path &path, const boost::filesystem::path &destPath) const override;